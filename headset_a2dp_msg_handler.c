@@ -15,6 +15,7 @@ Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
 #include "headset_debug.h"
 #include "headset_hfp_slc.h"
 #include "headset_init.h"
+#include "headset_intercom_msg_handler.h"
 #include "headset_link_policy.h"
 #include "headset_private.h"
 #include "headset_statemanager.h"
@@ -159,11 +160,11 @@ static void handleA2DPStartInd(hsTaskData *app, A2DP_START_IND_T *msg)
     if (!A2dpGetMediaSink(app->a2dp) || (stateManagerIsA2dpStreaming()))
         return;
 
-    if((app->aghfp_connect && app->audio_connect) || HfpGetAudioSink(app->intercom_hsp)) /* Unknown power off when play smart phone button tone sound during intercom. v110519 */
+    if(intercomIsAudioActive(app) || HfpGetAudioSink(app->intercom_hsp)) /* Unknown power off when play smart phone button tone sound during intercom. v110519 */
         return;
 
 #if 0  /* Unknown power off when play smart phone button tone sound during intercom. v110519 */
-    if (HfpGetAudioSink(app->hfp_hsp) || hfpSlcIsConnecting(app) || (app->aghfp_connect && app->audio_connect))
+    if (HfpGetAudioSink(app->hfp_hsp) || hfpSlcIsConnecting(app) || intercomIsAudioActive(app))
 #else
     if (HfpGetAudioSink(app->hfp_hsp) || hfpSlcIsConnecting(app))
 #endif
@@ -190,7 +191,7 @@ static void handleA2DPStartCfm(hsTaskData *app, A2DP_START_CFM_T *msg)
         /* start Kalimba decoding if it isn't already */
         if (!stateManagerIsA2dpStreaming())
         {			
-            if (HfpGetAudioSink(app->hfp_hsp) || hfpSlcIsConnecting(app) || (app->aghfp_connect && app->audio_connect))
+            if (HfpGetAudioSink(app->hfp_hsp) || hfpSlcIsConnecting(app) || intercomIsAudioActive(app))
             {
                 /* 
                     SCO has become active while we were waiting for a START_CFM (or SLC
@@ -199,6 +200,7 @@ static void handleA2DPStartCfm(hsTaskData *app, A2DP_START_CFM_T *msg)
 				    suspend the source again.
 				*/
                 A2dpSuspend(app->a2dp);
+                VolumeRiseCancel();
                 return;
             }
 
@@ -219,6 +221,7 @@ static void handleA2DPStartCfm(hsTaskData *app, A2DP_START_CFM_T *msg)
     else
     {
         A2DP_MSG_DEBUG(("Start Failed [Status %d]\n", msg->status));
+        VolumeRiseCancel();
 		
 		/* Workaraound for Samsung phones to start audio playing once media is connected.
  		   The phone sends an avdtp_start as soon as it receives the avdtp_open, so the
@@ -394,6 +397,8 @@ static void handleA2DPSignallingConnected(hsTaskData *app, a2dp_status_code stat
 
     app->a2dp = a2dp;
 #endif
+
+    reconnectStop(&app->a2dp_reconnect, &app->task, APP_A2DP_RECONNECT);
     
     /* We are now connected */
     if (!stateManagerIsA2dpStreaming())
@@ -463,6 +468,9 @@ static void handleA2DPSignallingDisconnected(hsTaskData *app, A2DP_SIGNALLING_CH
 			/* Standard reconnect procedure for A2DP */
             /* for Lock Up side of Stereo Dongle that attemp auto connection */
 			/*a2dpReconnectProcedure(app);*/
+			/* Leave the dongle time to reconnect before paging it ourselves */
+			reconnectStart(&app->a2dp_reconnect);
+			(void)reconnectSchedule(&app->a2dp_reconnect, reconnectA2dp, &app->task, APP_A2DP_RECONNECT, app->page_scan_enabled);
         }
 	}
 	else
@@ -495,7 +503,7 @@ void handleA2DPMessage( Task task, MessageId id, Message message )
 	case A2DP_SIGNALLING_CHANNEL_CONNECT_IND:
         A2DP_MSG_DEBUG(("A2DP_SIGNALLING_CHANNEL_CONNECT_IND : \n"));
 
-        if(app->aghfp_connect && app->audio_connect) /* Power OFF occur during Intercom */
+        if(intercomIsAudioActive(app)) /* Power OFF occur during Intercom */
         {
             A2DP_MSG_DEBUG(("Reject\n"));
             A2dpConnectSignallingChannelResponse(((A2DP_SIGNALLING_CHANNEL_CONNECT_IND_T *)message)->a2dp,
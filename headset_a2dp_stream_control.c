@@ -19,6 +19,8 @@ Copyright (C) Cambridge Silicon Radio Ltd. 2005-2008
 #include "headset_hfp_slc.h"
 #include "headset_init.h"
 #include "headset_statemanager.h"
+#include "headset_tone_cache.h"
+#include "headset_vad.h"
 #include "headset_volume.h"
 
 #include <audio.h>
@@ -63,6 +65,9 @@ void streamControlCeaseA2dpStreaming(hsTaskData *app, bool send_suspend)
 	{		
 		AudioDisconnect();
 		app->dsp_process = dsp_process_none;
+#ifdef VOICE_VAD
+		vadCodecReleased();
+#endif
 		STREAM_DEBUG(("CeaseStreaming - disconnect audio\n"));
 
 		/* Turn the audio amp off after a delay */
@@ -149,12 +154,19 @@ void streamControlConnectA2dpAudio(hsTaskData *app)
     }
 #endif
 
+#ifdef TONE_CACHE
+    toneCacheStop();
+#endif
+#ifdef VOICE_VAD
+    vadCodecClaimed();
+#endif
+
     /* v091111 Release */
     result = AudioConnect(audio_plugin,
                             A2dpGetMediaSink(app->a2dp),
                             AUDIO_SINK_AV,
                             app->theCodecTask,
-                            VolumeRetrieveGain(app->gAvVolumeLevel, TRUE),
+                            VolumeConnectGain(app, TRUE),
                             rate,
                             TRUE,
                             mode,
@@ -189,13 +201,19 @@ void streamControlCancelResumeA2dpStreaming(hsTaskData *app)
 void streamControlBeginA2dpStreaming(hsTaskData *app)
 {				  
 	if (HfpGetAudioSink(app->hfp_hsp) || (!A2dpGetMediaSink(app->a2dp)))
+	{
+		/* No A2DP audio is coming for a rise to be kept for */
+		VolumeRiseCancel();
 		return;
+	}
 
 	STREAM_DEBUG(("streamControlBeginA2dpStreaming\n"));
 	if (!stateManagerIsA2dpStreaming() && app->a2dpSourceSuspended)
 	{
 		STREAM_DEBUG(("Begin Streaming - start A2DP\n"));
 		streamControlStartA2dp(app);			
+		/* The audio connects, and takes any rise, once the source has started */
+		return;
 	}
 	
 	if (stateManagerIsA2dpStreaming() && (app->dsp_process != dsp_process_a2dp))
@@ -203,6 +221,9 @@ void streamControlBeginA2dpStreaming(hsTaskData *app)
 		STREAM_DEBUG(("Begin Streaming - connect audio\n"));
 		streamControlConnectA2dpAudio(app);
 	}
+
+	/* The audio is connected by now if it is coming at all */
+	VolumeRiseCancel();
 }
 
 
@@ -67,7 +67,8 @@ NAME
      streamControlBeginA2dpStreaming
     
 DESCRIPTION
-     Actually begin A2DP streaming and audio now if possible.
+     Actually begin A2DP streaming and audio now if possible. A rise asked
+     for by VolumeRiseNextA2dp is dropped if no A2DP audio follows.
 
 */
 void streamControlBeginA2dpStreaming(hsTaskData *app);
@@ -0,0 +1,125 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    headset_adpcm.c
+@brief   Implementation of the IMA ADPCM decoder.
+*/
+
+/****************************************************************************
+    Header files
+*/
+
+#include "headset_adpcm.h"
+
+
+/* Step sizes of the IMA ADPCM standard */
+static const uint16 gStep [ ADPCM_INDEX_MAX + 1 ] =
+{
+        7 ,     8 ,     9 ,    10 ,    11 ,    12 ,    13 ,    14 ,    16 ,    17 ,
+       19 ,    21 ,    23 ,    25 ,    28 ,    31 ,    34 ,    37 ,    41 ,    45 ,
+       50 ,    55 ,    60 ,    66 ,    73 ,    80 ,    88 ,    97 ,   107 ,   118 ,
+      130 ,   143 ,   157 ,   173 ,   190 ,   209 ,   230 ,   253 ,   279 ,   307 ,
+      337 ,   371 ,   408 ,   449 ,   494 ,   544 ,   598 ,   658 ,   724 ,   796 ,
+      876 ,   963 ,  1060 ,  1166 ,  1282 ,  1411 ,  1552 ,  1707 ,  1878 ,  2066 ,
+     2272 ,  2499 ,  2749 ,  3024 ,  3327 ,  3660 ,  4026 ,  4428 ,  4871 ,  5358 ,
+     5894 ,  6484 ,  7132 ,  7845 ,  8630 ,  9493 , 10442 , 11487 , 12635 , 13899 ,
+    15289 , 16818 , 18500 , 20350 , 22385 , 24623 , 27086 , 29794 , 32767
+} ;
+
+/* Change of step index for each code magnitude */
+static const int16 gIndexStep [ 8 ] =
+{
+    -1 , -1 , -1 , -1 , 2 , 4 , 6 , 8
+} ;
+
+
+/****************************************************************************
+  FUNCTIONS
+*/
+
+/**************************************************************************/
+void adpcmInit ( adpcmState_t * pState )
+{
+    pState->predicted = 0 ;
+    pState->index     = 0 ;
+}
+
+
+/**************************************************************************/
+int16 adpcmStep ( adpcmState_t * pState , uint16 pCode )
+{
+    uint16 lStep = gStep [ pState->index ] ;
+    int32 lDifference = lStep >> 3 ;
+    int32 lPredicted = pState->predicted ;
+    int16 lIndex = (int16) pState->index + gIndexStep [ pCode & 7 ] ;
+
+    if ( pCode & 4 )
+        lDifference += lStep ;
+    if ( pCode & 2 )
+        lDifference += lStep >> 1 ;
+    if ( pCode & 1 )
+        lDifference += lStep >> 2 ;
+
+    if ( pCode & 8 )
+        lPredicted -= lDifference ;
+    else
+        lPredicted += lDifference ;
+
+    if ( lPredicted > 32767 )
+        lPredicted = 32767 ;
+    else if ( lPredicted < -32768 )
+        lPredicted = -32768 ;
+
+    if ( lIndex < 0 )
+        lIndex = 0 ;
+    else if ( lIndex > ADPCM_INDEX_MAX )
+        lIndex = ADPCM_INDEX_MAX ;
+
+    pState->predicted = (int16) lPredicted ;
+    pState->index     = (uint16) lIndex ;
+
+    return pState->predicted ;
+}
+
+
+/**************************************************************************/
+void adpcmDecode ( adpcmState_t * pState , const uint16 * pCodes , int16 * pOut , uint16 pSamples )
+{
+    int32 lPredicted = pState->predicted ;
+    int16 lIndex = (int16) pState->index ;
+    uint16 i ;
+
+        /*adpcmStep, with the state kept in locals rather than written back each sample*/
+    for ( i = 0 ; i < pSamples ; i++ )
+    {
+        uint16 lCode = ( pCodes [ i / ADPCM_CODES_PER_WORD ] >> ( 12 - 4 * ( i & ( ADPCM_CODES_PER_WORD - 1 ) ) ) ) & 0xf ;
+        uint16 lStep = gStep [ lIndex ] ;
+        int32 lDifference = lStep >> 3 ;
+
+        if ( lCode & 4 )
+            lDifference += lStep ;
+        if ( lCode & 2 )
+            lDifference += lStep >> 1 ;
+        if ( lCode & 1 )
+            lDifference += lStep >> 2 ;
+
+        lPredicted += ( lCode & 8 ) ? -lDifference : lDifference ;
+        if ( lPredicted > 32767 )
+            lPredicted = 32767 ;
+        else if ( lPredicted < -32768 )
+            lPredicted = -32768 ;
+
+        lIndex += gIndexStep [ lCode & 7 ] ;
+        if ( lIndex < 0 )
+            lIndex = 0 ;
+        else if ( lIndex > ADPCM_INDEX_MAX )
+            lIndex = ADPCM_INDEX_MAX ;
+
+        pOut [ i ] = (int16) lPredicted ;
+    }
+
+    pState->predicted = (int16) lPredicted ;
+    pState->index     = (uint16) lIndex ;
+}
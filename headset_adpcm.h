@@ -0,0 +1,86 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    headset_adpcm.h
+@brief   Streaming IMA ADPCM decoder for sounds stored in the image.
+
+    The voice prompts (see headset_prompts.h) are kept in the image as 4
+    bit IMA ADPCM, a quarter of the size of 16 bit PCM. Four codes are packed in each uint16 word, the
+    first sample's code in the top nibble, since the XAP addresses words
+    rather than octets.
+
+    The decoder keeps only the predicted sample and the step index between
+    calls, so a sound is decoded a block at a time into whatever buffer
+    the caller is about to write to its sink, however long the sound is.
+*/
+
+#ifndef _HEADSET_ADPCM_H_
+#define _HEADSET_ADPCM_H_
+
+
+#include <csrtypes.h>
+
+
+/* Codes packed in each word */
+#define ADPCM_CODES_PER_WORD    (4)
+
+/* Words that hold pSamples codes */
+#define ADPCM_WORDS(pSamples)   ( ( (pSamples) + ADPCM_CODES_PER_WORD - 1 ) / ADPCM_CODES_PER_WORD )
+
+/* Largest step index */
+#define ADPCM_INDEX_MAX         (88)
+
+
+/*! @brief Decoder state carried from one block of a sound to the next */
+typedef struct
+{
+    int16       predicted ;     /*!< Last sample decoded */
+    uint16      index ;         /*!< Step size index, 0 to ADPCM_INDEX_MAX */
+} adpcmState_t ;
+
+
+/****************************************************************************
+  FUNCTIONS
+*/
+
+/*************************************************************************
+NAME
+    adpcmInit
+
+DESCRIPTION
+    Start decoding a sound from silence at the smallest step, as the sounds
+    are encoded.
+
+*/
+void adpcmInit ( adpcmState_t * pState ) ;
+
+
+/*************************************************************************
+NAME
+    adpcmStep
+
+DESCRIPTION
+    Decode one 4 bit code, updating the state.
+
+RETURNS
+    The sample. The encoder calls this too, to follow the decoder exactly.
+*/
+int16 adpcmStep ( adpcmState_t * pState , uint16 pCode ) ;
+
+
+/*************************************************************************
+NAME
+    adpcmDecode
+
+DESCRIPTION
+    Decode pSamples samples into pOut from the packed codes at pCodes,
+    starting with the top nibble of the first word. pSamples must be a
+    multiple of ADPCM_CODES_PER_WORD except for the last block of a sound.
+
+*/
+void adpcmDecode ( adpcmState_t * pState , const uint16 * pCodes , int16 * pOut , uint16 pSamples ) ;
+
+
+#endif /* _HEADSET_ADPCM_H_ */
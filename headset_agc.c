@@ -0,0 +1,192 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    headset_agc.c
+@brief   Implementation of the intercom automatic gain control.
+*/
+
+/****************************************************************************
+    Header files
+*/
+
+#include "headset_agc.h"
+#include "headset_debug.h"
+
+#include <string.h>
+
+
+#ifdef DEBUG_AGC
+    #define AGC_DEBUG(x) DEBUG(x)
+#else
+    #define AGC_DEBUG(x)
+#endif
+
+
+/* The level rises to a louder frame of speech in about 2 frames, 7.5ms,
+   and falls to a quieter one over about 64 frames, 240ms */
+#define AGC_ATTACK_SHIFT    (1)
+#define AGC_RELEASE_SHIFT   (6)
+
+/* The noise floor falls to a quieter frame in about 4 frames and rises to a
+   louder one over about 1s, or 15s while that is speech */
+#define AGC_NOISE_FALL_SHIFT    (2)
+#define AGC_NOISE_RISE_SHIFT    (8)
+#define AGC_NOISE_RISE_SHIFT_SPEECH (12)
+
+/* A frame is speech when its mean magnitude is above about -57dBFS and
+   12dB above the noise floor */
+#define AGC_GATE            (48)
+#define AGC_GATE_SHIFT      (2)
+
+/* Pause before the gate closes, 300ms, and how far it then turns the rider
+   down below their speech gain, 12dB */
+#define AGC_HOLD_FRAMES     (80)
+#define AGC_GATE_DEPTH      (2)
+
+/* Speech is turned down by at most 36dB and up by at most 24dB */
+#define AGC_GAIN_MIN        ( AGC_UNITY / 64 )
+#define AGC_GAIN_MAX        (32767)
+
+/* No sample leaves louder than -1dBFS */
+#define AGC_LIMIT           (29204)
+
+/* While the gate is open the gain rises by at most 1/16 a frame, about
+   0.5dB, so it recovers smoothly from the limiter */
+#define AGC_RECOVER_SHIFT   (4)
+
+
+/****************************************************************************
+  FUNCTIONS
+*/
+
+/**************************************************************************/
+void agcInit ( agcState_t * pState , uint16 pTarget )
+{
+    memset ( pState , 0 , sizeof ( agcState_t ) ) ;
+
+    pState->target = pTarget ;
+    pState->level  = (uint32) pTarget << 8 ;
+    pState->gain   = AGC_UNITY >> AGC_GATE_DEPTH ;
+}
+
+
+/**************************************************************************/
+void agcSetTarget ( agcState_t * pState , uint16 pTarget )
+{
+    AGC_DEBUG(("AGC: target %d\n" , pTarget)) ;
+    pState->target = pTarget ;
+}
+
+
+/**************************************************************************/
+uint16 agcTargetForStep ( uint16 pSteps )
+{
+    uint16 lTarget ;
+
+    if ( pSteps > 30 )
+        pSteps = 30 ;
+
+        /*6dB for every two steps, and 3dB more for an odd one*/
+    lTarget = AGC_TARGET_MAX >> ( pSteps >> 1 ) ;
+    if ( pSteps & 1 )
+        lTarget = (uint16) ( ( (uint32) lTarget * 23170 ) >> 15 ) ;
+
+    return lTarget ? lTarget : 1 ;
+}
+
+
+/**************************************************************************/
+void agcProcess ( agcState_t * pState , int16 * pFrame , uint16 pSamples )
+{
+    uint32 lSum = 0 ;
+    uint32 lMean ;
+    uint32 lLevel ;
+    uint32 lWanted ;
+    uint16 lPeak = 0 ;
+    uint16 lStart = pState->gain ;
+    uint16 lEnd ;
+    int32 lGain ;
+    int32 lStep ;
+    bool lOpen = ( pState->hold != 0 ) ;
+    bool lSpeech ;
+    uint16 i ;
+
+    if ( !pSamples )
+        return ;
+
+        /*mean and peak magnitude; no branches so the loop can be unrolled or vectorised*/
+    for ( i = 0 ; i < pSamples ; i++ )
+    {
+        int32 lSample = pFrame [ i ] ;
+        uint16 lMagnitude = (uint16) ( ( lSample < 0 ) ? -lSample : lSample ) ;
+
+        lSum  += lMagnitude ;
+        lPeak  = ( lMagnitude > lPeak ) ? lMagnitude : lPeak ;
+    }
+
+    lMean = ( lSum << 8 ) / pSamples ;
+
+    lSpeech = ( lMean > ( (uint32) AGC_GATE << 8 ) ) && ( lMean > ( pState->noise << AGC_GATE_SHIFT ) ) ;
+
+    if ( lSpeech )
+    {
+        if ( lMean > pState->level )
+            pState->level += ( lMean - pState->level ) >> AGC_ATTACK_SHIFT ;
+        else
+            pState->level -= ( pState->level - lMean ) >> AGC_RELEASE_SHIFT ;
+
+        if ( !pState->hold )
+        {
+            AGC_DEBUG(("AGC: open, level %ld\n" , pState->level >> 8)) ;
+        }
+        pState->hold = AGC_HOLD_FRAMES ;
+    }
+    else if ( pState->hold )
+    {
+        pState->hold-- ;
+    }
+
+    if ( lMean < pState->noise )
+        pState->noise -= ( pState->noise - lMean ) >> AGC_NOISE_FALL_SHIFT ;
+    else
+        pState->noise += ( ( lMean - pState->noise ) >> ( lSpeech ? AGC_NOISE_RISE_SHIFT_SPEECH : AGC_NOISE_RISE_SHIFT ) ) + 1 ;
+
+    lLevel  = pState->level >> 8 ;
+    lWanted = ( (uint32) pState->target << AGC_GAIN_BITS ) / ( lLevel ? lLevel : 1 ) ;
+
+    if ( lWanted < AGC_GAIN_MIN )
+        lWanted = AGC_GAIN_MIN ;
+    if ( lWanted > AGC_GAIN_MAX )
+        lWanted = AGC_GAIN_MAX ;
+
+    if ( !pState->hold )
+        lWanted >>= AGC_GATE_DEPTH ;
+
+        /*opening the gate is immediate so the first syllable is heard; after that recover gradually*/
+    else if ( lOpen && ( lWanted > (uint32) lStart + ( lStart >> AGC_RECOVER_SHIFT ) + 1 ) )
+        lWanted = (uint32) lStart + ( lStart >> AGC_RECOVER_SHIFT ) + 1 ;
+
+    lEnd = (uint16) lWanted ;
+
+        /*limit: both ends of the ramp must keep the frame's peak below the limit*/
+    if ( lPeak && ( ( (uint32) lPeak * ( ( lStart > lEnd ) ? lStart : lEnd ) ) >> AGC_GAIN_BITS ) > AGC_LIMIT )
+    {
+        lEnd = (uint16) ( ( (uint32) AGC_LIMIT << AGC_GAIN_BITS ) / lPeak ) ;
+        if ( lStart > lEnd )
+            lStart = lEnd ;
+    }
+
+    pState->gain = lEnd ;
+
+        /*ramp the gain across the frame; the limiter has bounded every product*/
+    lGain = (int32) lStart << 8 ;
+    lStep = ( ( (int32) lEnd - lStart ) << 8 ) / pSamples ;
+
+    for ( i = 0 ; i < pSamples ; i++ )
+    {
+        lGain += lStep ;
+        pFrame [ i ] = (int16) ( ( (int32) pFrame [ i ] * ( lGain >> 8 ) ) >> AGC_GAIN_BITS ) ;
+    }
+}
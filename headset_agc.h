@@ -0,0 +1,111 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    headset_agc.h
+@brief   Automatic gain control of the audio received from intercom riders.
+
+    Riders' voices arrive at very different levels, depending on their
+    helmet, microphone and how loudly they speak, so without AGC the
+    listener keeps stepping the volume. This stage brings the mean level
+    of each rider's speech to a target set by the listener's volume step.
+
+    The level is followed with a fast attack and a slow release, and the
+    gain is the target over that level, between AGC_GAIN_MIN and
+    AGC_GAIN_MAX. Frames quieter than AGC_GATE are not speech: the level is
+    not followed through them, so pauses do not pump the gain up, and once
+    they have lasted AGC_HOLD_FRAMES the gate closes and the rider's
+    background noise is turned down. A limiter, which sees each frame
+    before it is scaled, turns the gain down so no sample exceeds
+    AGC_LIMIT, and lets it recover gradually.
+
+    agcProcess works on whole frames in place, with the gain ramped across
+    each frame. Its time constants are counted in frames of
+    AGC_FRAME_SAMPLES; each rider needs their own agcState_t.
+*/
+
+#ifndef _HEADSET_AGC_H_
+#define _HEADSET_AGC_H_
+
+
+#include <csrtypes.h>
+
+
+/* Samples per frame, 3.75ms at 8kHz, as the conference mixes them */
+#define AGC_FRAME_SAMPLES   (30)
+
+/* Gains are Q11, so up to 16 times */
+#define AGC_GAIN_BITS       (11)
+#define AGC_UNITY           ( 1 << AGC_GAIN_BITS )
+
+/* Level of speech at the top volume step, about -24dBFS. The level is the
+   mean magnitude of a frame, followed near the loudest frames of each
+   syllable, so a whole phrase averages several dB below it */
+#define AGC_TARGET_MAX      (2048)
+
+
+/*! @brief Gain control state of one rider */
+typedef struct
+{
+    uint32      level ;         /*!< Followed mean magnitude of speech, Q8 */
+    uint32      noise ;         /*!< Floor of the mean magnitude, Q8 */
+    uint16      target ;        /*!< Mean magnitude the level is brought to */
+    uint16      gain ;          /*!< Gain at the end of the last frame, Q11 */
+    uint16      hold ;          /*!< Frames left before the gate closes */
+} agcState_t ;
+
+
+/****************************************************************************
+  FUNCTIONS
+*/
+
+/*************************************************************************
+NAME
+    agcInit
+
+DESCRIPTION
+    Start a rider at unity gain with the gate closed, aiming for pTarget.
+
+*/
+void agcInit ( agcState_t * pState , uint16 pTarget ) ;
+
+
+/*************************************************************************
+NAME
+    agcSetTarget
+
+DESCRIPTION
+    Change the mean magnitude the rider's speech is brought to. The gain
+    follows over the next frames.
+
+*/
+void agcSetTarget ( agcState_t * pState , uint16 pTarget ) ;
+
+
+/*************************************************************************
+NAME
+    agcTargetForStep
+
+DESCRIPTION
+    The target pSteps volume steps of 3dB below the top one.
+
+RETURNS
+    A mean magnitude for agcSetTarget.
+*/
+uint16 agcTargetForStep ( uint16 pSteps ) ;
+
+
+/*************************************************************************
+NAME
+    agcProcess
+
+DESCRIPTION
+    Scale a frame of pSamples samples in place, at most
+    AGC_FRAME_SAMPLES * 4.
+
+*/
+void agcProcess ( agcState_t * pState , int16 * pFrame , uint16 pSamples ) ;
+
+
+#endif /* _HEADSET_AGC_H_ */
@@ -0,0 +1,185 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    headset_audio_switch.c
+@brief   Implementation of the A2DP to intercom audio switch.
+*/
+
+/****************************************************************************
+    Header files
+*/
+
+#include "headset_audio_switch.h"
+#include "headset_a2dp_stream_control.h"
+#include "headset_amp.h"
+#include "headset_debug.h"
+#include "headset_intercom_msg_handler.h"
+#include "headset_statemanager.h"
+
+#include <vm.h>
+
+
+#ifdef DEBUG_AUDIO_SWITCH
+    #define SWITCH_DEBUG(x) DEBUG(x)
+#else
+    #define SWITCH_DEBUG(x)
+#endif
+
+
+/* The switch in progress */
+typedef struct
+{
+    uint32                  start ;         /* VmGetClock when the switch started */
+    uint16                  pending ;       /* SCO connections requested and not yet answered */
+    unsigned                a2dp_released:1 ;
+    audioSwitchTimings_t    timings ;
+} audioSwitch_t ;
+
+static audioSwitch_t gSwitch ;
+
+
+/****************************************************************************
+  LOCAL FUNCTIONS
+*/
+
+static uint16 audioSwitchElapsed ( void )
+{
+    uint32 lElapsed = VmGetClock () - gSwitch.start ;
+
+    return ( lElapsed < AUDIO_SWITCH_NOT_REACHED ) ? (uint16) lElapsed : AUDIO_SWITCH_NOT_REACHED - 1 ;
+}
+
+
+static void audioSwitchReset ( void )
+{
+    gSwitch.start         = VmGetClock () ;
+    gSwitch.pending       = 0 ;
+    gSwitch.a2dp_released = FALSE ;
+
+    gSwitch.timings.a2dp_ms   = AUDIO_SWITCH_NOT_REACHED ;
+    gSwitch.timings.amp_ms    = AUDIO_SWITCH_NOT_REACHED ;
+    gSwitch.timings.sco_ms    = AUDIO_SWITCH_NOT_REACHED ;
+    gSwitch.timings.plugin_ms = AUDIO_SWITCH_NOT_REACHED ;
+}
+
+
+/* Stop A2DP audio, unloading its plugin, if it is streaming */
+static void audioSwitchReleaseA2dp ( hsTaskData * pApp )
+{
+    if ( ( stateManagerGetA2dpState () == headsetA2dpStreaming ) || ( stateManagerGetA2dpState () == headsetA2dpPaused ) )
+    {
+#ifdef DUAL_STREAM
+        pApp->a2dp_state_change = TRUE ; /* SUSPEND */
+
+        streamControlCeaseA2dpStreaming ( pApp , FALSE ) ;
+        stateManagerEnterA2dpConnectedState ( pApp ) ; /* SUSPEND */
+#else
+        streamControlCeaseA2dpStreaming ( pApp , TRUE ) ;
+#endif
+        gSwitch.a2dp_released = TRUE ;
+        gSwitch.timings.a2dp_ms = audioSwitchElapsed () ;
+    }
+}
+
+
+static void audioSwitchAmpOn ( hsTaskData * pApp )
+{
+    AmpOn ( pApp ) ;
+
+    if ( gSwitch.timings.amp_ms == AUDIO_SWITCH_NOT_REACHED )
+        gSwitch.timings.amp_ms = audioSwitchElapsed () ;
+}
+
+
+/****************************************************************************
+  FUNCTIONS
+*/
+
+/**************************************************************************/
+void audioSwitchStart ( hsTaskData * pApp , uint16 pLinks )
+{
+    if ( !pLinks )
+        return ;
+
+    if ( gSwitch.pending )
+    {
+            /*more links joining a switch already under way*/
+        gSwitch.pending += pLinks ;
+        return ;
+    }
+
+    audioSwitchReset () ;
+    gSwitch.pending = pLinks ;
+
+    audioSwitchReleaseA2dp ( pApp ) ;
+    audioSwitchAmpOn ( pApp ) ;
+
+    SWITCH_DEBUG(("SWITCH: start %d links, a2dp %d\n" , pLinks , gSwitch.a2dp_released)) ;
+}
+
+
+/**************************************************************************/
+void audioSwitchScoConnected ( hsTaskData * pApp )
+{
+        /*a late answer to a link already given up on finds none pending*/
+    if ( gSwitch.pending )
+        gSwitch.pending-- ;
+    else if ( ( gSwitch.timings.plugin_ms != AUDIO_SWITCH_NOT_REACHED ) && ( pApp->dsp_process != dsp_process_sco ) )
+        audioSwitchReset () ;       /*opened by the far end, rather than a rider joining*/
+
+    if ( gSwitch.timings.sco_ms == AUDIO_SWITCH_NOT_REACHED )
+        gSwitch.timings.sco_ms = audioSwitchElapsed () ;
+
+    audioSwitchReleaseA2dp ( pApp ) ;
+    audioSwitchAmpOn ( pApp ) ;
+}
+
+
+/**************************************************************************/
+void audioSwitchPluginConnected ( hsTaskData * pApp )
+{
+    if ( gSwitch.timings.plugin_ms != AUDIO_SWITCH_NOT_REACHED )
+        return ;
+
+    gSwitch.timings.plugin_ms = audioSwitchElapsed () ;
+
+    SWITCH_DEBUG(("SWITCH: a2dp %d amp %d sco %d plugin %d ms\n" , gSwitch.timings.a2dp_ms , gSwitch.timings.amp_ms ,
+                  gSwitch.timings.sco_ms , gSwitch.timings.plugin_ms)) ;
+}
+
+
+/**************************************************************************/
+void audioSwitchScoFailed ( hsTaskData * pApp )
+{
+    if ( !gSwitch.pending )
+        return ;
+
+    if ( --gSwitch.pending || intercomIsAudioActive ( pApp ) )
+        return ;
+
+    SWITCH_DEBUG(("SWITCH: failed, a2dp %d\n" , gSwitch.a2dp_released)) ;
+
+    if ( gSwitch.a2dp_released )
+    {
+        gSwitch.a2dp_released = FALSE ;
+#ifdef DUAL_STREAM
+        if ( pApp->a2dp_state_change ) /* SUSPEND */
+        {
+            pApp->a2dp_state_change = FALSE ;
+            stateManagerEnterA2dpStreamingState ( pApp ) ;
+        }
+#endif
+        streamControlResumeA2dpStreaming ( pApp , 0 ) ;
+    }
+
+    AmpOffLater ( pApp ) ;
+}
+
+
+/**************************************************************************/
+const audioSwitchTimings_t * audioSwitchGetTimings ( void )
+{
+    return &gSwitch.timings ;
+}
@@ -0,0 +1,105 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    headset_audio_switch.h
+@brief   Switching the audio path from A2DP to the intercom SCO link.
+
+    Opening intercom audio used to run every step in turn once the SCO
+    link was up: release A2DP, power the amp, load the DSP plugin. Only
+    the plugin needs the SCO sink. The other steps start as soon as the
+    SCO connection is requested, so that the A2DP plugin unloads and the
+    amp settles while the links negotiate eSCO. When the link is up only
+    the SCO plugin still has to load.
+
+    If every requested link fails, A2DP is resumed and the amp is switched
+    off as if the switch had never started.
+
+    The time taken by each stage of the last switch is kept for tuning.
+*/
+
+#ifndef _HEADSET_AUDIO_SWITCH_H_
+#define _HEADSET_AUDIO_SWITCH_H_
+
+
+#include "headset_private.h"
+
+
+/* A stage of the switch which has not been reached */
+#define AUDIO_SWITCH_NOT_REACHED    (0xffff)
+
+
+/*! @brief When each stage of the last switch was reached, in ms after it started */
+typedef struct
+{
+    uint16      a2dp_ms;        /*!< A2DP released, AUDIO_SWITCH_NOT_REACHED if it was not streaming */
+    uint16      amp_ms;         /*!< Amp switched on */
+    uint16      sco_ms;         /*!< First SCO link up */
+    uint16      plugin_ms;      /*!< SCO plugin connected, the rider can be heard */
+} audioSwitchTimings_t;
+
+
+/****************************************************************************
+  FUNCTIONS
+*/
+
+/*************************************************************************
+NAME
+    audioSwitchStart
+
+DESCRIPTION
+    Start the steps which do not need the SCO link, having just requested
+    pLinks SCO connections.
+
+*/
+void audioSwitchStart ( hsTaskData * pApp , uint16 pLinks ) ;
+
+
+/*************************************************************************
+NAME
+    audioSwitchScoConnected
+
+DESCRIPTION
+    A SCO connection is up. Any step not already started, as when the far
+    end opened the audio, is run now; the caller then connects the plugin.
+
+*/
+void audioSwitchScoConnected ( hsTaskData * pApp ) ;
+
+
+/*************************************************************************
+NAME
+    audioSwitchPluginConnected
+
+DESCRIPTION
+    The SCO plugin is connected; the switch is complete.
+
+*/
+void audioSwitchPluginConnected ( hsTaskData * pApp ) ;
+
+
+/*************************************************************************
+NAME
+    audioSwitchScoFailed
+
+DESCRIPTION
+    A SCO connection failed, was timed out or lost with its SLC. Once none
+    is left pending and no rider has audio, A2DP is restored.
+
+*/
+void audioSwitchScoFailed ( hsTaskData * pApp ) ;
+
+
+/*************************************************************************
+NAME
+    audioSwitchGetTimings
+
+DESCRIPTION
+    Returns the stage timings of the last switch.
+
+*/
+const audioSwitchTimings_t * audioSwitchGetTimings ( void ) ;
+
+
+#endif /* _HEADSET_AUDIO_SWITCH_H_ */
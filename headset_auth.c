@@ -16,6 +16,7 @@ Copyright (C) Cambridge Silicon Radio Ltd. 2005-2008
 #include "headset_configmanager.h"
 #include "headset_debug.h"
 #include "headset_hfp_slc.h"
+#include "headset_pool.h"
 #include "headset_statemanager.h"
 
 #include "panic.h"
@@ -118,7 +119,7 @@ void headsetHandleUserConfirmationInd(hsTaskData* pApp, const CL_SM_USER_CONFIRM
         pApp->confirmation = TRUE;
         AUTH_DEBUG(("auth: can confirm %ld\n", ind->numeric_value));
         /* should use text to speech here */
-        pApp->confirmation_addr = (bdaddr*)PanicUnlessMalloc(sizeof(bdaddr));
+        pApp->confirmation_addr = (bdaddr*)PanicUnlessPoolAlloc(sizeof(bdaddr));
         *pApp->confirmation_addr = ind->bd_addr;
     }
     else
@@ -281,7 +282,7 @@ void AuthResetConfirmationFlags(hsTaskData* pApp)
     if (pApp->confirmation_addr != NULL)
     {
         AUTH_DEBUG(("auth: free confirmation addr\n"));
-        free(pApp->confirmation_addr);
+        poolFree(pApp->confirmation_addr);
     }
     pApp->confirmation_addr = NULL;
     pApp->confirmation = FALSE;
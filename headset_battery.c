@@ -26,6 +26,7 @@ Copyright (C) Cambridge Silicon Radio Ltd. 2005
 
 #include "headset_battery.h"
 #include "headset_debug.h"
+#include "headset_instrument.h"
 #include "headset_private.h"
 #include "headset_statemanager.h"
 
@@ -47,6 +48,7 @@ static void batteryNormal(Task pTask , hsTaskData* theHeadset );
 static void batteryLow(Task pTask, hsTaskData* theHeadset);
 static void batteryShutdown(Task pTask, hsTaskData* theHeadset);
 static void aio_handler(Task task, MessageId id, Message message);
+INSTRUMENTED_HANDLER(instrumentBattery, aio_handler)
 static void handleBatteryVoltageReading(hsTaskData* theHeadset, uint32 reading , Task pTask);
 
 
@@ -237,7 +239,7 @@ void batteryInit(hsTaskData* theHeadset)
 	/* --- Battery Voltage --- */
 	/* The battery voltage is monitored at all times.  Initialise the battery
 	   library to read the battery voltage via BATTERY_INTERNAL */
-	power->vbat_task.task.handler = aio_handler;
+	power->vbat_task.task.handler = INSTRUMENT(aio_handler);
 		
     /* Read battery now */
     batteryRead(theHeadset);
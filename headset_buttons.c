@@ -14,6 +14,8 @@ which is responsible for translating the button press generated into a system ev
 #include "headset_buttonmanager.h"
 #include "headset_buttons.h"
 #include "headset_debug.h"
+#include "headset_dispatch.h"
+#include "headset_instrument.h"
 
 #include <charger.h>
 #include <csrtypes.h>
@@ -53,6 +55,7 @@ typedef enum ButtonsIntMsgTag
 	LOCAL FUNCTION PROTOTYPES
  */
 static void ButtonsMessageHandler ( Task pTask, MessageId pId, Message pMessage )   ;
+INSTRUMENTED_HANDLER(instrumentButtons, ButtonsMessageHandler)
 static bool ButtonsWasButtonPressed ( uint32 pOldState , uint32 pNewState) ;
 static uint32 ButtonsWhichButtonChanged ( uint32 pOldState , uint32 pNewState ) ;
 static void ButtonsButtonDetected (  ButtonsTaskData * pButtonsTask ,uint32 pButtonMask  , ButtonsTime_t pTime  ) ;
@@ -75,7 +78,10 @@ void ButtonsInit ( ButtonsTaskData *pButtonsTask )
     pButtonsTask->gButtonLevelMask   = 0 ;
     pButtonsTask->gBOldEdgeState = 0 ;
     
-    pButtonsTask->task.handler = ButtonsMessageHandler;
+    pButtonsTask->task.handler = INSTRUMENT(ButtonsMessageHandler);
+    
+        /*repeats of a held button are not time critical, the first press is*/
+    dispatchSetLane ( &pButtonsTask->task , B_REPEAT_TIMER , B_REPEAT_TIMER , dispatchLaneLow ) ;
     
         /*connect the underlying PIO task to this task*/
     MessagePioTask(&pButtonsTask->task);
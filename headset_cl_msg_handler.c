@@ -34,27 +34,6 @@ Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
 
 /****************************************************************************/
 
-#ifndef S100A /* v101201 Repairing fail for same addr */
-/* For AG inquire */
-/* Keep a list of addresses we've tried before without success */
-enum { FAILED_SIZE = 8 };
-static bdaddr failed_addr[FAILED_SIZE];
-
-static uint16 tried_and_failed(const bdaddr *addr)
-{
-    static uint16 failed_next;
-    uint16 i;
-
-    for(i = 0; i < FAILED_SIZE; ++i)
-        if(failed_addr[i].lap == addr->lap && failed_addr[i].nap == addr->nap && failed_addr[i].uap == addr->uap)
-            return 1;
-    failed_addr[failed_next] = *addr;
-    ++failed_next;
-    if(failed_next == FAILED_SIZE) failed_next = 0;
-    return 0;
-}
-#endif
-
 void handleCLMessage( Task task, MessageId id, Message message )
 {
     hsTaskData * lApp = (hsTaskData *) getAppTask() ;
@@ -73,6 +52,8 @@ void handleCLMessage( Task task, MessageId id, Message message )
             }
             else
             {
+                /* report RSSI with inquiry results to rank intercom riders (2.1 EIR results carry it already), no confirmation needed */
+                ConnectionWriteInquiryMode(0, inquiry_mode_rssi);
                 /* no 2.1 EIR init to do -> initialise the HFP library now */
                 InitHfp(lApp);
             }
@@ -92,17 +73,7 @@ void handleCLMessage( Task task, MessageId id, Message message )
         {
             CL_MSG_DEBUG(("Found device\n"));
             /* Inquiry Result. We found a device! */
-#ifdef S100A /* v101201 Repairing fail for same addr */
             intercomInquiryResult(lApp, (CL_DM_INQUIRE_RESULT_T*)message);
-#else
-            if(!tried_and_failed(&((CL_DM_INQUIRE_RESULT_T*)message)->bd_addr))
-            {
-                CL_MSG_DEBUG(("Not already tried to connect\n"));
-                intercomInquiryResult(lApp, (CL_DM_INQUIRE_RESULT_T*)message);
-            }
-            else
-                CL_MSG_DEBUG(("Already tried to connect\n"));
-#endif
         }
         break;
     case CL_DM_WRITE_INQUIRY_MODE_CFM:
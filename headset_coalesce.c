@@ -0,0 +1,143 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    headset_coalesce.c
+@brief   Implementation of the coalescing message send.
+*/
+
+/****************************************************************************
+    Header files
+*/
+
+#include "headset_coalesce.h"
+#include "headset_debug.h"
+
+#include <panic.h>
+
+
+#ifdef DEBUG_COALESCE
+    #define COALESCE_DEBUG(x) DEBUG(x)
+#else
+    #define COALESCE_DEBUG(x)
+#endif
+
+
+/* A coalesced message */
+typedef struct
+{
+    Task        task ;
+    MessageId   id ;
+    uint16      pending ;
+    uint16      absorbed ;
+    uint16      sent ;
+} coalesceEntry ;
+
+
+static coalesceEntry    gEntries [ COALESCE_MAX_IDS ] ;
+static uint16           gNumEntries = 0 ;
+
+
+/****************************************************************************
+  LOCAL FUNCTIONS
+*/
+
+static coalesceEntry * coalesceFind ( Task pTask , MessageId pId , bool pCreate )
+{
+    uint16 i ;
+
+    for ( i = 0 ; i < gNumEntries ; i++ )
+    {
+        if ( ( gEntries [ i ].id == pId ) && ( gEntries [ i ].task == pTask ) )
+            return &gEntries [ i ] ;
+    }
+
+    if ( !pCreate )
+        return NULL ;
+
+    if ( gNumEntries == COALESCE_MAX_IDS )
+        Panic () ;
+
+    gEntries [ gNumEntries ].task = pTask ;
+    gEntries [ gNumEntries ].id   = pId ;
+    return &gEntries [ gNumEntries++ ] ;
+}
+
+
+static void coalesceCount ( uint16 * pCount , uint16 pAdd )
+{
+    *pCount = ( pAdd > ( 0xffff - *pCount ) ) ? 0xffff : *pCount + pAdd ;
+}
+
+
+/****************************************************************************
+  FUNCTIONS
+*/
+
+/**************************************************************************/
+void coalesceSend ( Task pTask , MessageId pId , uint32 pDelay , coalescePolicy_t pPolicy )
+{
+    coalesceEntry * lEntry = coalesceFind ( pTask , pId , TRUE ) ;
+
+    if ( lEntry->pending )
+    {
+        if ( pPolicy == coalesceMerge )
+        {
+            COALESCE_DEBUG(("COAL: merge [%x]\n" , pId)) ;
+            coalesceCount ( &lEntry->absorbed , 1 ) ;
+            return ;
+        }
+
+        COALESCE_DEBUG(("COAL: replace [%x]\n" , pId)) ;
+        coalesceCount ( &lEntry->absorbed , MessageCancelAll ( pTask , pId ) ) ;
+    }
+
+    MessageSendLater ( pTask , pId , 0 , pDelay ) ;
+    lEntry->pending = TRUE ;
+    coalesceCount ( &lEntry->sent , 1 ) ;
+}
+
+
+/**************************************************************************/
+void coalesceCancel ( Task pTask , MessageId pId )
+{
+    coalesceEntry * lEntry = coalesceFind ( pTask , pId , FALSE ) ;
+
+    MessageCancelAll ( pTask , pId ) ;
+
+    if ( lEntry )
+        lEntry->pending = FALSE ;
+}
+
+
+/**************************************************************************/
+void coalesceDelivered ( Task pTask , MessageId pId )
+{
+    uint16 i ;
+
+    for ( i = 0 ; i < gNumEntries ; i++ )
+    {
+        if ( ( gEntries [ i ].id == pId ) && ( gEntries [ i ].task == pTask ) )
+        {
+            gEntries [ i ].pending = FALSE ;
+            return ;
+        }
+    }
+}
+
+
+/**************************************************************************/
+uint16 coalesceGetAbsorbed ( Task pTask , MessageId pId )
+{
+    coalesceEntry * lEntry = coalesceFind ( pTask , pId , FALSE ) ;
+    return lEntry ? lEntry->absorbed : 0 ;
+}
+
+
+/**************************************************************************/
+uint16 coalesceGetSent ( Task pTask , MessageId pId )
+{
+    coalesceEntry * lEntry = coalesceFind ( pTask , pId , FALSE ) ;
+    return lEntry ? lEntry->sent : 0 ;
+}
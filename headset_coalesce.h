@@ -0,0 +1,91 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    headset_coalesce.h
+@brief   Coalescing send of messages which are idempotent while pending.
+
+    Some messages only set a state, so posting a second copy while the first
+    is still queued achieves nothing but queue churn and an extra wakeup.
+    Sending them through coalesceSend merges or replaces the pending copy
+    instead of queuing a duplicate.
+
+    Only messages without a payload may be coalesced. A coalesced message
+    must not be cancelled with MessageCancelAll/MessageCancelFirst, use
+    coalesceCancel so the pending state is kept in step.
+*/
+
+#ifndef _HEADSET_COALESCE_H_
+#define _HEADSET_COALESCE_H_
+
+
+#include <message.h>
+
+
+/* Number of distinct (task, message id) pairs which may be coalesced */
+#define COALESCE_MAX_IDS    (4)
+
+
+/*! @brief What to do with a send while a copy is already pending */
+typedef enum
+{
+    coalesceMerge ,     /*!< Keep the pending copy and drop the new send */
+    coalesceReplace     /*!< Cancel the pending copy and queue the new send */
+} coalescePolicy_t ;
+
+
+/****************************************************************************
+  FUNCTIONS
+*/
+
+/*************************************************************************
+NAME
+    coalesceSend
+
+DESCRIPTION
+    Post a message without payload after pDelay milliseconds, coalescing it
+    with any copy already pending according to pPolicy.
+
+*/
+void coalesceSend ( Task pTask , MessageId pId , uint32 pDelay , coalescePolicy_t pPolicy ) ;
+
+
+/*************************************************************************
+NAME
+    coalesceCancel
+
+DESCRIPTION
+    Cancel a pending coalesced message.
+
+*/
+void coalesceCancel ( Task pTask , MessageId pId ) ;
+
+
+/*************************************************************************
+NAME
+    coalesceDelivered
+
+DESCRIPTION
+    Called by the task handler as each message is delivered, so that the
+    next send of a merged message is queued again.
+
+*/
+void coalesceDelivered ( Task pTask , MessageId pId ) ;
+
+
+/*************************************************************************
+NAME
+    coalesceGetAbsorbed / coalesceGetSent
+
+DESCRIPTION
+    Returns the number of sends of a message which were absorbed into a
+    pending copy, and the number which were queued. Counts saturate at
+    0xffff.
+
+*/
+uint16 coalesceGetAbsorbed ( Task pTask , MessageId pId ) ;
+uint16 coalesceGetSent ( Task pTask , MessageId pId ) ;
+
+
+#endif /* _HEADSET_COALESCE_H_ */
@@ -0,0 +1,481 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    headset_conference.c
+@brief   Implementation of the intercom conference mix.
+*/
+
+/****************************************************************************
+    Header files
+*/
+
+#include "headset_conference.h"
+#include "headset_debug.h"
+#include "headset_mixer.h"
+
+#ifdef DEBUG_CONFERENCE
+    #define CONF_DEBUG(x) DEBUG(x)
+#else
+    #define CONF_DEBUG(x)
+#endif
+
+
+/**************************************************************************/
+void conferenceMix ( const int16 * const pIn [] , int16 * const pOut [] , uint16 pParties , uint16 pSamples )
+{
+    mixerSource_t lSources [ CONFERENCE_MAX_PARTIES ] ;
+    uint16 p ;
+
+    for ( p = 0 ; p < pParties ; p++ )
+    {
+        lSources [ p ].samples  = pIn [ p ] ;
+        lSources [ p ].gain     = MIXER_GAIN_UNITY ;
+        lSources [ p ].duckable = FALSE ;
+        lSources [ p ].ducking  = FALSE ;
+    }
+
+        /*each party hears everyone but itself*/
+    for ( p = 0 ; p < pParties ; p++ )
+    {
+        lSources [ p ].samples = NULL ;
+        mixerMix ( lSources , pParties , pOut [ p ] , pSamples , MIXER_GAIN_UNITY ) ;
+        lSources [ p ].samples = pIn [ p ] ;
+    }
+}
+
+
+#ifdef CONFERENCE_FRAME_PATH
+
+#include "headset_plc.h"
+#include "headset_ramp.h"
+#ifdef INTERCOM_WIND
+#include "headset_wind.h"
+#endif
+#ifdef INTERCOM_AGC
+#include "headset_agc.h"
+#endif
+#ifdef INTERCOM_JITTER
+#include "headset_jitter.h"
+#endif
+#ifdef TONE_MIX
+#include "headset_tone_mix.h"
+#endif
+
+#include <app/message/system_message.h>
+#include <message.h>
+#include <pcm.h>
+#include <source.h>
+#include <stream.h>
+#include <string.h>
+#ifdef INTERCOM_JITTER
+#include <vm.h>
+#endif
+
+
+#define CONFERENCE_FRAME_OCTETS     ( CONFERENCE_FRAME_SAMPLES * MIXER_SAMPLE_OCTETS )
+
+/* Party 0 is always the local codec */
+#define CONFERENCE_LOCAL            (0)
+
+/* Samples the local codec plays a millisecond */
+#define CONFERENCE_SAMPLES_PER_MS   (8)
+
+
+typedef struct
+{
+    Source      source ;
+    Sink        sink ;
+    plcState_t  plc ;       /* Conceals the frames a rider's link fails to deliver */
+#ifdef INTERCOM_AGC
+    agcState_t  agc ;       /* Brings the rider's voice to the listener's level */
+#endif
+#ifdef INTERCOM_JITTER
+    jitterState_t jitter ;  /* Holds the rider's frames from arrival to playout */
+#endif
+} conferenceParty ;
+
+
+static void conferenceHandler ( Task pTask , MessageId pId , Message pMessage ) ;
+
+static TaskData         gTask = { conferenceHandler } ;
+static conferenceParty  gParty [ CONFERENCE_MAX_PARTIES ] ;
+static uint16           gParties = 0 ;
+
+static int16            gIn  [ CONFERENCE_MAX_PARTIES ] [ CONFERENCE_FRAME_SAMPLES ] ;
+static int16            gOut [ CONFERENCE_MAX_PARTIES ] [ CONFERENCE_FRAME_SAMPLES ] ;
+
+#ifdef INTERCOM_WIND
+static windState_t      gWind ;     /* Wind suppression of the local microphone */
+#endif
+
+static rampState_t      gRamp ;             /* Dips the local rider's audio for a switch of the amp's gain */
+static Task             gSwitchTask = NULL ;    /* Told when the switch is due */
+static MessageId        gSwitchId ;
+static uint16           gCapacity ;         /* Octets the local sink holds, to time the switch by */
+
+#ifdef INTERCOM_AGC
+static uint16           gTarget = AGC_TARGET_MAX ;
+#endif
+
+
+/****************************************************************************
+  LOCAL FUNCTIONS
+*/
+
+static void conferenceRead ( const conferenceParty * pParty , int16 * pFrame )
+{
+    mixerUnpack ( SourceMap ( pParty->source ) , pFrame , CONFERENCE_FRAME_SAMPLES ) ;
+    SourceDrop ( pParty->source , CONFERENCE_FRAME_OCTETS ) ;
+}
+
+
+static void conferenceWrite ( const conferenceParty * pParty , const int16 * pFrame )
+{
+    uint16 lOffset = SinkClaim ( pParty->sink , CONFERENCE_FRAME_OCTETS ) ;
+
+    if ( lOffset == 0xffff )
+        return ;
+
+    mixerPack ( pFrame , SinkMap ( pParty->sink ) + lOffset , CONFERENCE_FRAME_SAMPLES ) ;
+    (void) SinkFlush ( pParty->sink , CONFERENCE_FRAME_OCTETS ) ;
+}
+
+
+#ifdef INTERCOM_JITTER
+/* Take every frame the riders' links have delivered into their jitter
+   buffers, stamped with its arrival */
+static void conferenceReceive ( void )
+{
+    uint16 p ;
+
+    for ( p = CONFERENCE_LOCAL + 1 ; p < gParties ; p++ )
+    {
+        while ( SourceSize ( gParty [ p ].source ) >= CONFERENCE_FRAME_OCTETS )
+        {
+            conferenceRead ( &gParty [ p ] , gIn [ p ] ) ;
+            jitterPut ( &gParty [ p ].jitter , gIn [ p ] , CONFERENCE_FRAME_SAMPLES , VmGetClock () ) ;
+        }
+    }
+}
+#endif
+
+
+/* The switch is due at sample pSample of the local frame about to be
+   written: tell the client when it reaches the codec, behind what the
+   sink still holds */
+static void conferenceSwitchDue ( uint16 pSample )
+{
+    uint16 lSlack = SinkSlack ( gParty [ CONFERENCE_LOCAL ].sink ) ;
+    uint16 lQueued = ( gCapacity > lSlack ) ? ( gCapacity - lSlack ) / 2 : 0 ;
+
+    if ( !gSwitchTask )
+        return ;
+
+    CONF_DEBUG(("CONF: amp switch in %d samples\n" , lQueued + pSample)) ;
+
+    MessageSendLater ( gSwitchTask , gSwitchId , 0 , ( lQueued + pSample ) / CONFERENCE_SAMPLES_PER_MS ) ;
+    gSwitchTask = NULL ;
+}
+
+
+/* Mix every frame that all parties can take. A party with no frame ready
+   is counted as lost once any other party has a second frame queued, so
+   one stalled link does not hold up the rest. A lost rider frame is
+   concealed, a lost local frame is silence. With INTERCOM_JITTER the
+   local codec sets the pace instead: a frame is mixed for each local one,
+   the riders' taken from their jitter buffers. With INTERCOM_WIND the
+   local frame is delayed by the wind suppression, which the riders'
+   frames are not: at 15ms the skew is well inside what the links add
+   anyway. With TONE_MIX the tones are mixed into what the local rider
+   hears, and only that, before the ramp that dips it for a switch of the
+   amp's gain. */
+static void conferencePump ( void )
+{
+    const int16 * lIn [ CONFERENCE_MAX_PARTIES ] ;
+    int16 * lOut [ CONFERENCE_MAX_PARTIES ] ;
+    uint16 lSwitch ;
+    uint16 p ;
+
+    for ( p = 0 ; p < CONFERENCE_MAX_PARTIES ; p++ )
+    {
+        lIn [ p ]  = gIn [ p ] ;
+        lOut [ p ] = gOut [ p ] ;
+    }
+
+#ifdef INTERCOM_JITTER
+    conferenceReceive () ;
+
+    for ( ;; )
+    {
+        if ( SourceSize ( gParty [ CONFERENCE_LOCAL ].source ) < CONFERENCE_FRAME_OCTETS )
+            return ;
+
+        for ( p = 0 ; p < gParties ; p++ )
+        {
+            if ( SinkSlack ( gParty [ p ].sink ) < CONFERENCE_FRAME_OCTETS )
+                return ;
+        }
+
+        conferenceRead ( &gParty [ CONFERENCE_LOCAL ] , gIn [ CONFERENCE_LOCAL ] ) ;
+
+        for ( p = CONFERENCE_LOCAL + 1 ; p < gParties ; p++ )
+        {
+            if ( jitterGet ( &gParty [ p ].jitter , gIn [ p ] , CONFERENCE_FRAME_SAMPLES ) )
+                plcGoodFrame ( &gParty [ p ].plc , gIn [ p ] , CONFERENCE_FRAME_SAMPLES ) ;
+            else
+                plcLostFrame ( &gParty [ p ].plc , gIn [ p ] , CONFERENCE_FRAME_SAMPLES ) ;
+        }
+#else
+    for ( ;; )
+    {
+        uint16 lReady = 0 ;
+        bool lBacklog = FALSE ;
+
+        for ( p = 0 ; p < gParties ; p++ )
+        {
+            uint16 lSize = SourceSize ( gParty [ p ].source ) ;
+
+            if ( SinkSlack ( gParty [ p ].sink ) < CONFERENCE_FRAME_OCTETS )
+                return ;
+
+            if ( lSize >= CONFERENCE_FRAME_OCTETS )
+                lReady++ ;
+            if ( lSize >= 2 * CONFERENCE_FRAME_OCTETS )
+                lBacklog = TRUE ;
+        }
+
+        if ( !lReady || ( ( lReady < gParties ) && !lBacklog ) )
+            return ;
+
+        for ( p = 0 ; p < gParties ; p++ )
+        {
+            if ( SourceSize ( gParty [ p ].source ) >= CONFERENCE_FRAME_OCTETS )
+            {
+                conferenceRead ( &gParty [ p ] , gIn [ p ] ) ;
+
+                if ( p != CONFERENCE_LOCAL )
+                    plcGoodFrame ( &gParty [ p ].plc , gIn [ p ] , CONFERENCE_FRAME_SAMPLES ) ;
+            }
+            else if ( p != CONFERENCE_LOCAL )
+            {
+                plcLostFrame ( &gParty [ p ].plc , gIn [ p ] , CONFERENCE_FRAME_SAMPLES ) ;
+            }
+            else
+            {
+                memset ( gIn [ p ] , 0 , sizeof ( gIn [ p ] ) ) ;
+            }
+        }
+#endif
+
+#ifdef INTERCOM_WIND
+        windProcess ( &gWind , gIn [ CONFERENCE_LOCAL ] , CONFERENCE_FRAME_SAMPLES ) ;
+#endif
+
+#ifdef INTERCOM_AGC
+        for ( p = CONFERENCE_LOCAL + 1 ; p < gParties ; p++ )
+            agcProcess ( &gParty [ p ].agc , gIn [ p ] , CONFERENCE_FRAME_SAMPLES ) ;
+#endif
+
+        conferenceMix ( lIn , lOut , gParties , CONFERENCE_FRAME_SAMPLES ) ;
+
+#ifdef TONE_MIX
+        toneMixFrame ( gOut [ CONFERENCE_LOCAL ] , CONFERENCE_FRAME_SAMPLES ) ;
+#endif
+
+        lSwitch = rampProcess ( &gRamp , gOut [ CONFERENCE_LOCAL ] , CONFERENCE_FRAME_SAMPLES ) ;
+        if ( lSwitch != RAMP_NO_SWITCH )
+            conferenceSwitchDue ( lSwitch ) ;
+
+        for ( p = 0 ; p < gParties ; p++ )
+            conferenceWrite ( &gParty [ p ] , gOut [ p ] ) ;
+    }
+}
+
+
+static void conferenceHandler ( Task pTask , MessageId pId , Message pMessage )
+{
+    switch ( pId )
+    {
+    case MESSAGE_MORE_DATA:
+    case MESSAGE_MORE_SPACE:
+        conferencePump () ;
+        break ;
+    default:
+        break ;
+    }
+}
+
+
+static void conferenceAttach ( Source pSource , Sink pSink )
+{
+    conferenceParty * lParty = &gParty [ gParties++ ] ;
+
+    lParty->source = pSource ;
+    lParty->sink   = pSink ;
+    plcInit ( &lParty->plc ) ;
+#ifdef INTERCOM_AGC
+    agcInit ( &lParty->agc , gTarget ) ;
+#endif
+#ifdef INTERCOM_JITTER
+    jitterInit ( &lParty->jitter ) ;
+#endif
+
+    (void) MessageSinkTask ( StreamSinkFromSource ( pSource ) , &gTask ) ;
+    (void) MessageSinkTask ( pSink , &gTask ) ;
+}
+
+
+static void conferenceDetach ( uint16 pParty )
+{
+    (void) MessageSinkTask ( StreamSinkFromSource ( gParty [ pParty ].source ) , NULL ) ;
+    (void) MessageSinkTask ( gParty [ pParty ].sink , NULL ) ;
+
+    gParty [ pParty ] = gParty [ --gParties ] ;
+}
+
+
+/****************************************************************************
+  FUNCTIONS
+*/
+
+/**************************************************************************/
+void conferenceStart ( void )
+{
+    if ( gParties )
+        return ;
+
+    CONF_DEBUG(("CONF: start\n")) ;
+
+#ifdef INTERCOM_WIND
+    windInit ( &gWind ) ;
+#endif
+    rampInit ( &gRamp , RAMP_GAIN_UNITY , RAMP_SAMPLES ) ;
+
+    (void) PcmRateAndRoute ( 0 , PCM_NO_SYNC , 8000 , 8000 , VM_PCM_INTERNAL_A ) ;
+    conferenceAttach ( StreamPcmSource ( 0 ) , StreamPcmSink ( 0 ) ) ;
+
+        /*nothing is queued yet, so all of it is slack*/
+    gCapacity = SinkSlack ( gParty [ CONFERENCE_LOCAL ].sink ) ;
+}
+
+
+/**************************************************************************/
+bool conferenceAddParty ( Sink pSco )
+{
+    if ( !gParties || ( gParties == CONFERENCE_MAX_PARTIES ) )
+        return FALSE ;
+
+    CONF_DEBUG(("CONF: add [%x]\n" , (int) pSco)) ;
+
+    conferenceAttach ( StreamSourceFromSink ( pSco ) , pSco ) ;
+    conferencePump () ;
+    return TRUE ;
+}
+
+
+/**************************************************************************/
+void conferenceRemoveParty ( Sink pSco )
+{
+    uint16 p ;
+
+    for ( p = CONFERENCE_LOCAL + 1 ; p < gParties ; p++ )
+    {
+        if ( gParty [ p ].sink == pSco )
+        {
+            CONF_DEBUG(("CONF: remove [%x]\n" , (int) pSco)) ;
+#ifdef INTERCOM_JITTER
+            CONF_DEBUG(("CONF: jitter underruns %ld late %ld overflows %ld\n" ,
+                        gParty [ p ].jitter.stats.underruns ,
+                        gParty [ p ].jitter.stats.late ,
+                        gParty [ p ].jitter.stats.overflows)) ;
+#endif
+            conferenceDetach ( p ) ;
+            return ;
+        }
+    }
+}
+
+
+/**************************************************************************/
+void conferenceStop ( void )
+{
+    if ( !gParties )
+        return ;
+
+    CONF_DEBUG(("CONF: stop\n")) ;
+
+#ifdef TONE_MIX
+    toneMixStop () ;
+#endif
+
+        /*the audio is going, so the switch need wait no longer*/
+    if ( gSwitchTask )
+        MessageSend ( gSwitchTask , gSwitchId , 0 ) ;
+    gSwitchTask = NULL ;
+
+    while ( gParties )
+        conferenceDetach ( gParties - 1 ) ;
+
+    PcmClearAllRouting () ;
+}
+
+
+/**************************************************************************/
+bool conferenceIsActive ( void )
+{
+    return gParties != 0 ;
+}
+
+
+/**************************************************************************/
+void conferenceSwitchAmp ( Task pTask , MessageId pId )
+{
+    if ( !gParties )
+    {
+        MessageSend ( pTask , pId , 0 ) ;
+        return ;
+    }
+
+    CONF_DEBUG(("CONF: dip for amp switch\n")) ;
+
+    gSwitchTask = pTask ;
+    gSwitchId   = pId ;
+    rampSwitch ( &gRamp , RAMP_GAIN_UNITY ) ;
+}
+
+
+#ifdef INTERCOM_AGC
+/**************************************************************************/
+void conferenceSetTarget ( uint16 pTarget )
+{
+    uint16 p ;
+
+    gTarget = pTarget ;
+
+    for ( p = CONFERENCE_LOCAL + 1 ; p < gParties ; p++ )
+        agcSetTarget ( &gParty [ p ].agc , pTarget ) ;
+}
+#endif
+
+
+#ifdef INTERCOM_JITTER
+/**************************************************************************/
+bool conferenceJitterStats ( Sink pSco , jitterStats_t * pStats )
+{
+    uint16 p ;
+
+    for ( p = CONFERENCE_LOCAL + 1 ; p < gParties ; p++ )
+    {
+        if ( gParty [ p ].sink == pSco )
+        {
+            *pStats = gParty [ p ].jitter.stats ;
+            return TRUE ;
+        }
+    }
+    return FALSE ;
+}
+#endif
+
+#endif /* CONFERENCE_FRAME_PATH */
@@ -0,0 +1,178 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    headset_conference.h
+@brief   Conference mix of the local rider and the intercom riders.
+
+    While more than one intercom rider has audio connected the DSP plugin,
+    which serves a single SCO link, is replaced by the conference. The local
+    microphone and speaker (PCM port 0) and the SCO link of each rider are
+    parties to the conference; every frame each party receives the sum of
+    all the other parties, saturated to 16 bits (a mix-minus), so nobody
+    hears their own voice back.
+
+    SCO links must carry 16 bit linear PCM at 8kHz. The plugin's cVc
+    processing is not applied while the conference runs.
+
+    A rider whose frame has not arrived in time is concealed from their
+    recent voice (see headset_plc.h) rather than mixed as silence. With
+    INTERCOM_PLC a single rider is also routed through the conference,
+    so that their dropouts are concealed too. With INTERCOM_WIND the same
+    is done so that the local microphone can be passed through the wind
+    noise suppression (see headset_wind.h) before it is mixed, and with
+    INTERCOM_AGC so that each rider's voice is brought to the level the
+    listener's volume step asks for (see headset_agc.h). With
+    INTERCOM_JITTER each rider's frames are taken into a jitter buffer as
+    they arrive and played out on the local codec's clock (see
+    headset_jitter.h), instead of being mixed as soon as every party has
+    one. These apply only while cVc is disabled, since they take the place
+    of its plugin. With TONE_MIX the tones are mixed into the local
+    rider's frames (see headset_tone_mix.h) rather than given the codec.
+
+    The local rider's frames pass last through a gain ramp (see
+    headset_ramp.h), which dips them while the amp's analogue gain
+    switches, so that the volume step across it does not click.
+*/
+
+#ifndef _HEADSET_CONFERENCE_H_
+#define _HEADSET_CONFERENCE_H_
+
+
+#include <csrtypes.h>
+#include <message.h>
+#include <sink.h>
+
+
+/* Local rider plus up to three intercom riders */
+#define CONFERENCE_MAX_PARTIES      (4)
+
+/* Samples mixed at a time, 3.75ms at 8kHz - one HV3 packet */
+#define CONFERENCE_FRAME_SAMPLES    (30)
+
+/* A single rider is carried by the conference instead of the plugin */
+#if defined(INTERCOM_PLC) || defined(INTERCOM_WIND) || defined(INTERCOM_AGC) || defined(INTERCOM_JITTER)
+#define CONFERENCE_SINGLE_RIDER
+#endif
+
+/* The conference frame path is built */
+#if defined(INTERCOM_CONFERENCE) || defined(CONFERENCE_SINGLE_RIDER)
+#define CONFERENCE_FRAME_PATH
+#endif
+
+
+/****************************************************************************
+  FUNCTIONS
+*/
+
+/*************************************************************************
+NAME
+    conferenceMix
+
+DESCRIPTION
+    Mix-minus pSamples samples of pParties parties: pOut[p] is the
+    saturated sum of every pIn except pIn[p].
+
+*/
+void conferenceMix ( const int16 * const pIn [] , int16 * const pOut [] , uint16 pParties , uint16 pSamples ) ;
+
+
+#ifdef CONFERENCE_FRAME_PATH
+
+/*************************************************************************
+NAME
+    conferenceStart
+
+DESCRIPTION
+    Start a conference with the local rider as its only party. The caller
+    must have released the codec from the DSP plugin with AudioDisconnect.
+
+*/
+void conferenceStart ( void ) ;
+
+
+/*************************************************************************
+NAME
+    conferenceAddParty / conferenceRemoveParty
+
+DESCRIPTION
+    Add or remove the SCO link of a rider.
+
+RETURNS
+    conferenceAddParty returns FALSE if the conference is full.
+*/
+bool conferenceAddParty ( Sink pSco ) ;
+void conferenceRemoveParty ( Sink pSco ) ;
+
+
+/*************************************************************************
+NAME
+    conferenceStop
+
+DESCRIPTION
+    Remove every party and release the local codec.
+
+*/
+void conferenceStop ( void ) ;
+
+
+/*************************************************************************
+NAME
+    conferenceIsActive
+
+DESCRIPTION
+    Returns TRUE between conferenceStart and conferenceStop.
+
+*/
+bool conferenceIsActive ( void ) ;
+
+
+/*************************************************************************
+NAME
+    conferenceSwitchAmp
+
+DESCRIPTION
+    Dip what the local rider hears for a switch of the amp's analogue
+    gain, and send pId to pTask when the dipped audio crosses zero at the
+    codec, for the switch to be made then. With no conference running the
+    message is sent at once.
+
+*/
+void conferenceSwitchAmp ( Task pTask , MessageId pId ) ;
+
+
+#ifdef INTERCOM_AGC
+/*************************************************************************
+NAME
+    conferenceSetTarget
+
+DESCRIPTION
+    Set the level the riders' voices are brought to, from now on and for
+    riders added later (see agcTargetForStep).
+
+*/
+void conferenceSetTarget ( uint16 pTarget ) ;
+#endif
+
+
+#ifdef INTERCOM_JITTER
+#include "headset_jitter.h"
+
+/*************************************************************************
+NAME
+    conferenceJitterStats
+
+DESCRIPTION
+    Copy the jitter buffer statistics of the rider on pSco into pStats.
+
+RETURNS
+    FALSE if pSco is not a party to the conference.
+*/
+bool conferenceJitterStats ( Sink pSco , jitterStats_t * pStats ) ;
+#endif
+
+#endif /* CONFERENCE_FRAME_PATH */
+
+
+#endif /* _HEADSET_CONFERENCE_H_ */
@@ -15,6 +15,8 @@ Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
 #include "headset_debug.h"
 #include "headset_events.h"
 #include "headset_LEDmanager.h"
+#include "headset_peer_table.h"
+#include "headset_pool.h"
 #include "headset_powermanager.h"
 #include "headset_statemanager.h"
 #include "headset_private.h"
@@ -160,8 +162,8 @@ void configManagerReset ( hsTaskData * pApp )
     (void)PsStore ( 7 , 0 , 0 ) ;
 #endif
 
-    /* Reset the Last Slave Intercom device */
-    (void)PsStore ( 12 , 0 , 0 ) ;
+    /* Reset the remembered Slave Intercom devices */
+    peerTableClear () ;
 
     /* Reset the Last Master Intercom device */
     (void)PsStore ( 14 , 0 , 0 ) ;
@@ -184,7 +186,7 @@ static void configManagerButtons(hsTaskData* theHeadset)
   	uint16 no_events = 20;
  
 	/* Allocate enough memory to hold event configuration */
-    event_config_type* config = (event_config_type*) PanicUnlessMalloc(no_events * sizeof(event_config_type));
+    event_config_type* config = (event_config_type*) PanicUnlessPoolAlloc(no_events * sizeof(event_config_type));
     
         /*read in the events for the first PSKEY*/                
     if(ConfigRetrieve(PSKEY_EVENTS_A, config, no_events * sizeof(event_config_type)))
@@ -241,7 +243,7 @@ static void configManagerButtons(hsTaskData* theHeadset)
     }        
 
     	/* Free up memory */
-  	free(config);
+  	poolFree(config);
 }
 
 
@@ -256,7 +258,7 @@ DESCRIPTION
 static void configManagerButtonPatterns(hsTaskData * theHeadset) 
 {  
       		/* Allocate enough memory to hold event configuration */
-    button_pattern_config_type* config = (button_pattern_config_type*) PanicUnlessMalloc(BM_NUM_BUTTON_MATCH_PATTERNS * sizeof(button_pattern_config_type));
+    button_pattern_config_type* config = (button_pattern_config_type*) PanicUnlessPoolAlloc(BM_NUM_BUTTON_MATCH_PATTERNS * sizeof(button_pattern_config_type));
    
     CONF_DEBUG(("Co: No Button Patterns - %d\n", BM_NUM_BUTTON_MATCH_PATTERNS));
    
@@ -278,7 +280,7 @@ static void configManagerButtonPatterns(hsTaskData * theHeadset)
 	    {
 	      CONF_DEBUG(("Co: !EvLen\n")) ;
     }
-    free (config) ;
+    poolFree (config) ;
 }
 
 
@@ -306,7 +308,7 @@ static bool config(hsTaskData * theHeadset , configType type, uint16 pskey_no, u
     	if((no_events > 0) && (no_events <= max))
     	{
       		/* Allocate enough memory to hold state/event configuration */
-      		led_config_type* config = (led_config_type*) PanicUnlessMalloc(no_events * sizeof(led_config_type));
+      		led_config_type* config = (led_config_type*) PanicUnlessPoolAlloc(no_events * sizeof(led_config_type));
    
       		/* Now read in configuration */
    			if(ConfigRetrieve(pskey_config, config, no_events * sizeof(led_config_type)))
@@ -347,7 +349,7 @@ static bool config(hsTaskData * theHeadset , configType type, uint16 pskey_no, u
                 CONF_DEBUG(("Co: !LedLen\n")) ;
             }
             /* Free up memory */
-   			free(config);
+   			poolFree(config);
   		}
   	}
   	return success;
@@ -378,7 +380,7 @@ static bool config_filter( hsTaskData * theHeadset , uint16 pskey_no, uint16 psk
     	if((no_filters > 0) && (no_filters <= max))
     	{
       		/* Allocate enough memory to hold filter configuration */
-      		led_filter_config_type* config = (led_filter_config_type*) PanicUnlessMalloc(no_filters * sizeof(led_filter_config_type));
+      		led_filter_config_type* config = (led_filter_config_type*) PanicUnlessPoolAlloc(no_filters * sizeof(led_filter_config_type));
    
       		/* Now read in configuration */
    			if(ConfigRetrieve(pskey_filter, config, no_filters * sizeof(led_filter_config_type)))
@@ -412,7 +414,7 @@ static bool config_filter( hsTaskData * theHeadset , uint16 pskey_no, uint16 psk
                 CONF_DEBUG(("Co :!FilLen\n")) ;
             }
     		/* Free up memory */
-   			free(config);
+   			poolFree(config);
 
        		success = TRUE;
     	}
@@ -485,7 +487,7 @@ static void configManagerEventTones ( hsTaskData* theHeadset)
   	if(ConfigRetrieve(PSKEY_NO_TONES, &no_tones, sizeof(uint16)))
   	{
         /* Allocate enough memory to hold event configuration */
-    	tone_config_type * config = (tone_config_type *) PanicUnlessMalloc(no_tones * sizeof(tone_config_type));
+    	tone_config_type * config = (tone_config_type *) PanicUnlessPoolAlloc(no_tones * sizeof(tone_config_type));
  
      	/* Now read in tones configuration */
     	if(ConfigRetrieve(PSKEY_TONES, config, no_tones * sizeof(tone_config_type)))
@@ -499,7 +501,7 @@ static void configManagerEventTones ( hsTaskData* theHeadset)
                 TonesConfigureEvent ( theHeadset , (config[n].event + EVENTS_EVENT_BASE), config[n].tone  ) ;
             }   
         }                    
-        free ( config ) ;
+        poolFree ( config ) ;
     }    
 	
  	/* Read the mixed A2DP tone volume */
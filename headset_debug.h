@@ -21,6 +21,8 @@ Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
 #define DEBUG_MAINx
 /* The audio amp messages*/
 #define DEBUG_AMPx
+/*The intercom automatic gain control*/
+#define DEBUG_AGCx
 /* The a2dp connection messages*/
 #define DEBUG_A2DP_CONNECTIONx
 /*The a2dp library messages*/
@@ -31,6 +33,8 @@ Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
 #define DEBUG_AVRCP_EVENTx
 /*The authorisation handling*/
 #define DEBUG_AUTHx
+/*The intercom audio switch*/
+#define DEBUG_AUDIO_SWITCHx
 /*The avrcp library messages*/
 #define DEBUG_AVRCP_MSGx
 /*The battery handling*/
@@ -43,8 +47,12 @@ Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
 #define DEBUG_CHARGERx
 /*The connection library messages*/
 #define DEBUG_CL_MSGx
+/*The coalescing message send*/
+#define DEBUG_COALESCEx
 /*The codec library messages*/
 #define DEBUG_CODEC_MSGx
+/*The intercom conference mix*/
+#define DEBUG_CONFERENCEx
 /*The config manager */
 #define DEBUG_CONFIGx
 /* The events received */
@@ -57,26 +65,50 @@ Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
 #define DEBUG_HFP_MSGx
 /*The hfp slc handling*/
 #define DEBUG_HFP_SLCx
+/*The message dispatch table*/
+#define DEBUG_DISPATCHx
 /*The Init handling*/
 #define DEBUG_INITx
+/*The intercom link state machine*/
+#define DEBUG_INTERCOM_STATEx
+/*Intercom inquiry*/
+#define DEBUG_INQUIREx
+/*The intercom jitter buffer*/
+#define DEBUG_JITTERx
 /*The LED manager */
 #define DEBUG_LMx
 /*The Lower level LED drive */
 #define DEBUG_LEDSx
 /*The Link policy messages */
 #define DEBUG_LINK_POLICYx
+/*The remembered intercom riders*/
+#define DEBUG_PEER_TABLEx
 /*The Lower lvel PIO drive*/
 #define DEBUG_PIOx
+/*The packet loss concealment*/
+#define DEBUG_PLCx
+/*The fixed block pools*/
+#define DEBUG_POOLx
 /*The power manager*/
 #define DEBUG_POWERx
+/*The link loss reconnect scheduler*/
+#define DEBUG_RECONNECTx
 /*Scan manager*/
 #define DEBUG_SCANx
 /*State manager*/
 #define DEBUG_STATESx
 /*Tone manager*/
 #define DEBUG_TONESx
+/*Tone cache*/
+#define DEBUG_TONE_CACHEx
+/*Tone mix*/
+#define DEBUG_TONE_MIXx
+/*The voice activity detector*/
+#define DEBUG_VADx
 /*Volume manager*/
 #define DEBUG_VOLUMEx
+/*Wind noise suppression*/
+#define DEBUG_WINDx
 /* CSR 2 CSR Extensions */
 #define DEBUG_CSR2CSRx
 /* Insert code for Intercom by Jace */
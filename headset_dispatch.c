@@ -0,0 +1,257 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    headset_dispatch.c
+@brief   Implementation of the application message dispatch table.
+*/
+
+/****************************************************************************
+    Header files
+*/
+
+#include "headset_dispatch.h"
+#include "headset_debug.h"
+#include "headset_private.h"
+
+#include <panic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef TEST_HARNESS
+#include "test_bc5_stereo.h"
+#endif
+
+
+#ifdef DEBUG_DISPATCH
+    #define DISPATCH_DEBUG(x) DEBUG(x)
+#else
+    #define DISPATCH_DEBUG(x)
+#endif
+
+
+/* Priority lane assignments made: the application task's three (main.c),
+   one for each intercom link's task, and the LED and button tasks' */
+#define DISPATCH_APP_LANES      (3)
+#define DISPATCH_MAX_LANES      ( DISPATCH_APP_LANES + INTERCOM_MAX_PEERS + 2 )
+
+/* Page table entries */
+#define DISPATCH_PAGE_EMPTY     (0x00)
+#define DISPATCH_PAGE_SHARED    (0xff)
+
+
+/* A registered message id range */
+typedef struct
+{
+    MessageId       base ;
+    MessageId       top ;
+    TaskHandler     handler ;
+    uint16          flags ;
+#ifdef DISPATCH_COUNTERS
+    uint16 *        counts ;
+#endif
+} dispatchRange ;
+
+
+/* A priority lane assignment */
+typedef struct
+{
+    Task            task ;
+    MessageId       base ;
+    MessageId       top ;
+    dispatchLane_t  lane ;
+} dispatchLaneRange ;
+
+
+static dispatchRange    gRanges [ DISPATCH_MAX_HANDLERS ] ;
+static uint16           gNumRanges = 0 ;
+
+    /*registration index + 1 of the range owning each page, or DISPATCH_PAGE_SHARED*/
+static uint8            gPages [ DISPATCH_NUM_PAGES ] ;
+
+static dispatchLaneRange    gLanes [ DISPATCH_MAX_LANES ] ;
+static uint16               gNumLanes = 0 ;
+
+#ifdef DISPATCH_COUNTERS
+static uint16           gUnhandled = 0 ;
+#endif
+
+
+/****************************************************************************
+  LOCAL FUNCTIONS
+*/
+
+/* Find the range holding an id on a page shared by more than one range */
+static const dispatchRange * dispatchSearch ( MessageId pId )
+{
+    uint16 i ;
+
+    for ( i = 0 ; i < gNumRanges ; i++ )
+    {
+        if ( ( pId >= gRanges [ i ].base ) && ( pId <= gRanges [ i ].top ) )
+            return &gRanges [ i ] ;
+    }
+    return NULL ;
+}
+
+
+static const dispatchRange * dispatchLookup ( MessageId pId )
+{
+    uint16 lPage = pId >> DISPATCH_PAGE_SHIFT ;
+    const dispatchRange * lRange ;
+
+    if ( lPage >= DISPATCH_NUM_PAGES )
+        return NULL ;
+
+    switch ( gPages [ lPage ] )
+    {
+        case DISPATCH_PAGE_EMPTY:
+            return NULL ;
+        case DISPATCH_PAGE_SHARED:
+            return dispatchSearch ( pId ) ;
+        default:
+            lRange = &gRanges [ gPages [ lPage ] - 1 ] ;
+                /*a range need not fill the whole page*/
+            if ( ( pId < lRange->base ) || ( pId > lRange->top ) )
+                return NULL ;
+            return lRange ;
+    }
+}
+
+
+#ifdef DISPATCH_COUNTERS
+static void dispatchCount ( uint16 * pCount )
+{
+    if ( *pCount != 0xffff )
+        (*pCount)++ ;
+}
+#endif
+
+
+/****************************************************************************
+  FUNCTIONS
+*/
+
+/**************************************************************************/
+void dispatchRegister ( MessageId pBase , MessageId pTop , TaskHandler pHandler , uint16 pFlags )
+{
+    dispatchRange * lRange ;
+    uint16 lPage ;
+
+    if ( ( gNumRanges >= DISPATCH_MAX_HANDLERS ) || ( pTop < pBase ) || ( ( pTop >> DISPATCH_PAGE_SHIFT ) >= DISPATCH_NUM_PAGES ) )
+        Panic () ;
+
+    lRange = &gRanges [ gNumRanges++ ] ;
+    lRange->base    = pBase ;
+    lRange->top     = pTop ;
+    lRange->handler = pHandler ;
+    lRange->flags   = pFlags ;
+
+#ifdef DISPATCH_COUNTERS
+    lRange->counts  = PanicUnlessMalloc ( ( pTop - pBase + 1 ) * sizeof ( uint16 ) ) ;
+    memset ( lRange->counts , 0 , ( pTop - pBase + 1 ) * sizeof ( uint16 ) ) ;
+#endif
+
+    for ( lPage = pBase >> DISPATCH_PAGE_SHIFT ; lPage <= ( pTop >> DISPATCH_PAGE_SHIFT ) ; lPage++ )
+    {
+        gPages [ lPage ] = ( gPages [ lPage ] == DISPATCH_PAGE_EMPTY ) ? gNumRanges : DISPATCH_PAGE_SHARED ;
+    }
+
+    DISPATCH_DEBUG(("DISP: Reg [%x..%x]\n" , pBase , pTop)) ;
+}
+
+
+/**************************************************************************/
+bool dispatchMessage ( Task pTask , MessageId pId , Message pMessage )
+{
+    const dispatchRange * lRange = dispatchLookup ( pId ) ;
+
+    if ( !lRange )
+    {
+#ifdef DISPATCH_COUNTERS
+        dispatchCount ( &gUnhandled ) ;
+#endif
+        return FALSE ;
+    }
+
+#ifdef DISPATCH_COUNTERS
+    dispatchCount ( &lRange->counts [ pId - lRange->base ] ) ;
+#endif
+
+    lRange->handler ( pTask , pId , pMessage ) ;
+
+#ifdef TEST_HARNESS
+    if ( lRange->flags & DISPATCH_LIB_MESSAGE )
+        test_handle_lib_message ( pTask , pId , pMessage ) ;
+#endif
+
+    return TRUE ;
+}
+
+
+/**************************************************************************/
+void dispatchSetLane ( Task pTask , MessageId pBase , MessageId pTop , dispatchLane_t pLane )
+{
+    if ( gNumLanes >= DISPATCH_MAX_LANES )
+        Panic () ;
+
+    gLanes [ gNumLanes ].task = pTask ;
+    gLanes [ gNumLanes ].base = pBase ;
+    gLanes [ gNumLanes ].top  = pTop ;
+    gLanes [ gNumLanes ].lane = pLane ;
+    gNumLanes++ ;
+}
+
+
+/**************************************************************************/
+dispatchLane_t dispatchGetLane ( Task pTask , MessageId pId )
+{
+    uint16 i = gNumLanes ;
+
+        /*search newest first so later assignments override*/
+    while ( i-- > 0 )
+    {
+        if ( ( gLanes [ i ].task == pTask ) && ( pId >= gLanes [ i ].base ) && ( pId <= gLanes [ i ].top ) )
+            return gLanes [ i ].lane ;
+    }
+    return dispatchLaneNormal ;
+}
+
+
+#ifdef DISPATCH_COUNTERS
+/**************************************************************************/
+uint16 dispatchGetCount ( MessageId pId )
+{
+    const dispatchRange * lRange ;
+
+    if ( pId == DISPATCH_UNHANDLED_ID )
+        return gUnhandled ;
+
+    lRange = dispatchLookup ( pId ) ;
+    return lRange ? lRange->counts [ pId - lRange->base ] : 0 ;
+}
+
+
+/**************************************************************************/
+void dispatchDumpCounts ( bool pClear )
+{
+    uint16 i ;
+    MessageId lId ;
+
+    for ( i = 0 ; i < gNumRanges ; i++ )
+    {
+        for ( lId = gRanges [ i ].base ; lId <= gRanges [ i ].top ; lId++ )
+        {
+            if ( gRanges [ i ].counts [ lId - gRanges [ i ].base ] )
+                DEBUG(("DISP: [%x] %u\n" , lId , gRanges [ i ].counts [ lId - gRanges [ i ].base ])) ;
+        }
+        if ( pClear )
+            memset ( gRanges [ i ].counts , 0 , ( gRanges [ i ].top - gRanges [ i ].base + 1 ) * sizeof ( uint16 ) ) ;
+    }
+
+    DEBUG(("DISP: unhandled %u\n" , gUnhandled)) ;
+    if ( pClear )
+        gUnhandled = 0 ;
+}
+#endif
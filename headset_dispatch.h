@@ -0,0 +1,132 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    headset_dispatch.h
+@brief   Table driven dispatch of the messages received by the application task.
+
+    Each subsystem registers a handler for the message id range it owns. The
+    ranges are indexed by the top byte of the message id so that routing a
+    message costs a single table lookup, however many subsystems there are.
+
+    When DISPATCH_COUNTERS is defined a delivery counter is kept for every
+    message id in a registered range.
+
+    Messages may also be assigned a priority lane, so that audio path set up
+    is served ahead of cosmetic traffic such as LED and button timers. The
+    lanes are honoured by schedulers able to reorder due messages (the host
+    runtime); the BlueCore scheduler delivers strictly in time order.
+*/
+
+#ifndef _HEADSET_DISPATCH_H_
+#define _HEADSET_DISPATCH_H_
+
+
+#include <message.h>
+
+
+/* Maximum number of message id ranges which may be registered */
+#define DISPATCH_MAX_HANDLERS   (10)
+
+/* Message ids are grouped in pages of 256, only ids below 0x8000 are dispatched */
+#define DISPATCH_PAGE_SHIFT     (8)
+#define DISPATCH_NUM_PAGES      (0x80)
+
+/* Registration flags */
+#define DISPATCH_LIB_MESSAGE    (0x0001)    /*!< Also pass the message to the test harness */
+
+
+/*! @brief Priority lanes, highest first */
+typedef enum
+{
+    dispatchLaneHigh ,      /*!< Audio path set up */
+    dispatchLaneNormal ,    /*!< Everything not assigned a lane */
+    dispatchLaneLow ,       /*!< Cosmetic traffic - LEDs, tones and button repeats */
+    DISPATCH_NUM_LANES
+} dispatchLane_t ;
+
+
+/****************************************************************************
+  FUNCTIONS
+*/
+
+/*************************************************************************
+NAME
+    dispatchRegister
+
+DESCRIPTION
+    Register a handler for the messages with ids pBase to pTop inclusive.
+    Ranges must not overlap. Panics if the registration table is full.
+
+*/
+void dispatchRegister ( MessageId pBase , MessageId pTop , TaskHandler pHandler , uint16 pFlags ) ;
+
+
+/*************************************************************************
+NAME
+    dispatchMessage
+
+DESCRIPTION
+    Pass a message to the handler registered for its id.
+
+RETURNS
+    TRUE if a handler was found, FALSE otherwise.
+*/
+bool dispatchMessage ( Task pTask , MessageId pId , Message pMessage ) ;
+
+
+/*************************************************************************
+NAME
+    dispatchSetLane
+
+DESCRIPTION
+    Assign the messages with ids pBase to pTop inclusive, sent to pTask, to
+    a priority lane. Later assignments take precedence over earlier ones.
+    Panics if the lane table is full.
+
+*/
+void dispatchSetLane ( Task pTask , MessageId pBase , MessageId pTop , dispatchLane_t pLane ) ;
+
+
+/*************************************************************************
+NAME
+    dispatchGetLane
+
+DESCRIPTION
+    Returns the priority lane of a message.
+
+*/
+dispatchLane_t dispatchGetLane ( Task pTask , MessageId pId ) ;
+
+
+#ifdef DISPATCH_COUNTERS
+/*************************************************************************
+NAME
+    dispatchGetCount
+
+DESCRIPTION
+    Returns the number of times a message has been dispatched. Counts
+    saturate at 0xffff. Messages with no registered handler are all counted
+    against the id DISPATCH_UNHANDLED_ID.
+
+*/
+#define DISPATCH_UNHANDLED_ID   (0xffff)
+
+uint16 dispatchGetCount ( MessageId pId ) ;
+
+
+/*************************************************************************
+NAME
+    dispatchDumpCounts
+
+DESCRIPTION
+    Print every non zero counter over the debug channel and optionally
+    clear them.
+
+*/
+void dispatchDumpCounts ( bool pClear ) ;
+#endif
+
+
+#endif /* _HEADSET_DISPATCH_H_ */
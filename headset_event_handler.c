@@ -9,16 +9,21 @@ Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
 
 #include "headset_a2dp_connection.h"
 #include "headset_avrcp_event_handler.h"
+#include "headset_coalesce.h"
 #include "headset_configmanager.h"
 #include "headset_debug.h"
 #include "headset_event_handler.h"
 #include "headset_events.h"
 #include "headset_hfp_call.h"
 #include "headset_hfp_slc.h"
+#include "headset_intercom_msg_handler.h"
 #include "headset_LEDmanager.h"
+#include "headset_peer_table.h"
 #include "headset_powermanager.h"
 #include "headset_tones.h"
+#include "headset_trace.h"
 #include "headset_statemanager.h"
+#include "headset_vad.h"
 #include "headset_volume.h"
 #include "headset_auth.h"
 #include "hfp.h"
@@ -82,8 +87,6 @@ static void ampGainTrans(hsTaskData* pApp)
 
 
 #ifdef S100A /* GOLDWING_v101020 */
-#define PSKEY_TARGET_BDADDR 12
-
 #ifdef AUTO_MIC_DETECT
 static void automicDetect( void )
 {
@@ -140,6 +143,10 @@ static void micTrans(hsTaskData* pApp, bool powerOn)
 
 static void mSP430Trans(bool highSignal) /* R100 */
 {
+#ifdef VOICE_VAD
+    /* High told the MSP430 not to listen */
+    vadEnable(!highSignal);
+#else
     if(highSignal)
     {
         PioSetDir(MSP_HIGH_MASK, MSP_HIGH_MASK);
@@ -150,6 +157,7 @@ static void mSP430Trans(bool highSignal) /* R100 */
         PioSetDir(MSP_HIGH_MASK, MSP_HIGH_MASK);
         PioSet(MSP_HIGH_MASK, 0);
     }
+#endif
 }
 
 
@@ -168,8 +176,12 @@ static void voiceControlTrans(hsTaskData* pApp, bool powerOn) /* v100225 */
     if(pApp->voice_manual_mode)
     {
 #ifdef VOICE_SEASON2 /* MSP430 ip_count thread value trans between OPEN and FULL Helmet */
+#ifdef VOICE_VAD
+        vadSetHighThreshold(TRUE);
+#else
         PioSetDir(EXT_MIC_PIN_MASK, EXT_MIC_PIN_MASK);
         PioSet(EXT_MIC_PIN_MASK, EXT_MIC_PIN_MASK);
+#endif
 #else
         mSP430Trans(TRUE);
 #endif
@@ -178,8 +190,12 @@ static void voiceControlTrans(hsTaskData* pApp, bool powerOn) /* v100225 */
     else
     {
 #ifdef VOICE_SEASON2 /* MSP430 ip_count thread value trans between OPEN and FULL Helmet */
+#ifdef VOICE_VAD
+        vadSetHighThreshold(FALSE);
+#else
         PioSetDir(EXT_MIC_PIN_MASK, EXT_MIC_PIN_MASK);
         PioSet(EXT_MIC_PIN_MASK, 0);
+#endif
 #else
         mSP430Trans(FALSE);
 #endif
@@ -263,7 +279,7 @@ void handleUEMessage( Task task, MessageId id, Message message )
         }
 
 #ifdef S100A /* GOLDWING_v101020 */
-        if(PsRetrieve(PSKEY_TARGET_BDADDR, &addr, sizeof(bdaddr)))
+        if(peerTableCount())
         {
                 lApp->init_aghfp_power_on = TRUE;
                 MessageSendLater(&lApp->task, EventRWDPress, 0, D_SEC(9));
@@ -294,7 +310,10 @@ void handleUEMessage( Task task, MessageId id, Message message )
         break;
     }
     case EventPowerOff:
-        if(lApp->aghfp_connect) AghfpSlcDisconnect(lApp->aghfp);
+        /* Keep the messages leading up to the power off for field diagnosis */
+        TRACE_FLUSH(traceToPs);
+
+        intercomSlcDisconnectAll(lApp);
 
         lshutdown = TRUE;
 
@@ -306,6 +325,9 @@ void handleUEMessage( Task task, MessageId id, Message message )
 
         stateManagerEnterPoweringOffState ( lApp );
         AuthResetConfirmationFlags(lApp);
+#ifdef VOICE_VAD
+        vadEnable(FALSE);
+#endif
 
         hfpCallClearQueuedEvent ( lApp ) ;
         MessageCancelAll ( &lApp->task , EventPairingFail) ;
@@ -341,7 +363,7 @@ void handleUEMessage( Task task, MessageId id, Message message )
         uint16 pin_length = 0;
         uint8 pin[16];
 
-        if((lApp->aghfp_connect && lApp->audio_connect) || lApp->slave_function)
+        if(intercomIsAudioActive(lApp) || lApp->slave_function)
         {
             lIndicateEvent = FALSE;
             break;
@@ -365,7 +387,7 @@ void handleUEMessage( Task task, MessageId id, Message message )
     case EventInitateVoiceDial: /* v100622 Intercom Pairing mode */
         if (lState != headsetPoweringOn)
         {
-            if(lApp->slave_function || lApp->aghfp_connect)
+            if(lApp->slave_function || intercomIsConnected(lApp))
             {
                 lApp->intercom_pairing_mode = FALSE;
                 MessageSend(&lApp->task, EventEndOfCall, 0);
@@ -421,7 +443,7 @@ void handleUEMessage( Task task, MessageId id, Message message )
         }
         break;
     case EventLongTimer:
-        if (lState == headsetPoweringOn || (lApp->aghfp_connect && lApp->audio_connect) || (lApp->slave_function && (int)HfpGetAudioSink(lApp->intercom_hsp) && lApp->dsp_process)) /* Don't play music during intercom - v110422 */
+        if (lState == headsetPoweringOn || intercomIsAudioActive(lApp) || (lApp->slave_function && (int)HfpGetAudioSink(lApp->intercom_hsp) && lApp->dsp_process)) /* Don't play music during intercom - v110422 */
             lIndicateEvent = FALSE ;
         break;
     case EventVLongTimer:
@@ -455,7 +477,7 @@ void handleUEMessage( Task task, MessageId id, Message message )
             MessageSendLater(&lApp->task, EventButtonLockingOff, 0, D_SEC(6));
         }
 
-        if(lApp->aghfp_connect && lApp->audio_connect)
+        if(intercomIsAudioActive(lApp))
         {
 			lIndicateEvent = FALSE;
 			break;
@@ -479,12 +501,17 @@ void handleUEMessage( Task task, MessageId id, Message message )
         break;
     }
     case EventHfpReconnectFailed:
+        /* Only indicate once the link loss retries have given up */
+        if (reconnectSchedule(&lApp->hfp_reconnect, reconnectHfp, &lApp->task, APP_HFP_RECONNECT, lApp->page_scan_enabled))
+            lIndicateEvent = FALSE ;
         break;
 	case EventA2dpReconnectFailed:
+        if (reconnectSchedule(&lApp->a2dp_reconnect, reconnectA2dp, &lApp->task, APP_A2DP_RECONNECT, lApp->page_scan_enabled))
+            lIndicateEvent = FALSE ;
         break;
     case EventLastNumberRedial:
     {
-		if (lApp->aghfp_connect && lApp->audio_connect)
+		if (intercomIsAudioActive(lApp))
 		{
 			lIndicateEvent = FALSE ;
 			break;
@@ -498,12 +525,12 @@ void handleUEMessage( Task task, MessageId id, Message message )
     case EventAnswer:
         if(lState == headsetIncomingCallEstablish) /* Auto Answer Update */
         {
-            MessageSend(&lApp->task, EventSkipForward, 0);
+            coalesceSend(&lApp->task, EventSkipForward, 0, coalesceMerge);
 
             /* Modify Old Mobile Call connection */
-            if(lApp->aghfp_connect && lApp->audio_connect)
+            if(intercomIsAudioActive(lApp))
             {
-                AghfpAudioDisconnect(lApp->aghfp);
+                intercomAudioDisconnectAll(lApp);
                 MessageSendLater(&lApp->task, EventReject, 0, 1000); /* SUSPEND */
             }
             else if(lApp->slave_function && (int)HfpGetAudioSink(lApp->intercom_hsp) && lApp->dsp_process) /* v100129 */
@@ -551,7 +578,7 @@ void handleUEMessage( Task task, MessageId id, Message message )
 #ifdef S100A /* v101201 Power On connect to intercom addr */
         bdaddr addr;
 
-        if(!(lState == headsetConnDiscoverable && !(lApp->intercom_pairing_mode) && !PsRetrieve(12, &addr, sizeof(bdaddr)) && !PsRetrieve(14, &addr, sizeof(bdaddr))))
+        if(!(lState == headsetConnDiscoverable && !(lApp->intercom_pairing_mode) && !peerTableCount() && !PsRetrieve(14, &addr, sizeof(bdaddr))))
 #else
         if(!(lState == headsetConnDiscoverable && !(lApp->intercom_pairing_mode))) /* v100817 Z100 Only button run during Intercom Pairing mode */
 #endif
@@ -581,15 +608,15 @@ void handleUEMessage( Task task, MessageId id, Message message )
 #endif
 
 #ifdef R100 /* v110117 Miss match. For No intercom function before intercom pariring */
-        if(!lApp->aghfp_connect && !lApp->slave_function && !lApp->intercom_button)
+        if(!intercomIsConnected(lApp) && !lApp->slave_function && !lApp->intercom_button)
         {
-            MessageSend(&lApp->task, EventSkipForward, 0);
-            MessageSendLater(&lApp->task, EventSkipBackward, 0, D_SEC(1));
+            coalesceSend(&lApp->task, EventSkipForward, 0, coalesceMerge);
+            coalesceSend(&lApp->task, EventSkipBackward, D_SEC(1), coalesceReplace);
             break;
         }
 #endif
 
-        if(!((lApp->slave_function && (int)HfpGetAudioSink(lApp->intercom_hsp) && lApp->dsp_process) || (lApp->aghfp_connect && lApp->audio_connect) || lApp->init_aghfp_power_on))
+        if(!((lApp->slave_function && (int)HfpGetAudioSink(lApp->intercom_hsp) && lApp->dsp_process) || intercomIsAudioActive(lApp) || lApp->init_aghfp_power_on))
         {
             TonesPlayTone(lApp, 14, TRUE); /* R100 */
 #ifdef BEEP_AUDIO_CON /* Not beep audio connection flag */
@@ -610,7 +637,7 @@ void handleUEMessage( Task task, MessageId id, Message message )
                         HfpAudioDisconnect(lApp->intercom_hsp);
                     else
                     {
-                        if(lApp->intercom_button) MessageSend(&lApp->task, EventSkipForward, 0); /* R100 */
+                        if(lApp->intercom_button) coalesceSend(&lApp->task, EventSkipForward, 0, coalesceMerge); /* R100 */
                         HfpAudioConnect(lApp->intercom_hsp, sync_all_sco, 0);
                     }
                 }
@@ -709,7 +736,7 @@ void handleUEMessage( Task task, MessageId id, Message message )
         break;
     }
 	case EventEstablishA2dp:
-		if (lApp->aghfp_connect && lApp->audio_connect)
+		if (intercomIsAudioActive(lApp))
 		{
 			lIndicateEvent = FALSE ;
 			break;
@@ -770,7 +797,7 @@ void handleUEMessage( Task task, MessageId id, Message message )
         break;
         
 	case EventPlay:
-		if ((lApp->aghfp_connect && lApp->audio_connect) || (lApp->slave_function && (int)HfpGetAudioSink(lApp->intercom_hsp) && lApp->dsp_process)) /* Don't play music during intercom - v110422 */
+		if (intercomIsAudioActive(lApp) || (lApp->slave_function && (int)HfpGetAudioSink(lApp->intercom_hsp) && lApp->dsp_process)) /* Don't play music during intercom - v110422 */
 		{
 			lIndicateEvent = FALSE ;
 			break;
@@ -800,7 +827,7 @@ void handleUEMessage( Task task, MessageId id, Message message )
     {
         uint8 pin[2];
 
-        if(lApp->aghfp_connect && lApp->audio_connect)
+        if(intercomIsAudioActive(lApp))
         {
             lIndicateEvent = FALSE;
             break;
@@ -105,10 +105,15 @@ typedef enum headsetEventsTag
 
 /*0x41*/    EventConfirmationAccept,
 /*0x42*/    EventConfirmationReject,
-/*0x43*/    EventToggleDebugKeys
+/*0x43*/    EventToggleDebugKeys,
+
+    /* Indications only, played through gEventTones but never sent */
+/*0x44*/    EventIntercomConnected,
+/*0x45*/    EventIntercomDisconnected,
+/*0x46*/    EventIntercomFailed
 } headsetEvents_t; 
 
-#define EVENTS_LAST_EVENT EventToggleDebugKeys
+#define EVENTS_LAST_EVENT EventIntercomFailed
 
 #define EVENTS_MAX_EVENTS ( (EVENTS_LAST_EVENT - EVENTS_EVENT_BASE) + 1 )
 
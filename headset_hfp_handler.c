@@ -9,15 +9,19 @@ Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
 
 #include "headset_a2dp_stream_control.h"
 #include "headset_amp.h"
+#include "headset_coalesce.h"
 #include "headset_configmanager.h"
 #include "headset_debug.h"
 #include "headset_hfp_handler.h"
 #include "headset_hfp_slc.h"
 #include "headset_init.h"
+#include "headset_intercom_msg_handler.h"
 #include "headset_LEDmanager.h"
 #include "headset_link_policy.h"
 #include "headset_statemanager.h"
+#include "headset_tone_cache.h"
 #include "headset_tones.h"
+#include "headset_vad.h"
 #include "headset_volume.h"
 #include "headset_csr_features.h"
 #include "headset_scan.h"
@@ -123,7 +127,7 @@ void hfpHandlerConnectInd( hsTaskData * pApp , const HFP_SLC_CONNECT_IND_T *ind
 #endif
             {
                 HfpSlcConnectResponse(ind->hfp, 1, &ind->addr, 0);
-                MessageSend(&pApp->task, EventSkipForward, 0);
+                coalesceSend(&pApp->task, EventSkipForward, 0, coalesceMerge);
             }
             else
             {
@@ -147,13 +151,13 @@ void hfpHandlerConnectInd( hsTaskData * pApp , const HFP_SLC_CONNECT_IND_T *ind
         if (ind->hfp == pApp->hfp)
         {
             HfpSlcConnectResponse(ind->hfp, 1, &ind->addr, 0);
-            MessageSend(&pApp->task, EventSkipForward, 0);
+            coalesceSend(&pApp->task, EventSkipForward, 0, coalesceMerge);
             pApp->profile_connected = hfp_handsfree_profile;
         }
         else if (ind->hfp == pApp->hsp)
         {
             HfpSlcConnectResponse(ind->hfp, 1, &ind->addr, 0);
-            MessageSend(&pApp->task, EventSkipForward, 0);
+            coalesceSend(&pApp->task, EventSkipForward, 0, coalesceMerge);
         }
         else
             /* Something is wrong we should be either hfp or hsp */
@@ -205,8 +209,8 @@ void hfpHandlerConnectCfm( hsTaskData * pApp , const HFP_SLC_CONNECT_CFM_T *cfm
             pApp->intercom_button = FALSE; /* R100 */
             hfpSlcConnectFail(pApp);
 
-            MessageSend(&pApp->task, EventSkipForward, 0);
-            MessageSendLater(&pApp->task, EventSkipBackward, 0, D_SEC(1));
+            coalesceSend(&pApp->task, EventSkipForward, 0, coalesceMerge);
+            coalesceSend(&pApp->task, EventSkipBackward, D_SEC(1), coalesceReplace);
             return;
         }
 
@@ -239,8 +243,8 @@ void hfpHandlerConnectCfm( hsTaskData * pApp , const HFP_SLC_CONNECT_CFM_T *cfm
             pApp->intercom_button = FALSE; /* R100 */
             hfpSlcConnectFail(pApp);
         
-            MessageSend(&pApp->task, EventSkipForward, 0);
-            MessageSendLater(&pApp->task, EventSkipBackward, 0, D_SEC(1));
+            coalesceSend(&pApp->task, EventSkipForward, 0, coalesceMerge);
+            coalesceSend(&pApp->task, EventSkipBackward, D_SEC(1), coalesceReplace);
             return;
         }
 
@@ -280,7 +284,8 @@ void hfpHandlerDisconnectInd(hsTaskData * pApp, const HFP_SLC_DISCONNECT_IND_T *
     			if (pApp->combined_link_loss)
     				pApp->slcConnectFromPowerOn = TRUE;
 
-    			/* A Link Loss has occured - attempt reconnect */
+    			/* A Link Loss has occured - attempt reconnect, retrying from EventHfpReconnectFailed */
+    			reconnectStart( &pApp->hfp_reconnect ) ;
             	hfpSlcConnectRequest( pApp , hfp_handsfree_profile ) ;
             }
 		}
@@ -405,12 +410,12 @@ void hfpHandlerCallSetupInd ( hsTaskData *pApp,  const HFP_CALL_SETUP_IND_T * pI
         break;
     case (hfp_incoming_call_setup): /*!< HFP device currently ringing.*/
 
-        if(pApp->aghfp_connect && pApp->audio_connect) /* SUSPEND */
+        if(intercomIsAudioActive(pApp)) /* SUSPEND */
         {
 #ifdef AUTO_INT_AFTERCALL
             pApp->discon_intercom_incoming = TRUE; /* v100617 Auto connetion INTERCOM after end call */
 #endif
-            AghfpAudioDisconnect(pApp->aghfp);
+            intercomAudioDisconnectAll(pApp);
         }
         else if(pApp->slave_function && (int)HfpGetAudioSink(pApp->intercom_hsp) && pApp->dsp_process) /* v100617 */
         {
@@ -425,12 +430,12 @@ void hfpHandlerCallSetupInd ( hsTaskData *pApp,  const HFP_CALL_SETUP_IND_T * pI
         break;
     case (hfp_outgoing_call_setup): /*!< Call currently being dialed.*/
 #ifdef S100A /* Discon INT when manual outgoing call v110422 */
-        if(pApp->aghfp_connect && pApp->audio_connect) /* SUSPEND */
+        if(intercomIsAudioActive(pApp)) /* SUSPEND */
         {
 #ifdef AUTO_INT_AFTERCALL
             pApp->discon_intercom_incoming = TRUE; /* v100617 Auto connetion INTERCOM after end call */
 #endif
-            AghfpAudioDisconnect(pApp->aghfp);
+            intercomAudioDisconnectAll(pApp);
         }
         else if(pApp->slave_function && (int)HfpGetAudioSink(pApp->intercom_hsp) && pApp->dsp_process) /* v100617 */
         {
@@ -457,7 +462,7 @@ void hfpHandlerCallSetupInd ( hsTaskData *pApp,  const HFP_CALL_SETUP_IND_T * pI
 void hfpHandlerRingInd ( hsTaskData *pApp )
 {
 	/* Disconnect A2DP audio if it is streaming from a standalone A2DP source */
-	if (!IsA2dpSourceAnAg(pApp) && !pApp->audio_connect) /* SUSPEND */
+	if (!IsA2dpSourceAnAg(pApp) && !intercomIsAudioActive(pApp)) /* SUSPEND */
     {
 		streamControlCeaseA2dpStreaming(pApp, TRUE);
     }
@@ -605,8 +610,8 @@ void hfpHandlerAudioConnectCfm( hsTaskData *pApp, const HFP_AUDIO_CONNECT_CFM_T
             TonesPlayTone(pApp, 8, TRUE);
             pApp->intercom_button = FALSE; /* R100 */
 
-            MessageSend(&pApp->task, EventSkipForward, 0);
-            MessageSendLater(&pApp->task, EventSkipBackward, 0, D_SEC(1));
+            coalesceSend(&pApp->task, EventSkipForward, 0, coalesceMerge);
+            coalesceSend(&pApp->task, EventSkipBackward, D_SEC(1), coalesceReplace);
         }
     }
 }
@@ -623,6 +628,9 @@ void hfpHandlerAudioDisconnectInd( hsTaskData *pApp, const HFP_AUDIO_DISCONNECT_
 	AmpOffLater(pApp);
 	
 	pApp->dsp_process = dsp_process_none;
+#ifdef VOICE_VAD
+    vadCodecReleased();
+#endif
 
 	/* Try to resume A2DP streaming if not outgoing or incoming call */
 	if ((stateManagerGetHfpState() != headsetIncomingCallEstablish) && (stateManagerGetHfpState() != headsetOutgoingCallEstablish))     
@@ -725,6 +733,13 @@ static bool audioConnectSco(hsTaskData *pApp, HFP *hfp, AUDIO_SINK_T sink_type,
     }
 #endif
 
+#ifdef TONE_CACHE
+    toneCacheStop();
+#endif
+#ifdef VOICE_VAD
+    vadCodecClaimed();
+#endif
+
 #if 0
     /* v091111 Release */
     lResult = AudioConnect(plugin,
@@ -744,7 +759,7 @@ static bool audioConnectSco(hsTaskData *pApp, HFP *hfp, AUDIO_SINK_T sink_type,
                                  HfpGetAudioSink(pApp->hfp_hsp),
                                  sink_type,
                                  pApp->theCodecTask,
-                                 VolumeRetrieveGain(pApp->gHfpVolumeLevel, FALSE),
+                                 VolumeConnectGain(pApp, FALSE),
                                  8000, /* Jace_Test */
                                  TRUE,
                                  lMode,
@@ -758,7 +773,7 @@ static bool audioConnectSco(hsTaskData *pApp, HFP *hfp, AUDIO_SINK_T sink_type,
                                  HfpGetAudioSink(pApp->intercom_hsp),
                                  sink_type,
                                  pApp->theCodecTask,
-                                 VolumeRetrieveGain(pApp->gHfpVolumeLevel, FALSE),
+                                 VolumeConnectGain(pApp, FALSE),
                                  8000, /* Jace_Test */
                                  TRUE,
                                  lMode,
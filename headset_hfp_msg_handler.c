@@ -8,6 +8,7 @@ Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
 */
 
 
+#include "headset_coalesce.h"
 #include "headset_debug.h"
 #include "headset_hfp_handler.h"
 #include "headset_hfp_msg_handler.h"
@@ -210,7 +211,7 @@ void handleHFPMessage( Task task, MessageId id, Message message )
         
     case HFP_AUDIO_CONNECT_IND:
         HFP_MSG_DEBUG(("HFP_AUDIO_CONNECT_IND\n"));
-        if(lApp->slave_function) MessageSend(&lApp->task, EventSkipForward, 0);
+        if(lApp->slave_function) coalesceSend(&lApp->task, EventSkipForward, 0, coalesceMerge);
         hfpHandlerAudioConnectInd( lApp, (HFP_AUDIO_CONNECT_IND_T *) message );
         break;
         
@@ -229,8 +230,8 @@ void handleHFPMessage( Task task, MessageId id, Message message )
             lApp->intercom_button = FALSE; /* R100 */
         }
 
-        MessageSend(&lApp->task, EventSkipForward, 0);
-        MessageSendLater(&lApp->task, EventSkipBackward, 0, D_SEC(1));
+        coalesceSend(&lApp->task, EventSkipForward, 0, coalesceMerge);
+        coalesceSend(&lApp->task, EventSkipBackward, D_SEC(1), coalesceReplace);
         break;
 
 	/* CSR Specific Messages */
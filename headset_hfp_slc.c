@@ -9,10 +9,12 @@ Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
 
 #include "headset_a2dp_connection.h"
 #include "headset_a2dp_stream_control.h"
+#include "headset_coalesce.h"
 #include "headset_configmanager.h"
 #include "headset_debug.h"
 #include "headset_hfp_call.h"
 #include "headset_hfp_slc.h"
+#include "headset_peer_table.h"
 #include "headset_statemanager.h"
 #include "headset_volume.h"
 
@@ -56,11 +58,15 @@ void hfpSlcConnectSuccess ( hsTaskData * pApp , HFP * pProfile, Sink sink )
     bdaddr ag_addr;
 #ifdef R100
     uint8 lslavemode;
+#ifdef S100A
+    bdaddr last_int;
+#endif
 #endif
 
 	HFP_SLC_DEBUG(("HFP: Connected[%x]\n", (uint16)sink)) ;
     
     pApp->slcConnecting = FALSE;
+    reconnectStop(&pApp->hfp_reconnect, &pApp->task, APP_HFP_RECONNECT);
 	
     if ( SinkGetBdAddr ( sink, &ag_addr ) )
     {
@@ -77,7 +83,9 @@ void hfpSlcConnectSuccess ( hsTaskData * pApp , HFP * pProfile, Sink sink )
             (void) PsStore(PSKEY_SLAVE_MODE, &lslavemode, sizeof(uint8)); /* Slave Mode memory */
             (void) PsStore(PSKEY_LAST_USED_INT, &ag_addr, sizeof(bdaddr));
 #ifdef S100A
-            (void)PsStore(12, 0, 0);
+            /* Forget only the last rider, as clearing its old key did */
+            if (peerTableGet(0, &last_int))
+                peerTableForget(&last_int);
 #endif
 #endif
 #ifdef SINPUNG
@@ -87,7 +95,7 @@ void hfpSlcConnectSuccess ( hsTaskData * pApp , HFP * pProfile, Sink sink )
         else
         {
             pApp->repeat_stop = FALSE;
-            MessageSend(&pApp->task, EventSkipBackward, 0); /* R100 */
+            coalesceSend(&pApp->task, EventSkipBackward, 0, coalesceReplace); /* R100 */
             hfpSlcStoreBdaddr ( &ag_addr );
         }
     }
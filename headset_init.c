@@ -311,21 +311,31 @@ Task InitA2dpPlugin(uint8 seid)
 }
 
 
+/*****************************************************************************/
+void InitIntercomPeer(intercomPeer *peer)
+{
+    /* The task of the link is left alone, it is set up once in main() */
+    peer->aghfp = NULL;
+    peer->audio_sink = NULL;
+    peer->bd_addr.nap = 0;
+    peer->bd_addr.uap = 0;
+    peer->bd_addr.lap = 0;
+    peer->link_type = sync_link_unknown;
+
+    intercomLinkReset(&peer->link);
+    reconnectStop(&peer->reconnect, &peer->task, AGHFP_LINK_LOSS_SLC_CONNECT_ATTEMPT); /* R100 */
+}
+
+
 /*****************************************************************************/
 void InitIntercomData(hsTaskData *pApp)
 {
-    pApp->aghfp = NULL;
-    pApp->audio_sink = NULL;
-    pApp->ag_bd_addr.nap = 0;
-    pApp->ag_bd_addr.uap = 0;
-    pApp->ag_bd_addr.lap = 0;
+    uint16 i;
+
+    for (i = 0; i < INTERCOM_MAX_PEERS; i++)
+        InitIntercomPeer(&pApp->intercom[i]);
 
-    pApp->aghfp_initial = FALSE;
     pApp->slave_function = FALSE;
-    pApp->aghfp_connect = FALSE;
-    pApp->audio_connect = FALSE;
-    pApp->aghfp_connecting = FALSE; /* R100 */
-    pApp->aghfp_attempt_count = 0; /* R100 */
     pApp->is_slc_connect_ind = FALSE; /* R100 */
     pApp->intercom_button = FALSE; /* R100 */
     pApp->repeat_stop = FALSE;
@@ -110,6 +110,17 @@ DESCRIPTION
 Task InitA2dpPlugin(uint8 seid);
 
 
+/*************************************************************************
+NAME    
+    InitIntercomPeer
+    
+DESCRIPTION
+    Clear one intercom link: its AGHFP instance, sink, address, link state
+    and reconnect attempts. The other links are left alone.
+*/
+void InitIntercomPeer ( intercomPeer *peer );
+
+
 /* Insert code for Intercom by Jace */
 /*************************************************************************
 NAME    
@@ -0,0 +1,181 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    headset_instrument.c
+@brief   Implementation of the optional message handler instrumentation.
+*/
+
+/****************************************************************************
+    Header files
+*/
+
+#include "headset_instrument.h"
+#include "headset_debug.h"
+
+#ifdef INSTRUMENT_HANDLERS
+
+#include <string.h>
+#include <vm.h>
+
+#ifdef HOST_BUILD
+#include <stdio.h>
+#include "host_runtime.h"
+
+#define INSTRUMENT_PRINT(x)     {printf x;}
+#define INSTRUMENT_CLOCK()      HostWallClockUs()
+#define INSTRUMENT_HAS_QUEUE_INFO
+#else
+#define INSTRUMENT_PRINT(x)     DEBUG(x)
+#define INSTRUMENT_CLOCK()      VmGetClock()
+#endif
+
+
+static instrumentEntry_t        gEntries [ INSTRUMENT_MAX_IDS + 1 ] ;
+static uint16                   gNumEntries = 0 ;
+static instrumentHistogram_t    gDepth [ INSTRUMENT_NUM_SOURCES ] ;
+
+static const char * const gSourceNames [ INSTRUMENT_NUM_SOURCES + 1 ] =
+{
+    "app" , "leds" , "buttons" , "battery" , "other"
+} ;
+
+
+/****************************************************************************
+  LOCAL FUNCTIONS
+*/
+
+static void instrumentRecord ( instrumentHistogram_t * pHist , uint32 pValue )
+{
+    uint16 lBucket = 0 ;
+    uint32 lValue  = pValue ;
+
+    while ( lValue && ( lBucket < INSTRUMENT_BUCKETS - 1 ) )
+    {
+        lValue >>= 1 ;
+        lBucket++ ;
+    }
+
+    if ( pHist->bucket [ lBucket ] != 0xffff )
+        pHist->bucket [ lBucket ]++ ;
+
+    if ( pValue > pHist->max )
+        pHist->max = pValue ;
+}
+
+
+static instrumentEntry_t * instrumentFind ( instrumentSource_t pSource , MessageId pId , bool pCreate )
+{
+    uint16 i ;
+
+    for ( i = 0 ; i < gNumEntries ; i++ )
+    {
+        if ( ( gEntries [ i ].id == pId ) && ( gEntries [ i ].source == pSource ) )
+            return &gEntries [ i ] ;
+    }
+
+    if ( !pCreate )
+        return NULL ;
+
+    if ( gNumEntries == INSTRUMENT_MAX_IDS )
+    {
+            /*table full - merge into the overflow entry*/
+        gEntries [ INSTRUMENT_MAX_IDS ].source = INSTRUMENT_NUM_SOURCES ;
+        return &gEntries [ INSTRUMENT_MAX_IDS ] ;
+    }
+
+    gEntries [ gNumEntries ].id     = pId ;
+    gEntries [ gNumEntries ].source = pSource ;
+    return &gEntries [ gNumEntries++ ] ;
+}
+
+
+static void instrumentPrintHistogram ( const char * pName , const instrumentHistogram_t * pHist )
+{
+    uint16 i ;
+
+    INSTRUMENT_PRINT(("  %s max %lu :" , pName , (unsigned long) pHist->max)) ;
+    for ( i = 0 ; i < INSTRUMENT_BUCKETS ; i++ )
+    {
+        if ( pHist->bucket [ i ] )
+            INSTRUMENT_PRINT((" <%lu:%u" , (unsigned long) 1 << i , pHist->bucket [ i ])) ;
+    }
+    INSTRUMENT_PRINT(("\n")) ;
+}
+
+
+/****************************************************************************
+  FUNCTIONS
+*/
+
+/**************************************************************************/
+void instrumentHandler ( instrumentSource_t pSource , TaskHandler pHandler , Task pTask , MessageId pId , Message pMessage )
+{
+    instrumentEntry_t * lEntry = instrumentFind ( pSource , pId , TRUE ) ;
+    uint32 lStart ;
+
+#ifdef INSTRUMENT_HAS_QUEUE_INFO
+    instrumentRecord ( &lEntry->late , HostNow () - HostDeliveryDue () ) ;
+    instrumentRecord ( &gDepth [ pSource ] , HostQueueDepth () ) ;
+#endif
+
+    lStart = INSTRUMENT_CLOCK () ;
+    pHandler ( pTask , pId , pMessage ) ;
+    instrumentRecord ( &lEntry->exec , INSTRUMENT_CLOCK () - lStart ) ;
+
+    if ( lEntry->count != 0xffff )
+        lEntry->count++ ;
+}
+
+
+/**************************************************************************/
+const instrumentEntry_t * instrumentGetEntry ( instrumentSource_t pSource , MessageId pId )
+{
+    return instrumentFind ( pSource , pId , FALSE ) ;
+}
+
+
+/**************************************************************************/
+const instrumentHistogram_t * instrumentGetDepth ( instrumentSource_t pSource )
+{
+    return &gDepth [ pSource ] ;
+}
+
+
+/**************************************************************************/
+void instrumentDump ( bool pClear )
+{
+    uint16 i ;
+
+    for ( i = 0 ; i <= INSTRUMENT_MAX_IDS ; i++ )
+    {
+        const instrumentEntry_t * lEntry = &gEntries [ i ] ;
+
+        if ( !lEntry->count )
+            continue ;
+
+        INSTRUMENT_PRINT(("INST: %s [%x] count %u\n" , gSourceNames [ lEntry->source ] , lEntry->id , lEntry->count)) ;
+        instrumentPrintHistogram ( "exec" , &lEntry->exec ) ;
+#ifdef INSTRUMENT_HAS_QUEUE_INFO
+        instrumentPrintHistogram ( "late" , &lEntry->late ) ;
+#endif
+    }
+
+#ifdef INSTRUMENT_HAS_QUEUE_INFO
+    for ( i = 0 ; i < INSTRUMENT_NUM_SOURCES ; i++ )
+    {
+        INSTRUMENT_PRINT(("INST: %s queue depth\n" , gSourceNames [ i ])) ;
+        instrumentPrintHistogram ( "depth" , &gDepth [ i ] ) ;
+    }
+#endif
+
+    if ( pClear )
+    {
+        memset ( gEntries , 0 , sizeof ( gEntries ) ) ;
+        memset ( gDepth , 0 , sizeof ( gDepth ) ) ;
+        gNumEntries = 0 ;
+    }
+}
+
+#endif /* INSTRUMENT_HANDLERS */
@@ -0,0 +1,148 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    headset_instrument.h
+@brief   Optional instrumentation of the application message handlers.
+
+    When INSTRUMENT_HANDLERS is defined every message delivered to an
+    instrumented task handler is timed, and the results are accumulated per
+    message id in fixed size log2 histograms:
+
+    - execution time of the handler
+    - lateness, the time between the message falling due and being handled
+    - depth of the message queue when the message was handled
+
+    On the chip execution time is in milliseconds and lateness and queue
+    depth are not available. In the host build execution time is in
+    microseconds of wall clock, lateness in milliseconds of virtual time.
+
+    Without INSTRUMENT_HANDLERS the macros below compile to the plain handler.
+*/
+
+#ifndef _HEADSET_INSTRUMENT_H_
+#define _HEADSET_INSTRUMENT_H_
+
+
+#include <message.h>
+
+
+/* Number of log2 buckets in each histogram - bucket n holds values 2^(n-1) to 2^n - 1 */
+#define INSTRUMENT_BUCKETS      (16)
+
+/* Number of distinct (task, message id) pairs tracked, further pairs are merged */
+#define INSTRUMENT_MAX_IDS      (48)
+
+
+/*! @brief The instrumented task handlers */
+typedef enum
+{
+    instrumentApp ,
+    instrumentLeds ,
+    instrumentButtons ,
+    instrumentBattery ,
+    INSTRUMENT_NUM_SOURCES
+} instrumentSource_t ;
+
+
+/*! @brief A log2 histogram */
+typedef struct
+{
+    uint16  bucket [ INSTRUMENT_BUCKETS ] ;
+    uint32  max ;
+} instrumentHistogram_t ;
+
+
+/*! @brief The statistics held for one message id */
+typedef struct
+{
+    MessageId               id ;
+    uint16                  source ;    /*!< instrumentSource_t, INSTRUMENT_NUM_SOURCES for the overflow entry */
+    uint16                  count ;
+    instrumentHistogram_t   exec ;
+    instrumentHistogram_t   late ;
+} instrumentEntry_t ;
+
+
+#ifdef INSTRUMENT_HANDLERS
+
+/****************************************************************************
+  FUNCTIONS
+*/
+
+/*************************************************************************
+NAME
+    instrumentHandler
+
+DESCRIPTION
+    Call pHandler for a message and record its statistics against pSource.
+    Not normally called directly, see INSTRUMENTED_HANDLER.
+
+*/
+void instrumentHandler ( instrumentSource_t pSource , TaskHandler pHandler , Task pTask , MessageId pId , Message pMessage ) ;
+
+
+/*************************************************************************
+NAME
+    instrumentGetEntry
+
+DESCRIPTION
+    Look up the statistics held for a message id.
+
+RETURNS
+    The entry, or NULL if the message has not been handled.
+*/
+const instrumentEntry_t * instrumentGetEntry ( instrumentSource_t pSource , MessageId pId ) ;
+
+
+/*************************************************************************
+NAME
+    instrumentGetDepth
+
+DESCRIPTION
+    Returns the histogram of queue depths seen by a task handler.
+
+*/
+const instrumentHistogram_t * instrumentGetDepth ( instrumentSource_t pSource ) ;
+
+
+/*************************************************************************
+NAME
+    instrumentDump
+
+DESCRIPTION
+    Print the statistics over the debug channel (stdout in the host build)
+    and optionally clear them.
+
+*/
+void instrumentDump ( bool pClear ) ;
+
+
+/*************************************************************************
+NAME
+    INSTRUMENTED_HANDLER / INSTRUMENT
+
+DESCRIPTION
+    INSTRUMENTED_HANDLER(source, handler) defines a wrapper for a task
+    handler, placed after the handler is declared. INSTRUMENT(handler) then
+    names the wrapper where the handler is installed in a task.
+
+*/
+#define INSTRUMENTED_HANDLER(pSource , pHandler) \
+    static void pHandler##Instrumented ( Task task , MessageId id , Message message ) \
+    { \
+        instrumentHandler ( pSource , pHandler , task , id , message ) ; \
+    }
+
+#define INSTRUMENT(pHandler) pHandler##Instrumented
+
+#else
+
+#define INSTRUMENTED_HANDLER(pSource , pHandler)
+#define INSTRUMENT(pHandler) pHandler
+
+#endif /* INSTRUMENT_HANDLERS */
+
+
+#endif /* _HEADSET_INSTRUMENT_H_ */
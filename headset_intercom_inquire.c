@@ -8,6 +8,11 @@ FILE NAME
 DESCRIPTION
     Handles inquiry procedures of Intercom application
 
+    Riders which answer the inquiry are collected for INQUIRY_WINDOW_MS
+    after the first answer, then the one heard with the strongest signal
+    is connected. In a crowd of helmets the rider being paired with is
+    normally the one held next to us.
+
 */
 
 /****************************************************************************
@@ -15,14 +20,268 @@ DESCRIPTION
 */
 #include <connection.h>
 #include <stdio.h>
+#include <string.h>
 #include <bdaddr.h>
 #include <aghfp.h>
+#include <vm.h>
 
+#include "headset_debug.h"
 #include "headset_private.h"
 #include "headset_intercom_inquire.h"
+#include "headset_intercom_msg_handler.h"
+
+#ifdef DEBUG_INQUIRE
+#define INQUIRE_DEBUG(x) DEBUG(x)
+#else
+#define INQUIRE_DEBUG(x)
+#endif
 
 #define CLASS_OF_DEVICE (AUDIO_MAJOR_SERV_CLASS | AV_MAJOR_DEVICE_CLASS)
 
+/* Riders ranked at once; a weaker one is dropped for a stronger one */
+#define INQUIRY_MAX_CANDIDATES  (4)
+
+/* Collection time after the first answer, two inquiry trains */
+#define INQUIRY_WINDOW_MS       (5120)
+
+
+typedef struct
+{
+    bdaddr      addr;
+    int16       rssi;
+} inquiryCandidate;
+
+static void inquiry_window_handler(Task task, MessageId id, Message message);
+
+static TaskData         window_task = { inquiry_window_handler };
+static inquiryCandidate candidates[INQUIRY_MAX_CANDIDATES];
+static uint16           num_candidates = 0;
+
+
+static inquiryFailedStats failed_stats;
+
+#ifndef S100A /* v101201 Repairing fail for same addr */
+/* For AG inquire */
+/* Keep a set of addresses we've tried before without success. An address
+   is skipped for FAILED_HOLD_MS after its first failure, twice as long
+   after each further one up to FAILED_HOLD_MAX_SHIFT doublings, and then
+   offered again. An entry left expired for FAILED_FORGET_MS is forgotten
+   with its count. The set is hashed on the LAP with linear probing; a
+   forgotten entry's slot is emptied by moving the rest of its chain back,
+   so chains stay short and a lookup stops at the first empty slot. */
+enum { FAILED_SIZE = 16 };              /* Power of two */
+#define FAILED_HOLD_MS          (30000UL)
+#define FAILED_HOLD_MAX_SHIFT   (4)     /* 8 minutes */
+#define FAILED_FORGET_MS        (FAILED_HOLD_MS << FAILED_HOLD_MAX_SHIFT)
+
+typedef struct
+{
+    bdaddr      addr;
+    uint16      failures;               /* 0 for a slot never used */
+    uint32      expires;                /* VmGetClock at which the address is offered again */
+} failedEntry;
+
+static failedEntry failed_addr[FAILED_SIZE];
+static bdaddr chosen_addr;
+
+static uint16 failed_hash(const bdaddr *addr)
+{
+    return (uint16)((addr->lap ^ (addr->lap >> 8) ^ addr->uap) & (FAILED_SIZE - 1));
+}
+
+static bool failed_live(const failedEntry *entry, uint32 now)
+{
+    return entry->failures && ((int32)(entry->expires - now) > 0);
+}
+
+static bool failed_stale(const failedEntry *entry, uint32 now)
+{
+    return entry->failures && ((int32)(now - entry->expires) >= (int32)FAILED_FORGET_MS);
+}
+
+/* Empty a slot, moving back each later entry of the chain whose home slot
+   it does not pass, so that none is cut off from its home */
+static void failed_remove(uint16 slot)
+{
+    uint16 next = slot;
+    uint16 i;
+
+    for(i = 1; i < FAILED_SIZE; i++)
+    {
+        uint16 home;
+
+        next = (next + 1) & (FAILED_SIZE - 1);
+        if(!failed_addr[next].failures)
+            break;
+
+        home = failed_hash(&failed_addr[next].addr);
+        if(((next - home) & (FAILED_SIZE - 1)) >= ((next - slot) & (FAILED_SIZE - 1)))
+        {
+            failed_addr[slot] = failed_addr[next];
+            slot = next;
+        }
+    }
+    failed_addr[slot].failures = 0;
+}
+
+/* The slot holding addr, or FAILED_SIZE, forgetting stale entries on the way */
+static uint16 failed_find(const bdaddr *addr, uint32 now)
+{
+    uint16 slot = failed_hash(addr);
+    uint16 i;
+
+    for(i = 0; i < FAILED_SIZE; i++)
+    {
+        if(!failed_addr[slot].failures)
+            break;
+        if(failed_stale(&failed_addr[slot], now))
+        {
+            /* Look again at the entry moved in */
+            failed_remove(slot);
+            continue;
+        }
+        if(BdaddrIsSame(&failed_addr[slot].addr, addr))
+            return slot;
+        slot = (slot + 1) & (FAILED_SIZE - 1);
+    }
+    return FAILED_SIZE;
+}
+
+static bool tried_and_failed(const bdaddr *addr)
+{
+    uint32 now = VmGetClock();
+    uint16 slot = failed_find(addr, now);
+
+    if(slot != FAILED_SIZE && failed_live(&failed_addr[slot], now))
+    {
+        failed_stats.hits++;
+        return TRUE;
+    }
+    failed_stats.misses++;
+    return FALSE;
+}
+
+static void add_failed(const bdaddr *addr)
+{
+    uint32 now = VmGetClock();
+    uint16 slot = failed_find(addr, now);
+    uint16 shift;
+
+    if(slot == FAILED_SIZE)
+    {
+        /* New address: the first empty or expired slot on its chain, else
+           the one due to expire soonest */
+        uint16 probe = failed_hash(addr);
+        uint16 i;
+
+        slot = probe;
+        for(i = 0; i < FAILED_SIZE; i++)
+        {
+            if(!failed_live(&failed_addr[probe], now))
+            {
+                slot = probe;
+                break;
+            }
+            if((int32)(failed_addr[probe].expires - failed_addr[slot].expires) < 0)
+                slot = probe;
+            probe = (probe + 1) & (FAILED_SIZE - 1);
+        }
+        if(i == FAILED_SIZE)
+            failed_stats.evictions++;
+
+        failed_addr[slot].addr = *addr;
+        failed_addr[slot].failures = 0;
+    }
+
+    if(failed_addr[slot].failures < 0xffff)
+        failed_addr[slot].failures++;
+
+    shift = failed_addr[slot].failures - 1;
+    if(shift > FAILED_HOLD_MAX_SHIFT)
+        shift = FAILED_HOLD_MAX_SHIFT;
+    failed_addr[slot].expires = now + (FAILED_HOLD_MS << shift);
+
+    INQUIRE_DEBUG(("INQ: failed %d times, held %ldms\n", failed_addr[slot].failures, FAILED_HOLD_MS << shift));
+}
+#endif
+
+
+/* Candidates answering without RSSI rank below every measured one */
+static int16 rank_rssi(int16 rssi)
+{
+    return (rssi == CL_RSSI_UNKNOWN) ? -0x7fff : rssi;
+}
+
+
+static void add_candidate(const bdaddr *addr, int16 rssi)
+{
+    uint16 i;
+    uint16 weakest = 0;
+
+    for(i = 0; i < num_candidates; i++)
+    {
+        if(BdaddrIsSame(&candidates[i].addr, addr))
+        {
+            /* Answered again, keep the best reading */
+            if(rank_rssi(rssi) > rank_rssi(candidates[i].rssi))
+                candidates[i].rssi = rssi;
+            return;
+        }
+        if(rank_rssi(candidates[i].rssi) < rank_rssi(candidates[weakest].rssi))
+            weakest = i;
+    }
+
+    if(num_candidates < INQUIRY_MAX_CANDIDATES)
+        weakest = num_candidates++;
+    else if(rank_rssi(rssi) <= rank_rssi(candidates[weakest].rssi))
+        return;
+
+    candidates[weakest].addr = *addr;
+    candidates[weakest].rssi = rssi;
+}
+
+
+/* Connect the pairing link to the strongest candidate */
+static void select_candidate(hsTaskData* app)
+{
+    intercomPeer* peer = intercomPeerPairing(app);
+    uint16 best = 0;
+    uint16 i;
+
+    MessageCancelAll(&window_task, 0);
+
+    for(i = 1; i < num_candidates; i++)
+    {
+        if(rank_rssi(candidates[i].rssi) > rank_rssi(candidates[best].rssi))
+            best = i;
+    }
+
+    if(peer && num_candidates && !intercomPeerFromAddr(app, &candidates[best].addr))
+    {
+        INQUIRE_DEBUG(("INQ: %d candidates, best rssi %d\n", num_candidates, candidates[best].rssi));
+
+        peer->bd_addr = candidates[best].addr;
+        (void)intercomPeerEvent(peer, intercomEventSlcRequest);
+#ifndef S100A
+        chosen_addr = peer->bd_addr;
+#endif
+
+        /* Cancel the inquiry */
+        ConnectionInquireCancel(getAppTask());
+
+        /* Now try and connect to this device */
+        AghfpSlcConnect(peer->aghfp, &peer->bd_addr);
+    }
+
+    num_candidates = 0;
+}
+
+
+static void inquiry_window_handler(Task task, MessageId id, Message message)
+{
+    select_candidate((hsTaskData *) getAppTask());
+}
+
 
 /****************************************************************************
 NAME    
@@ -36,6 +295,9 @@ RETURNS
 */
 void intercomInquire(hsTaskData* app)
 {
+    num_candidates = 0;
+    MessageCancelAll(&window_task, 0);
+
     /* Turn off security */
     ConnectionSmRegisterIncomingService(0x0000, 0x0001, 0x0000);
     /* Write class of device */
@@ -56,7 +318,12 @@ RETURNS
 */
 void intercomInquiryComplete(hsTaskData* app)
 {
-    if(BdaddrIsZero(&app->ag_bd_addr))
+    if(num_candidates)
+    {
+        /* Inquiry ended inside the collection window */
+        select_candidate(app);
+    }
+    else if(intercomPeerPairing(app))
     {
         /* No remote device found, so must decide what to do now */
         /* Restart Inquiry */
@@ -80,16 +347,61 @@ RETURNS
 */
 void intercomInquiryResult(hsTaskData* app, const CL_DM_INQUIRE_RESULT_T* res)
 {
-    /*  make sure device class returned is correct,
-    and that we currently aren't trying to connect to another device  */
-    if((res->dev_class & CLASS_OF_DEVICE) && (BdaddrIsZero(&app->ag_bd_addr)))
+    /*  make sure device class returned is correct, that a link is waiting
+    for a rider and that this rider is not already on another link  */
+    if(!(res->dev_class & CLASS_OF_DEVICE) || !intercomPeerPairing(app) || intercomPeerFromAddr(app, &res->bd_addr))
+        return;
+
+#ifndef S100A /* v101201 Repairing fail for same addr */
+    if(tried_and_failed(&res->bd_addr))
     {
-        app->ag_bd_addr = res->bd_addr;
+        INQUIRE_DEBUG(("INQ: already failed\n"));
+        return;
+    }
+#endif
 
-        /* Cancel the inquiry */
-        ConnectionInquireCancel(getAppTask());
+    INQUIRE_DEBUG(("INQ: candidate rssi %d\n", res->rssi));
 
-        /* Now try and connect to this device */
-        AghfpSlcConnect(app->aghfp, &app->ag_bd_addr);
-    }
+    /* The first answer opens the collection window */
+    if(!num_candidates)
+        MessageSendLater(&window_task, 0, 0, INQUIRY_WINDOW_MS);
+
+    add_candidate(&res->bd_addr, res->rssi);
+}
+
+/****************************************************************************
+NAME
+    intercomInquiryConnectFailed
+
+DESCRIPTION
+    The connection to addr failed; if it was chosen from an inquiry it is
+    not offered again for a while, longer each time it fails.
+
+RETURNS
+    void
+*/
+void intercomInquiryConnectFailed(const bdaddr* addr)
+{
+#ifndef S100A /* v101201 Repairing fail for same addr */
+    if(BdaddrIsZero(addr) || !BdaddrIsSame(addr, &chosen_addr))
+        return;
+
+    add_failed(addr);
+    memset(&chosen_addr, 0, sizeof(bdaddr));
+#endif
+}
+
+/****************************************************************************
+NAME    
+    intercomInquiryFailedStats
+
+DESCRIPTION
+    Returns how well the failed address set is filtering inquiry results
+
+RETURNS
+    The statistics
+*/
+const inquiryFailedStats* intercomInquiryFailedStats(void)
+{
+    return &failed_stats;
 }
@@ -14,6 +14,15 @@ DESCRIPTION
 #define _HEADSET_INTERCOM_INQUIRE_H_
 
 
+/* Filtering of inquiry results by the set of riders which failed to connect */
+typedef struct
+{
+    uint16 hits;        /* Results skipped as the rider failed recently, wrapping */
+    uint16 misses;      /* Results looked up and not skipped, wrapping */
+    uint16 evictions;   /* Riders dropped from the full set before they expired */
+} inquiryFailedStats;
+
+
 /****************************************************************************
 NAME    
     intercomInquire
@@ -52,5 +61,31 @@ RETURNS
 */
 void intercomInquiryResult(hsTaskData* app, const CL_DM_INQUIRE_RESULT_T* res);
 
+
+/****************************************************************************
+NAME    
+    intercomInquiryConnectFailed
+    
+DESCRIPTION
+    Connection to a rider failed, stop offering it if it came from an inquiry
+
+RETURNS
+    void
+*/
+void intercomInquiryConnectFailed(const bdaddr* addr);
+
+
+/****************************************************************************
+NAME    
+    intercomInquiryFailedStats
+    
+DESCRIPTION
+    Returns how well the failed address set is filtering inquiry results
+
+RETURNS
+    The statistics
+*/
+const inquiryFailedStats* intercomInquiryFailedStats(void);
+
 #endif /* _HEADSET_INTERCOM_INQUIRE_H_ */
 
@@ -8,6 +8,7 @@ Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
 */
 
 #include <aghfp.h>
+#include <bdaddr.h>
 #include <panic.h>
 #include <ps.h>
 #include <codec.h>
@@ -23,20 +24,26 @@ Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
 #include <stdlib.h>
 #include <string.h>
 
+#include "headset_coalesce.h"
+#include "headset_conference.h"
 #include "headset_debug.h"
 #include "headset_private.h"
 #include "headset_intercom_msg_handler.h"
 #include "headset_volume.h"
 #include "headset_a2dp_stream_control.h"
 #include "headset_amp.h"
+#include "headset_audio_switch.h"
 #include "headset_LEDmanager.h"
 #include "headset_init.h"
+#include "headset_tone_cache.h"
 #include "headset_tones.h"
 #include "headset_statemanager.h"
 #include "headset_hfp_slc.h"
 #include "headset_a2dp_connection.h"
 /* For AG inquire */
 #include "headset_intercom_inquire.h"
+#include "headset_peer_table.h"
+#include "headset_vad.h"
 #include "headset_scan.h" /* v100817 Disable Connectable Problem (AGHFP, A2DP, HFP) */
 
 #ifdef DEBUG_INTERCOM_MSG
@@ -70,40 +77,259 @@ Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
 
 /****************************************************************************/
 
-/* For AG inquire */
-#define PSKEY_TARGET_BDADDR 12
+static uint16 know_far_addr(bdaddr far_addr)
+{
+    return far_addr.lap || far_addr.nap || far_addr.uap;
+}
 
-/* Manipulate far_addr, keeping it in step with the copy in Persistent Store */
+/* Give the link the most recent rider not already on another link */
+static void recall_far_addr(hsTaskData* app, intercomPeer* peer)
+{
+    bdaddr addr;
+    uint16 i;
+
+    memset(&peer->bd_addr, 0, sizeof(bdaddr));
+
+    for(i = 0; peerTableGet(i, &addr); i++)
+    {
+        if(!intercomPeerFromAddr(app, &addr))
+        {
+            peer->bd_addr = addr;
+            INTERCOM_MSG_DEBUG(("Recall far addr %d: %ld %d %d\n", i, addr.lap, addr.uap, addr.nap));
+            return;
+        }
+    }
+}
 
-static void write_far_addr(bdaddr* far_addr)
+/* Find the rider link a message was sent to */
+static intercomPeer* peer_from_task(hsTaskData* app, Task task)
 {
-    (void)PanicZero(PsStore(PSKEY_TARGET_BDADDR, far_addr, sizeof(bdaddr)));
-    INTERCOM_MSG_DEBUG(("Write far addr: %ld %d %d\n", far_addr->lap, far_addr->uap, far_addr->nap));
+    uint16 i;
+
+    for(i = 0; i < INTERCOM_MAX_PEERS; i++)
+    {
+        if(task == &app->intercom[i].task)
+            return &app->intercom[i];
+    }
+
+    /* A replayed trace delivers to the application task, it belongs to the first rider */
+    return &app->intercom[0];
 }
 
-static void clear_far_addr(bdaddr* far_addr)
+#ifdef S100A
+static bool all_initialised(hsTaskData* app)
 {
-    memset(far_addr, 0, sizeof(bdaddr));
-    (void)PsStore(PSKEY_TARGET_BDADDR, 0, 0);
-    INTERCOM_MSG_DEBUG(("Clear far addr:\n"));
+    uint16 i;
+
+    for(i = 0; i < INTERCOM_MAX_PEERS; i++)
+    {
+        if(app->intercom[i].link.state == intercomLinkUninitialised)
+            return FALSE;
+    }
+    return TRUE;
 }
+#endif
 
-static void read_far_addr(bdaddr* far_addr)
+/* Connect the DSP plugin to the SCO link of a single rider */
+static void connect_plugin(hsTaskData* app, intercomPeer* peer)
 {
-    if(!PsRetrieve(PSKEY_TARGET_BDADDR, far_addr, sizeof(bdaddr)))
-        clear_far_addr(far_addr);
-    INTERCOM_MSG_DEBUG(("Read far addr: %ld %d %d\n", far_addr->lap, far_addr->uap, far_addr->nap));
+    TaskData * plugin = NULL;
+
+#ifdef TONE_CACHE
+    toneCacheStop();
+#endif
+#ifdef VOICE_VAD
+    vadCodecClaimed();
+#endif
+
+#ifdef CONFERENCE_SINGLE_RIDER
+    if(!app->cvcEnabled)
+    {
+        /* Carry the rider's frames through the VM, where their arrival is
+           smoothed out, those lost on air are concealed, their level is
+           controlled and the wind is taken out of the microphone, instead
+           of through the plugin which does none of these */
+        if(!conferenceIsActive())
+        {
+            AudioDisconnect();
+            conferenceStart();
+#ifdef INTERCOM_AGC
+            conferenceSetTarget(VolumeRetrieveAgcTarget(app->gHfpVolumeLevel));
+#endif
+        }
+        (void)conferenceAddParty(peer->audio_sink);
+        return;
+    }
+#endif
+
+    if (!app->cvcEnabled) plugin = (TaskData *)&csr_cvsd_no_dsp_plugin;
+    else plugin = (TaskData *)&csr_cvsd_cvc_1mic_headset_plugin; /* Jace_Test */
+
+    /* v091111 Release */
+    AudioConnect(plugin,
+                   peer->audio_sink,
+                   peer->link_type,
+                   app->theCodecTask,
+                   VolumeConnectGain(app, FALSE),
+                   8000, /* Jace_Test */
+                   TRUE,
+                   AUDIO_MODE_CONNECTED,
+                   NULL,
+                   &app->task); /* Jace_Test */
 }
 
-static uint16 know_far_addr(bdaddr far_addr)
+#ifdef INTERCOM_CONFERENCE
+static uint16 audio_peers(hsTaskData* app)
 {
-    return far_addr.lap || far_addr.nap || far_addr.uap;
+    uint16 i;
+    uint16 count = 0;
+
+    for(i = 0; i < INTERCOM_MAX_PEERS; i++)
+    {
+        if(app->intercom[i].link.state == intercomLinkAudio)
+            count++;
+    }
+    return count;
+}
+
+/* Route the audio of the riders still connected after one joins or leaves.
+   The DSP plugin serves a single rider, the conference mix any more. */
+static void route_audio(hsTaskData* app)
+{
+    uint16 i;
+
+#ifdef TONE_CACHE
+    toneCacheStop();
+#endif
+#ifdef VOICE_VAD
+    vadCodecClaimed();
+#endif
+
+    conferenceStop();
+    AudioDisconnect();
+
+    if(audio_peers(app) > 1)
+    {
+        conferenceStart();
+#ifdef INTERCOM_AGC
+        conferenceSetTarget(VolumeRetrieveAgcTarget(app->gHfpVolumeLevel));
+#endif
+    }
+
+    for(i = 0; i < INTERCOM_MAX_PEERS; i++)
+    {
+        intercomPeer* peer = &app->intercom[i];
+
+        if(peer->link.state != intercomLinkAudio)
+            continue;
+
+        if(conferenceIsActive())
+            (void)conferenceAddParty(peer->audio_sink);
+        else
+            connect_plugin(app, peer);
+    }
+}
+#endif
+
+
+/****************************************************************************
+    FUNCTIONS
+*/
+
+bool intercomIsConnected(hsTaskData* app)
+{
+    uint16 i;
+
+    for(i = 0; i < INTERCOM_MAX_PEERS; i++)
+    {
+        if(app->intercom[i].link.state >= intercomLinkConnected)
+            return TRUE;
+    }
+    return FALSE;
+}
+
+bool intercomIsAudioActive(hsTaskData* app)
+{
+    uint16 i;
+
+    for(i = 0; i < INTERCOM_MAX_PEERS; i++)
+    {
+        if(app->intercom[i].link.state == intercomLinkAudio)
+            return TRUE;
+    }
+    return FALSE;
+}
+
+void intercomAudioDisconnectAll(hsTaskData* app)
+{
+    uint16 i;
+
+    for(i = 0; i < INTERCOM_MAX_PEERS; i++)
+    {
+        if(app->intercom[i].link.state == intercomLinkAudio)
+            AghfpAudioDisconnect(app->intercom[i].aghfp);
+    }
+}
+
+void intercomSlcDisconnectAll(hsTaskData* app)
+{
+    uint16 i;
+
+    for(i = 0; i < INTERCOM_MAX_PEERS; i++)
+    {
+        reconnectStop(&app->intercom[i].reconnect, &app->intercom[i].task, AGHFP_LINK_LOSS_SLC_CONNECT_ATTEMPT);
+
+        if(app->intercom[i].link.state >= intercomLinkConnected)
+            AghfpSlcDisconnect(app->intercom[i].aghfp);
+    }
+}
+
+intercomPeer* intercomPeerFree(hsTaskData* app)
+{
+    uint16 i;
+
+    for(i = 0; i < INTERCOM_MAX_PEERS; i++)
+    {
+        if(!know_far_addr(app->intercom[i].bd_addr))
+            return &app->intercom[i];
+    }
+    return NULL;
+}
+
+intercomPeer* intercomPeerPairing(hsTaskData* app)
+{
+    uint16 i;
+
+    for(i = 0; i < INTERCOM_MAX_PEERS; i++)
+    {
+        if(app->intercom[i].link.state == intercomLinkPairing && !know_far_addr(app->intercom[i].bd_addr))
+            return &app->intercom[i];
+    }
+    return NULL;
+}
+
+bool intercomPeerEvent(intercomPeer* peer, intercomLinkEvent_t event)
+{
+    return intercomLinkEvent(&peer->link, &peer->task, event);
+}
+
+intercomPeer* intercomPeerFromAddr(hsTaskData* app, const bdaddr* addr)
+{
+    uint16 i;
+
+    for(i = 0; i < INTERCOM_MAX_PEERS; i++)
+    {
+        if(BdaddrIsSame(&app->intercom[i].bd_addr, addr))
+            return &app->intercom[i];
+    }
+    return NULL;
 }
 
 
 void handleINTERCOMMessage(Task task, MessageId id, Message message)
 {
     hsTaskData* app = (hsTaskData*)getAppTask();
+    intercomPeer* peer = peer_from_task(app, task);
 
     switch(id)
     {
@@ -112,52 +338,62 @@ void handleINTERCOMMessage(Task task, MessageId id, Message message)
         AGHFP_INIT_CFM_T* msg = (AGHFP_INIT_CFM_T*)message;
         INTERCOM_MSG_DEBUG(("AGHFP_INIT_CFM\n"));
 
-        read_far_addr(&app->ag_bd_addr);
+        recall_far_addr(app, peer);
 
         if(msg->status == success)
         {
             INTERCOM_MSG_DEBUG(("success\n"));
-            app->aghfp = msg->aghfp;
-            app->aghfp_initial = TRUE;
+            peer->aghfp = msg->aghfp;
+            (void)intercomPeerEvent(peer, intercomEventInitialised);
 
 #ifdef S100A
             if(app->init_aghfp_power_on)
             {
-                app->repeat_stop = FALSE;
-                app->intercom_button = FALSE;
-                app->init_aghfp_power_on = FALSE;
+                /* Wait for every link to be initialised */
+                if(all_initialised(app))
+                {
+                    app->repeat_stop = FALSE;
+                    app->intercom_button = FALSE;
+                    app->init_aghfp_power_on = FALSE;
+                }
                 break;
             }
 #endif
 
-            if(know_far_addr(app->ag_bd_addr))
+            if(know_far_addr(peer->bd_addr))
             {
                 /*  We paired with a device, try and connect to it */
                 app->intercom_init = TRUE;
 
-                if(app->intercom_button) MessageSend(&app->task, EventSkipForward, 0);
+                if(app->intercom_button) coalesceSend(&app->task, EventSkipForward, 0, coalesceMerge);
 
-                AghfpSlcConnect(app->aghfp, &app->ag_bd_addr);
+                if(intercomPeerEvent(peer, intercomEventSlcRequest))
+                    AghfpSlcConnect(peer->aghfp, &peer->bd_addr);
             }
             else if(app->intercom_pairing_mode)
             {
-                MessageSend(&app->task, EventSkipForward, 0);
-                MessageSendLater(&app->task, AGHFP_INQUIRE_START, 0, 10); /* v100617 Pairing problem after slave's S/W Init. */
+                /* Pair the first free link only */
+                if(peer == intercomPeerFree(app))
+                {
+                    coalesceSend(&app->task, EventSkipForward, 0, coalesceMerge);
+                    MessageSendLater(&peer->task, AGHFP_INQUIRE_START, 0, 10); /* v100617 Pairing problem after slave's S/W Init. */
+                }
             }
-            else
+            else if(peer == &app->intercom[0])
             {
                 /* Insert code for Intercom by Jace */
                 app->repeat_stop = FALSE;
                 TonesPlayTone(app, 8, TRUE);
 
-                MessageSend(&app->task, EventSkipForward, 0);
-                MessageSendLater(&app->task, EventSkipBackward, 0, D_SEC(1));
+                coalesceSend(&app->task, EventSkipForward, 0, coalesceMerge);
+                coalesceSend(&app->task, EventSkipBackward, D_SEC(1), coalesceReplace);
             }
         }
         else
         {
             INTERCOM_MSG_DEBUG(("failure\n"));
-            InitIntercomData(app);
+            /* Only this link failed, the other riders' links carry on */
+            InitIntercomPeer(peer);
         }
         break;
     }
@@ -167,25 +403,22 @@ void handleINTERCOMMessage(Task task, MessageId id, Message message)
         AGHFP_SLC_CONNECT_CFM_T* msg = (AGHFP_SLC_CONNECT_CFM_T*)message;
         INTERCOM_MSG_DEBUG(("AGHFP_SLC_CONNECT_CFM\n"));
 
-        MessageCancelAll(&app->task, AGHFP_CONNECT_FAIL_TIMEOUT);
-        app->aghfp_connecting = FALSE; /* R100 */
-
         if(msg->status == aghfp_connect_success)
         {
             INTERCOM_MSG_DEBUG(("success\n"));
+            (void)intercomPeerEvent(peer, intercomEventSlcUp);
 #ifdef S100A
             app->intercom_init = FALSE; /* v100817 v100617 remodify */
 #endif
             MessageSend(&app->task, EventEndOfCall, 0); /* 4s LED ON concept */
-            app->aghfp_connect = TRUE;
-            app->aghfp_attempt_count = 0; /* R100 */
+            reconnectStop(&peer->reconnect, &peer->task, AGHFP_LINK_LOSS_SLC_CONNECT_ATTEMPT); /* R100 */
 
-            write_far_addr(&app->ag_bd_addr); /* For AG inquire */
+            peerTableConnected(&peer->bd_addr); /* For AG inquire */
 #ifdef R100
             (void)PsStore ( 7 , 0 , 0 ) ;
 #endif
 
-            TonesPlayTone(app, 7, TRUE);
+            TonesPlayEvent(app, EventIntercomConnected);
 #if 0
             if (lState == headsetConnDiscoverable) MessageSend(&app->task, EventPairingFail, 0);
 #else
@@ -202,11 +435,15 @@ void handleINTERCOMMessage(Task task, MessageId id, Message message)
             }
 #endif
 
-            MessageSendLater(&app->task, AGHFP_STABILIZE_AUDIO_CONNECT, 0, D_SEC(10));
+            MessageSendLater(&peer->task, AGHFP_STABILIZE_AUDIO_CONNECT, 0, D_SEC(10));
         }
         else
         {
             INTERCOM_MSG_DEBUG(("failure : %d\n", msg->status));
+            (void)intercomPeerEvent(peer, intercomEventSlcFailed);
+
+            intercomInquiryConnectFailed(&peer->bd_addr);
+            peerTableConnectFailed(&peer->bd_addr);
 
             app->repeat_stop = FALSE;
             app->intercom_button = FALSE; /* R100 */
@@ -214,18 +451,19 @@ void handleINTERCOMMessage(Task task, MessageId id, Message message)
             app->beep_audio_con = FALSE; 
 #endif
 
-            MessageSend(&app->task, EventSkipForward, 0);
-            MessageSendLater(&app->task, EventSkipBackward, 0, D_SEC(1));
+            coalesceSend(&app->task, EventSkipForward, 0, coalesceMerge);
+            coalesceSend(&app->task, EventSkipBackward, D_SEC(1), coalesceReplace);
 
-            if(app->aghfp_attempt_count == 0 || app->aghfp_attempt_count == 30) /* Link loss retry error tone remove */
-                TonesPlayTone(app, 8, TRUE);
+            /* Link loss retry error tone remove, until the retries give up */
+            if(!reconnectSchedule(&peer->reconnect, reconnectIntercom, &peer->task, AGHFP_LINK_LOSS_SLC_CONNECT_ATTEMPT, app->page_scan_enabled))
+                TonesPlayEvent(app, EventIntercomFailed);
 
             if(app->intercom_init)
             {
                 /* Restart enquiry process */
                 if(app->intercom_pairing_mode)
                 {
-                    MessageSendLater(&app->task, AGHFP_INQUIRE_START, 0, 500); /* v100617 Pairing problem after slave's S/W Init. */
+                    MessageSendLater(&peer->task, AGHFP_INQUIRE_START, 0, 500); /* v100617 Pairing problem after slave's S/W Init. */
                 }
             }
         }
@@ -236,25 +474,24 @@ void handleINTERCOMMessage(Task task, MessageId id, Message message)
         if(app->intercom_init)
         {
 #ifndef S100A /* v101201 Repairing fail for same addr */
-            ConnectionSmAuthenticate(&app->task, &app->ag_bd_addr, 1);
+            ConnectionSmAuthenticate(&app->task, &peer->bd_addr, 1);
 #else
-            (void) ConnectionSmDeleteAuthDevice(&app->ag_bd_addr);
+            (void) ConnectionSmDeleteAuthDevice(&peer->bd_addr);
 #endif
-            memset(&app->ag_bd_addr, 0, sizeof(bdaddr));
+            memset(&peer->bd_addr, 0, sizeof(bdaddr));
             app->intercom_init = FALSE; /* v100817 v100617 remodify */
         }
 
+        /* The inquiry result fills in this link */
+        (void)intercomPeerEvent(peer, intercomEventInquire);
         intercomInquire(app);
         break;
 
     case AGHFP_AUDIO_CONNECT_CFM:
     {
         AGHFP_AUDIO_CONNECT_CFM_T* msg = (AGHFP_AUDIO_CONNECT_CFM_T*)message;
-        TaskData * plugin = NULL;
         INTERCOM_MSG_DEBUG(("AGHFP_AUDIO_CONNECT_CFM\n"));
 
-        MessageCancelAll(&app->task, AGHFP_CONNECT_FAIL_TIMEOUT);
-
         app->repeat_stop = FALSE;
         app->is_slc_connect_ind = FALSE; /* R100 */
 
@@ -274,27 +511,22 @@ void handleINTERCOMMessage(Task task, MessageId id, Message message)
             TonesPlayTone(app, 7, TRUE);
 #endif
 
-            app->audio_connect = TRUE;
-            app->audio_sink = msg->audio_sink;
+            (void)intercomPeerEvent(peer, intercomEventAudioUp);
+            peer->audio_sink = msg->audio_sink;
+            peer->link_type = msg->link_type;
 
-            /* Disconnect A2DP audio if it was active */
-            if((stateManagerGetA2dpState() == headsetA2dpStreaming) || (stateManagerGetA2dpState() == headsetA2dpPaused))
-            {
-#ifdef DUAL_STREAM
-                app->a2dp_state_change = TRUE; /* SUSPEND */
+            /* Release A2DP and turn the audio amp on, unless already done
+               while the link was negotiated */
+            audioSwitchScoConnected(app);
 
-                streamControlCeaseA2dpStreaming(app, FALSE);
-                stateManagerEnterA2dpConnectedState(app); /* SUSPEND */
-#else
-                streamControlCeaseA2dpStreaming(app, TRUE);
-#endif
+#ifdef INTERCOM_CONFERENCE
+            if(audio_peers(app) > 1)
+            {
+                /* Another rider is already talking, mix them together */
+                route_audio(app);
+                break;
             }
-
-            if (!app->cvcEnabled) plugin = (TaskData *)&csr_cvsd_no_dsp_plugin;
-            else plugin = (TaskData *)&csr_cvsd_cvc_1mic_headset_plugin; /* Jace_Test */
-
-            /* Turn the audio amp on */
-            AmpOn(app);
+#endif
 
 #ifdef R100 /* v091221 */
             if(app->gHfpVolumeLevel > 4)
@@ -309,17 +541,8 @@ void handleINTERCOMMessage(Task task, MessageId id, Message message)
             }
 #endif
 
-            /* v091111 Release */
-            AudioConnect(plugin,
-                           app->audio_sink,
-                           msg->link_type,
-                           app->theCodecTask,
-                           VolumeRetrieveGain(app->gHfpVolumeLevel, FALSE),
-                           8000, /* Jace_Test */
-                           TRUE,
-                           AUDIO_MODE_CONNECTED,
-                           NULL,
-                           &app->task); /* Jace_Test */
+            connect_plugin(app, peer);
+            audioSwitchPluginConnected(app);
 
             app->dsp_process = dsp_process_sco;
 
@@ -330,14 +553,16 @@ void handleINTERCOMMessage(Task task, MessageId id, Message message)
         else
         {
             INTERCOM_MSG_DEBUG(("failure\n"));
-            TonesPlayTone(app, 8, TRUE);
+            (void)intercomPeerEvent(peer, intercomEventAudioFailed);
+            audioSwitchScoFailed(app);
+            TonesPlayEvent(app, EventIntercomFailed);
             app->intercom_button = FALSE; /* R100 */
 #ifdef BEEP_AUDIO_CON /* Not beep audio connection flag */
             app->beep_audio_con = FALSE; 
 #endif
 
-            MessageSend(&app->task, EventSkipForward, 0);
-            MessageSendLater(&app->task, EventSkipBackward, 0, D_SEC(1));
+            coalesceSend(&app->task, EventSkipForward, 0, coalesceMerge);
+            coalesceSend(&app->task, EventSkipBackward, D_SEC(1), coalesceReplace);
         }
         break;
     }
@@ -345,29 +570,53 @@ void handleINTERCOMMessage(Task task, MessageId id, Message message)
     case AGHFP_SLC_DISCONNECT_IND:
     {
         AGHFP_SLC_DISCONNECT_IND_T* msg = (AGHFP_SLC_DISCONNECT_IND_T*)message;
+        bool audio_connecting = (peer->link.state == intercomLinkAudioConnecting);
         INTERCOM_MSG_DEBUG(("AGHFP_SLC_DISCONNECT_IND\n"));
 
-        app->aghfp_connect = FALSE;
-        app->audio_connect = FALSE;
+        (void)intercomPeerEvent(peer, intercomEventSlcDown);
+        /* Audio still being set up on the link is lost with it */
+        if(audio_connecting)
+            audioSwitchScoFailed(app);
 
         headsetEnableConnectable(app); /* v100817 Disable Connectable Problem (AGHFP, A2DP, HFP) */
 
-        LEDManagerIndicateState(&app->theLEDTask, headsetHfpConnectable, stateManagerGetA2dpState());
-        TonesPlayTone(app, 9, TRUE);
+        if(!intercomIsConnected(app))
+            LEDManagerIndicateState(&app->theLEDTask, headsetHfpConnectable, stateManagerGetA2dpState());
+        TonesPlayEvent(app, EventIntercomDisconnected);
 
-        if(msg->status == aghfp_disconnect_link_loss && !(app->ag_bd_addr.nap == 0x24 && app->ag_bd_addr.uap == 0xbc && (app->ag_bd_addr.lap >= 0x100000 && app->ag_bd_addr.lap < 0x200000))) /* F100 ȣȯ */
-            MessageSendLater(&app->task, AGHFP_LINK_LOSS_SLC_CONNECT_ATTEMPT, 0, D_SEC(20)); /* R100 */
+        if(msg->status == aghfp_disconnect_link_loss && !(peer->bd_addr.nap == 0x24 && peer->bd_addr.uap == 0xbc && (peer->bd_addr.lap >= 0x100000 && peer->bd_addr.lap < 0x200000))) /* F100 ȣȯ */
+        {
+            peerTableLinkLost(&peer->bd_addr);
+            reconnectStart(&peer->reconnect); /* R100 */
+            (void)reconnectSchedule(&peer->reconnect, reconnectIntercom, &peer->task, AGHFP_LINK_LOSS_SLC_CONNECT_ATTEMPT, app->page_scan_enabled);
+        }
         break;
     }
 
     case AGHFP_AUDIO_DISCONNECT_IND:
         INTERCOM_MSG_DEBUG(("AGHFP_AUDIO_DISCONNECT_IND\n"));
 
-        app->audio_connect = FALSE;
+        (void)intercomPeerEvent(peer, intercomEventAudioDown);
         app->repeat_stop = FALSE;
         app->intercom_button = FALSE; /* R100 */
 
+#ifdef INTERCOM_CONFERENCE
+        if(audio_peers(app))
+        {
+            /* The other riders are still talking */
+            route_audio(app);
+            TonesPlayTone(app, 2, TRUE);
+            break;
+        }
+#endif
+
+#ifdef CONFERENCE_SINGLE_RIDER
+        conferenceStop();
+#endif
         AudioDisconnect();
+#ifdef VOICE_VAD
+        vadCodecReleased();
+#endif
 
         /* Turn the audio amp off after a delay */
         AmpOffLater(app);
@@ -399,8 +648,8 @@ void handleINTERCOMMessage(Task task, MessageId id, Message message)
             }
         }
 
-        MessageSend(&app->task, EventSkipForward, 0);
-        MessageSendLater(&app->task, EventSkipBackward, 0, D_SEC(1));
+        coalesceSend(&app->task, EventSkipForward, 0, coalesceMerge);
+        coalesceSend(&app->task, EventSkipBackward, D_SEC(1), coalesceReplace);
         break;
 
     case AGHFP_SLC_CONNECT_IND:
@@ -417,16 +666,19 @@ void handleINTERCOMMessage(Task task, MessageId id, Message message)
             case headsetConnDiscoverable:
             case headsetHfpConnectable:
             case headsetHfpConnected:
-                MessageSendLater(&app->task, AGHFP_CONNECT_FAIL_TIMEOUT, 0, D_SEC(10));
-                AghfpSlcConnectResponse(app->aghfp, TRUE, &msg->bd_addr);
+                (void)intercomPeerEvent(peer, intercomEventSlcRequest);
+                MessageSendLater(&peer->task, AGHFP_CONNECT_FAIL_TIMEOUT, 0, D_SEC(10));
+                /* The rider calling is who the link is to, for the peer table and reconnects */
+                peer->bd_addr = msg->bd_addr;
+                AghfpSlcConnectResponse(peer->aghfp, TRUE, &msg->bd_addr);
 
-                MessageSend(&app->task, EventSkipForward, 0);
+                coalesceSend(&app->task, EventSkipForward, 0, coalesceMerge);
                 app->is_slc_connect_ind = TRUE; /* R100 */
                 break;
 
             default:
                 /* Ignore IND */
-                AghfpSlcConnectResponse(app->aghfp, FALSE, &msg->bd_addr);
+                AghfpSlcConnectResponse(peer->aghfp, FALSE, &msg->bd_addr);
                 break;
         }
         break;
@@ -437,8 +689,9 @@ void handleINTERCOMMessage(Task task, MessageId id, Message message)
         AGHFP_AUDIO_CONNECT_IND_T* msg = (AGHFP_AUDIO_CONNECT_IND_T*)message;
         INTERCOM_MSG_DEBUG(("AGHFP_AUDIO_CONNECT_IND\n"));
 
-        MessageSend(&app->task, EventSkipForward, 0);
+        coalesceSend(&app->task, EventSkipForward, 0, coalesceMerge);
         app->repeat_stop = TRUE;
+        (void)intercomPeerEvent(peer, intercomEventAudioRequest);
         AghfpAudioConnectResponse(msg->aghfp, TRUE, sync_all_sco, 0);
         break;
     }
@@ -460,34 +713,38 @@ void handleINTERCOMMessage(Task task, MessageId id, Message message)
     case AGHFP_STABILIZE_AUDIO_CONNECT:
         INTERCOM_MSG_DEBUG(("AGHFP_STABILIZE_AUDIO_CONNECT\n"));
 
-        MessageCancelAll(&app->task, AGHFP_STABILIZE_AUDIO_CONNECT);
-        AghfpAudioConnect(app->aghfp, sync_all_sco, 0);
+        MessageCancelAll(&peer->task, AGHFP_STABILIZE_AUDIO_CONNECT);
+        if(intercomPeerEvent(peer, intercomEventAudioRequest))
+        {
+            AghfpAudioConnect(peer->aghfp, sync_all_sco, 0);
+            audioSwitchStart(app, 1);
+        }
         break;
         
     case AGHFP_CONNECT_FAIL_TIMEOUT:
+    {
+        bool audio_connecting = (peer->link.state == intercomLinkAudioConnecting);
         INTERCOM_MSG_DEBUG(("AGHFP_CONNECT_FAIL_TIMEOUT\n"));
 
-        MessageCancelAll(&app->task, AGHFP_CONNECT_FAIL_TIMEOUT);
-        TonesPlayTone(app, 8, TRUE);
-        app->aghfp_connect = FALSE;
-        app->audio_connect = FALSE;
+        MessageCancelAll(&peer->task, AGHFP_CONNECT_FAIL_TIMEOUT);
+        /* A link which timed out setting up audio keeps its SLC, but gives
+           up its part in the audio switch */
+        (void)intercomPeerEvent(peer, intercomEventTimeout);
+        if(audio_connecting)
+            audioSwitchScoFailed(app);
+
+        TonesPlayEvent(app, EventIntercomFailed);
         app->repeat_stop = FALSE;
         break;
+    }
 
     case AGHFP_LINK_LOSS_SLC_CONNECT_ATTEMPT: /* R100 */
         INTERCOM_MSG_DEBUG(("AGHFP_LINK_LOSS_SLC_CONNECT_ATTEMPT\n"));
-        if(!app->aghfp_connect && app->aghfp_attempt_count < 30)
+        /* The next attempt is scheduled when this one fails */
+        if(intercomPeerEvent(peer, intercomEventSlcRequest))
         {
-            app->aghfp_attempt_count++;
-
-            if(!app->aghfp_connecting)
-            {
-                app->aghfp_connecting = TRUE;
-                MessageSend(&app->task, EventSkipForward, 0);
-                AghfpSlcConnect(app->aghfp, &app->ag_bd_addr);
-            }
-
-            MessageSendLater(&app->task, AGHFP_LINK_LOSS_SLC_CONNECT_ATTEMPT, 0, D_SEC(20));
+            coalesceSend(&app->task, EventSkipForward, 0, coalesceMerge);
+            AghfpSlcConnect(peer->aghfp, &peer->bd_addr);
         }
         break;
 
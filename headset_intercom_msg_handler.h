@@ -12,6 +12,8 @@ Part of Stereo-Headset-SDK Q3-2007.RC3.1
 
 #include <message.h>
 
+#include "headset_private.h"
+
 
 /****************************************************************************
     FUNCTIONS
@@ -27,4 +29,86 @@ DESCRIPTION
 */
 void handleINTERCOMMessage(Task task, MessageId id, Message message);
 
+
+/*************************************************************************
+NAME
+    intercomIsConnected
+
+DESCRIPTION
+    Returns TRUE if any rider has an SLC connected.
+
+*/
+bool intercomIsConnected(hsTaskData* app);
+
+
+/*************************************************************************
+NAME
+    intercomIsAudioActive
+
+DESCRIPTION
+    Returns TRUE if any rider has an SLC and audio connected.
+
+*/
+bool intercomIsAudioActive(hsTaskData* app);
+
+
+/*************************************************************************
+NAME
+    intercomAudioDisconnectAll / intercomSlcDisconnectAll
+
+DESCRIPTION
+    Disconnect the audio, or the SLC, of every rider.
+
+*/
+void intercomAudioDisconnectAll(hsTaskData* app);
+void intercomSlcDisconnectAll(hsTaskData* app);
+
+
+/*************************************************************************
+NAME
+    intercomPeerFree
+
+DESCRIPTION
+    Returns the first link with no far address, or NULL if every link has
+    a rider.
+
+*/
+intercomPeer* intercomPeerFree(hsTaskData* app);
+
+
+/*************************************************************************
+NAME
+    intercomPeerPairing
+
+DESCRIPTION
+    Returns the link waiting for an inquiry result, or NULL if there is
+    none.
+
+*/
+intercomPeer* intercomPeerPairing(hsTaskData* app);
+
+
+/*************************************************************************
+NAME
+    intercomPeerFromAddr
+
+DESCRIPTION
+    Returns the link to the rider at addr, or NULL if there is none.
+
+*/
+intercomPeer* intercomPeerFromAddr(hsTaskData* app, const bdaddr* addr);
+
+
+/*************************************************************************
+NAME
+    intercomPeerEvent
+
+DESCRIPTION
+    Apply event to the state machine of a link.
+
+RETURNS
+    TRUE if the event moved the link to another state.
+*/
+bool intercomPeerEvent(intercomPeer* peer, intercomLinkEvent_t event);
+
 #endif
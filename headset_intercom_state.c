@@ -0,0 +1,165 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    headset_intercom_state.c
+@brief   Implementation of the intercom link state machine.
+*/
+
+/****************************************************************************
+    Header files
+*/
+
+#include "headset_intercom_state.h"
+#include "headset_debug.h"
+
+#include <aghfp.h>
+#include <string.h>
+#include <vm.h>
+
+
+#ifdef DEBUG_INTERCOM_STATE
+    #define STATE_DEBUG(x) DEBUG(x)
+#else
+    #define STATE_DEBUG(x)
+#endif
+
+
+/* A permitted transition */
+typedef struct
+{
+    unsigned    from:4 ;        /* intercomLinkState_t */
+    unsigned    event:4 ;       /* intercomLinkEvent_t */
+    unsigned    to:4 ;          /* intercomLinkState_t */
+} intercomTransition_t ;
+
+
+/* Run on entering and on leaving a state */
+typedef struct
+{
+    void ( * entry ) ( Task pTask ) ;
+    void ( * exit ) ( Task pTask ) ;
+} intercomStateActions_t ;
+
+
+/****************************************************************************
+  LOCAL FUNCTIONS
+*/
+
+/* The request was answered, or given up */
+static void intercomCancelConnectTimeout ( Task pTask )
+{
+    MessageCancelAll ( pTask , AGHFP_CONNECT_FAIL_TIMEOUT ) ;
+}
+
+
+/* Without an SLC there is nothing to open audio on */
+static void intercomCancelAudioConnect ( Task pTask )
+{
+    MessageCancelAll ( pTask , AGHFP_STABILIZE_AUDIO_CONNECT ) ;
+}
+
+
+/* Every transition not listed leaves the link where it is */
+static const intercomTransition_t gTransitions [] =
+{
+    { intercomLinkUninitialised   , intercomEventInitialised  , intercomLinkIdle } ,
+    { intercomLinkUninitialised   , intercomEventInquire      , intercomLinkPairing } ,
+
+    { intercomLinkIdle            , intercomEventInquire      , intercomLinkPairing } ,
+    { intercomLinkIdle            , intercomEventSlcRequest   , intercomLinkConnecting } ,
+    { intercomLinkIdle            , intercomEventSlcUp        , intercomLinkConnected } ,
+
+    { intercomLinkPairing         , intercomEventSlcRequest   , intercomLinkConnecting } ,
+    { intercomLinkPairing         , intercomEventSlcUp        , intercomLinkConnected } ,
+    { intercomLinkPairing         , intercomEventSlcFailed    , intercomLinkIdle } ,
+    { intercomLinkPairing         , intercomEventSlcDown      , intercomLinkIdle } ,
+    { intercomLinkPairing         , intercomEventTimeout      , intercomLinkIdle } ,
+
+    { intercomLinkConnecting      , intercomEventSlcUp        , intercomLinkConnected } ,
+    { intercomLinkConnecting      , intercomEventSlcFailed    , intercomLinkIdle } ,
+    { intercomLinkConnecting      , intercomEventSlcDown      , intercomLinkIdle } ,
+    { intercomLinkConnecting      , intercomEventTimeout      , intercomLinkIdle } ,
+
+    { intercomLinkConnected       , intercomEventAudioRequest , intercomLinkAudioConnecting } ,
+    { intercomLinkConnected       , intercomEventAudioUp      , intercomLinkAudio } ,
+    { intercomLinkConnected       , intercomEventSlcDown      , intercomLinkIdle } ,
+
+    { intercomLinkAudioConnecting , intercomEventAudioUp      , intercomLinkAudio } ,
+    { intercomLinkAudioConnecting , intercomEventAudioFailed  , intercomLinkConnected } ,
+    { intercomLinkAudioConnecting , intercomEventAudioDown    , intercomLinkConnected } ,
+    { intercomLinkAudioConnecting , intercomEventTimeout      , intercomLinkConnected } ,
+    { intercomLinkAudioConnecting , intercomEventSlcDown      , intercomLinkIdle } ,
+
+    { intercomLinkAudio           , intercomEventAudioDown    , intercomLinkConnected } ,
+    { intercomLinkAudio           , intercomEventSlcDown      , intercomLinkIdle }
+} ;
+
+#define INTERCOM_TRANSITIONS    ( sizeof ( gTransitions ) / sizeof ( gTransitions [ 0 ] ) )
+
+
+/* Indexed by intercomLinkState_t */
+static const intercomStateActions_t gActions [ intercom_link_states ] =
+{
+    { NULL , NULL } ,                                       /* Uninitialised */
+    { intercomCancelAudioConnect , NULL } ,                 /* Idle */
+    { NULL , intercomCancelConnectTimeout } ,               /* Pairing */
+    { NULL , intercomCancelConnectTimeout } ,               /* Connecting */
+    { NULL , NULL } ,                                       /* Connected */
+    { NULL , intercomCancelConnectTimeout } ,               /* AudioConnecting */
+    { NULL , NULL }                                         /* Audio */
+} ;
+
+
+/****************************************************************************
+  FUNCTIONS
+*/
+
+/**************************************************************************/
+void intercomLinkReset ( intercomLink_t * pLink )
+{
+    memset ( pLink , 0 , sizeof ( intercomLink_t ) ) ;
+
+    pLink->state   = intercomLinkUninitialised ;
+    pLink->entered = VmGetClock () ;
+}
+
+
+/**************************************************************************/
+bool intercomLinkEvent ( intercomLink_t * pLink , Task pTask , intercomLinkEvent_t pEvent )
+{
+    uint32 lNow ;
+    uint32 lDwell ;
+    uint16 i ;
+
+    for ( i = 0 ; i < INTERCOM_TRANSITIONS ; i++ )
+    {
+        if ( ( gTransitions [ i ].from == pLink->state ) && ( gTransitions [ i ].event == pEvent ) )
+            break ;
+    }
+
+    if ( i == INTERCOM_TRANSITIONS )
+    {
+        STATE_DEBUG(("ICSTATE: %d ignored in %d\n" , pEvent , pLink->state)) ;
+        return FALSE ;
+    }
+
+    lNow   = VmGetClock () ;
+    lDwell = lNow - pLink->entered ;
+
+    pLink->dwell_ms [ pLink->state ] = ( lDwell < 0xffff ) ? (uint16) lDwell : 0xffff ;
+
+    STATE_DEBUG(("ICSTATE: %d -> %d on %d after %ldms\n" , pLink->state , gTransitions [ i ].to , pEvent , lDwell)) ;
+
+    if ( gActions [ pLink->state ].exit )
+        gActions [ pLink->state ].exit ( pTask ) ;
+
+    pLink->state   = (intercomLinkState_t) gTransitions [ i ].to ;
+    pLink->entered = lNow ;
+
+    if ( gActions [ pLink->state ].entry )
+        gActions [ pLink->state ].entry ( pTask ) ;
+
+    return TRUE ;
+}
@@ -0,0 +1,99 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    headset_intercom_state.h
+@brief   State machine of one intercom link.
+
+    Each link is in exactly one state. The AGHFP handlers report what
+    happened as an event, and a table says which state, if any, the event
+    moves the link to. An event with no entry for the current state is
+    ignored, so a handler can use the result to decide whether to act.
+    Actions run on leaving and entering a state.
+
+    The time of each transition is recorded. For each state the link keeps
+    how long it stayed there on its last visit, so the SLC and SCO set up
+    phases of a connection can be timed separately.
+*/
+
+#ifndef _HEADSET_INTERCOM_STATE_H_
+#define _HEADSET_INTERCOM_STATE_H_
+
+
+#include <csrtypes.h>
+#include <message.h>
+
+
+/*! @brief States of an intercom link, ordered so that every state from intercomLinkConnected on has an SLC */
+typedef enum
+{
+    intercomLinkUninitialised ,     /*!< No AGHFP instance yet */
+    intercomLinkIdle ,              /*!< No SLC */
+    intercomLinkPairing ,           /*!< Waiting for an inquiry result to fill bd_addr */
+    intercomLinkConnecting ,        /*!< SLC being set up */
+    intercomLinkConnected ,         /*!< SLC up, no audio */
+    intercomLinkAudioConnecting ,   /*!< SCO being set up */
+    intercomLinkAudio ,             /*!< SCO up */
+    intercom_link_states
+} intercomLinkState_t ;
+
+
+/*! @brief What happened to an intercom link */
+typedef enum
+{
+    intercomEventInitialised ,      /*!< AGHFP_INIT_CFM success */
+    intercomEventInquire ,          /*!< Inquiry started to find a rider */
+    intercomEventSlcRequest ,       /*!< SLC connect requested or accepted */
+    intercomEventSlcUp ,            /*!< AGHFP_SLC_CONNECT_CFM success */
+    intercomEventSlcFailed ,        /*!< AGHFP_SLC_CONNECT_CFM failure */
+    intercomEventSlcDown ,          /*!< AGHFP_SLC_DISCONNECT_IND */
+    intercomEventAudioRequest ,     /*!< SCO connect requested or accepted */
+    intercomEventAudioUp ,          /*!< AGHFP_AUDIO_CONNECT_CFM success */
+    intercomEventAudioFailed ,      /*!< AGHFP_AUDIO_CONNECT_CFM failure */
+    intercomEventAudioDown ,        /*!< AGHFP_AUDIO_DISCONNECT_IND */
+    intercomEventTimeout ,          /*!< AGHFP_CONNECT_FAIL_TIMEOUT */
+    intercom_link_events
+} intercomLinkEvent_t ;
+
+
+/*! @brief State of one intercom link */
+typedef struct
+{
+    intercomLinkState_t state ;
+    uint32      entered ;                           /*!< VmGetClock when the current state was entered */
+    uint16      dwell_ms [ intercom_link_states ] ; /*!< Time spent in each state on its last visit, saturating */
+} intercomLink_t ;
+
+
+/****************************************************************************
+  FUNCTIONS
+*/
+
+/*************************************************************************
+NAME
+    intercomLinkReset
+
+DESCRIPTION
+    Put a link back in intercomLinkUninitialised, with no actions run and
+    the timings cleared.
+
+*/
+void intercomLinkReset ( intercomLink_t * pLink ) ;
+
+
+/*************************************************************************
+NAME
+    intercomLinkEvent
+
+DESCRIPTION
+    Apply pEvent to a link. pTask is the task of the link, the target of
+    the messages the actions send or cancel.
+
+RETURNS
+    TRUE if the event moved the link to another state.
+*/
+bool intercomLinkEvent ( intercomLink_t * pLink , Task pTask , intercomLinkEvent_t pEvent ) ;
+
+
+#endif /* _HEADSET_INTERCOM_STATE_H_ */
@@ -0,0 +1,278 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    headset_jitter.c
+@brief   Implementation of the intercom jitter buffer.
+*/
+
+/****************************************************************************
+    Header files
+*/
+
+#include "headset_jitter.h"
+#include "headset_debug.h"
+
+#include <string.h>
+
+
+#ifdef DEBUG_JITTER
+    #define JITTER_DEBUG(x) DEBUG(x)
+#else
+    #define JITTER_DEBUG(x)
+#endif
+
+
+#define JITTER_MASK         ( JITTER_RING - 1 )
+
+/* Arrival times are in milliseconds, samples at 8kHz */
+#define JITTER_SAMPLES_PER_MS   (8)
+
+/* The jitter rises to a later frame's variation in about 4 frames and falls
+   back over about 512, two seconds, so the depth is still there for the
+   next time the radio is held up elsewhere */
+#define JITTER_RISE_SHIFT   (2)
+#define JITTER_FALL_SHIFT   (9)
+
+/* The depth aimed for is a frame plus twice the jitter, which is held in Q4 */
+#define JITTER_DEPTH_SHIFT  (3)
+
+/* Frames are stretched when the depth is half a frame from the target, and
+   no more than one in JITTER_STRETCH_GAP, so catching up is not heard as
+   a change of speed */
+#define JITTER_STRETCH_GAP  (4)
+
+
+/****************************************************************************
+  LOCAL FUNCTIONS
+*/
+
+/* The sample pOffset from the next to play, negative for those played */
+static int16 jitterSample ( const jitterState_t * pState , int16 pOffset )
+{
+    return pState->ring [ (uint16) ( pState->read + pOffset ) & JITTER_MASK ] ;
+}
+
+
+/* Lag between pMin and pMax, forward or back, over which the next pSamples
+   samples best repeat, by the average magnitude difference function */
+static uint16 jitterFindLag ( const jitterState_t * pState , uint16 pSamples , uint16 pMin , uint16 pMax , bool pForward )
+{
+    uint32 lBest = 0xffffffffUL ;
+    uint16 lLag = pMin ;
+    uint16 l , i ;
+
+    for ( l = pMin ; l <= pMax ; l++ )
+    {
+        int16 lOffset = pForward ? (int16) l : - (int16) l ;
+        uint32 lSum = 0 ;
+
+        for ( i = 0 ; i < pSamples ; i += 2 )
+        {
+            int32 lDifference = (int32) jitterSample ( pState , i ) - jitterSample ( pState , i + lOffset ) ;
+
+            lSum += (uint32) ( ( lDifference < 0 ) ? -lDifference : lDifference ) ;
+        }
+
+        if ( lSum < lBest )
+        {
+            lBest = lSum ;
+            lLag  = l ;
+        }
+    }
+    return lLag ;
+}
+
+
+/* Play pSamples samples cross faded from the buffer to pLag further on (or
+   back), so they end where the buffer does pLag samples later (or earlier) */
+static void jitterStretch ( const jitterState_t * pState , int16 * pFrame , uint16 pSamples , int16 pLag )
+{
+    int32 lWeight = 0 ;
+    int32 lStep = ( pSamples > 1 ) ? 0x8000L / ( pSamples - 1 ) : 0x8000L ;
+    uint16 i ;
+
+    for ( i = 0 ; i < pSamples ; i++ )
+    {
+        int32 lFrom = jitterSample ( pState , i ) ;
+        int32 lTo = jitterSample ( pState , i + pLag ) ;
+
+        if ( i == pSamples - 1 )
+            lWeight = 0x8000L ;
+
+        pFrame [ i ] = (int16) ( lFrom + ( ( ( lTo - lFrom ) * lWeight ) >> 15 ) ) ;
+        lWeight += lStep ;
+    }
+}
+
+
+/* Move the read point on past pSamples samples, keeping them as history */
+static void jitterConsume ( jitterState_t * pState , uint16 pSamples )
+{
+    pState->read          = ( pState->read + pSamples ) & JITTER_MASK ;
+    pState->stats.depth  -= pSamples ;
+    pState->history       = ( pState->history + pSamples > JITTER_HISTORY ) ? JITTER_HISTORY : pState->history + pSamples ;
+}
+
+
+/****************************************************************************
+  FUNCTIONS
+*/
+
+/**************************************************************************/
+void jitterInit ( jitterState_t * pState )
+{
+    memset ( pState , 0 , sizeof ( jitterState_t ) ) ;
+
+    pState->filling = TRUE ;
+}
+
+
+/**************************************************************************/
+void jitterPut ( jitterState_t * pState , const int16 * pFrame , uint16 pSamples , uint32 pNow )
+{
+    int32 lTransit = (int32) ( pNow * JITTER_SAMPLES_PER_MS - pState->received ) ;
+    uint16 lRoom ;
+    uint16 lWrite ;
+    uint16 i ;
+
+    if ( pSamples > JITTER_FRAME_MAX )
+    {
+        pFrame   += pSamples - JITTER_FRAME_MAX ;
+        pSamples  = JITTER_FRAME_MAX ;
+    }
+
+        /*interarrival jitter: how much later or earlier this frame came than the last, for its samples*/
+    if ( pState->started )
+    {
+        int32 lDifference = lTransit - pState->transit ;
+        uint16 lVariation ;
+
+        if ( lDifference < 0 )
+            lDifference = -lDifference ;
+        if ( lDifference > JITTER_RING )
+            lDifference = JITTER_RING ;
+        lVariation = (uint16) lDifference << 4 ;
+
+        if ( lVariation > pState->jitter )
+            pState->jitter += ( lVariation - pState->jitter ) >> JITTER_RISE_SHIFT ;
+        else
+            pState->jitter -= ( pState->jitter - lVariation ) >> JITTER_FALL_SHIFT ;
+    }
+
+    pState->started   = TRUE ;
+    pState->transit   = lTransit ;
+    pState->received += pSamples ;
+
+    if ( pState->starved )
+    {
+        pState->stats.late++ ;
+        pState->starved = FALSE ;
+    }
+
+        /*no room: the oldest samples go, as they would have had to be caught up anyway*/
+    lRoom = JITTER_RING - JITTER_HISTORY - pState->stats.depth ;
+    if ( pSamples > lRoom )
+    {
+        JITTER_DEBUG(("JIT: overflow, depth %d\n" , pState->stats.depth)) ;
+        jitterConsume ( pState , pSamples - lRoom ) ;
+        pState->stats.overflows++ ;
+    }
+
+    lWrite = pState->read + pState->stats.depth ;
+    for ( i = 0 ; i < pSamples ; i++ )
+        pState->ring [ ( lWrite + i ) & JITTER_MASK ] = pFrame [ i ] ;
+
+    pState->stats.depth += pSamples ;
+}
+
+
+/**************************************************************************/
+bool jitterGet ( jitterState_t * pState , int16 * pFrame , uint16 pSamples )
+{
+    uint16 lDepth = pState->stats.depth ;
+    uint16 lTarget ;
+    uint16 i ;
+
+    if ( !pSamples )
+        return TRUE ;
+    if ( pSamples > JITTER_FRAME_MAX )
+        pSamples = JITTER_FRAME_MAX ;
+
+    lTarget = pSamples + ( pState->jitter >> JITTER_DEPTH_SHIFT ) ;
+    if ( lTarget > JITTER_DEPTH_MAX )
+        lTarget = JITTER_DEPTH_MAX ;
+    pState->stats.target = lTarget ;
+
+    if ( pState->filling )
+    {
+        if ( ( lDepth < lTarget ) || ( lDepth < pSamples ) )
+            return FALSE ;
+
+        JITTER_DEBUG(("JIT: playing, depth %d\n" , lDepth)) ;
+        pState->filling = FALSE ;
+    }
+
+    if ( lDepth < pSamples )
+    {
+        JITTER_DEBUG(("JIT: underrun, target %d\n" , lTarget)) ;
+        pState->stats.underruns++ ;
+        pState->starved = TRUE ;
+        pState->filling = TRUE ;
+        return FALSE ;
+    }
+
+    if ( pState->gap )
+    {
+        pState->gap-- ;
+    }
+    else if ( ( lDepth >= lTarget + pSamples / 2 ) && ( lDepth >= pSamples + JITTER_STRETCH_MIN ) )
+    {
+            /*too deep: play this frame from up to JITTER_STRETCH_MAX more samples*/
+        uint16 lMax = lDepth - pSamples ;
+        uint16 lLag ;
+
+        if ( lMax > lDepth - lTarget )
+            lMax = lDepth - lTarget ;
+        if ( lMax > JITTER_STRETCH_MAX )
+            lMax = JITTER_STRETCH_MAX ;
+
+        if ( lMax >= JITTER_STRETCH_MIN )
+        {
+            lLag = jitterFindLag ( pState , pSamples , JITTER_STRETCH_MIN , lMax , TRUE ) ;
+            jitterStretch ( pState , pFrame , pSamples , (int16) lLag ) ;
+            jitterConsume ( pState , pSamples + lLag ) ;
+            pState->stats.compressed++ ;
+            pState->gap = JITTER_STRETCH_GAP - 1 ;
+            return TRUE ;
+        }
+    }
+    else if ( lDepth + pSamples / 2 <= lTarget )
+    {
+            /*too shallow: play this frame from up to a frame fewer samples, reaching back into those played*/
+        uint16 lMax = lTarget - lDepth ;
+        uint16 lLag ;
+
+        if ( lMax > pSamples )
+            lMax = pSamples ;
+        if ( lMax > pState->history )
+            lMax = pState->history ;
+
+        if ( lMax >= JITTER_STRETCH_MIN )
+        {
+            lLag = jitterFindLag ( pState , pSamples , JITTER_STRETCH_MIN , lMax , FALSE ) ;
+            jitterStretch ( pState , pFrame , pSamples , - (int16) lLag ) ;
+            jitterConsume ( pState , pSamples - lLag ) ;
+            pState->stats.expanded++ ;
+            pState->gap = JITTER_STRETCH_GAP - 1 ;
+            return TRUE ;
+        }
+    }
+
+    for ( i = 0 ; i < pSamples ; i++ )
+        pFrame [ i ] = jitterSample ( pState , i ) ;
+    jitterConsume ( pState , pSamples ) ;
+
+    return TRUE ;
+}
@@ -0,0 +1,124 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    headset_jitter.h
+@brief   Adaptive jitter buffer for the audio received from intercom riders.
+
+    A rider's SCO frames do not arrive evenly: retransmissions and the
+    other links sharing the air delay some of them, more so in a group
+    than in a pair. The buffer holds a rider's samples between their
+    arrival and their playout on the local codec's clock, deep enough to
+    ride out that variation and no deeper.
+
+    The depth aimed for follows the variation of the frames' arrival
+    against their sample count (the interarrival jitter of RFC 3550),
+    rising at once when frames get later and falling slowly. Playout keeps
+    to it by time stretching: when too much is buffered a frame is played
+    from up to JITTER_STRETCH_MAX more samples, and when too little from
+    up to a frame fewer, each time cross faded across a lag where the
+    waveform repeats so the pitch is not disturbed. When the buffer runs
+    dry the frame is reported missing, for concealment, and playout waits
+    until the target depth has built up again.
+
+    Each rider needs their own jitterState_t. Frames may be of any length
+    up to JITTER_FRAME_MAX samples, in fixed point only.
+*/
+
+#ifndef _HEADSET_JITTER_H_
+#define _HEADSET_JITTER_H_
+
+
+#include <csrtypes.h>
+
+
+/* Samples of ring, 32ms at 8kHz; a power of two */
+#define JITTER_RING         (256)
+
+/* Longest frame put or taken */
+#define JITTER_FRAME_MAX    (60)
+
+/* Samples already played that are kept, to stretch a frame back into them */
+#define JITTER_HISTORY      (40)
+
+/* Lags a frame is stretched by, 2 to 5ms */
+#define JITTER_STRETCH_MIN  (16)
+#define JITTER_STRETCH_MAX  (40)
+
+/* Deepest the buffer is allowed to aim for, about 20ms */
+#define JITTER_DEPTH_MAX    ( JITTER_RING - JITTER_HISTORY - JITTER_FRAME_MAX )
+
+
+/*! @brief What the buffer has done so far */
+typedef struct
+{
+    uint32      underruns ;     /*!< Frames taken while the buffer was dry */
+    uint32      late ;          /*!< Frames that arrived after their turn to play */
+    uint32      overflows ;     /*!< Frames whose oldest samples were dropped for lack of room */
+    uint32      compressed ;    /*!< Frames played from extra samples */
+    uint32      expanded ;      /*!< Frames played from fewer samples */
+    uint16      depth ;         /*!< Samples buffered now */
+    uint16      target ;        /*!< Samples the buffer aims to hold */
+} jitterStats_t ;
+
+
+/*! @brief Jitter buffer of one rider */
+typedef struct
+{
+    int16           ring [ JITTER_RING ] ;  /*!< Buffered samples, after those kept as history */
+    uint16          read ;                  /*!< Ring index of the next sample to play */
+    uint16          history ;               /*!< Samples before read that may be replayed */
+    uint32          received ;              /*!< Samples put since the start */
+    int32           transit ;               /*!< Arrival time less the samples received, of the last frame */
+    uint16          jitter ;                /*!< Smoothed variation of the transit, samples Q4 */
+    uint16          gap ;                   /*!< Frames to play before the next may be stretched */
+    unsigned        started:1 ;             /*!< A frame has arrived */
+    unsigned        filling:1 ;             /*!< Waiting for the target depth before playing */
+    unsigned        starved:1 ;             /*!< A frame has been missed since the last arrived */
+    jitterStats_t   stats ;                 /*!< What the buffer has done so far */
+} jitterState_t ;
+
+
+/****************************************************************************
+  FUNCTIONS
+*/
+
+/*************************************************************************
+NAME
+    jitterInit
+
+DESCRIPTION
+    Start an empty buffer, waiting for its first frames.
+
+*/
+void jitterInit ( jitterState_t * pState ) ;
+
+
+/*************************************************************************
+NAME
+    jitterPut
+
+DESCRIPTION
+    A frame of pSamples samples arrived at pNow milliseconds, as from
+    VmGetClock.
+
+*/
+void jitterPut ( jitterState_t * pState , const int16 * pFrame , uint16 pSamples , uint32 pNow ) ;
+
+
+/*************************************************************************
+NAME
+    jitterGet
+
+DESCRIPTION
+    Take the next pSamples samples to play into pFrame.
+
+RETURNS
+    FALSE if the buffer had none to give, when the frame should be
+    concealed.
+*/
+bool jitterGet ( jitterState_t * pState , int16 * pFrame , uint16 pSamples ) ;
+
+
+#endif /* _HEADSET_JITTER_H_ */
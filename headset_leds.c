@@ -8,6 +8,8 @@ Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
 */
 
 
+#include "headset_dispatch.h"
+#include "headset_instrument.h"
 #include "headset_LEDmanager.h"
 #include "headset_leds.h"
 #include "headset_pio.h"
@@ -39,6 +41,7 @@ Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
 
  /*internal message handler for the LED callback messages*/
 static void LedsMessageHandler( Task task, MessageId id, Message message ) ;
+INSTRUMENTED_HANDLER(instrumentLeds, LedsMessageHandler)
 
  /*helper functions for the message handler*/
 static uint16 LedsApplyFilterToTime     ( LedTaskData * pLEDTask , uint16 pTime )  ;
@@ -79,7 +82,10 @@ static void LedsSetEnablePin ( LedTaskData * pLEDTask , bool pOnOrOff ) ;
 void LedsInit ( LedTaskData * pTask ) 
 {
         /*Set the callback handler for the task*/
-    pTask->task.handler = LedsMessageHandler ;
+    pTask->task.handler = INSTRUMENT(LedsMessageHandler) ;
+    
+        /*LED pattern and dimming timers are cosmetic*/
+    dispatchSetLane ( &pTask->task , 0 , 0xffff , dispatchLaneLow ) ;
     
     pTask->gCurrentlyIndicatingEvent = FALSE ;
     	/*set the tricolour leds to known values*/
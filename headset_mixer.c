@@ -0,0 +1,127 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    headset_mixer.c
+@brief   Implementation of the fixed point PCM mixer.
+*/
+
+/****************************************************************************
+    Header files
+*/
+
+#include "headset_mixer.h"
+
+
+/* Lets the host compiler assume the frames do not overlap */
+#ifdef HOST_BUILD
+#define MIXER_RESTRICT  __restrict__
+#else
+#define MIXER_RESTRICT
+#endif
+
+
+/* Running sum of the scaled sources, wide enough for MIXER_MAX_SOURCES at full gain */
+static int32 gAcc [ MIXER_MAX_FRAME ] ;
+
+
+/****************************************************************************
+  LOCAL FUNCTIONS
+*/
+
+static void mixerAccumulate ( int32 * MIXER_RESTRICT pAcc , const int16 * MIXER_RESTRICT pIn , int32 pGain , uint16 pSamples )
+{
+    uint16 i ;
+
+    for ( i = 0 ; i < pSamples ; i++ )
+        pAcc [ i ] += pIn [ i ] * pGain ;
+}
+
+
+static void mixerSaturate ( int16 * MIXER_RESTRICT pOut , const int32 * MIXER_RESTRICT pAcc , uint16 pSamples )
+{
+    uint16 i ;
+
+    for ( i = 0 ; i < pSamples ; i++ )
+    {
+        int32 lSample = pAcc [ i ] >> MIXER_GAIN_SHIFT ;
+
+        lSample = lSample > 32767 ? 32767 : lSample ;
+        lSample = lSample < -32768 ? -32768 : lSample ;
+        pOut [ i ] = (int16) lSample ;
+    }
+}
+
+
+/****************************************************************************
+  FUNCTIONS
+*/
+
+/**************************************************************************/
+uint16 mixerFrameSamples ( uint16 pRate )
+{
+    return ( pRate > 8000 ) ? MIXER_FRAME_16K : MIXER_FRAME_8K ;
+}
+
+
+/**************************************************************************/
+void mixerMix ( const mixerSource_t * pSources , uint16 pCount , int16 * pOut , uint16 pSamples , uint16 pDuckGain )
+{
+    bool lDuck = FALSE ;
+    uint16 i ;
+
+    if ( pSamples > MIXER_MAX_FRAME )
+        pSamples = MIXER_MAX_FRAME ;
+
+    for ( i = 0 ; i < pCount ; i++ )
+    {
+        if ( pSources [ i ].samples && pSources [ i ].ducking )
+            lDuck = TRUE ;
+    }
+
+    for ( i = 0 ; i < pSamples ; i++ )
+        gAcc [ i ] = 0 ;
+
+    for ( i = 0 ; i < pCount ; i++ )
+    {
+        const mixerSource_t * lSource = &pSources [ i ] ;
+        int32 lGain = lSource->gain ;
+
+        if ( !lSource->samples )
+            continue ;
+
+        if ( lDuck && lSource->duckable )
+            lGain = ( lGain * pDuckGain ) >> MIXER_GAIN_SHIFT ;
+
+        if ( lGain > MIXER_GAIN_MAX )
+            lGain = MIXER_GAIN_MAX ;
+
+        mixerAccumulate ( gAcc , lSource->samples , lGain , pSamples ) ;
+    }
+
+    mixerSaturate ( pOut , gAcc , pSamples ) ;
+}
+
+
+/**************************************************************************/
+void mixerUnpack ( const uint8 * pData , int16 * pFrame , uint16 pSamples )
+{
+    uint16 i ;
+
+    for ( i = 0 ; i < pSamples ; i++ )
+        pFrame [ i ] = (int16) ( ( ( pData [ 2 * i ] & 0xff ) << 8 ) | ( pData [ 2 * i + 1 ] & 0xff ) ) ;
+}
+
+
+/**************************************************************************/
+void mixerPack ( const int16 * pFrame , uint8 * pData , uint16 pSamples )
+{
+    uint16 i ;
+
+    for ( i = 0 ; i < pSamples ; i++ )
+    {
+        pData [ 2 * i ]     = ( pFrame [ i ] >> 8 ) & 0xff ;
+        pData [ 2 * i + 1 ] = pFrame [ i ] & 0xff ;
+    }
+}
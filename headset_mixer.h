@@ -0,0 +1,110 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    headset_mixer.h
+@brief   Fixed point mixer for 16 bit PCM frames.
+
+    Mixes up to MIXER_MAX_SOURCES frames of 8kHz or 16kHz 16 bit PCM, each
+    scaled by its own gain, into one output frame saturated to 16 bits. A
+    source marked as ducking (intercom or call voice) lowers every source
+    marked as duckable (music, tones) to the duck gain while it is present.
+
+    The loops are kept free of branches and aliasing so that a vectorising
+    compiler can use SIMD on the host; on the chip they run as plain C.
+
+    Frames are moved to and from the PCM streams with mixerUnpack and
+    mixerPack, which every module reading or writing them shares.
+*/
+
+#ifndef _HEADSET_MIXER_H_
+#define _HEADSET_MIXER_H_
+
+
+#include <csrtypes.h>
+
+
+/* Number of sources mixed into one frame */
+#define MIXER_MAX_SOURCES       (4)
+
+/* Gains are Q12: MIXER_GAIN_UNITY passes a source unchanged */
+#define MIXER_GAIN_SHIFT        (12)
+#define MIXER_GAIN_UNITY        ( 1 << MIXER_GAIN_SHIFT )
+
+/* Largest gain, keeping the sum of MIXER_MAX_SOURCES full scale sources within 32 bits */
+#define MIXER_GAIN_MAX          ( 4 * MIXER_GAIN_UNITY - 1 )
+
+/* Samples in a 7.5ms frame - two HV3 packets at 8kHz */
+#define MIXER_FRAME_8K          (60)
+#define MIXER_FRAME_16K         (120)
+#define MIXER_MAX_FRAME         ( MIXER_FRAME_16K )
+
+/* Samples are carried on the streams as two octets, most significant first */
+#define MIXER_SAMPLE_OCTETS     (2)
+
+
+/*! @brief One input to the mixer */
+typedef struct
+{
+    const int16 *   samples ;       /*!< Frame to mix, NULL if the source has nothing this frame */
+    uint16          gain ;          /*!< Q12 gain, at most MIXER_GAIN_MAX */
+    unsigned        duckable:1 ;    /*!< Lowered to the duck gain while a ducking source is present */
+    unsigned        ducking:1 ;     /*!< Lowers the duckable sources while present */
+} mixerSource_t ;
+
+
+/****************************************************************************
+  FUNCTIONS
+*/
+
+/*************************************************************************
+NAME
+    mixerFrameSamples
+
+DESCRIPTION
+    Returns the number of samples in a frame at pRate Hz (8000 or 16000).
+
+*/
+uint16 mixerFrameSamples ( uint16 pRate ) ;
+
+
+/*************************************************************************
+NAME
+    mixerMix
+
+DESCRIPTION
+    Mix pSamples samples (at most MIXER_MAX_FRAME) of pCount sources into
+    pOut. pDuckGain is the Q12 gain applied on top of the gain of every
+    duckable source while any ducking source is present. pOut may not be
+    one of the inputs.
+
+*/
+void mixerMix ( const mixerSource_t * pSources , uint16 pCount , int16 * pOut , uint16 pSamples , uint16 pDuckGain ) ;
+
+
+/*************************************************************************
+NAME
+    mixerUnpack
+
+DESCRIPTION
+    Read pSamples samples from the pSamples * MIXER_SAMPLE_OCTETS octets
+    at pData, as mapped from a PCM source, into pFrame.
+
+*/
+void mixerUnpack ( const uint8 * pData , int16 * pFrame , uint16 pSamples ) ;
+
+
+/*************************************************************************
+NAME
+    mixerPack
+
+DESCRIPTION
+    Write pSamples samples of pFrame to the pSamples * MIXER_SAMPLE_OCTETS
+    octets at pData, as claimed in a PCM sink.
+
+*/
+void mixerPack ( const int16 * pFrame , uint8 * pData , uint16 pSamples ) ;
+
+
+#endif /* _HEADSET_MIXER_H_ */
@@ -0,0 +1,306 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    headset_peer_table.c
+@brief   Implementation of the remembered intercom riders.
+*/
+
+/****************************************************************************
+    Header files
+*/
+
+#include "headset_peer_table.h"
+#include "headset_debug.h"
+
+#include <ps.h>
+#include <string.h>
+
+
+#ifdef DEBUG_PEER_TABLE
+    #define PEER_DEBUG(x) DEBUG(x)
+#else
+    #define PEER_DEBUG(x)
+#endif
+
+
+/* Persistent store key holding the table */
+#define PEER_TABLE_PSKEY        (48)
+
+/* Bumped whenever the layout of peerTable_t changes; an unknown record is discarded */
+#define PEER_TABLE_VERSION      (1)
+
+/* Keys which held the far address of each intercom link before the table, first link first */
+static const uint16 gLegacyKeys [] = { 12 , 46 , 47 } ;
+
+#define PEER_TABLE_LEGACY_KEYS  ( sizeof ( gLegacyKeys ) / sizeof ( gLegacyKeys [ 0 ] ) )
+
+
+/* A rider as stored, the address packed into three words */
+typedef struct
+{
+    uint16      lap_lo ;        /* Bits 0-15 of the LAP, the part most likely to differ, compared first */
+    unsigned    lap_hi:8 ;      /* Bits 16-23 of the LAP */
+    unsigned    uap:8 ;
+    uint16      nap ;
+    uint16      last_seen ;     /* Table clock when the rider last connected */
+    unsigned    history:8 ;
+    unsigned    losses:8 ;
+} peerRecord_t ;
+
+
+/* The record in Persistent Store; only the first count riders are stored */
+typedef struct
+{
+    unsigned        version:8 ;
+    unsigned        count:8 ;
+    uint16          clock ;     /* Advanced on every connection */
+    peerRecord_t    peer [ PEER_TABLE_SIZE ] ;
+} peerTable_t ;
+
+#define PEER_TABLE_LENGTH(count)    ( sizeof ( peerTable_t ) - ( PEER_TABLE_SIZE - (count) ) * sizeof ( peerRecord_t ) )
+
+
+static peerTable_t  gTable ;
+static bool         gLoaded = FALSE ;
+
+
+/****************************************************************************
+  LOCAL FUNCTIONS
+*/
+
+static void peerPack ( const bdaddr * pAddr , peerRecord_t * pRecord )
+{
+    pRecord->lap_lo = (uint16) ( pAddr->lap & 0xffff ) ;
+    pRecord->lap_hi = (uint16) ( pAddr->lap >> 16 ) & 0xff ;
+    pRecord->uap    = pAddr->uap ;
+    pRecord->nap    = pAddr->nap ;
+}
+
+
+static void peerUnpack ( const peerRecord_t * pRecord , bdaddr * pAddr )
+{
+    pAddr->lap = ( (uint32) pRecord->lap_hi << 16 ) | pRecord->lap_lo ;
+    pAddr->uap = pRecord->uap ;
+    pAddr->nap = pRecord->nap ;
+}
+
+
+static void peerSave ( void )
+{
+    (void) PsStore ( PEER_TABLE_PSKEY , &gTable , PEER_TABLE_LENGTH ( gTable.count ) ) ;
+}
+
+
+/* Move the rider at pIndex to the front, keeping the order of the others */
+static void peerToFront ( uint16 pIndex )
+{
+    peerRecord_t lRecord = gTable.peer [ pIndex ] ;
+
+    memmove ( &gTable.peer [ 1 ] , &gTable.peer [ 0 ] , pIndex * sizeof ( peerRecord_t ) ) ;
+    gTable.peer [ 0 ] = lRecord ;
+}
+
+
+static uint16 peerIndex ( const bdaddr * pAddr )
+{
+    peerRecord_t lKey ;
+    uint16 i ;
+
+    peerPack ( pAddr , &lKey ) ;
+
+    for ( i = 0 ; i < gTable.count ; i++ )
+    {
+        const peerRecord_t * lRecord = &gTable.peer [ i ] ;
+
+        if ( ( lRecord->lap_lo == lKey.lap_lo ) && ( lRecord->lap_hi == lKey.lap_hi ) &&
+             ( lRecord->uap == lKey.uap ) && ( lRecord->nap == lKey.nap ) )
+            return i ;
+    }
+    return PEER_TABLE_NONE ;
+}
+
+
+/* Add a rider at the front unless already known, dropping the least recent if full */
+static void peerInsert ( const bdaddr * pAddr )
+{
+    uint16 lIndex = peerIndex ( pAddr ) ;
+
+    if ( lIndex == PEER_TABLE_NONE )
+    {
+        if ( gTable.count < PEER_TABLE_SIZE )
+            gTable.count++ ;
+
+        lIndex = gTable.count - 1 ;
+        memset ( &gTable.peer [ lIndex ] , 0 , sizeof ( peerRecord_t ) ) ;
+        peerPack ( pAddr , &gTable.peer [ lIndex ] ) ;
+    }
+
+    peerToFront ( lIndex ) ;
+}
+
+
+/* Read the table, or build it from the keys used before it existed */
+static void peerLoad ( void )
+{
+    uint16 lLength ;
+    uint16 i ;
+
+    if ( gLoaded )
+        return ;
+    gLoaded = TRUE ;
+
+    lLength = PsRetrieve ( PEER_TABLE_PSKEY , &gTable , sizeof ( gTable ) ) ;
+
+    if ( ( lLength >= PEER_TABLE_LENGTH ( 0 ) ) && ( gTable.version == PEER_TABLE_VERSION ) &&
+         ( gTable.count <= PEER_TABLE_SIZE ) && ( lLength == PEER_TABLE_LENGTH ( gTable.count ) ) )
+    {
+        PEER_DEBUG(("PEER: %d riders\n" , gTable.count)) ;
+        return ;
+    }
+
+    memset ( &gTable , 0 , sizeof ( gTable ) ) ;
+    gTable.version = PEER_TABLE_VERSION ;
+
+        /*the last link first, so the first link ends up most recent*/
+    for ( i = PEER_TABLE_LEGACY_KEYS ; i-- ; )
+    {
+        bdaddr lAddr ;
+
+        if ( PsRetrieve ( gLegacyKeys [ i ] , &lAddr , sizeof ( bdaddr ) ) && ( lAddr.lap || lAddr.uap || lAddr.nap ) )
+        {
+            peerInsert ( &lAddr ) ;
+            PEER_DEBUG(("PEER: imported key %d\n" , gLegacyKeys [ i ])) ;
+        }
+        (void) PsStore ( gLegacyKeys [ i ] , 0 , 0 ) ;
+    }
+
+    peerSave () ;
+}
+
+
+/****************************************************************************
+  FUNCTIONS
+*/
+
+/**************************************************************************/
+bool peerTableGet ( uint16 pIndex , bdaddr * pAddr )
+{
+    peerLoad () ;
+
+    if ( pIndex >= gTable.count )
+        return FALSE ;
+
+    peerUnpack ( &gTable.peer [ pIndex ] , pAddr ) ;
+    return TRUE ;
+}
+
+
+/**************************************************************************/
+uint16 peerTableFind ( const bdaddr * pAddr , peerTableInfo_t * pInfo )
+{
+    uint16 lIndex ;
+
+    peerLoad () ;
+    lIndex = peerIndex ( pAddr ) ;
+
+    if ( pInfo && ( lIndex != PEER_TABLE_NONE ) )
+    {
+        pInfo->age     = gTable.clock - gTable.peer [ lIndex ].last_seen ;
+        pInfo->history = gTable.peer [ lIndex ].history ;
+        pInfo->losses  = gTable.peer [ lIndex ].losses ;
+    }
+    return lIndex ;
+}
+
+
+/**************************************************************************/
+uint16 peerTableCount ( void )
+{
+    peerLoad () ;
+    return gTable.count ;
+}
+
+
+/**************************************************************************/
+void peerTableConnected ( const bdaddr * pAddr )
+{
+        /*an address never learnt is no rider, and would push a real one out*/
+    if ( BdaddrIsZero ( pAddr ) )
+        return ;
+
+    peerLoad () ;
+    peerInsert ( pAddr ) ;
+
+    gTable.peer [ 0 ].last_seen = ++gTable.clock ;
+    gTable.peer [ 0 ].history   = ( ( gTable.peer [ 0 ].history << 1 ) | 1 ) & 0xff ;
+
+    PEER_DEBUG(("PEER: connected %lx, %d riders\n" , pAddr->lap , gTable.count)) ;
+    peerSave () ;
+}
+
+
+/**************************************************************************/
+void peerTableConnectFailed ( const bdaddr * pAddr )
+{
+    uint16 lIndex ;
+
+    peerLoad () ;
+    lIndex = peerIndex ( pAddr ) ;
+
+    if ( lIndex != PEER_TABLE_NONE )
+        gTable.peer [ lIndex ].history = ( gTable.peer [ lIndex ].history << 1 ) & 0xff ;
+}
+
+
+/**************************************************************************/
+void peerTableLinkLost ( const bdaddr * pAddr )
+{
+    uint16 lIndex ;
+
+    peerLoad () ;
+    lIndex = peerIndex ( pAddr ) ;
+
+    if ( ( lIndex != PEER_TABLE_NONE ) && ( gTable.peer [ lIndex ].losses < 0xff ) )
+    {
+        gTable.peer [ lIndex ].losses++ ;
+        peerSave () ;
+    }
+}
+
+
+/**************************************************************************/
+void peerTableForget ( const bdaddr * pAddr )
+{
+    uint16 lIndex ;
+
+    peerLoad () ;
+    lIndex = peerIndex ( pAddr ) ;
+
+    if ( lIndex != PEER_TABLE_NONE )
+    {
+        gTable.count-- ;
+        memmove ( &gTable.peer [ lIndex ] , &gTable.peer [ lIndex + 1 ] ,
+                  ( gTable.count - lIndex ) * sizeof ( peerRecord_t ) ) ;
+        peerSave () ;
+        PEER_DEBUG(("PEER: forgot %lx, %d riders\n" , pAddr->lap , gTable.count)) ;
+    }
+}
+
+
+/**************************************************************************/
+void peerTableClear ( void )
+{
+    uint16 i ;
+
+    memset ( &gTable , 0 , sizeof ( gTable ) ) ;
+    gTable.version = PEER_TABLE_VERSION ;
+    gLoaded = TRUE ;
+
+    for ( i = 0 ; i < PEER_TABLE_LEGACY_KEYS ; i++ )
+        (void) PsStore ( gLegacyKeys [ i ] , 0 , 0 ) ;
+
+    (void) PsStore ( PEER_TABLE_PSKEY , 0 , 0 ) ;
+    PEER_DEBUG(("PEER: cleared\n")) ;
+}
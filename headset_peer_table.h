@@ -0,0 +1,151 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    headset_peer_table.h
+@brief   Intercom riders remembered across power cycles.
+
+    Up to PEER_TABLE_SIZE riders are kept in most recently connected
+    order in a single versioned Persistent Store record, so a rider who
+    moves between groups finds the riders of each group still known and
+    can connect without pairing again. For each rider the table keeps
+    when it last connected, as a count of table updates since there is
+    no real time clock, the outcome of the last eight connection attempts
+    and the number of link losses.
+
+    The record replaces the one key per intercom link used before; those
+    keys are imported, most recent first, the first time the table is
+    read.
+*/
+
+#ifndef _HEADSET_PEER_TABLE_H_
+#define _HEADSET_PEER_TABLE_H_
+
+
+#include <bdaddr.h>
+#include <csrtypes.h>
+
+
+/* Riders remembered */
+#define PEER_TABLE_SIZE         (8)
+
+/* Returned by peerTableFind for a rider not in the table */
+#define PEER_TABLE_NONE         (0xffff)
+
+
+/*! @brief What is known of one remembered rider */
+typedef struct
+{
+    uint16      age;            /*!< Table updates since the rider last connected */
+    unsigned    history:8;      /*!< Outcome of the last 8 connection attempts, newest in bit 0, 1 = connected */
+    unsigned    losses:8;       /*!< Link losses, saturating at 255 */
+} peerTableInfo_t;
+
+
+/****************************************************************************
+  FUNCTIONS
+*/
+
+/*************************************************************************
+NAME
+    peerTableGet
+
+DESCRIPTION
+    Read the address of the rider at pIndex, 0 being the most recently
+    connected.
+
+RETURNS
+    FALSE if fewer than pIndex + 1 riders are remembered.
+*/
+bool peerTableGet ( uint16 pIndex , bdaddr * pAddr ) ;
+
+
+/*************************************************************************
+NAME
+    peerTableFind
+
+DESCRIPTION
+    Look up a rider by address, optionally returning what is known of it
+    in pInfo.
+
+RETURNS
+    The position of the rider in most recently connected order, or
+    PEER_TABLE_NONE.
+*/
+uint16 peerTableFind ( const bdaddr * pAddr , peerTableInfo_t * pInfo ) ;
+
+
+/*************************************************************************
+NAME
+    peerTableCount
+
+DESCRIPTION
+    Returns the number of riders remembered.
+
+*/
+uint16 peerTableCount ( void ) ;
+
+
+/*************************************************************************
+NAME
+    peerTableConnected
+
+DESCRIPTION
+    Record a connection to pAddr, adding the rider at the front of the
+    table, dropping the least recently connected rider if it is full.
+    The table is written to Persistent Store. A zero address is ignored.
+
+*/
+void peerTableConnected ( const bdaddr * pAddr ) ;
+
+
+/*************************************************************************
+NAME
+    peerTableConnectFailed
+
+DESCRIPTION
+    Record a failed connection attempt to a remembered rider. This is kept
+    in RAM and written with the next update, so that reconnect attempts do
+    not wear the store.
+
+*/
+void peerTableConnectFailed ( const bdaddr * pAddr ) ;
+
+
+/*************************************************************************
+NAME
+    peerTableLinkLost
+
+DESCRIPTION
+    Record a link loss to a remembered rider. The table is written to
+    Persistent Store.
+
+*/
+void peerTableLinkLost ( const bdaddr * pAddr ) ;
+
+
+/*************************************************************************
+NAME
+    peerTableForget
+
+DESCRIPTION
+    Forget one rider, keeping the order of the others. The table is
+    written to Persistent Store.
+
+*/
+void peerTableForget ( const bdaddr * pAddr ) ;
+
+
+/*************************************************************************
+NAME
+    peerTableClear
+
+DESCRIPTION
+    Forget every rider.
+
+*/
+void peerTableClear ( void ) ;
+
+
+#endif /* _HEADSET_PEER_TABLE_H_ */
@@ -0,0 +1,188 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    headset_plc.c
+@brief   Implementation of the packet loss concealment.
+*/
+
+/****************************************************************************
+    Header files
+*/
+
+#include "headset_plc.h"
+#include "headset_debug.h"
+
+#include <string.h>
+
+
+#ifdef DEBUG_PLC
+    #define PLC_DEBUG(x) DEBUG(x)
+#else
+    #define PLC_DEBUG(x)
+#endif
+
+
+/* Samples at the end of the history matched against each candidate period, 5ms */
+#define PLC_MATCH           (40)
+
+/* Samples cross faded from the concealment into the first good frame, 2ms */
+#define PLC_OLA             (16)
+
+/* Concealment at full level, 10ms, then fading over 50ms */
+#define PLC_FADE_START      (80)
+#define PLC_FADE_LENGTH     (400)
+
+/* Q15 gain lost per sample while fading; reaches 0 within PLC_FADE_LENGTH */
+#define PLC_FADE_STEP       ( ( 0x7fff + PLC_FADE_LENGTH - 1 ) / PLC_FADE_LENGTH )
+
+
+/****************************************************************************
+  LOCAL FUNCTIONS
+*/
+
+/* Mean magnitude difference between the last PLC_MATCH samples and those pLag earlier,
+   taking every pStep'th sample */
+static uint32 plcDifference ( const int16 * pHistory , uint16 pLag , uint16 pStep )
+{
+    const int16 * lNow = &pHistory [ PLC_HISTORY - PLC_MATCH ] ;
+    const int16 * lThen = lNow - pLag ;
+    uint32 lSum = 0 ;
+    uint16 i ;
+
+    for ( i = 0 ; i < PLC_MATCH ; i += pStep )
+    {
+        int32 lDiff = (int32) lNow [ i ] - lThen [ i ] ;
+
+        lSum += ( lDiff < 0 ) ? -lDiff : lDiff ;
+    }
+    return lSum ;
+}
+
+
+/* The lag at which the history best repeats itself: a coarse search on every
+   other lag and sample, refined at full resolution around the best */
+static uint16 plcFindPitch ( const int16 * pHistory )
+{
+    uint32 lBest = 0xffffffffUL ;
+    uint16 lPitch = PLC_PITCH_MIN ;
+    uint16 lCentre ;
+    uint16 lLag ;
+
+    for ( lLag = PLC_PITCH_MIN ; lLag <= PLC_PITCH_MAX ; lLag += 2 )
+    {
+        uint32 lDiff = plcDifference ( pHistory , lLag , 2 ) ;
+
+        if ( lDiff < lBest )
+        {
+            lBest  = lDiff ;
+            lPitch = lLag ;
+        }
+    }
+
+    lCentre = lPitch ;
+    lBest   = 0xffffffffUL ;
+
+    for ( lLag = lCentre - 1 ; lLag <= lCentre + 1 ; lLag++ )
+    {
+        uint32 lDiff ;
+
+        if ( ( lLag < PLC_PITCH_MIN ) || ( lLag > PLC_PITCH_MAX ) )
+            continue ;
+
+        lDiff = plcDifference ( pHistory , lLag , 1 ) ;
+
+        if ( lDiff < lBest )
+        {
+            lBest  = lDiff ;
+            lPitch = lLag ;
+        }
+    }
+    return lPitch ;
+}
+
+
+/* Continue the concealment for pSamples samples */
+static void plcSynthesise ( plcState_t * pState , int16 * pOut , uint16 pSamples )
+{
+    const int16 * lPeriod = &pState->history [ PLC_HISTORY - pState->pitch ] ;
+    uint16 i ;
+
+    for ( i = 0 ; i < pSamples ; i++ )
+    {
+        int32 lSample = lPeriod [ pState->phase ] ;
+
+        if ( pState->lost >= PLC_FADE_START )
+        {
+            uint32 lFade = (uint32) ( pState->lost - PLC_FADE_START ) * PLC_FADE_STEP ;
+            int32 lGain = ( lFade < 0x7fff ) ? (int32) ( 0x7fff - lFade ) : 0 ;
+
+            lSample = ( lSample * lGain ) >> 15 ;
+        }
+
+        pOut [ i ] = (int16) lSample ;
+
+        if ( ++pState->phase == pState->pitch )
+            pState->phase = 0 ;
+        if ( pState->lost < 0xffff )
+            pState->lost++ ;
+    }
+}
+
+
+/****************************************************************************
+  FUNCTIONS
+*/
+
+/**************************************************************************/
+void plcInit ( plcState_t * pState )
+{
+    memset ( pState , 0 , sizeof ( plcState_t ) ) ;
+}
+
+
+/**************************************************************************/
+void plcGoodFrame ( plcState_t * pState , int16 * pFrame , uint16 pSamples )
+{
+    if ( pState->pitch )
+    {
+        int16 lConcealed [ PLC_OLA ] ;
+        uint16 lLength = ( pSamples < PLC_OLA ) ? pSamples : PLC_OLA ;
+        uint16 i ;
+
+        PLC_DEBUG(("PLC: %d samples concealed, pitch %d\n" , pState->lost , pState->pitch)) ;
+
+        plcSynthesise ( pState , lConcealed , lLength ) ;
+
+        for ( i = 0 ; i < lLength ; i++ )
+            pFrame [ i ] = (int16) ( ( (int32) lConcealed [ i ] * ( PLC_OLA - i ) + (int32) pFrame [ i ] * i ) / PLC_OLA ) ;
+
+        pState->pitch = 0 ;
+        pState->lost  = 0 ;
+    }
+
+    if ( pSamples >= PLC_HISTORY )
+    {
+        memcpy ( pState->history , &pFrame [ pSamples - PLC_HISTORY ] , sizeof ( pState->history ) ) ;
+    }
+    else
+    {
+        memmove ( pState->history , &pState->history [ pSamples ] , ( PLC_HISTORY - pSamples ) * sizeof ( int16 ) ) ;
+        memcpy ( &pState->history [ PLC_HISTORY - pSamples ] , pFrame , pSamples * sizeof ( int16 ) ) ;
+    }
+}
+
+
+/**************************************************************************/
+void plcLostFrame ( plcState_t * pState , int16 * pFrame , uint16 pSamples )
+{
+    if ( !pState->pitch )
+    {
+        pState->pitch = plcFindPitch ( pState->history ) ;
+        pState->phase = 0 ;
+        pState->lost  = 0 ;
+    }
+
+    plcSynthesise ( pState , pFrame , pSamples ) ;
+}
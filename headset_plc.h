@@ -0,0 +1,84 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    headset_plc.h
+@brief   Packet loss concealment for 8kHz 16 bit PCM.
+
+    When a frame of a rider's voice is lost the last pitch period heard is
+    repeated in its place, so a short gap sounds like a held vowel rather
+    than a click. The period is found by the average magnitude difference
+    function over the last 5ms, which needs no multiplies. The repeated
+    period plays at full level for 10ms, then fades to silence over the
+    next 50ms so a long dropout does not buzz. The first 2ms of audio after
+    the gap are cross faded from the concealment.
+
+    Each stream needs its own plcState_t; the functions work on frames of
+    any length up to PLC_HISTORY samples, in fixed point only.
+*/
+
+#ifndef _HEADSET_PLC_H_
+#define _HEADSET_PLC_H_
+
+
+#include <csrtypes.h>
+
+
+/* Good samples kept, 20ms: enough to match PLC_PITCH_MAX against the last 5ms */
+#define PLC_HISTORY         (160)
+
+/* Pitch periods searched, 250Hz down to 80Hz */
+#define PLC_PITCH_MIN       (32)
+#define PLC_PITCH_MAX       (100)
+
+
+/*! @brief Concealment state of one stream */
+typedef struct
+{
+    int16       history [ PLC_HISTORY ] ;  /*!< Last good samples, oldest first */
+    uint16      pitch ;                     /*!< Period being repeated, 0 when the last frame was good */
+    uint16      phase ;                     /*!< Next sample of the period to play */
+    uint16      lost ;                      /*!< Samples concealed in this gap, saturating */
+} plcState_t ;
+
+
+/****************************************************************************
+  FUNCTIONS
+*/
+
+/*************************************************************************
+NAME
+    plcInit
+
+DESCRIPTION
+    Start a stream with silence as its history.
+
+*/
+void plcInit ( plcState_t * pState ) ;
+
+
+/*************************************************************************
+NAME
+    plcGoodFrame
+
+DESCRIPTION
+    A frame of pSamples samples was received. If it ends a gap its start is
+    cross faded in place from the concealment.
+
+*/
+void plcGoodFrame ( plcState_t * pState , int16 * pFrame , uint16 pSamples ) ;
+
+
+/*************************************************************************
+NAME
+    plcLostFrame
+
+DESCRIPTION
+    A frame of pSamples samples was lost: fill pFrame with its concealment.
+
+*/
+void plcLostFrame ( plcState_t * pState , int16 * pFrame , uint16 pSamples ) ;
+
+
+#endif /* _HEADSET_PLC_H_ */
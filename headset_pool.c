@@ -0,0 +1,195 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    headset_pool.c
+@brief   Implementation of the fixed block pools.
+*/
+
+/****************************************************************************
+    Header files
+*/
+
+#include "headset_pool.h"
+#include "headset_debug.h"
+
+#include <panic.h>
+#include <stdlib.h>
+
+
+#ifdef DEBUG_POOL
+    #define POOL_DEBUG(x) DEBUG(x)
+#else
+    #define POOL_DEBUG(x)
+#endif
+
+
+/* Blocks are kept aligned for the widest type held in them */
+#define POOL_ROUND(s)       ( ( ( s ) + sizeof ( uint32 ) - 1 ) / sizeof ( uint32 ) )
+
+#define POOL_STORAGE_SIZE   ( POOL_ROUND ( POOL_SMALL_SIZE ) * POOL_SMALL_COUNT + POOL_ROUND ( POOL_MEDIUM_SIZE ) * POOL_MEDIUM_COUNT )
+
+/* Largest number of blocks in any class, and the free list terminator */
+#define POOL_MAX_COUNT      (8)
+#define POOL_END            (0xff)
+
+
+/* A size class */
+typedef struct
+{
+    uint32 *    base ;
+    uint16      stride ;                    /* block size in uint32 */
+    uint8       free_head ;
+    uint8       next [ POOL_MAX_COUNT ] ;   /* free list, by block index */
+} poolClass ;
+
+
+static uint32       gStorage [ POOL_STORAGE_SIZE ] ;
+static poolClass    gClasses [ POOL_NUM_CLASSES ] ;
+static poolStats_t  gStats [ POOL_NUM_CLASSES ] ;
+static uint16       gOversize = 0 ;
+
+
+/****************************************************************************
+  LOCAL FUNCTIONS
+*/
+
+static void poolInitClass ( uint16 pClass , uint32 * pBase , uint16 pSize , uint16 pCount )
+{
+    poolClass * lClass = &gClasses [ pClass ] ;
+    uint16 i ;
+
+    lClass->base      = pBase ;
+    lClass->stride    = POOL_ROUND ( pSize ) ;
+    lClass->free_head = 0 ;
+
+    for ( i = 0 ; i < pCount ; i++ )
+        lClass->next [ i ] = ( i + 1 < pCount ) ? i + 1 : POOL_END ;
+
+    gStats [ pClass ].size  = pSize ;
+    gStats [ pClass ].count = pCount ;
+}
+
+
+static void poolCount ( uint16 * pCount )
+{
+    if ( *pCount != 0xffff )
+        (*pCount)++ ;
+}
+
+
+#ifdef DEBUG_POOL
+/* A block freed twice would be linked into the free list twice, and later
+   handed out to two owners */
+static void poolCheckFree ( const poolClass * pClass , uint8 pIndex )
+{
+    uint8 lBlock ;
+
+    for ( lBlock = pClass->free_head ; lBlock != POOL_END ; lBlock = pClass->next [ lBlock ] )
+    {
+        if ( lBlock == pIndex )
+        {
+            POOL_DEBUG(("POOL: block %d freed twice\n" , pIndex)) ;
+            Panic () ;
+        }
+    }
+}
+#endif
+
+
+/****************************************************************************
+  FUNCTIONS
+*/
+
+/**************************************************************************/
+void poolInit ( void )
+{
+    poolInitClass ( 0 , &gStorage [ 0 ] , POOL_SMALL_SIZE , POOL_SMALL_COUNT ) ;
+    poolInitClass ( 1 , &gStorage [ POOL_ROUND ( POOL_SMALL_SIZE ) * POOL_SMALL_COUNT ] , POOL_MEDIUM_SIZE , POOL_MEDIUM_COUNT ) ;
+}
+
+
+/**************************************************************************/
+void * poolAlloc ( uint16 pSize )
+{
+    uint16 i ;
+
+    for ( i = 0 ; i < POOL_NUM_CLASSES ; i++ )
+    {
+        if ( pSize <= gStats [ i ].size )
+        {
+            poolClass * lClass = &gClasses [ i ] ;
+            uint8 lBlock = lClass->free_head ;
+
+            if ( lBlock == POOL_END )
+            {
+                POOL_DEBUG(("POOL: class %d full\n" , i)) ;
+                poolCount ( &gStats [ i ].fallbacks ) ;
+                return malloc ( pSize ) ;
+            }
+
+            lClass->free_head = lClass->next [ lBlock ] ;
+
+            if ( ++gStats [ i ].in_use > gStats [ i ].high_water )
+                gStats [ i ].high_water = gStats [ i ].in_use ;
+            poolCount ( &gStats [ i ].allocs ) ;
+
+            return lClass->base + lBlock * lClass->stride ;
+        }
+    }
+
+    poolCount ( &gOversize ) ;
+    return malloc ( pSize ) ;
+}
+
+
+/**************************************************************************/
+void * PanicUnlessPoolAlloc ( uint16 pSize )
+{
+    return PanicNull ( poolAlloc ( pSize ) ) ;
+}
+
+
+/**************************************************************************/
+void poolFree ( void * pBlock )
+{
+    uint32 * lBlock = (uint32 *) pBlock ;
+    uint16 i ;
+
+    if ( !lBlock )
+        return ;
+
+    if ( ( lBlock >= gStorage ) && ( lBlock < gStorage + POOL_STORAGE_SIZE ) )
+    {
+        for ( i = 0 ; i < POOL_NUM_CLASSES ; i++ )
+        {
+            poolClass * lClass = &gClasses [ i ] ;
+
+            if ( lBlock < lClass->base + lClass->stride * gStats [ i ].count )
+            {
+                uint8 lIndex = ( lBlock - lClass->base ) / lClass->stride ;
+
+#ifdef DEBUG_POOL
+                poolCheckFree ( lClass , lIndex ) ;
+#endif
+                lClass->next [ lIndex ] = lClass->free_head ;
+                lClass->free_head = lIndex ;
+                gStats [ i ].in_use-- ;
+                return ;
+            }
+        }
+    }
+
+    free ( pBlock ) ;
+}
+
+
+/**************************************************************************/
+const poolStats_t * poolGetStats ( uint16 pClass , uint16 * pOversize )
+{
+    if ( pOversize )
+        *pOversize = gOversize ;
+
+    return ( pClass < POOL_NUM_CLASSES ) ? &gStats [ pClass ] : NULL ;
+}
@@ -0,0 +1,114 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    headset_pool.h
+@brief   Fixed block pools for the transient allocations made by the headset.
+
+    Buffers which are allocated and freed repeatedly while the headset runs
+    are taken from a small set of size classes held in static memory, so
+    they cannot fragment the heap and allocation time does not depend on the
+    state of the heap. A request too large for any class, or made while its
+    class is exhausted, falls back to the heap.
+
+    Message payloads cannot be taken from the pools: the firmware frees them
+    with free() once they have been delivered.
+*/
+
+#ifndef _HEADSET_POOL_H_
+#define _HEADSET_POOL_H_
+
+
+#include <bdaddr.h>
+#include <csrtypes.h>
+
+
+/* Size classes, sizes are in sizeof units */
+#define POOL_SMALL_SIZE     ( sizeof ( bdaddr ) )   /*!< Device addresses */
+#define POOL_SMALL_COUNT    (2)
+#define POOL_MEDIUM_SIZE    (32)                    /*!< EIR data and other short buffers */
+#define POOL_MEDIUM_COUNT   (1)
+
+#define POOL_NUM_CLASSES    (2)
+
+
+/*! @brief Usage of a size class */
+typedef struct
+{
+    uint16  size ;          /*!< Block size */
+    uint16  count ;         /*!< Number of blocks */
+    uint16  in_use ;        /*!< Blocks currently allocated */
+    uint16  high_water ;    /*!< Highest value of in_use */
+    uint16  allocs ;        /*!< Successful allocations, saturating */
+    uint16  fallbacks ;     /*!< Requests passed to the heap as the class was full, saturating */
+} poolStats_t ;
+
+
+/****************************************************************************
+  FUNCTIONS
+*/
+
+/*************************************************************************
+NAME
+    poolInit
+
+DESCRIPTION
+    Set up the size classes with every block free. Called once at boot,
+    before anything is allocated from the pools.
+
+*/
+void poolInit ( void ) ;
+
+
+/*************************************************************************
+NAME
+    poolAlloc
+
+DESCRIPTION
+    Allocate pSize sizeof units from the smallest class able to hold them,
+    or from the heap if there is none or it is full.
+
+RETURNS
+    The block, or NULL if the heap is also exhausted.
+*/
+void * poolAlloc ( uint16 pSize ) ;
+
+
+/*************************************************************************
+NAME
+    PanicUnlessPoolAlloc
+
+DESCRIPTION
+    As poolAlloc, but panics rather than returning NULL. Drop in replacement
+    for PanicUnlessMalloc where the block is freed with poolFree.
+
+*/
+void * PanicUnlessPoolAlloc ( uint16 pSize ) ;
+
+
+/*************************************************************************
+NAME
+    poolFree
+
+DESCRIPTION
+    Free a block allocated with poolAlloc. NULL is ignored. With
+    DEBUG_POOL, freeing a pool block which is already free panics.
+
+*/
+void poolFree ( void * pBlock ) ;
+
+
+/*************************************************************************
+NAME
+    poolGetStats
+
+DESCRIPTION
+    Returns the usage of a size class, and through pOversize the number of
+    requests too large for any class.
+
+*/
+const poolStats_t * poolGetStats ( uint16 pClass , uint16 * pOversize ) ;
+
+
+#endif /* _HEADSET_POOL_H_ */
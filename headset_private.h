@@ -15,7 +15,9 @@ Part of Stereo-Headset-SDK Q3-2007.RC3.1
 
 
 #include "headset_buttonmanager.h"
+#include "headset_intercom_state.h"
 #include "headset_leddata.h"
+#include "headset_reconnect.h"
 #include "headset_states.h"
 
 #include <app/message/system_message.h>
@@ -78,6 +80,8 @@ enum
     APP_SEND_PLAY,
     APP_CHARGER_MONITOR,
     APP_INTERCOM_MODE,
+    APP_HFP_RECONNECT,
+    APP_A2DP_RECONNECT,
     HEADSET_MSG_TOP
 };
 
@@ -264,6 +268,25 @@ typedef struct
 
 } subrate_data;
 
+/*! @brief Number of intercom riders linked at once. More than one needs the conference mix. */
+#ifdef INTERCOM_CONFERENCE
+#define INTERCOM_MAX_PEERS      (3)
+#else
+#define INTERCOM_MAX_PEERS      (1)
+#endif
+
+/*! @brief Intercom link to one rider. */
+typedef struct
+{
+    TaskData            task;               /*!< Receives the AGHFP library messages of this link */
+    AGHFP               *aghfp;             /*!< AGHFP instance serving this link */
+    Sink                audio_sink;         /*!< SCO sink while audio is connected */
+    bdaddr              bd_addr;            /*!< Far address, kept in step with Persistent Store */
+    sync_link_type      link_type;          /*!< SCO or eSCO */
+    intercomLink_t      link;               /*!< Connection state, see headset_intercom_state.h */
+    reconnectState_t    reconnect;          /*!< Link loss reconnect attempts */ /* R100 */
+} intercomPeer;
+
 /*! @brief Headset data
 
     Global data for the stereo headset application.
@@ -292,15 +315,10 @@ typedef struct
     subrate_data        ssr_data;                       /*!< Sniff Subrate parameters */
     bdaddr*             confirmation_addr;              /*!< user confirmation data */
 
-    AGHFP               *aghfp;
-    Sink                audio_sink;
-    bdaddr              ag_bd_addr;
-    unsigned            aghfp_initial:1;
+    intercomPeer        intercom[INTERCOM_MAX_PEERS];   /*!< Intercom rider links */
+    reconnectState_t    hfp_reconnect;                  /*!< Link loss reconnect attempts to the AG */
+    reconnectState_t    a2dp_reconnect;                 /*!< Link loss reconnect attempts to the A2DP source */
     unsigned            slave_function:1;
-    unsigned            aghfp_connect:1;
-    unsigned            audio_connect:1;
-    unsigned            aghfp_connecting:1; /* R100 */
-    uint16              aghfp_attempt_count; /* R100 */
     unsigned            is_slc_connect_ind:1; /* R100 */
     unsigned            intercom_button:1; /* R100 */
     unsigned            repeat_stop:1;
@@ -0,0 +1,44 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    headset_prompts.c
+@brief   Implementation of the streaming decode of the voice prompts.
+*/
+
+/****************************************************************************
+    Header files
+*/
+
+#include "headset_prompts.h"
+
+
+/****************************************************************************
+  FUNCTIONS
+*/
+
+/**************************************************************************/
+void promptStart ( promptState_t * pState , const uint16 * pImage , const promptEntry_t * pEntry )
+{
+    adpcmInit ( &pState->adpcm ) ;
+
+    pState->codes    = pImage + pEntry->offset ;
+    pState->samples  = pEntry->samples ;
+    pState->position = 0 ;
+}
+
+
+/**************************************************************************/
+uint16 promptDecode ( promptState_t * pState , int16 * pOut , uint16 pSamples )
+{
+    uint16 lLeft = pState->samples - pState->position ;
+
+    if ( pSamples > lLeft )
+        pSamples = lLeft ;
+
+    adpcmDecode ( &pState->adpcm , pState->codes + pState->position / ADPCM_CODES_PER_WORD , pOut , pSamples ) ;
+    pState->position += pSamples ;
+
+    return pSamples ;
+}
@@ -0,0 +1,115 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    headset_prompts.h
+@brief   Spoken voice prompts, stored in the image as IMA ADPCM.
+
+    A rider cannot see the LEDs inside a helmet, and the beeps that tell
+    an intercom connecting from one failing sound much alike. With
+    VOICE_PROMPTS (which needs TONE_CACHE) the events of most use to a
+    rider are spoken instead: "intercom connected", "battery low" and the
+    rest of prompt_t.
+
+    The prompts are recorded as raw 16 bit little endian 8kHz mono files,
+    prompts/<name>.raw, and packed by host/host_prompt_compiler.c:
+
+        make -C host prompt_image
+
+    which writes headset_prompt_image.c: all the prompts as 4 bit IMA
+    ADPCM in the one read only image, gPromptImage, each starting on a
+    word, with an index of where each starts and how long it is,
+    gPromptIndex. A prompt with no recording is left empty, and its
+    event beeps as before.
+
+    A prompt is decoded as it is played, a block at a time into the
+    caller's buffer, so however long it is only a promptState_t is kept
+    for it. Each is given a tone number after the fixed tones,
+    PROMPT_TONE (see headset_tones.h), so that gEventTones maps an event
+    to a prompt as it maps one to a tone.
+*/
+
+#ifndef _HEADSET_PROMPTS_H_
+#define _HEADSET_PROMPTS_H_
+
+
+#include <csrtypes.h>
+
+#include "headset_adpcm.h"
+
+
+/* Sample rate of the prompts */
+#define PROMPT_RATE             (8000)
+
+
+/*! @brief The voice prompts, in the order of gPromptIndex */
+typedef enum
+{
+    promptIntercomConnected ,
+    promptIntercomDisconnected ,
+    promptIntercomFailed ,
+    promptPhonePaired ,
+    promptPhoneConnected ,
+    promptBatteryLow ,
+    NUM_PROMPTS
+} prompt_t ;
+
+/*! @brief Where a prompt is in the image, as written by host/host_prompt_compiler.c */
+typedef struct
+{
+    uint16          offset ;    /*!< Word of gPromptImage it starts at */
+    uint16          samples ;   /*!< Samples in it, 0 if it was not recorded */
+} promptEntry_t ;
+
+/*! @brief A prompt being decoded */
+typedef struct
+{
+    adpcmState_t    adpcm ;
+    const uint16 *  codes ;     /*!< First word of the prompt */
+    uint16          samples ;
+    uint16          position ;  /*!< Samples decoded so far */
+} promptState_t ;
+
+
+#ifdef VOICE_PROMPTS
+
+/* The prompts and their index (headset_prompt_image.c) */
+extern const uint16 gPromptImage [] ;
+extern const promptEntry_t gPromptIndex [ NUM_PROMPTS ] ;
+
+#endif /* VOICE_PROMPTS */
+
+
+/****************************************************************************
+  FUNCTIONS
+*/
+
+/*************************************************************************
+NAME
+    promptStart
+
+DESCRIPTION
+    Start decoding the prompt at pEntry of the image pImage, from its
+    first sample.
+
+*/
+void promptStart ( promptState_t * pState , const uint16 * pImage , const promptEntry_t * pEntry ) ;
+
+
+/*************************************************************************
+NAME
+    promptDecode
+
+DESCRIPTION
+    Decode the next pSamples samples of the prompt into pOut. pSamples
+    must be a multiple of ADPCM_CODES_PER_WORD, so that each call starts
+    on a word.
+
+RETURNS
+    The samples decoded, fewer than pSamples at the end of the prompt.
+*/
+uint16 promptDecode ( promptState_t * pState , int16 * pOut , uint16 pSamples ) ;
+
+
+#endif /* _HEADSET_PROMPTS_H_ */
@@ -0,0 +1,234 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    headset_ramp.c
+@brief   Implementation of the per sample gain ramps.
+*/
+
+/****************************************************************************
+    Header files
+*/
+
+#include "headset_ramp.h"
+
+
+/* Bits of the gain kept below Q12 */
+#define RAMP_FRACTION       (16)
+
+
+/****************************************************************************
+  LOCAL FUNCTIONS
+*/
+
+static int16 rampSaturate ( int32 pSample )
+{
+    if ( pSample > 32767 )
+        return 32767 ;
+    if ( pSample < -32768 )
+        return -32768 ;
+    return (int16) pSample ;
+}
+
+
+/* pCount samples at a gain of pGain, Q12 */
+static void rampConstant ( int16 * pSamples , uint16 pCount , int32 pGain )
+{
+    uint16 i ;
+
+    if ( pGain == RAMP_GAIN_UNITY )
+        return ;
+
+    for ( i = 0 ; i < pCount ; i++ )
+        pSamples [ i ] = rampSaturate ( ( pSamples [ i ] * pGain ) >> RAMP_GAIN_SHIFT ) ;
+}
+
+
+/* pCount samples from a gain of pGain, adding pSlope each sample, both
+   with RAMP_FRACTION bits below Q12 */
+static void rampSlide ( int16 * pSamples , uint16 pCount , int32 pGain , int32 pSlope )
+{
+    uint16 i ;
+
+    for ( i = 0 ; i < pCount ; i++ )
+    {
+        pSamples [ i ] = rampSaturate ( ( pSamples [ i ] * ( pGain >> RAMP_FRACTION ) ) >> RAMP_GAIN_SHIFT ) ;
+        pGain += pSlope ;
+    }
+}
+
+
+/* Slide from the gain now to pGain, or hold it if it is there already */
+static void rampSlideTo ( rampState_t * pState , uint16 pGain )
+{
+    int32 lDelta = ( (int32) pGain << RAMP_FRACTION ) - pState->gain ;
+
+    if ( !lDelta )
+    {
+        pState->phase = rampSteady ;
+        return ;
+    }
+
+    pState->slope = lDelta / (int32) pState->length ;
+    pState->left  = pState->length ;
+    pState->phase = rampSliding ;
+}
+
+
+/* Move on from a phase that has run its length */
+static void rampNext ( rampState_t * pState )
+{
+    switch ( pState->phase )
+    {
+    case rampSliding:
+        if ( pState->switching )
+        {
+            pState->gain  = (int32) RAMP_DIP << RAMP_FRACTION ;
+            pState->left  = RAMP_SEEK_MAX ;
+            pState->phase = rampSeeking ;
+        }
+        else
+        {
+            pState->gain  = (int32) pState->target << RAMP_FRACTION ;
+            pState->phase = rampSteady ;
+        }
+        break ;
+
+    case rampSeeking:
+        pState->left  = RAMP_HOLD ;
+        pState->phase = rampHolding ;
+        break ;
+
+    case rampHolding:
+        pState->switching = FALSE ;
+        rampSlideTo ( pState , pState->target ) ;
+        break ;
+
+    default:
+        break ;
+    }
+}
+
+
+/****************************************************************************
+  FUNCTIONS
+*/
+
+/**************************************************************************/
+void rampInit ( rampState_t * pState , uint16 pGain , uint16 pSamples )
+{
+    pState->gain      = (int32) pGain << RAMP_FRACTION ;
+    pState->slope     = 0 ;
+    pState->length    = pSamples ? pSamples : 1 ;
+    pState->left      = 0 ;
+    pState->target    = pGain ;
+    pState->phase     = rampSteady ;
+    pState->switching = FALSE ;
+    pState->positive  = TRUE ;
+}
+
+
+/**************************************************************************/
+void rampSetGain ( rampState_t * pState , uint16 pGain )
+{
+    if ( pGain > RAMP_GAIN_MAX )
+        pGain = RAMP_GAIN_MAX ;
+
+    pState->target = pGain ;
+
+    if ( !pState->switching )
+        rampSlideTo ( pState , pGain ) ;
+}
+
+
+/**************************************************************************/
+void rampSwitch ( rampState_t * pState , uint16 pGain )
+{
+    rampSetGain ( pState , pGain ) ;
+
+        /*a switch already under way takes this one's place*/
+    if ( pState->switching )
+        return ;
+
+    pState->switching = TRUE ;
+
+    if ( pState->gain > ( (int32) RAMP_DIP << RAMP_FRACTION ) )
+    {
+        rampSlideTo ( pState , RAMP_DIP ) ;
+    }
+    else
+    {
+        pState->phase = rampSliding ;
+        rampNext ( pState ) ;
+    }
+}
+
+
+/**************************************************************************/
+uint16 rampProcess ( rampState_t * pState , int16 * pSamples , uint16 pCount )
+{
+    uint16 lSwitch = RAMP_NO_SWITCH ;
+    uint16 lDone = 0 ;
+
+    while ( lDone < pCount )
+    {
+        int16 * lSamples = pSamples + lDone ;
+        uint16 lCount = pCount - lDone ;
+        uint16 i ;
+
+        if ( pState->phase == rampSteady )
+        {
+            rampConstant ( lSamples , lCount , pState->gain >> RAMP_FRACTION ) ;
+            lDone = pCount ;
+            break ;
+        }
+
+        if ( lCount > pState->left )
+            lCount = pState->left ;
+
+        switch ( pState->phase )
+        {
+        case rampSliding:
+            rampSlide ( lSamples , lCount , pState->gain , pState->slope ) ;
+            pState->gain += pState->slope * lCount ;
+            pState->left -= lCount ;
+            break ;
+
+        case rampSeeking:
+                /*up to the first sample across zero from the last*/
+            for ( i = 0 ; i < lCount ; i++ )
+            {
+                if ( ( lSamples [ i ] >= 0 ) != pState->positive )
+                    break ;
+            }
+
+            rampConstant ( lSamples , i , pState->gain >> RAMP_FRACTION ) ;
+            pState->left = ( i < lCount ) ? 0 : pState->left - lCount ;
+            lCount = i ;
+
+                /*the switch is due at the crossing, or now if none came*/
+            if ( !pState->left )
+                lSwitch = lDone + lCount ;
+            break ;
+
+        default:
+            rampConstant ( lSamples , lCount , pState->gain >> RAMP_FRACTION ) ;
+            pState->left -= lCount ;
+            break ;
+        }
+
+        if ( lCount )
+            pState->positive = ( lSamples [ lCount - 1 ] >= 0 ) ;
+
+        lDone += lCount ;
+
+        if ( !pState->left )
+            rampNext ( pState ) ;
+    }
+
+    if ( pCount )
+        pState->positive = ( pSamples [ pCount - 1 ] >= 0 ) ;
+
+    return lSwitch ;
+}
@@ -0,0 +1,133 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    headset_ramp.h
+@brief   Per sample gain ramps, so that a change of gain does not click.
+
+    A gain changed between one sample and the next is a step in the
+    waveform, heard as a click, and a volume button held down as a string
+    of them: zipper noise. rampSetGain instead slides the gain from where
+    it is to the new one, a little each sample, over the length set at
+    rampInit.
+
+    The amp's analogue gain switch (AMP_GAIN_MASK) steps the level too,
+    and cannot be slid. rampSwitch covers it: the gain slides down to
+    RAMP_DIP, waits there for the waveform to cross zero, where the switch
+    steps it least, and holds the dip for RAMP_HOLD samples, long enough
+    for the switch, made when that sample reaches the amp, to land inside
+    it. Then it slides to the new gain. rampProcess returns where the
+    crossing is, for the caller to time the switch by.
+
+    Gains are Q12, as the mixer's. The gain is kept to 16 bits more, so
+    that a slide of any length ends where it was sent.
+*/
+
+#ifndef _HEADSET_RAMP_H_
+#define _HEADSET_RAMP_H_
+
+
+#include <csrtypes.h>
+
+
+/* Gains are Q12, up to 4 times */
+#define RAMP_GAIN_SHIFT     (12)
+#define RAMP_GAIN_UNITY     ( 1 << RAMP_GAIN_SHIFT )
+#define RAMP_GAIN_MAX       ( 4 * RAMP_GAIN_UNITY - 1 )
+
+/* Length of a slide, 10ms at 8kHz: long enough not to click, short enough
+   that the volume still answers the button at once */
+#define RAMP_SAMPLES        (80)
+
+/* Gain the audio dips to while the analogue gain switches, -30dB */
+#define RAMP_DIP            ( RAMP_GAIN_UNITY / 32 )
+
+/* Most samples waited at the dip for a zero crossing, 4ms: a crossing
+   comes twice a period, so this finds one above 125Hz */
+#define RAMP_SEEK_MAX       (32)
+
+/* Samples held at the dip after the crossing, 8ms, for the switch to land in */
+#define RAMP_HOLD           (64)
+
+/* rampProcess found no switch due */
+#define RAMP_NO_SWITCH      (0xffff)
+
+
+/*! @brief What the gain is doing */
+typedef enum
+{
+    rampSteady ,        /*!< Held at the target */
+    rampSliding ,       /*!< Sliding to the target, or to the dip */
+    rampSeeking ,       /*!< At the dip, waiting for a zero crossing */
+    rampHolding         /*!< At the dip, until the switch has landed */
+} rampPhase_t ;
+
+/*! @brief State of one ramped gain */
+typedef struct
+{
+    int32           gain ;      /*!< Gain now, Q12 with 16 more bits */
+    int32           slope ;     /*!< Added to the gain each sample of a slide */
+    uint16          length ;    /*!< Samples in a slide */
+    uint16          left ;      /*!< Samples left of the phase */
+    uint16          target ;    /*!< Gain slid to, once any switch is done */
+    rampPhase_t     phase ;
+    bool            switching ; /*!< The slide is down to the dip for a switch */
+    bool            positive ;  /*!< Sign of the last sample, to find a crossing */
+} rampState_t ;
+
+
+/****************************************************************************
+  FUNCTIONS
+*/
+
+/*************************************************************************
+NAME
+    rampInit
+
+DESCRIPTION
+    Start steady at pGain, with slides of pSamples samples.
+
+*/
+void rampInit ( rampState_t * pState , uint16 pGain , uint16 pSamples ) ;
+
+
+/*************************************************************************
+NAME
+    rampSetGain
+
+DESCRIPTION
+    Slide from the gain now to pGain. While a switch is under way, pGain
+    is where the gain slides to once it is done.
+
+*/
+void rampSetGain ( rampState_t * pState , uint16 pGain ) ;
+
+
+/*************************************************************************
+NAME
+    rampSwitch
+
+DESCRIPTION
+    Dip the gain for a switch of the analogue gain, then slide to pGain.
+    rampProcess returns the sample the switch is due at.
+
+*/
+void rampSwitch ( rampState_t * pState , uint16 pGain ) ;
+
+
+/*************************************************************************
+NAME
+    rampProcess
+
+DESCRIPTION
+    Apply the gain to pCount samples in place, saturated to 16 bits.
+
+RETURNS
+    The sample of pSamples the analogue switch is due at, where the dipped
+    waveform crosses zero, or RAMP_NO_SWITCH.
+*/
+uint16 rampProcess ( rampState_t * pState , int16 * pSamples , uint16 pCount ) ;
+
+
+#endif /* _HEADSET_RAMP_H_ */
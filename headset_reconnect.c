@@ -0,0 +1,140 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    headset_reconnect.c
+@brief   Implementation of the link loss reconnect scheduler.
+*/
+
+/****************************************************************************
+    Header files
+*/
+
+#include "headset_reconnect.h"
+#include "headset_debug.h"
+
+#include <vm.h>
+
+
+#ifdef DEBUG_RECONNECT
+    #define RECONNECT_DEBUG(x) DEBUG(x)
+#else
+    #define RECONNECT_DEBUG(x)
+#endif
+
+
+/* When to attempt reconnecting one link, in milliseconds */
+typedef struct
+{
+    uint16  fast_ms ;           /* Delay before each of the fast attempts */
+    uint16  fast_attempts ;     /* Attempts made at fast_ms before backing off */
+    uint16  base_ms ;           /* Delay before the first attempt after the fast ones, doubled for each one after */
+    uint16  max_ms ;            /* Longest delay between attempts while page scanning */
+    uint16  max_attempts ;      /* Attempts before giving up */
+} reconnectPolicy_t ;
+
+
+/* Indexed by reconnectLink_t.
+   Intercom: both riders page, so a few quick tries then back off to a
+   minute; 14 attempts span about 8 minutes against 10 for the fixed
+   30 x 20s they replace.
+   Hfp: the first attempt is made as soon as the link is lost, the
+   scheduler only handles the retries.
+   A2dp: the source normally reconnects itself, so hold off for 10s to
+   leave it the page scan. */
+static const reconnectPolicy_t gPolicy [ reconnect_max_links ] =
+{
+    {  1000 , 3 ,  2000 , 60000 , 14 } ,
+    {  2000 , 2 ,  4000 , 60000 , 10 } ,
+    { 10000 , 1 , 15000 , 60000 ,  6 }
+} ;
+
+
+static uint32 gSeed = 0 ;
+
+
+/****************************************************************************
+  LOCAL FUNCTIONS
+*/
+
+/* Cheap pseudo random number; stirring in the clock keeps two headsets which booted together apart */
+static uint16 reconnectRandom ( void )
+{
+    gSeed = gSeed * 1664525UL + 1013904223UL + VmGetClock () ;
+    return (uint16) ( gSeed >> 16 ) ;
+}
+
+
+/* Nominal delay before attempt pAttempt (from 0) */
+static uint32 reconnectDelay ( const reconnectPolicy_t * pPolicy , uint16 pAttempt , bool pPageScan )
+{
+    uint32 lMax = pPageScan ? pPolicy->max_ms : pPolicy->max_ms / 2 ;
+    uint32 lDelay ;
+    uint16 lShift ;
+
+    if ( pAttempt < pPolicy->fast_attempts )
+        return pPolicy->fast_ms ;
+
+    lShift = pAttempt - pPolicy->fast_attempts ;
+    lDelay = pPolicy->base_ms ;
+
+    while ( lShift-- && ( lDelay < lMax ) )
+        lDelay <<= 1 ;
+
+    return ( lDelay < lMax ) ? lDelay : lMax ;
+}
+
+
+/****************************************************************************
+  FUNCTIONS
+*/
+
+/**************************************************************************/
+void reconnectStart ( reconnectState_t * pState )
+{
+    pState->active   = TRUE ;
+    pState->attempts = 0 ;
+}
+
+
+/**************************************************************************/
+bool reconnectSchedule ( reconnectState_t * pState , reconnectLink_t pLink , Task pTask , MessageId pId , bool pPageScan )
+{
+    const reconnectPolicy_t * lPolicy = &gPolicy [ pLink ] ;
+    uint32 lDelay ;
+
+    if ( !pState->active )
+        return FALSE ;
+
+    if ( pState->attempts >= lPolicy->max_attempts )
+    {
+        RECONNECT_DEBUG(("RECONNECT: link %d gave up after %d\n" , pLink , pState->attempts)) ;
+        pState->active = FALSE ;
+        return FALSE ;
+    }
+
+    lDelay = reconnectDelay ( lPolicy , pState->attempts , pPageScan ) ;
+
+        /*spread by +/-25%*/
+    lDelay = lDelay - ( lDelay / 4 ) + ( reconnectRandom () % ( lDelay / 2 + 1 ) ) ;
+
+    RECONNECT_DEBUG(("RECONNECT: link %d attempt %d in %ldms\n" , pLink , pState->attempts + 1 , lDelay)) ;
+
+    pState->attempts++ ;
+
+    MessageCancelAll ( pTask , pId ) ;
+    MessageSendLater ( pTask , pId , 0 , lDelay ) ;
+    return TRUE ;
+}
+
+
+/**************************************************************************/
+void reconnectStop ( reconnectState_t * pState , Task pTask , MessageId pId )
+{
+    pState->active   = FALSE ;
+    pState->attempts = 0 ;
+
+    MessageCancelAll ( pTask , pId ) ;
+}
+
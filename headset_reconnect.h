@@ -0,0 +1,92 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    headset_reconnect.h
+@brief   Scheduling of reconnect attempts after a link loss.
+
+    After a link loss the far end is most often back within a few seconds,
+    so the first attempts follow quickly. Each further attempt waits twice
+    as long as the one before, up to a cap, and the number of attempts is
+    bounded, so an absent device is not paged for ever. Every delay is
+    spread by +/-25% so that two headsets which lost the same link do not
+    page each other in lock step, neither of them page scanning.
+
+    While page scan is enabled the far end can restore the link by paging
+    us, so the full cap applies. With page scan disabled only our own pages
+    can restore it and the cap is halved.
+
+    The caller owns a reconnectState_t per link and posts the attempt
+    message itself: reconnectSchedule only decides when.
+*/
+
+#ifndef _HEADSET_RECONNECT_H_
+#define _HEADSET_RECONNECT_H_
+
+
+#include <message.h>
+
+
+/*! @brief The links which are reconnected after a link loss, each with its own policy */
+typedef enum
+{
+    reconnectIntercom ,     /*!< SLC to an intercom rider */
+    reconnectHfp ,          /*!< SLC to the phone */
+    reconnectA2dp ,         /*!< A2DP signalling to the last used source */
+    reconnect_max_links
+} reconnectLink_t ;
+
+
+/*! @brief Progress of the reconnection of one link */
+typedef struct
+{
+    unsigned    active:1 ;      /*!< From reconnectStart until reconnectStop or the policy gives up */
+    unsigned    attempts:15 ;   /*!< Attempts scheduled since reconnectStart */
+} reconnectState_t ;
+
+
+/****************************************************************************
+  FUNCTIONS
+*/
+
+/*************************************************************************
+NAME
+    reconnectStart
+
+DESCRIPTION
+    Begin reconnecting a link which has just been lost.
+
+*/
+void reconnectStart ( reconnectState_t * pState ) ;
+
+
+/*************************************************************************
+NAME
+    reconnectSchedule
+
+DESCRIPTION
+    Post pId to pTask when the next attempt to reconnect pLink is due.
+    pPageScan tells whether the headset is page scanning. Any attempt
+    already pending is replaced.
+
+RETURNS
+    FALSE, with nothing posted, if the link is not being reconnected or the
+    policy allows no further attempts.
+*/
+bool reconnectSchedule ( reconnectState_t * pState , reconnectLink_t pLink , Task pTask , MessageId pId , bool pPageScan ) ;
+
+
+/*************************************************************************
+NAME
+    reconnectStop
+
+DESCRIPTION
+    Stop reconnecting, on success or when the link is no longer wanted, and
+    cancel any pending attempt.
+
+*/
+void reconnectStop ( reconnectState_t * pState , Task pTask , MessageId pId ) ;
+
+
+#endif /* _HEADSET_RECONNECT_H_ */
@@ -13,6 +13,7 @@ Copyright (C) Cambridge Silicon Radio Ltd. 2005-2008
 */
 
 #include "headset_debug.h"
+#include "headset_pool.h"
 #include "headset_scan.h"
 #include "panic.h"
 #include "string.h"
@@ -81,7 +82,7 @@ void headsetWriteEirData(hsTaskData *app, CL_DM_LOCAL_NAME_COMPLETE_T *message)
     uint16 size = EIR_DATA_SHORTENED ? EIR_MAX_SIZE : EIR_DATA_SIZE_FULL;
 
     /* Just enough for the UUID16 and name fields and null termination */
-    uint8 *const eir = (uint8 *)PanicUnlessMalloc(size * sizeof(uint8));
+    uint8 *const eir = (uint8 *)PanicUnlessPoolAlloc(size * sizeof(uint8));
     uint8 *p = eir;
 
     *p++ = EIR_NAME_SIZE + 1;
@@ -97,7 +98,7 @@ void headsetWriteEirData(hsTaskData *app, CL_DM_LOCAL_NAME_COMPLETE_T *message)
     ConnectionWriteEirData(FALSE, size, eir);
 
     /* Free the EIR data */
-    free(eir);
+    poolFree(eir);
 }
 
 
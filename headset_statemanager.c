@@ -10,9 +10,11 @@ Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
 #include "headset_a2dp_connection.h"
 #include "headset_a2dp_stream_control.h"
 #include "headset_buttonmanager.h"
+#include "headset_coalesce.h"
 #include "headset_configmanager.h"
 #include "headset_debug.h"
 #include "headset_hfp_slc.h"
+#include "headset_intercom_msg_handler.h"
 #include "headset_LEDmanager.h"
 #include "headset_scan.h"
 #include "headset_statemanager.h"
@@ -119,8 +121,8 @@ void stateManagerEnterHfpConnectableState ( hsTaskData *pApp, bool req_disc )
         headsetDisableDiscoverable ( pApp) ;
         MessageCancelAll ( &pApp->task , EventPairingFail ) ;        
     
-        MessageSend(&pApp->task, EventSkipForward, 0);
-        MessageSendLater(&pApp->task, EventSkipBackward, 0, D_SEC(1));
+        coalesceSend(&pApp->task, EventSkipForward, 0, coalesceMerge);
+        coalesceSend(&pApp->task, EventSkipBackward, D_SEC(1), coalesceReplace);
     }
     else
     {
@@ -180,7 +182,7 @@ void stateManagerEnterA2dpConnectedState(hsTaskData * pApp)
    		stateManagerSetA2dpState(pApp , headsetA2dpConnected);
 
 #ifndef BNFON
-    	if ( stateManagerIsHfpConnected() && !pApp->audio_connect && (pApp->aghfp_connect || pApp->slave_function)) /* SUSPEND */
+    	if ( stateManagerIsHfpConnected() && !intercomIsAudioActive(pApp) && (intercomIsConnected(pApp) || pApp->slave_function)) /* SUSPEND */
         {      
             headsetDisableConnectable  ( pApp ) ;
         }
@@ -222,7 +224,7 @@ void stateManagerEnterA2dpPausedState(hsTaskData * pApp)
 /*****************************************************************************/
 void stateManagerEnterConnDiscoverableState ( hsTaskData *pApp )
 {
-    MessageSend(&pApp->task, EventSkipForward, 0);
+    coalesceSend(&pApp->task, EventSkipForward, 0, coalesceMerge);
 
 #ifdef S100A /* v100622 Intercom Pairing mode */
     if(!pApp->intercom_pairing_mode)
@@ -276,7 +278,7 @@ void stateManagerEnterHfpConnectedState ( hsTaskData *pApp )
         headsetDisableDiscoverable ( pApp ) ;
 
 #ifndef BNFON
-        if ( stateManagerIsA2dpSignallingActive ( pApp ) && (pApp->aghfp_connect || pApp->slave_function) )
+        if ( stateManagerIsA2dpSignallingActive ( pApp ) && (intercomIsConnected(pApp) || pApp->slave_function) )
             headsetDisableConnectable  ( pApp ) ;
 #endif
 
@@ -342,6 +344,9 @@ void stateManagerEnterActiveCallState ( hsTaskData * pApp )
 /*****************************************************************************/
 void stateManagerEnterPoweringOffState ( hsTaskData *pApp )
 {
+    reconnectStop(&pApp->hfp_reconnect, &pApp->task, APP_HFP_RECONNECT);
+    reconnectStop(&pApp->a2dp_reconnect, &pApp->task, APP_A2DP_RECONNECT);
+
 	if ( stateManagerIsA2dpConnected() )
     {      
       	a2dpDisconnectRequest( pApp );
@@ -0,0 +1,407 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    headset_synth.c
+@brief   Implementation of the software synthesis of audio_note scripts.
+*/
+
+/****************************************************************************
+    Header files
+*/
+
+#include "headset_synth.h"
+
+
+/* Lets the host compiler assume the table and the output do not overlap,
+   and gather from tables of 32 bit samples; the chip keeps them in words */
+#ifdef HOST_BUILD
+#define SYNTH_RESTRICT  __restrict__
+typedef int32 synthSample_t ;
+#else
+#define SYNTH_RESTRICT
+typedef int16 synthSample_t ;
+#endif
+
+/* Durations are counted in hemidemisemiquavers, sixteen to the beat */
+#define SYNTH_PER_BEAT          (16)
+
+/* Samples of a hemidemisemiquaver at a tempo of one beat a minute */
+#define SYNTH_UNIT_SAMPLES      ( 60L * SYNTH_RATE / SYNTH_PER_BEAT )
+
+/* Note times are kept in 1/256 samples, so the notes of any tempo add up */
+#define SYNTH_TIME_SHIFT        (8)
+
+/* Largest tempo and volume read, as the host renderer */
+#define SYNTH_TEMPO_MAX         (4095)
+#define SYNTH_VOLUME_MAX        (255)
+
+/* Script defaults until a word sets them */
+#define SYNTH_DEFAULT_TEMPO     (120)
+#define SYNTH_DEFAULT_VOLUME    (64)
+
+/* Pitches are MIDI numbers: rests and the start of a script have none */
+#define SYNTH_REST              (-1)
+#define SYNTH_NO_PITCH          (-2)
+
+/* The phase steps of octave 7, MIDI 96 to 107, at SYNTH_RATE; lower octaves halve them */
+#define SYNTH_TOP_OCTAVE        (8)
+
+/* Fraction bits of the phase used to interpolate between table samples */
+#define SYNTH_FRACTION_BITS     (15)
+
+
+typedef struct
+{
+    audio_note  word ;      /* The note at a crotchet less a crotchet rest */
+    int16       pitch ;
+} synthPitch_t ;
+
+typedef struct
+{
+    audio_note  rest ;      /* A rest of the duration */
+    audio_note  tie ;       /* A tied rest of the duration */
+    uint16      units ;
+} synthDuration_t ;
+
+
+/* Every note of octaves 5 to 7 by the SDK's macros; the names are pasted, so
+   each must be written out */
+#define SYNTH_PITCH(n,p)    { (audio_note) ( AUDIO_NOTE ( n , CROTCHET ) - AUDIO_NOTE ( REST , CROTCHET ) ) , p }
+#define SYNTH_OCTAVE(o)     SYNTH_PITCH(C##o,12*o+12) , SYNTH_PITCH(CS##o,12*o+13) , SYNTH_PITCH(DF##o,12*o+13) , \
+                            SYNTH_PITCH(D##o,12*o+14) , SYNTH_PITCH(DS##o,12*o+15) , SYNTH_PITCH(EF##o,12*o+15) , \
+                            SYNTH_PITCH(E##o,12*o+16) , SYNTH_PITCH(F##o,12*o+17) , SYNTH_PITCH(FS##o,12*o+18) , \
+                            SYNTH_PITCH(G##o,12*o+19) , SYNTH_PITCH(GS##o,12*o+20) , SYNTH_PITCH(AF##o,12*o+20) , \
+                            SYNTH_PITCH(A##o,12*o+21) , SYNTH_PITCH(BF##o,12*o+22) , SYNTH_PITCH(B##o,12*o+23)
+#define SYNTH_DURATION(d,u) { AUDIO_NOTE ( REST , d ) , AUDIO_NOTE_TIE ( REST , d ) , u }
+
+static const synthPitch_t gPitches [] =
+{
+    SYNTH_OCTAVE(5) ,
+    SYNTH_OCTAVE(6) ,
+    SYNTH_OCTAVE(7)
+} ;
+
+static const synthDuration_t gDurations [] =
+{
+    SYNTH_DURATION ( SEMIBREVE , 64 ) ,
+    SYNTH_DURATION ( MINIM , 32 ) ,
+    SYNTH_DURATION ( CROTCHET , 16 ) ,
+    SYNTH_DURATION ( QUAVER , 8 ) ,
+    SYNTH_DURATION ( SEMIQUAVER , 4 ) ,
+    SYNTH_DURATION ( DEMISEMIQUAVER , 2 ) ,
+    SYNTH_DURATION ( HEMIDEMISEMIQUAVER , 1 )
+} ;
+
+static const audio_note gTimbres [] =
+{
+    AUDIO_TIMBRE ( sine ) ,
+    AUDIO_TIMBRE ( square ) ,
+    AUDIO_TIMBRE ( saw ) ,
+    AUDIO_TIMBRE ( triangle )
+} ;
+
+static const uint32 gSteps [ 12 ] =
+{
+    1123673247UL , 1190490335UL , 1261280574UL , 1336280220UL , 1415739577UL , 1499923833UL ,
+    1589113945UL , 1683607578UL , 1783720094UL , 1889785610UL , 2002158110UL , 2121212627UL
+} ;
+
+/* One cycle of each timbre, in the order of gTimbres, with the first sample
+   again at the end to interpolate towards */
+static const synthSample_t gTables [] [ SYNTH_TABLE_SIZE + 1 ] =
+{
+    {
+             0 ,   3212 ,   6393 ,   9512 ,  12539 ,  15446 ,  18204 ,  20787 ,
+         23170 ,  25329 ,  27245 ,  28898 ,  30273 ,  31356 ,  32137 ,  32609 ,
+         32767 ,  32609 ,  32137 ,  31356 ,  30273 ,  28898 ,  27245 ,  25329 ,
+         23170 ,  20787 ,  18204 ,  15446 ,  12539 ,   9512 ,   6393 ,   3212 ,
+             0 ,  -3212 ,  -6393 ,  -9512 , -12539 , -15446 , -18204 , -20787 ,
+        -23170 , -25329 , -27245 , -28898 , -30273 , -31356 , -32137 , -32609 ,
+        -32767 , -32609 , -32137 , -31356 , -30273 , -28898 , -27245 , -25329 ,
+        -23170 , -20787 , -18204 , -15446 , -12539 ,  -9512 ,  -6393 ,  -3212 ,
+             0
+    } ,
+    {
+         32767 ,  32767 ,  32767 ,  32767 ,  32767 ,  32767 ,  32767 ,  32767 ,
+         32767 ,  32767 ,  32767 ,  32767 ,  32767 ,  32767 ,  32767 ,  32767 ,
+         32767 ,  32767 ,  32767 ,  32767 ,  32767 ,  32767 ,  32767 ,  32767 ,
+         32767 ,  32767 ,  32767 ,  32767 ,  32767 ,  32767 ,  32767 ,  32767 ,
+        -32767 , -32767 , -32767 , -32767 , -32767 , -32767 , -32767 , -32767 ,
+        -32767 , -32767 , -32767 , -32767 , -32767 , -32767 , -32767 , -32767 ,
+        -32767 , -32767 , -32767 , -32767 , -32767 , -32767 , -32767 , -32767 ,
+        -32767 , -32767 , -32767 , -32767 , -32767 , -32767 , -32767 , -32767 ,
+         32767
+    } ,
+    {
+        -32767 , -31743 , -30719 , -29695 , -28671 , -27647 , -26623 , -25599 ,
+        -24575 , -23551 , -22527 , -21503 , -20479 , -19455 , -18431 , -17407 ,
+        -16384 , -15360 , -14336 , -13312 , -12288 , -11264 , -10240 ,  -9216 ,
+         -8192 ,  -7168 ,  -6144 ,  -5120 ,  -4096 ,  -3072 ,  -2048 ,  -1024 ,
+             0 ,   1024 ,   2048 ,   3072 ,   4096 ,   5120 ,   6144 ,   7168 ,
+          8192 ,   9216 ,  10240 ,  11264 ,  12288 ,  13312 ,  14336 ,  15360 ,
+         16384 ,  17407 ,  18431 ,  19455 ,  20479 ,  21503 ,  22527 ,  23551 ,
+         24575 ,  25599 ,  26623 ,  27647 ,  28671 ,  29695 ,  30719 ,  31743 ,
+        -32767
+    } ,
+    {
+             0 ,   2048 ,   4096 ,   6144 ,   8192 ,  10240 ,  12288 ,  14336 ,
+         16384 ,  18431 ,  20479 ,  22527 ,  24575 ,  26623 ,  28671 ,  30719 ,
+         32767 ,  30719 ,  28671 ,  26623 ,  24575 ,  22527 ,  20479 ,  18431 ,
+         16384 ,  14336 ,  12288 ,  10240 ,   8192 ,   6144 ,   4096 ,   2048 ,
+             0 ,  -2048 ,  -4096 ,  -6144 ,  -8192 , -10240 , -12288 , -14336 ,
+        -16384 , -18431 , -20479 , -22527 , -24575 , -26623 , -28671 , -30719 ,
+        -32767 , -30719 , -28671 , -26623 , -24575 , -22527 , -20479 , -18431 ,
+        -16384 , -14336 , -12288 , -10240 ,  -8192 ,  -6144 ,  -4096 ,  -2048 ,
+             0
+    }
+} ;
+
+
+/****************************************************************************
+  LOCAL FUNCTIONS
+*/
+
+/* The pitch and duration of a note word, if it is one */
+static bool synthNoteWord ( audio_note pWord , int16 * pPitch , uint16 * pUnits , bool * pTie )
+{
+    uint16 d , p ;
+
+    for ( d = 0 ; d < sizeof ( gDurations ) / sizeof ( gDurations [ 0 ] ) ; d++ )
+    {
+        uint16 t ;
+
+        for ( t = 0 ; t < 2 ; t++ )
+        {
+            audio_note lPitch = (audio_note) ( pWord - ( t ? gDurations [ d ].tie : gDurations [ d ].rest ) ) ;
+
+            *pUnits = gDurations [ d ].units ;
+            *pTie   = ( t != 0 ) ;
+
+            if ( !lPitch )
+            {
+                *pPitch = SYNTH_REST ;
+                return TRUE ;
+            }
+
+            for ( p = 0 ; p < sizeof ( gPitches ) / sizeof ( gPitches [ 0 ] ) ; p++ )
+            {
+                if ( gPitches [ p ].word == lPitch )
+                {
+                    *pPitch = gPitches [ p ].pitch ;
+                    return TRUE ;
+                }
+            }
+        }
+    }
+
+    return FALSE ;
+}
+
+
+/* Read the script on to its next note, into pNote. FALSE at the end of the
+   script or at a word that cannot be read */
+static bool synthRead ( synthState_t * pState , synthNote_t * pNote )
+{
+    for ( ;; pState->script++ )
+    {
+        audio_note lWord = *pState->script ;
+        audio_note lValue ;
+        int16 lPitch ;
+        uint16 lUnits , t ;
+        bool lTie ;
+
+        if ( lWord == AUDIO_END )
+            return FALSE ;
+
+        for ( t = 0 ; t < sizeof ( gTimbres ) / sizeof ( gTimbres [ 0 ] ) ; t++ )
+        {
+            if ( gTimbres [ t ] == lWord )
+                break ;
+        }
+        if ( t < sizeof ( gTimbres ) / sizeof ( gTimbres [ 0 ] ) )
+        {
+            pState->timbre = t ;
+            continue ;
+        }
+
+        lValue = (audio_note) ( lWord - AUDIO_TEMPO ( 0 ) ) ;
+        if ( lValue && ( lValue <= SYNTH_TEMPO_MAX ) && ( AUDIO_TEMPO ( lValue ) == lWord ) )
+        {
+            pState->tempo = lValue ;
+            continue ;
+        }
+
+        lValue = (audio_note) ( lWord - AUDIO_VOLUME ( 0 ) ) ;
+        if ( ( lValue <= SYNTH_VOLUME_MAX ) && ( AUDIO_VOLUME ( lValue ) == lWord ) )
+        {
+            pState->volume = lValue ;
+            continue ;
+        }
+
+        if ( !synthNoteWord ( lWord , &lPitch , &lUnits , &lTie ) )
+        {
+            pState->result = synthUnknown ;
+            return FALSE ;
+        }
+
+        pNote->start     = ( pState->time + ( 1 << ( SYNTH_TIME_SHIFT - 1 ) ) ) >> SYNTH_TIME_SHIFT ;
+        pState->time    += ( ( SYNTH_UNIT_SAMPLES * lUnits << SYNTH_TIME_SHIFT ) + pState->tempo / 2 ) / pState->tempo ;
+        pNote->end       = ( pState->time + ( 1 << ( SYNTH_TIME_SHIFT - 1 ) ) ) >> SYNTH_TIME_SHIFT ;
+        pNote->step      = ( lPitch < 0 ) ? 0 : gSteps [ lPitch % 12 ] >> ( SYNTH_TOP_OCTAVE - lPitch / 12 ) ;
+        pNote->amplitude = ( lPitch < 0 ) ? 0 : (int16) ( pState->volume * 128 ) ;
+        pNote->timbre    = pState->timbre ;
+        pNote->tied      = lTie && ( pState->pitch == lPitch ) ;
+
+        pState->pitch = lPitch ;
+        pState->script++ ;
+        return TRUE ;
+    }
+}
+
+
+/* Move on to the note read ahead */
+static void synthAdvance ( synthState_t * pState )
+{
+    pState->playing = pState->ahead ;
+
+    if ( pState->ahead )
+    {
+        pState->note  = pState->next ;
+        pState->ahead = synthRead ( pState , &pState->next ) ;
+    }
+}
+
+
+/* pCount samples of a wavetable, from pPhase in steps of pStep, at a gain
+   of pGain plus pSlope a sample, both in 1/256 */
+static void synthBlock ( const synthSample_t * SYNTH_RESTRICT pTable , uint32 pPhase , uint32 pStep , int32 pGain , int32 pSlope , int16 * SYNTH_RESTRICT pOut , uint16 pCount )
+{
+    uint16 i ;
+
+    for ( i = 0 ; i < pCount ; i++ )
+    {
+        uint32 lIndex    = pPhase >> ( 32 - SYNTH_TABLE_BITS ) ;
+        int32  lFraction = (int32) ( ( pPhase >> ( 32 - SYNTH_TABLE_BITS - SYNTH_FRACTION_BITS ) ) & ( ( 1 << SYNTH_FRACTION_BITS ) - 1 ) ) ;
+        int32  lSample   = pTable [ lIndex ] + ( ( ( pTable [ lIndex + 1 ] - pTable [ lIndex ] ) * lFraction ) >> SYNTH_FRACTION_BITS ) ;
+
+        pOut [ i ] = (int16) ( ( lSample * ( pGain >> 8 ) ) >> 15 ) ;
+
+        pPhase += pStep ;
+        pGain  += pSlope ;
+    }
+}
+
+
+/* Render pCount samples of the note playing, which has that many left. The
+   note is split where its fades begin and end, each part a straight line
+   of gain */
+static void synthNote ( synthState_t * pState , int16 * pOut , uint16 pCount )
+{
+    const synthNote_t * lNote = &pState->note ;
+    uint32 lLength = lNote->end - lNote->start ;
+    uint32 lFade = ( lLength / 2 < SYNTH_FADE ) ? lLength / 2 : SYNTH_FADE ;
+    uint32 lFadeIn = lNote->tied ? 0 : lFade ;
+    uint32 lFadeOut = ( pState->ahead && pState->next.tied ) ? 0 : lFade ;
+    int32 lFull = (int32) lNote->amplitude << 8 ;
+    int32 lSlope = lFull / (int32) ( lFade + 1 ) ;
+
+    while ( pCount )
+    {
+        uint32 k = pState->position - lNote->start ;
+        uint32 lPart ;
+        int32 lGain , lPartSlope ;
+
+        if ( k < lFadeIn )
+        {
+            lPart      = lFadeIn - k ;
+            lGain      = lSlope * (int32) ( k + 1 ) ;
+            lPartSlope = lSlope ;
+        }
+        else if ( k < lLength - lFadeOut )
+        {
+            lPart      = lLength - lFadeOut - k ;
+            lGain      = lFull ;
+            lPartSlope = 0 ;
+        }
+        else
+        {
+            lPart      = lLength - k ;
+            lGain      = lSlope * (int32) ( lLength - k ) ;
+            lPartSlope = -lSlope ;
+        }
+
+        if ( lPart > pCount )
+            lPart = pCount ;
+
+        synthBlock ( gTables [ lNote->timbre ] , pState->phase , lNote->step , lGain , lPartSlope , pOut , (uint16) lPart ) ;
+
+        pState->phase    += (uint32) lPart * lNote->step ;
+        pState->position += lPart ;
+        pOut             += lPart ;
+        pCount           -= (uint16) lPart ;
+    }
+}
+
+
+/****************************************************************************
+  FUNCTIONS
+*/
+
+/**************************************************************************/
+void synthStart ( synthState_t * pState , const audio_note * pScript )
+{
+    pState->script   = pScript ;
+    pState->time     = 0 ;
+    pState->position = 0 ;
+    pState->phase    = 0 ;
+    pState->tempo    = SYNTH_DEFAULT_TEMPO ;
+    pState->volume   = SYNTH_DEFAULT_VOLUME ;
+    pState->timbre   = 0 ;
+    pState->pitch    = SYNTH_NO_PITCH ;
+    pState->result   = synthOk ;
+
+    pState->playing = synthRead ( pState , &pState->note ) ;
+    pState->ahead   = pState->playing && synthRead ( pState , &pState->next ) ;
+}
+
+
+/**************************************************************************/
+uint16 synthRender ( synthState_t * pState , int16 * pOut , uint16 pSamples )
+{
+    uint16 lDone = 0 ;
+
+    while ( ( lDone < pSamples ) && pState->playing )
+    {
+        uint32 lLeft = pState->note.end - pState->position ;
+        uint16 lCount = ( lLeft < (uint32) ( pSamples - lDone ) ) ? (uint16) lLeft : pSamples - lDone ;
+
+        synthNote ( pState , pOut + lDone , lCount ) ;
+        lDone += lCount ;
+
+        if ( pState->position >= pState->note.end )
+            synthAdvance ( pState ) ;
+    }
+
+    return lDone ;
+}
+
+
+/**************************************************************************/
+uint32 synthLength ( const audio_note * pScript , synthResult_t * pResult )
+{
+    synthState_t lState ;
+    uint32 lLength = 0 ;
+
+    synthStart ( &lState , pScript ) ;
+
+    while ( lState.playing )
+    {
+        lLength = lState.note.end ;
+        synthAdvance ( &lState ) ;
+    }
+
+    *pResult = lState.result ;
+    return lLength ;
+}
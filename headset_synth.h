@@ -0,0 +1,129 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    headset_synth.h
+@brief   Software synthesis of audio_note scripts into 8kHz PCM.
+
+    Plays the same scripts as AudioPlayTone - AUDIO_TEMPO, AUDIO_VOLUME,
+    AUDIO_TIMBRE, AUDIO_NOTE, AUDIO_NOTE_TIE and AUDIO_END - without the
+    firmware's tone generator, so new ring tones and rider chimes need
+    only a new script. Each note is a phase accumulator stepping through a
+    SYNTH_TABLE_SIZE sample wavetable of its timbre (sine, square, saw or
+    triangle), linearly interpolated, at an amplitude of the volume times
+    128. As the host renderer does (host/host_tone_render.h), a crotchet
+    is one beat, the phase runs on from note to note and each note is
+    faded in and out over SYNTH_FADE samples except into a tied note.
+
+    The words are read with the SDK's macros by taking each one as a tag
+    plus its value: the tempo of a word is what is left once AUDIO_TEMPO(0)
+    is taken from it, if AUDIO_TEMPO gives the word back for that tempo,
+    and likewise for the volume, the duration of a note and its pitch. The
+    host golden check, which assumes nothing of the packing, shows whether
+    that holds for the SDK in use.
+
+    Notes are rendered a block at a time by a loop kept free of branches
+    and aliasing, so that a vectorising compiler can use SIMD on the host;
+    on the chip it runs as plain C.
+*/
+
+#ifndef _HEADSET_SYNTH_H_
+#define _HEADSET_SYNTH_H_
+
+
+#include <csrtypes.h>
+#include <audio.h>
+
+
+/* Sample rate synthesised at */
+#define SYNTH_RATE              (8000)
+
+/* Samples a note fades in and out over, 2ms */
+#define SYNTH_FADE              (16)
+
+/* Samples in each wavetable, a power of two */
+#define SYNTH_TABLE_BITS        (6)
+#define SYNTH_TABLE_SIZE        ( 1 << SYNTH_TABLE_BITS )
+
+
+/*! @brief Result of reading a script */
+typedef enum
+{
+    synthOk ,               /*!< Read to AUDIO_END */
+    synthUnknown            /*!< A word the synth cannot read, where it stopped */
+} synthResult_t ;
+
+/*! @brief A note read from a script */
+typedef struct
+{
+    uint32          start ;     /*!< First sample */
+    uint32          end ;       /*!< First sample after it */
+    uint32          step ;      /*!< Phase added each sample, 0 for a rest */
+    int16           amplitude ;
+    uint16          timbre ;
+    bool            tied ;      /*!< Continues the note before, so is not faded in */
+} synthNote_t ;
+
+/*! @brief A script being synthesised */
+typedef struct
+{
+    const audio_note *  script ;    /*!< Next word to read */
+    uint32          time ;          /*!< End of the notes read, in 1/256 samples */
+    uint32          position ;      /*!< Samples rendered */
+    uint32          phase ;
+    uint16          tempo ;
+    uint16          volume ;
+    uint16          timbre ;
+    int16           pitch ;         /*!< Of the last note read, to tell a tie */
+    synthResult_t   result ;
+    bool            playing ;       /*!< note is to be played */
+    bool            ahead ;         /*!< next has been read */
+    synthNote_t     note ;
+    synthNote_t     next ;
+} synthState_t ;
+
+
+/****************************************************************************
+  FUNCTIONS
+*/
+
+/*************************************************************************
+NAME
+    synthStart
+
+DESCRIPTION
+    Start synthesising pScript, from its first sample.
+
+*/
+void synthStart ( synthState_t * pState , const audio_note * pScript ) ;
+
+
+/*************************************************************************
+NAME
+    synthRender
+
+DESCRIPTION
+    Render the next pSamples samples of the script into pOut.
+
+RETURNS
+    The samples rendered, fewer than pSamples once the script ends.
+*/
+uint16 synthRender ( synthState_t * pState , int16 * pOut , uint16 pSamples ) ;
+
+
+/*************************************************************************
+NAME
+    synthLength
+
+DESCRIPTION
+    Read pScript through without rendering it.
+
+RETURNS
+    The length of the tone in samples, up to any word the synth cannot
+    read; *pResult says whether there was one.
+*/
+uint32 synthLength ( const audio_note * pScript , synthResult_t * pResult ) ;
+
+
+#endif /* _HEADSET_SYNTH_H_ */
@@ -0,0 +1,324 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    headset_tone_cache.c
+@brief   Implementation of the playback of pre-rendered tones.
+*/
+
+/****************************************************************************
+    Header files
+*/
+
+#include "headset_tone_cache.h"
+
+
+/* Bias added to the magnitude before it is coded, as G.711 does */
+#define TONE_CACHE_BIAS         (0x84)
+
+
+/**************************************************************************/
+void toneCacheDecode ( const uint16 * pCodes , uint16 pFirst , int16 * pOut , uint16 pSamples )
+{
+    uint16 i ;
+
+    for ( i = 0 ; i < pSamples ; i++ )
+    {
+        uint16 lIndex = pFirst + i ;
+        uint16 lCode = ~( pCodes [ lIndex / TONE_CACHE_PER_WORD ] >> ( ( lIndex & 1 ) ? 0 : 8 ) ) & 0xff ;
+        int16 lMagnitude = ( ( ( lCode & 0x0f ) << 3 ) + TONE_CACHE_BIAS ) << ( ( lCode >> 4 ) & 7 ) ;
+
+        pOut [ i ] = ( lCode & 0x80 ) ? TONE_CACHE_BIAS - lMagnitude : lMagnitude - TONE_CACHE_BIAS ;
+    }
+}
+
+
+#ifdef TONE_CACHE
+
+#include "headset_debug.h"
+#include "headset_mixer.h"
+#include "headset_tone_queue.h"
+#include "headset_tone_scripts.h"
+#ifdef VOICE_VAD
+#include "headset_vad.h"
+#endif
+#ifdef TONE_SYNTH
+#include "headset_synth.h"
+#endif
+#ifdef VOICE_PROMPTS
+#include "headset_prompts.h"
+#include "headset_tones.h"
+#endif
+
+#include <app/message/system_message.h>
+#include <message.h>
+#include <pcm.h>
+#include <sink.h>
+#include <stream.h>
+#include <string.h>
+#include <vm.h>
+
+#ifdef DEBUG_TONE_CACHE
+    #define CACHE_DEBUG(x) DEBUG(x)
+#else
+    #define CACHE_DEBUG(x)
+#endif
+
+
+/* Samples decoded and written at a time, 4ms */
+#define TONE_CACHE_BLOCK        (32)
+
+#define TONE_CACHE_OCTETS       ( TONE_CACHE_BLOCK * MIXER_SAMPLE_OCTETS )
+
+/* Sent when the last block written should have been played */
+#define TONE_CACHE_DONE         (0)
+
+/* Allowance for the samples still in the codec's buffer at the end, ms */
+#define TONE_CACHE_DRAIN_MS     (10)
+
+
+static void toneCacheHandler ( Task pTask , MessageId pId , Message pMessage ) ;
+
+static TaskData             gTask = { toneCacheHandler } ;
+static Sink                 gSink = 0 ;
+static const toneCacheEntry_t * gEntry ;    /* Tone playing, 0 for a prompt */
+static uint32               gLength ;       /* Samples in it */
+static toneQueue_t          gQueue ;        /* It and the tones waiting to follow it */
+static uint32               gWritten ;      /* Samples of it written so far */
+static uint32               gEnd ;          /* VmGetClock when it will have played */
+static int16                gBlock [ TONE_CACHE_BLOCK ] ;
+#ifdef TONE_SYNTH
+static synthState_t         gSynth ;        /* Tone playing, if it has no table */
+#endif
+#ifdef VOICE_PROMPTS
+static promptState_t        gPrompt ;       /* Prompt playing */
+#endif
+
+
+/****************************************************************************
+  LOCAL FUNCTIONS
+*/
+
+static void toneCacheWrite ( uint16 pSamples )
+{
+    uint16 lOffset = SinkClaim ( gSink , TONE_CACHE_OCTETS ) ;
+    uint8 * lData ;
+
+    if ( lOffset == 0xffff )
+        return ;
+
+    lData = SinkMap ( gSink ) + lOffset ;
+    mixerPack ( gBlock , lData , pSamples ) ;
+
+        /*the last block is padded with silence*/
+    memset ( lData + pSamples * MIXER_SAMPLE_OCTETS , 0 , ( TONE_CACHE_BLOCK - pSamples ) * MIXER_SAMPLE_OCTETS ) ;
+
+    (void) SinkFlush ( gSink , TONE_CACHE_OCTETS ) ;
+}
+
+
+/* Decode the next pSamples samples of what is playing into gBlock,
+   returning how many there were */
+static uint16 toneCacheRender ( uint16 pSamples )
+{
+#ifdef VOICE_PROMPTS
+    if ( !gEntry )
+        return promptDecode ( &gPrompt , gBlock , pSamples ) ;
+#endif
+#ifdef TONE_SYNTH
+    if ( !gEntry->codes )
+        return synthRender ( &gSynth , gBlock , pSamples ) ;
+#endif
+    toneCacheDecode ( gEntry->codes , (uint16) gWritten , gBlock , pSamples ) ;
+    return pSamples ;
+}
+
+
+/* Decode and write as many blocks as the sink has room for. Once the last
+   is written the codec is released when it should have played out. */
+static void toneCacheFill ( void )
+{
+    while ( ( gWritten < gLength ) && ( SinkSlack ( gSink ) >= TONE_CACHE_OCTETS ) )
+    {
+        uint16 lSamples = ( gLength - gWritten > TONE_CACHE_BLOCK ) ? TONE_CACHE_BLOCK : (uint16) ( gLength - gWritten ) ;
+
+        lSamples = toneCacheRender ( lSamples ) ;
+        toneCacheWrite ( lSamples ) ;
+        gWritten += lSamples ;
+
+            /*the synth stops at a word it cannot read*/
+        if ( !lSamples )
+            gWritten = gLength ;
+
+        if ( gWritten >= gLength )
+        {
+            uint32 lNow = VmGetClock () ;
+            uint32 lLeft = ( (int32) ( gEnd - lNow ) > 0 ) ? gEnd - lNow : 0 ;
+
+            MessageSendLater ( &gTask , TONE_CACHE_DONE , 0 , lLeft + TONE_CACHE_DRAIN_MS ) ;
+        }
+    }
+}
+
+
+static void toneCacheStart ( HeadsetTone_t pTone )
+{
+    gWritten = 0 ;
+
+#ifdef VOICE_PROMPTS
+    if ( pTone >= PROMPT_TONE ( 0 ) )
+    {
+        const promptEntry_t * lEntry = &gPromptIndex [ pTone - PROMPT_TONE ( 0 ) ] ;
+
+        gEntry  = 0 ;
+        gLength = lEntry->samples ;
+        promptStart ( &gPrompt , gPromptImage , lEntry ) ;
+    }
+    else
+#endif
+    {
+        gEntry  = &gToneCache [ pTone - 1 ] ;
+        gLength = gEntry->samples ;
+    }
+
+#ifdef TONE_SYNTH
+    if ( gEntry && !gEntry->codes )
+    {
+        synthResult_t lResult ;
+
+        gLength = synthLength ( gFixedTones [ pTone - 1 ] , &lResult ) ;
+        synthStart ( &gSynth , gFixedTones [ pTone - 1 ] ) ;
+    }
+#endif
+
+    gEnd = VmGetClock () + ( gLength * 1000 ) / TONE_CACHE_RATE ;
+
+    CACHE_DEBUG(("CACHE: play %d, %ld samples\n" , pTone , gLength)) ;
+
+    if ( !gSink )
+    {
+#ifdef VOICE_VAD
+        vadCodecClaimed () ;
+#endif
+        (void) PcmRateAndRoute ( 0 , PCM_NO_SYNC , TONE_CACHE_RATE , TONE_CACHE_RATE , VM_PCM_INTERNAL_A_AND_B ) ;
+        gSink = StreamPcmSink ( 0 ) ;
+        (void) MessageSinkTask ( gSink , &gTask ) ;
+    }
+
+    toneCacheFill () ;
+}
+
+
+static void toneCacheRelease ( void )
+{
+    (void) MessageSinkTask ( gSink , NULL ) ;
+    PcmClearAllRouting () ;
+    gSink = 0 ;
+
+#ifdef VOICE_VAD
+    vadCodecReleased () ;
+#endif
+}
+
+
+static void toneCacheHandler ( Task pTask , MessageId pId , Message pMessage )
+{
+    if ( !gSink )
+        return ;
+
+    switch ( pId )
+    {
+    case MESSAGE_MORE_SPACE:
+        toneCacheFill () ;
+        break ;
+    case TONE_CACHE_DONE:
+    {
+        HeadsetTone_t lNext = toneQueueNext ( &gQueue ) ;
+
+        if ( lNext != TONE_NOT_DEFINED )
+        {
+            toneCacheStart ( lNext ) ;
+        }
+        else
+        {
+            CACHE_DEBUG(("CACHE: done\n")) ;
+            toneCacheRelease () ;
+        }
+        break ;
+    }
+    default:
+        break ;
+    }
+}
+
+
+/****************************************************************************
+  FUNCTIONS
+*/
+
+/**************************************************************************/
+bool toneCachePlay ( HeadsetTone_t pTone , bool pCanQueue )
+{
+#ifdef VOICE_PROMPTS
+    if ( pTone >= PROMPT_TONE ( 0 ) )
+    {
+        if ( ( pTone >= PROMPT_TONE ( NUM_PROMPTS ) ) || !gPromptIndex [ pTone - PROMPT_TONE ( 0 ) ].samples )
+            return FALSE ;
+    }
+    else
+#endif
+    if ( ( pTone == TONE_NOT_DEFINED ) || ( pTone > NUM_FIXED_TONES ) )
+        return FALSE ;
+
+#ifdef TONE_SYNTH
+    if ( ( pTone <= NUM_FIXED_TONES ) && !gToneCache [ pTone - 1 ].codes )
+    {
+        synthResult_t lResult ;
+
+            /*a script the synth cannot read whole is left to the firmware*/
+        if ( !synthLength ( gFixedTones [ pTone - 1 ] , &lResult ) || ( lResult != synthOk ) )
+            return FALSE ;
+    }
+#else
+    if ( ( pTone <= NUM_FIXED_TONES ) && !gToneCache [ pTone - 1 ].codes )
+        return FALSE ;
+#endif
+
+    switch ( toneQueuePush ( &gQueue , pTone , pCanQueue ) )
+    {
+    case toneQueueStart:
+        toneCacheStart ( pTone ) ;
+        break ;
+    case toneQueuePreempt:
+            /*the beep playing is cut short*/
+        (void) MessageCancelAll ( &gTask , TONE_CACHE_DONE ) ;
+        toneCacheStart ( pTone ) ;
+        break ;
+    case toneQueueQueued:
+        CACHE_DEBUG(("CACHE: %d queued\n" , pTone)) ;
+        break ;
+    default:
+        CACHE_DEBUG(("CACHE: busy, %d dropped\n" , pTone)) ;
+        break ;
+    }
+
+    return TRUE ;
+}
+
+
+/**************************************************************************/
+void toneCacheStop ( void )
+{
+    toneQueueInit ( &gQueue ) ;
+
+    if ( !gSink )
+        return ;
+
+    CACHE_DEBUG(("CACHE: stop\n")) ;
+
+    (void) MessageCancelAll ( &gTask , TONE_CACHE_DONE ) ;
+    toneCacheRelease () ;
+}
+
+#endif /* TONE_CACHE */
@@ -0,0 +1,122 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    headset_tone_cache.h
+@brief   Playback of the fixed tones from tables rendered at build time.
+
+    AudioPlayTone hands a tone's audio_note script to the firmware, which
+    interprets it note by note as the tone plays. With TONE_CACHE the
+    short tones - the connection, volume and confirmation beeps the rider
+    hears all the time - are instead rendered once, at build time, by
+    host/host_tone_compiler.c:
+
+        make -C host tone_tables
+
+    which writes headset_tone_tables.c from the scripts in
+    headset_tone_scripts.c: each tone no longer than TONE_CACHE_MAX_MS as
+    8 bit mu-law PCM, two samples to a word since the XAP addresses words
+    rather than octets, with an index of them by tone. Mu-law keeps the
+    pure tones some 37dB above its noise at half the size of 16 bit PCM,
+    where 4 bit ADPCM manages only 15 to 25dB on them. The file must be
+    made again whenever a script changes.
+
+    A cached tone is streamed from its table straight into the codec, a
+    block at a time as the sink takes them, so it starts as soon as the
+    first block is written. This is done only while the codec is not in
+    use by a plugin or the conference; otherwise, and for the tones too
+    long to cache, AudioPlayTone is used as before. With TONE_SYNTH as
+    well, the tones too long to cache are synthesised from their scripts
+    as they stream (headset_synth.h) rather than given to AudioPlayTone.
+    With VOICE_PROMPTS the voice prompts (headset_prompts.h) are streamed
+    the same way, decoded from their ADPCM a block at a time.
+*/
+
+#ifndef _HEADSET_TONE_CACHE_H_
+#define _HEADSET_TONE_CACHE_H_
+
+
+#include <csrtypes.h>
+
+
+/* Longest tone rendered into a table: the connection, volume and
+   confirmation beeps are, the power-on, error and ring tones are not */
+#define TONE_CACHE_MAX_MS       (400)
+
+/* Sample rate of the tables */
+#define TONE_CACHE_RATE         (8000)
+
+/* Samples packed in each word, the first in the top octet */
+#define TONE_CACHE_PER_WORD     (2)
+
+/* Words that hold pSamples samples */
+#define TONE_CACHE_WORDS(pSamples)  ( ( (pSamples) + TONE_CACHE_PER_WORD - 1 ) / TONE_CACHE_PER_WORD )
+
+
+/*! @brief Table of one tone, as written by host/host_tone_compiler.c */
+typedef struct
+{
+    const uint16 *  codes ;     /*!< Packed mu-law samples, 0 if the tone is not cached */
+    uint16          samples ;   /*!< Samples in the tone */
+} toneCacheEntry_t ;
+
+
+/****************************************************************************
+  FUNCTIONS
+*/
+
+/*************************************************************************
+NAME
+    toneCacheDecode
+
+DESCRIPTION
+    Expand pSamples mu-law samples of a table, from sample pFirst, into
+    pOut.
+
+*/
+void toneCacheDecode ( const uint16 * pCodes , uint16 pFirst , int16 * pOut , uint16 pSamples ) ;
+
+
+#ifdef TONE_CACHE
+
+#include "headset_private.h"
+
+/* Tables of the fixed tones, indexed by HeadsetTone_t - 1 (headset_tone_tables.c) */
+extern const toneCacheEntry_t gToneCache [] ;
+
+
+/*************************************************************************
+NAME
+    toneCachePlay
+
+DESCRIPTION
+    Play pTone from its table, or the prompt it stands for, through the
+    codec which the caller has found free. If a cached tone is already
+    playing pTone is queued by priority, coalesced or dropped (see
+    headset_tone_queue.h).
+
+RETURNS
+    FALSE if pTone has no table, or with TONE_SYNTH a script the synth
+    cannot read, when it should be given to AudioPlayTone; or if it is a
+    prompt that was not recorded.
+*/
+bool toneCachePlay ( HeadsetTone_t pTone , bool pCanQueue ) ;
+
+
+/*************************************************************************
+NAME
+    toneCacheStop
+
+DESCRIPTION
+    Stop the cached tone playing, if any, and the one queued after it, and
+    release the codec. Called before a plugin or the conference takes the
+    codec.
+
+*/
+void toneCacheStop ( void ) ;
+
+#endif /* TONE_CACHE */
+
+
+#endif /* _HEADSET_TONE_CACHE_H_ */
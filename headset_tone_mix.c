@@ -0,0 +1,185 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    headset_tone_mix.c
+@brief   Implementation of the mixing of tones into the audio playing.
+*/
+
+/****************************************************************************
+    Header files
+*/
+
+#include "headset_tone_mix.h"
+
+#ifdef TONE_MIX
+
+#include "headset_debug.h"
+#include "headset_mixer.h"
+#include "headset_tone_cache.h"
+#include "headset_tone_queue.h"
+#include "headset_tone_scripts.h"
+
+#include <string.h>
+#include <vm.h>
+
+#ifdef DEBUG_TONE_MIX
+    #define MIX_DEBUG(x) DEBUG(x)
+#else
+    #define MIX_DEBUG(x)
+#endif
+
+
+/* Change of the duck gain each frame */
+#define TONE_MIX_DUCK_STEP      ( ( MIXER_GAIN_UNITY - TONE_MIX_DUCK ) / TONE_MIX_DUCK_FRAMES )
+
+
+static uint32 gPluginEnd ;      /* VmGetClock when the tones given to the plugin will have played */
+
+
+/**************************************************************************/
+bool toneMixAdmit ( HeadsetTone_t pTone , bool pCanQueue )
+{
+    uint32 lNow = VmGetClock () ;
+    bool lBusy = ( (int32) ( gPluginEnd - lNow ) > 0 ) ;
+    uint32 lLength = TONE_MIX_UNKNOWN_MS ;
+
+    if ( lBusy && ( toneQueuePriority ( pTone ) == tonePriorityLow ) )
+    {
+        MIX_DEBUG(("MIX: plugin busy, %d dropped\n" , pTone)) ;
+        return FALSE ;
+    }
+
+    if ( ( pTone != TONE_NOT_DEFINED ) && ( pTone <= NUM_FIXED_TONES ) && gToneCache [ pTone - 1 ].codes )
+        lLength = ( (uint32) gToneCache [ pTone - 1 ].samples * 1000 ) / TONE_CACHE_RATE ;
+
+        /*a tone AudioPlayTone will not queue does not add to the time*/
+    if ( !lBusy )
+        gPluginEnd = lNow + lLength ;
+    else if ( pCanQueue )
+        gPluginEnd += lLength ;
+
+    return TRUE ;
+}
+
+
+#ifdef CONFERENCE_FRAME_PATH
+
+static toneQueue_t              gQueue ;
+static const toneCacheEntry_t * gEntry ;        /* Tone being mixed, 0 if none */
+static uint16                   gPosition ;     /* Samples of it mixed so far */
+static uint16                   gDuck = MIXER_GAIN_UNITY ;
+static int16                    gTone [ MIXER_MAX_FRAME ] ;
+static int16                    gMixed [ MIXER_MAX_FRAME ] ;
+
+
+/****************************************************************************
+  LOCAL FUNCTIONS
+*/
+
+static void toneMixStart ( HeadsetTone_t pTone )
+{
+    MIX_DEBUG(("MIX: play %d\n" , pTone)) ;
+
+    gEntry    = &gToneCache [ pTone - 1 ] ;
+    gPosition = 0 ;
+}
+
+
+/****************************************************************************
+  FUNCTIONS
+*/
+
+/**************************************************************************/
+bool toneMixPlay ( HeadsetTone_t pTone , bool pCanQueue )
+{
+    if ( ( pTone == TONE_NOT_DEFINED ) || ( pTone > NUM_FIXED_TONES ) || !gToneCache [ pTone - 1 ].codes )
+        return FALSE ;
+
+    switch ( toneQueuePush ( &gQueue , pTone , pCanQueue ) )
+    {
+    case toneQueueStart:
+    case toneQueuePreempt:
+        toneMixStart ( pTone ) ;
+        break ;
+    case toneQueueQueued:
+        MIX_DEBUG(("MIX: %d queued\n" , pTone)) ;
+        break ;
+    default:
+        MIX_DEBUG(("MIX: %d dropped\n" , pTone)) ;
+        break ;
+    }
+
+    return TRUE ;
+}
+
+
+/**************************************************************************/
+void toneMixFrame ( int16 * pFrame , uint16 pSamples )
+{
+    mixerSource_t lSources [ 2 ] ;
+    uint16 lTarget = gEntry ? TONE_MIX_DUCK : MIXER_GAIN_UNITY ;
+    uint16 i ;
+
+    if ( !gEntry && ( gDuck == MIXER_GAIN_UNITY ) )
+        return ;
+
+        /*the audio is lowered and raised a step a frame*/
+    if ( gDuck > lTarget )
+        gDuck = ( gDuck - lTarget > TONE_MIX_DUCK_STEP ) ? gDuck - TONE_MIX_DUCK_STEP : lTarget ;
+    else if ( gDuck < lTarget )
+        gDuck = ( lTarget - gDuck > TONE_MIX_DUCK_STEP ) ? gDuck + TONE_MIX_DUCK_STEP : lTarget ;
+
+    lSources [ 0 ].samples  = pFrame ;
+    lSources [ 0 ].gain     = gDuck ;
+    lSources [ 0 ].duckable = FALSE ;
+    lSources [ 0 ].ducking  = FALSE ;
+
+    lSources [ 1 ].samples  = NULL ;
+    lSources [ 1 ].gain     = TONE_MIX_GAIN ;
+    lSources [ 1 ].duckable = FALSE ;
+    lSources [ 1 ].ducking  = FALSE ;
+
+    if ( gEntry )
+    {
+        uint16 lCount = gEntry->samples - gPosition ;
+
+        if ( lCount > pSamples )
+            lCount = pSamples ;
+
+        toneCacheDecode ( gEntry->codes , gPosition , gTone , lCount ) ;
+        for ( i = lCount ; i < pSamples ; i++ )
+            gTone [ i ] = 0 ;
+
+        lSources [ 1 ].samples = gTone ;
+        gPosition += lCount ;
+    }
+
+    mixerMix ( lSources , 2 , gMixed , pSamples , MIXER_GAIN_UNITY ) ;
+    memcpy ( pFrame , gMixed , pSamples * sizeof ( int16 ) ) ;
+
+    if ( gEntry && ( gPosition >= gEntry->samples ) )
+    {
+        HeadsetTone_t lNext = toneQueueNext ( &gQueue ) ;
+
+        gEntry = 0 ;
+        if ( lNext != TONE_NOT_DEFINED )
+            toneMixStart ( lNext ) ;
+    }
+}
+
+
+/**************************************************************************/
+void toneMixStop ( void )
+{
+    MIX_DEBUG(("MIX: stop\n")) ;
+
+    toneQueueInit ( &gQueue ) ;
+    gEntry = 0 ;
+    gDuck  = MIXER_GAIN_UNITY ;
+}
+
+#endif /* CONFERENCE_FRAME_PATH */
+
+#endif /* TONE_MIX */
@@ -0,0 +1,118 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    headset_tone_mix.h
+@brief   Tones mixed into the audio that is playing rather than replacing it.
+
+    AudioPlayTone takes the codec for a tone, so a tone played while the
+    conference carries the intercom competes with it for the PCM port and
+    the riders' voices break up under every beep. With TONE_MIX, which
+    needs TONE_CACHE for its tables, such a tone is instead mixed into the
+    frame the local rider hears, one frame at a time in the conference
+    pump. The voices are ducked by TONE_MIX_DUCK under the tone, lowered
+    and raised again over a few frames so the step is not heard, and the
+    tones wait in a priority queue (see headset_tone_queue.h) so that
+    volume beeps are coalesced rather than strung out.
+
+    While music plays the A2DP plugin mixes AudioPlayTone's tones into the
+    stream itself, at PSKEY_A2DP_TONE_VOLUME, and the VM never sees the
+    samples. There only the queue's rules are applied, ahead of
+    AudioPlayTone: a low priority beep is dropped while an earlier tone is
+    still sounding, judged from the length of its table.
+*/
+
+#ifndef _HEADSET_TONE_MIX_H_
+#define _HEADSET_TONE_MIX_H_
+
+
+#include "headset_mixer.h"
+
+#include <csrtypes.h>
+
+
+/* Q12 gain of the audio under a tone, -12dB */
+#define TONE_MIX_DUCK           ( MIXER_GAIN_UNITY / 4 )
+
+/* Frames the audio is ducked and restored over, 15ms */
+#define TONE_MIX_DUCK_FRAMES    (4)
+
+/* Q12 gain of the tone, whose table is already at the tone's volume */
+#define TONE_MIX_GAIN           ( MIXER_GAIN_UNITY )
+
+/* Length assumed for a tone handed to the plugin that has no table, ms */
+#define TONE_MIX_UNKNOWN_MS     (1000)
+
+
+#ifdef TONE_MIX
+
+#include "headset_conference.h"
+#include "headset_private.h"
+
+
+/****************************************************************************
+  FUNCTIONS
+*/
+
+/*************************************************************************
+NAME
+    toneMixAdmit
+
+DESCRIPTION
+    Decide whether pTone is to be given to AudioPlayTone while the A2DP
+    plugin mixes the tones, and note how long it will sound if so.
+
+RETURNS
+    FALSE if it is a beep to be dropped.
+*/
+bool toneMixAdmit ( HeadsetTone_t pTone , bool pCanQueue ) ;
+
+
+#ifdef CONFERENCE_FRAME_PATH
+
+/*************************************************************************
+NAME
+    toneMixPlay
+
+DESCRIPTION
+    Mix pTone into the conference, now or when the tones ahead of it in
+    the queue have played.
+
+RETURNS
+    FALSE if pTone has no table, when it should be given to AudioPlayTone.
+*/
+bool toneMixPlay ( HeadsetTone_t pTone , bool pCanQueue ) ;
+
+
+/*************************************************************************
+NAME
+    toneMixFrame
+
+DESCRIPTION
+    Mix the next pSamples samples (at most MIXER_MAX_FRAME) of the tone
+    playing into pFrame, ducking it. Called by the conference for the
+    frame the local rider hears; does nothing once no tone is playing and
+    the duck is restored.
+
+*/
+void toneMixFrame ( int16 * pFrame , uint16 pSamples ) ;
+
+
+/*************************************************************************
+NAME
+    toneMixStop
+
+DESCRIPTION
+    Stop the tone being mixed, if any, and those waiting. Called as the
+    conference stops.
+
+*/
+void toneMixStop ( void ) ;
+
+#endif /* CONFERENCE_FRAME_PATH */
+
+#endif /* TONE_MIX */
+
+
+#endif /* _HEADSET_TONE_MIX_H_ */
@@ -0,0 +1,148 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    headset_tone_queue.c
+@brief   Implementation of the priority queue of tones.
+*/
+
+/****************************************************************************
+    Header files
+*/
+
+#include "headset_tone_queue.h"
+
+
+/* Priorities of the fixed tones, in the order of gFixedTones */
+static const uint16 gPriority [] =
+{
+/*1*/    tonePriorityHigh ,      /* power */
+/*2*/    tonePriorityNormal ,    /* pairing */
+/*3*/    tonePriorityNormal ,    /* inactive */
+/*4*/    tonePriorityNormal ,    /* active */
+/*5*/    tonePriorityHigh ,      /* battery */
+/*6*/    tonePriorityLow ,       /* volume limit */
+/*7*/    tonePriorityNormal ,    /* connection */
+/*8*/    tonePriorityHigh ,      /* error */
+/*9*/    tonePriorityLow ,       /* short */
+/*a*/    tonePriorityNormal ,    /* long */
+/*b*/    tonePriorityNormal ,    /* mute reminder */
+/*c*/    tonePriorityHigh ,      /* rings */
+/*d*/    tonePriorityHigh ,
+/*e*/    tonePriorityHigh
+} ;
+
+
+/****************************************************************************
+  LOCAL FUNCTIONS
+*/
+
+static bool toneQueueHas ( const toneQueue_t * pQueue , uint16 pTone )
+{
+    uint16 i ;
+
+    for ( i = 0 ; i < pQueue->count ; i++ )
+    {
+        if ( pQueue->waiting [ i ] == pTone )
+            return TRUE ;
+    }
+    return FALSE ;
+}
+
+
+/****************************************************************************
+  FUNCTIONS
+*/
+
+/**************************************************************************/
+void toneQueueInit ( toneQueue_t * pQueue )
+{
+    pQueue->playing = TONE_QUEUE_NONE ;
+    pQueue->count   = 0 ;
+}
+
+
+/**************************************************************************/
+tonePriority_t toneQueuePriority ( uint16 pTone )
+{
+    if ( ( pTone == TONE_QUEUE_NONE ) || ( pTone > sizeof ( gPriority ) / sizeof ( gPriority [ 0 ] ) ) )
+        return tonePriorityNormal ;
+
+    return (tonePriority_t) gPriority [ pTone - 1 ] ;
+}
+
+
+/**************************************************************************/
+toneQueueResult_t toneQueuePush ( toneQueue_t * pQueue , uint16 pTone , bool pCanQueue )
+{
+    tonePriority_t lPriority = toneQueuePriority ( pTone ) ;
+    tonePriority_t lPlaying ;
+    uint16 i ;
+
+    if ( pQueue->playing == TONE_QUEUE_NONE )
+    {
+        pQueue->playing = pTone ;
+        return toneQueueStart ;
+    }
+
+    lPlaying = toneQueuePriority ( pQueue->playing ) ;
+
+        /*a beep is cut short rather than waited for*/
+    if ( ( lPlaying == tonePriorityLow ) && ( lPriority > tonePriorityLow ) )
+    {
+        pQueue->playing = pTone ;
+        return toneQueuePreempt ;
+    }
+
+    if ( lPriority == tonePriorityLow )
+    {
+        if ( ( pQueue->playing == pTone ) || toneQueueHas ( pQueue , pTone ) )
+            return toneQueueCoalesced ;
+
+        if ( ( lPlaying > tonePriorityLow ) ||
+             ( pQueue->count && ( toneQueuePriority ( pQueue->waiting [ 0 ] ) > tonePriorityLow ) ) )
+            return toneQueueDropped ;
+    }
+
+    if ( !pCanQueue )
+        return toneQueueDropped ;
+
+        /*when full the last, of the lowest priority, makes way for a higher one*/
+    if ( pQueue->count == TONE_QUEUE_SIZE )
+    {
+        if ( toneQueuePriority ( pQueue->waiting [ TONE_QUEUE_SIZE - 1 ] ) >= lPriority )
+            return toneQueueDropped ;
+
+        pQueue->count-- ;
+    }
+
+    for ( i = pQueue->count ; ( i > 0 ) && ( toneQueuePriority ( pQueue->waiting [ i - 1 ] ) < lPriority ) ; i-- )
+        pQueue->waiting [ i ] = pQueue->waiting [ i - 1 ] ;
+
+    pQueue->waiting [ i ] = pTone ;
+    pQueue->count++ ;
+
+    return toneQueueQueued ;
+}
+
+
+/**************************************************************************/
+uint16 toneQueueNext ( toneQueue_t * pQueue )
+{
+    uint16 i ;
+
+    if ( !pQueue->count )
+    {
+        pQueue->playing = TONE_QUEUE_NONE ;
+        return TONE_QUEUE_NONE ;
+    }
+
+    pQueue->playing = pQueue->waiting [ 0 ] ;
+    pQueue->count-- ;
+
+    for ( i = 0 ; i < pQueue->count ; i++ )
+        pQueue->waiting [ i ] = pQueue->waiting [ i + 1 ] ;
+
+    return pQueue->playing ;
+}
@@ -0,0 +1,116 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    headset_tone_queue.h
+@brief   Priority queue of the tones waiting to be played.
+
+    Each fixed tone has a priority: the ring, power, battery and error
+    tones are high, the volume and short confirmation beeps low, and the
+    rest normal. A tone that may wait is queued behind those of its own
+    priority and ahead of those of lower priority. A low priority beep is
+    coalesced with the same beep already playing or waiting, and dropped
+    while a tone of higher priority is playing or waiting, so holding the
+    volume button gives one beep rather than a train of them. A tone of
+    higher priority cuts a low priority beep short instead of waiting for
+    it. Used by the tone cache and the tone mix, which play the tones
+    themselves; AudioPlayTone keeps its own queue.
+*/
+
+#ifndef _HEADSET_TONE_QUEUE_H_
+#define _HEADSET_TONE_QUEUE_H_
+
+
+#include <csrtypes.h>
+
+
+/* Tones that can wait behind the one playing */
+#define TONE_QUEUE_SIZE         (4)
+
+/* No tone, as TONE_NOT_DEFINED */
+#define TONE_QUEUE_NONE         (0)
+
+
+/*! @brief Priority of a tone */
+typedef enum
+{
+    tonePriorityLow ,
+    tonePriorityNormal ,
+    tonePriorityHigh
+} tonePriority_t ;
+
+/*! @brief What became of a tone given to the queue */
+typedef enum
+{
+    toneQueueStart ,        /*!< Nothing was playing: play it now */
+    toneQueuePreempt ,      /*!< It cuts short the beep playing: play it now */
+    toneQueueQueued ,       /*!< It will play after those ahead of it */
+    toneQueueCoalesced ,    /*!< The same beep is already playing or waiting */
+    toneQueueDropped        /*!< It is outranked, may not wait, or there is no room */
+} toneQueueResult_t ;
+
+/*! @brief The tone playing and those waiting */
+typedef struct
+{
+    uint16  playing ;                       /*!< TONE_QUEUE_NONE when idle */
+    uint16  count ;
+    uint16  waiting [ TONE_QUEUE_SIZE ] ;   /*!< Highest priority first, in order of arrival within one */
+} toneQueue_t ;
+
+
+/****************************************************************************
+  FUNCTIONS
+*/
+
+/*************************************************************************
+NAME
+    toneQueueInit
+
+DESCRIPTION
+    Empty the queue, with nothing playing.
+
+*/
+void toneQueueInit ( toneQueue_t * pQueue ) ;
+
+
+/*************************************************************************
+NAME
+    toneQueuePriority
+
+DESCRIPTION
+    Returns the priority of fixed tone pTone.
+
+*/
+tonePriority_t toneQueuePriority ( uint16 pTone ) ;
+
+
+/*************************************************************************
+NAME
+    toneQueuePush
+
+DESCRIPTION
+    Offer pTone to the queue. pCanQueue is FALSE for a tone that is to be
+    dropped rather than wait, as AudioPlayTone takes it.
+
+RETURNS
+    What became of it: on toneQueueStart and toneQueuePreempt it is now
+    the tone playing and the caller must start it.
+*/
+toneQueueResult_t toneQueuePush ( toneQueue_t * pQueue , uint16 pTone , bool pCanQueue ) ;
+
+
+/*************************************************************************
+NAME
+    toneQueueNext
+
+DESCRIPTION
+    Called when the tone playing has ended.
+
+RETURNS
+    The tone to play next, now the one playing, or TONE_QUEUE_NONE.
+*/
+uint16 toneQueueNext ( toneQueue_t * pQueue ) ;
+
+
+#endif /* _HEADSET_TONE_QUEUE_H_ */
@@ -0,0 +1,240 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    headset_tone_scripts.c
+@brief    The audio_note scripts of the fixed tones.
+
+    Kept apart from headset_tones.c so that host/host_tone_compiler.c can
+    render the same scripts into the tables of the tone cache.
+*/
+
+#include "headset_tone_scripts.h"
+
+/****************************************************************/
+/*
+    SIMPLE TONES
+ */
+/****************************************************************/
+
+/* eg. power tone */
+static const audio_note tone_power[] =
+{
+    AUDIO_TEMPO(120), AUDIO_VOLUME(64), AUDIO_TIMBRE(sine),
+    
+    AUDIO_NOTE(REST, HEMIDEMISEMIQUAVER),        
+    AUDIO_NOTE(G7,   CROTCHET), 
+    
+    AUDIO_END
+};
+
+/* eg. pairing tone */
+static const audio_note tone_pairing[] =
+{
+    AUDIO_TEMPO(2400), AUDIO_VOLUME(64), AUDIO_TIMBRE(sine),
+    
+    AUDIO_NOTE(REST, CROTCHET),
+    AUDIO_NOTE(G5 , SEMIBREVE),
+    AUDIO_NOTE(REST, CROTCHET),
+    AUDIO_NOTE(REST, QUAVER),
+    AUDIO_NOTE(G5 , SEMIBREVE),
+    
+    AUDIO_END
+};
+
+/* eg. mute off */
+static const audio_note tone_inactive[] =
+{
+    AUDIO_TEMPO(2400), AUDIO_VOLUME(64), AUDIO_TIMBRE(sine),
+    
+    AUDIO_NOTE(REST, CROTCHET),
+    AUDIO_NOTE(G6 , SEMIBREVE),
+    AUDIO_NOTE(REST, CROTCHET),
+    AUDIO_NOTE(C7 , SEMIBREVE),
+    
+    AUDIO_END
+};
+
+/* eg. mute on */
+static const audio_note tone_active[] =
+{
+    AUDIO_TEMPO(2400), AUDIO_VOLUME(64), AUDIO_TIMBRE(sine),
+    
+    AUDIO_NOTE(REST, CROTCHET),
+    AUDIO_NOTE(G6 , SEMIBREVE),
+    AUDIO_NOTE(REST, CROTCHET),
+    AUDIO_NOTE(G5 , SEMIBREVE),
+    
+    AUDIO_END
+};
+
+/* eg. battery low */
+static const audio_note tone_battery[] =
+{
+    AUDIO_TEMPO(120), AUDIO_VOLUME(64), AUDIO_TIMBRE(sine),
+    
+    AUDIO_NOTE(REST, HEMIDEMISEMIQUAVER),
+    AUDIO_NOTE(G6 , CROTCHET),
+    AUDIO_NOTE(REST, HEMIDEMISEMIQUAVER),
+    AUDIO_NOTE(G6 , CROTCHET),
+    AUDIO_NOTE(REST, HEMIDEMISEMIQUAVER),
+    AUDIO_NOTE(G6 , CROTCHET),
+    
+    AUDIO_END
+};
+
+/* eg. vol limit */
+static const audio_note tone_vol[] =
+{
+    AUDIO_TEMPO(600), AUDIO_VOLUME(64), AUDIO_TIMBRE(sine),
+    AUDIO_NOTE(REST, SEMIQUAVER),
+    AUDIO_TEMPO(200), AUDIO_VOLUME(64), AUDIO_TIMBRE(sine),
+    AUDIO_NOTE(G7 , CROTCHET),
+    
+    AUDIO_END
+};
+
+/* eg. connection */
+static const audio_note tone_connection[] =
+{
+    AUDIO_TEMPO(2400), AUDIO_VOLUME(64), AUDIO_TIMBRE(sine),
+    
+    AUDIO_NOTE(REST, CROTCHET),
+    AUDIO_NOTE(G7 , SEMIBREVE),
+    
+    AUDIO_END
+};
+
+/* error tone */
+static const audio_note tone_error[] =
+{
+    AUDIO_TEMPO(120), AUDIO_VOLUME(64), AUDIO_TIMBRE(sine),
+    
+    AUDIO_NOTE(REST, HEMIDEMISEMIQUAVER),
+    AUDIO_NOTE(G5 , CROTCHET),
+    
+    AUDIO_END
+};
+
+/* short confirmation */
+static const audio_note tone_short[] =
+{
+    AUDIO_TEMPO(2400), AUDIO_VOLUME(64), AUDIO_TIMBRE(sine),
+    
+    AUDIO_NOTE(REST, CROTCHET),
+    AUDIO_NOTE(G6 , SEMIBREVE),
+    
+    AUDIO_END
+};
+
+/* long confirmation */
+static const audio_note tone_long[] =
+{
+    AUDIO_TEMPO(1200), AUDIO_VOLUME(64), AUDIO_TIMBRE(sine),  
+    AUDIO_NOTE(REST, QUAVER),
+    AUDIO_TEMPO(150), AUDIO_VOLUME(64), AUDIO_TIMBRE(sine), 
+    AUDIO_NOTE(G6 , MINIM),
+    
+    AUDIO_END
+};
+
+#ifdef FAVORITES_CALL
+static const audio_note tone_mute_reminder[] =
+{
+    AUDIO_TEMPO(1), AUDIO_VOLUME(128), AUDIO_TIMBRE(sine),
+    AUDIO_NOTE(G7 , SEMIBREVE), 
+
+    AUDIO_END
+};
+#else
+static const audio_note tone_mute_reminder[] =
+{
+    AUDIO_TEMPO(600), AUDIO_VOLUME(64), AUDIO_TIMBRE(sine),
+    AUDIO_NOTE(REST, SEMIQUAVER),
+    AUDIO_TEMPO(120), AUDIO_VOLUME(64), AUDIO_TIMBRE(sine),
+    AUDIO_NOTE(G5, CROTCHET),
+    AUDIO_NOTE(REST, CROTCHET),
+    AUDIO_NOTE(G5, CROTCHET),
+    AUDIO_END
+};
+#endif
+
+/* ringtone 1 */
+static const audio_note ring_twilight[] =
+{
+    AUDIO_TEMPO(180), AUDIO_VOLUME(64), AUDIO_TIMBRE(sine),
+    
+    AUDIO_NOTE(E7, QUAVER),
+    AUDIO_NOTE(F7, QUAVER),
+    AUDIO_NOTE(E7, QUAVER),
+    AUDIO_NOTE(C7, QUAVER),
+    AUDIO_NOTE(E7, QUAVER),
+    AUDIO_NOTE(F7, QUAVER),
+    AUDIO_NOTE(E7, QUAVER),
+    AUDIO_NOTE(C7, QUAVER),
+
+    AUDIO_END
+};
+
+/* ringtone 2 */
+static const audio_note ring_greensleeves[] =
+{
+    AUDIO_TEMPO(400), AUDIO_VOLUME(64), AUDIO_TIMBRE(sine),
+              
+    AUDIO_NOTE(F6,CROTCHET),                                  
+    AUDIO_NOTE(AF6,MINIM),                                            
+    AUDIO_NOTE(BF6,CROTCHET),                         
+    AUDIO_NOTE(C7,CROTCHET),                          
+    AUDIO_NOTE_TIE(C7,QUAVER),                                            
+    AUDIO_NOTE(DF7,QUAVER),                           
+    AUDIO_NOTE(C7,CROTCHET),                                          
+    AUDIO_NOTE(BF6,MINIM),                            
+    AUDIO_NOTE(G6,CROTCHET),          
+    AUDIO_NOTE(EF6,CROTCHET), 
+    AUDIO_NOTE_TIE(EF6,QUAVER),
+       
+    AUDIO_END
+};
+
+/* ringtone 3 */
+static const audio_note ring_major_scale[] =
+{
+    AUDIO_TEMPO(300), AUDIO_VOLUME(64), AUDIO_TIMBRE(sine),
+
+    AUDIO_NOTE(E6,QUAVER),                                    
+    AUDIO_NOTE(FS6,QUAVER),                                           
+    AUDIO_NOTE(GS6,QUAVER),                           
+    AUDIO_NOTE(A6,QUAVER),                            
+    AUDIO_NOTE(B6,QUAVER),                                            
+    AUDIO_NOTE(CS7,QUAVER),                           
+    AUDIO_NOTE(DS7,QUAVER),                                           
+    AUDIO_NOTE(E7,QUAVER),    
+
+    AUDIO_END
+};
+
+/***************************************************************************/
+/*
+    The Tone Array
+*/
+/*************************************************************************/
+
+/* This must make use of all of the defined tones - requires the extra space first */
+const audio_note * const gFixedTones [ NUM_FIXED_TONES ] = 
+{
+/*1*/    tone_power,
+/*2*/    tone_pairing,
+/*3*/    tone_inactive,
+/*4*/    tone_active,
+/*5*/    tone_battery,
+/*6*/    tone_vol,
+/*7*/    tone_connection, 
+/*8*/    tone_error,
+/*9*/    tone_short,
+/*a*/    tone_long,		
+/*b*/	 tone_mute_reminder,
+/*c*/    ring_twilight,
+/*d*/    ring_greensleeves,
+/*e*/    ring_major_scale
+};    
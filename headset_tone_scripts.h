@@ -0,0 +1,24 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    headset_tone_scripts.h
+@brief   The audio_note scripts of the fixed tones, indexed by HeadsetTone_t - 1.
+*/
+
+#ifndef _HEADSET_TONE_SCRIPTS_H_
+#define _HEADSET_TONE_SCRIPTS_H_
+
+
+#include <audio.h>
+
+
+#define NUM_FIXED_TONES (14)
+
+
+/* Script of each fixed tone, tone_id_power first */
+extern const audio_note * const gFixedTones [ NUM_FIXED_TONES ] ;
+
+
+#endif /* _HEADSET_TONE_SCRIPTS_H_ */
@@ -9,9 +9,19 @@ Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
 
 #include "headset_amp.h"
 #include "headset_debug.h"
+#include "headset_tone_cache.h"
+#include "headset_tone_mix.h"
+#include "headset_tone_scripts.h"
 #include "headset_tones.h"
+#include "headset_volume.h"
+#ifdef VOICE_PROMPTS
+#include "headset_prompts.h"
+#endif
 
 #include <audio.h>
+#ifdef TONE_CACHE
+#include <codec.h>
+#endif
 #if 0 /* Jace_Test */
 #include <csr_cvsd_8k_cvc_1mic_headset_plugin.h>
 #endif
@@ -27,234 +37,47 @@ Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
 #define TONE_TYPE_RING (0x60FF)
 
 
-/****************************************************************/
-/*
-    SIMPLE TONES
- */
-/****************************************************************/
-
-/* eg. power tone */
-static const audio_note tone_power[] =
+/* Tones of the intercom indications, which have no configuration of their own */
+static const HeadsetTone_t gIntercomTones [] =
 {
-    AUDIO_TEMPO(120), AUDIO_VOLUME(64), AUDIO_TIMBRE(sine),
-    
-    AUDIO_NOTE(REST, HEMIDEMISEMIQUAVER),        
-    AUDIO_NOTE(G7,   CROTCHET), 
-    
-    AUDIO_END
-};
+    tone_id_connection ,    /* EventIntercomConnected */
+    tone_id_short ,         /* EventIntercomDisconnected */
+    tone_id_error           /* EventIntercomFailed */
+} ;
 
-/* eg. pairing tone */
-static const audio_note tone_pairing[] =
-{
-    AUDIO_TEMPO(2400), AUDIO_VOLUME(64), AUDIO_TIMBRE(sine),
-    
-    AUDIO_NOTE(REST, CROTCHET),
-    AUDIO_NOTE(G5 , SEMIBREVE),
-    AUDIO_NOTE(REST, CROTCHET),
-    AUDIO_NOTE(REST, QUAVER),
-    AUDIO_NOTE(G5 , SEMIBREVE),
-    
-    AUDIO_END
-};
-
-/* eg. mute off */
-static const audio_note tone_inactive[] =
-{
-    AUDIO_TEMPO(2400), AUDIO_VOLUME(64), AUDIO_TIMBRE(sine),
-    
-    AUDIO_NOTE(REST, CROTCHET),
-    AUDIO_NOTE(G6 , SEMIBREVE),
-    AUDIO_NOTE(REST, CROTCHET),
-    AUDIO_NOTE(C7 , SEMIBREVE),
-    
-    AUDIO_END
-};
+#ifdef VOICE_PROMPTS
 
-/* eg. mute on */
-static const audio_note tone_active[] =
+/*! @brief An event spoken by default */
+typedef struct
 {
-    AUDIO_TEMPO(2400), AUDIO_VOLUME(64), AUDIO_TIMBRE(sine),
-    
-    AUDIO_NOTE(REST, CROTCHET),
-    AUDIO_NOTE(G6 , SEMIBREVE),
-    AUDIO_NOTE(REST, CROTCHET),
-    AUDIO_NOTE(G5 , SEMIBREVE),
-    
-    AUDIO_END
-};
+    headsetEvents_t event ;
+    prompt_t        prompt ;
+} eventPrompt_t ;
 
-/* eg. battery low */
-static const audio_note tone_battery[] =
+static const eventPrompt_t gEventPrompts [] =
 {
-    AUDIO_TEMPO(120), AUDIO_VOLUME(64), AUDIO_TIMBRE(sine),
-    
-    AUDIO_NOTE(REST, HEMIDEMISEMIQUAVER),
-    AUDIO_NOTE(G6 , CROTCHET),
-    AUDIO_NOTE(REST, HEMIDEMISEMIQUAVER),
-    AUDIO_NOTE(G6 , CROTCHET),
-    AUDIO_NOTE(REST, HEMIDEMISEMIQUAVER),
-    AUDIO_NOTE(G6 , CROTCHET),
-    
-    AUDIO_END
-};
-
-/* eg. vol limit */
-static const audio_note tone_vol[] =
+    { EventIntercomConnected ,      promptIntercomConnected } ,
+    { EventIntercomDisconnected ,   promptIntercomDisconnected } ,
+    { EventIntercomFailed ,         promptIntercomFailed } ,
+    { EventPairingSuccessful ,      promptPhonePaired } ,
+    { EventSLCConnected ,           promptPhoneConnected } ,
+    { EventLowBattery ,             promptBatteryLow }
+} ;
+
+/* Tone played for each prompt while the codec is taken or if it was not
+   recorded: the one configured for its event, if any */
+static HeadsetTone_t gPromptTones [ NUM_PROMPTS ] =
 {
-    AUDIO_TEMPO(600), AUDIO_VOLUME(64), AUDIO_TIMBRE(sine),
-    AUDIO_NOTE(REST, SEMIQUAVER),
-    AUDIO_TEMPO(200), AUDIO_VOLUME(64), AUDIO_TIMBRE(sine),
-    AUDIO_NOTE(G7 , CROTCHET),
-    
-    AUDIO_END
-};
+    tone_id_connection ,
+    tone_id_short ,
+    tone_id_error ,
+    TONE_NOT_DEFINED ,
+    TONE_NOT_DEFINED ,
+    TONE_NOT_DEFINED
+} ;
 
-/* eg. connection */
-static const audio_note tone_connection[] =
-{
-    AUDIO_TEMPO(2400), AUDIO_VOLUME(64), AUDIO_TIMBRE(sine),
-    
-    AUDIO_NOTE(REST, CROTCHET),
-    AUDIO_NOTE(G7 , SEMIBREVE),
-    
-    AUDIO_END
-};
+#endif /* VOICE_PROMPTS */
 
-/* error tone */
-static const audio_note tone_error[] =
-{
-    AUDIO_TEMPO(120), AUDIO_VOLUME(64), AUDIO_TIMBRE(sine),
-    
-    AUDIO_NOTE(REST, HEMIDEMISEMIQUAVER),
-    AUDIO_NOTE(G5 , CROTCHET),
-    
-    AUDIO_END
-};
-
-/* short confirmation */
-static const audio_note tone_short[] =
-{
-    AUDIO_TEMPO(2400), AUDIO_VOLUME(64), AUDIO_TIMBRE(sine),
-    
-    AUDIO_NOTE(REST, CROTCHET),
-    AUDIO_NOTE(G6 , SEMIBREVE),
-    
-    AUDIO_END
-};
-
-/* long confirmation */
-static const audio_note tone_long[] =
-{
-    AUDIO_TEMPO(1200), AUDIO_VOLUME(64), AUDIO_TIMBRE(sine),  
-    AUDIO_NOTE(REST, QUAVER),
-    AUDIO_TEMPO(150), AUDIO_VOLUME(64), AUDIO_TIMBRE(sine), 
-    AUDIO_NOTE(G6 , MINIM),
-    
-    AUDIO_END
-};
-
-#ifdef FAVORITES_CALL
-static const audio_note tone_mute_reminder[] =
-{
-    AUDIO_TEMPO(1), AUDIO_VOLUME(128), AUDIO_TIMBRE(sine),
-    AUDIO_NOTE(G7 , SEMIBREVE), 
-
-    AUDIO_END
-};
-#else
-static const audio_note tone_mute_reminder[] =
-{
-    AUDIO_TEMPO(600), AUDIO_VOLUME(64), AUDIO_TIMBRE(sine),
-    AUDIO_NOTE(REST, SEMIQUAVER),
-    AUDIO_TEMPO(120), AUDIO_VOLUME(64), AUDIO_TIMBRE(sine),
-    AUDIO_NOTE(G5, CROTCHET),
-    AUDIO_NOTE(REST, CROTCHET),
-    AUDIO_NOTE(G5, CROTCHET),
-    AUDIO_END
-};
-#endif
-
-/* ringtone 1 */
-static const audio_note ring_twilight[] =
-{
-    AUDIO_TEMPO(180), AUDIO_VOLUME(64), AUDIO_TIMBRE(sine),
-    
-    AUDIO_NOTE(E7, QUAVER),
-    AUDIO_NOTE(F7, QUAVER),
-    AUDIO_NOTE(E7, QUAVER),
-    AUDIO_NOTE(C7, QUAVER),
-    AUDIO_NOTE(E7, QUAVER),
-    AUDIO_NOTE(F7, QUAVER),
-    AUDIO_NOTE(E7, QUAVER),
-    AUDIO_NOTE(C7, QUAVER),
-
-    AUDIO_END
-};
-
-/* ringtone 2 */
-static const audio_note ring_greensleeves[] =
-{
-    AUDIO_TEMPO(400), AUDIO_VOLUME(64), AUDIO_TIMBRE(sine),
-              
-    AUDIO_NOTE(F6,CROTCHET),                                  
-    AUDIO_NOTE(AF6,MINIM),                                            
-    AUDIO_NOTE(BF6,CROTCHET),                         
-    AUDIO_NOTE(C7,CROTCHET),                          
-    AUDIO_NOTE_TIE(C7,QUAVER),                                            
-    AUDIO_NOTE(DF7,QUAVER),                           
-    AUDIO_NOTE(C7,CROTCHET),                                          
-    AUDIO_NOTE(BF6,MINIM),                            
-    AUDIO_NOTE(G6,CROTCHET),          
-    AUDIO_NOTE(EF6,CROTCHET), 
-    AUDIO_NOTE_TIE(EF6,QUAVER),
-       
-    AUDIO_END
-};
-
-/* ringtone 3 */
-static const audio_note ring_major_scale[] =
-{
-    AUDIO_TEMPO(300), AUDIO_VOLUME(64), AUDIO_TIMBRE(sine),
-
-    AUDIO_NOTE(E6,QUAVER),                                    
-    AUDIO_NOTE(FS6,QUAVER),                                           
-    AUDIO_NOTE(GS6,QUAVER),                           
-    AUDIO_NOTE(A6,QUAVER),                            
-    AUDIO_NOTE(B6,QUAVER),                                            
-    AUDIO_NOTE(CS7,QUAVER),                           
-    AUDIO_NOTE(DS7,QUAVER),                                           
-    AUDIO_NOTE(E7,QUAVER),    
-
-    AUDIO_END
-};
-
-/***************************************************************************/
-/*
-    The Tone Array
-*/
-/*************************************************************************/
-#define NUM_FIXED_TONES (14)
-
-
-/* This must make use of all of the defined tones - requires the extra space first */
-static const audio_note * const gFixedTones [ NUM_FIXED_TONES ] = 
-{
-/*1*/    tone_power,
-/*2*/    tone_pairing,
-/*3*/    tone_inactive,
-/*4*/    tone_active,
-/*5*/    tone_battery,
-/*6*/    tone_vol,
-/*7*/    tone_connection, 
-/*8*/    tone_error,
-/*9*/    tone_short,
-/*a*/    tone_long,		
-/*b*/	 tone_mute_reminder,
-/*c*/    ring_twilight,
-/*d*/    ring_greensleeves,
-/*e*/    ring_major_scale
-};    
 
 /****************************************************************************
   FUNCTIONS
@@ -274,12 +97,16 @@ static bool IsToneDefined ( HeadsetTone_t pTone )
 {
     bool lResult = TRUE ;
 
-    if ( pTone == TONE_NOT_DEFINED )
+    if ( ( pTone == TONE_NOT_DEFINED ) || ( pTone > NUM_FIXED_TONES ) )
     {
         lResult = FALSE ;
+#ifdef VOICE_PROMPTS
+            /*a prompt is defined, even if not recorded, as it has a tone to fall back on*/
+        if ( ( pTone >= PROMPT_TONE ( 0 ) ) && ( pTone < PROMPT_TONE ( NUM_PROMPTS ) ) )
+            lResult = TRUE ;
+#endif
     }
-    
-    if (  ! gFixedTones [ (pTone - 1) ] )
+    else if (  ! gFixedTones [ (pTone - 1) ] )
     {	    /*the tone is also not defined if no entry exists for it*/
         lResult = FALSE ; 
     }
@@ -288,6 +115,36 @@ static bool IsToneDefined ( HeadsetTone_t pTone )
 }
 
 
+#ifdef VOICE_PROMPTS
+/****************************************************************************
+NAME    
+    PromptOrTone
+    
+DESCRIPTION
+  	A prompt is spoken only while the codec is free for the tone cache to
+  	stream it; otherwise, or if it was not recorded, its tone is played.
+    
+RETURNS
+    pTone, or the tone to play in place of the prompt
+*/
+static HeadsetTone_t PromptOrTone ( hsTaskData * pApp , HeadsetTone_t pTone )
+{
+    prompt_t lPrompt = (prompt_t) ( pTone - PROMPT_TONE ( 0 ) ) ;
+
+    if ( ( pTone < PROMPT_TONE ( 0 ) ) || ( pTone >= PROMPT_TONE ( NUM_PROMPTS ) ) )
+        return pTone ;
+
+#ifdef TONE_CACHE
+    if ( ( pApp->dsp_process == dsp_process_none ) && gPromptIndex [ lPrompt ].samples )
+        return pTone ;
+#endif
+
+    TONE_DEBUG(("TONE: prompt %d as tone %d\n" , lPrompt , gPromptTones [ lPrompt ] )) ;
+    return gPromptTones [ lPrompt ] ;
+}
+#endif
+
+
 /*****************************************************************************/
 uint16 TonesInit ( hsTaskData * pApp ) 
 {
@@ -310,6 +167,19 @@ uint16 TonesInit ( hsTaskData * pApp )
         pApp->gEventTones[ lEvent ] = TONE_NOT_DEFINED ;
     }
     
+    for ( lEvent = 0 ; lEvent < sizeof ( gIntercomTones ) / sizeof ( gIntercomTones [ 0 ] ) ; lEvent ++ )
+    {
+        pApp->gEventTones [ EventIntercomConnected - EVENTS_EVENT_BASE + lEvent ] = gIntercomTones [ lEvent ] ;
+    }
+
+#ifdef VOICE_PROMPTS
+        /*the tones configured later for these events become their prompts' tones*/
+    for ( lEvent = 0 ; lEvent < sizeof ( gEventPrompts ) / sizeof ( gEventPrompts [ 0 ] ) ; lEvent ++ )
+    {
+        pApp->gEventTones [ gEventPrompts [ lEvent ].event - EVENTS_EVENT_BASE ] = PROMPT_TONE ( gEventPrompts [ lEvent ].prompt ) ;
+    }
+#endif
+    
     return lSize;
 }
 
@@ -326,6 +196,14 @@ void TonesConfigureEvent ( hsTaskData * pApp ,headsetEvents_t pEvent , HeadsetTo
             TONE_DEBUG(("TONE: ConfRingTone [%x]\n" , pTone)) ;
             pApp->RingTone = pTone ;
         }
+#ifdef VOICE_PROMPTS
+        else if ( ( pTone <= NUM_FIXED_TONES ) && ( pApp->gEventTones [ lEventIndex ] >= PROMPT_TONE ( 0 ) ) )
+        {
+                /*the event keeps its prompt, the tone played when it cannot be*/
+            TONE_DEBUG(("TONE: Ev[%x] prompt tone[%x]\n" , pEvent , pTone )) ;
+            gPromptTones [ pApp->gEventTones [ lEventIndex ] - PROMPT_TONE ( 0 ) ] = pTone ;
+        }
+#endif
         else
         {
                 /* gEventTones is an array of indexes to the tones*/
@@ -362,11 +240,26 @@ void TonesPlayEvent ( hsTaskData * pApp,  headsetEvents_t pEvent )
 /*****************************************************************************/
 void TonesPlayTone ( hsTaskData * pApp , HeadsetTone_t pTone , bool pCanQueue )
 {
+#ifdef VOICE_PROMPTS
+    pTone = PromptOrTone ( pApp , pTone ) ;
+#endif
+
     if ( IsToneDefined(pTone) )			
     {   
         uint16 lToneVolume;
 		uint16 ampOffDelay = pApp->ampOffDelay;
 		uint16 newDelay = ampOffDelay;
+
+#ifdef TONE_MIX
+#ifdef CONFERENCE_FRAME_PATH
+            /*over the conference the tone is mixed in, the codec left to it*/
+        if ( conferenceIsActive () && toneMixPlay ( pTone , pCanQueue ) )
+            return ;
+#endif
+            /*the A2DP plugin mixes the tone itself, but is spared repeated beeps*/
+        if ( ( pApp->dsp_process == dsp_process_a2dp ) && !toneMixAdmit ( pTone , pCanQueue ) )
+            return ;
+#endif
 		
 		/* Turn the audio amp on */
 		AmpOn(pApp);
@@ -420,6 +313,19 @@ void TonesPlayTone ( hsTaskData * pApp , HeadsetTone_t pTone , bool pCanQueue )
         pApp->extmic_evt = FALSE;
 #endif
 
+            /*a tone taking the free codec is heard before the music that was to rise*/
+        if ( pApp->dsp_process == dsp_process_none )
+            VolumeRiseCancel () ;
+
+#ifdef TONE_CACHE
+            /*short tones start at once from their tables while the codec is free*/
+        if ( ( pApp->dsp_process == dsp_process_none ) && toneCachePlay ( pTone , pCanQueue ) )
+        {
+            CodecSetOutputGainNow ( pApp->theCodecTask , lToneVolume , left_and_right_ch ) ;
+            return ;
+        }
+#endif
+
         AudioPlayTone ( gFixedTones [ pTone  - 1 ] , pCanQueue ,pApp->theCodecTask, lToneVolume , TRUE ) ;
     }    
 }
@@ -428,6 +334,9 @@ void TonesPlayTone ( hsTaskData * pApp , HeadsetTone_t pTone , bool pCanQueue )
 /*****************************************************************************/
 void ToneTerminate ( hsTaskData * pApp )
 {
+#ifdef TONE_CACHE
+    toneCacheStop () ;
+#endif
     AudioStopTone() ;
 }  
 
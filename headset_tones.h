@@ -12,6 +12,7 @@ Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
 
 
 #include "headset_private.h"
+#include "headset_tone_scripts.h"
 
 
 
@@ -37,6 +38,15 @@ enum
 };    
 
 
+/****************************************************************************
+DESCRIPTION
+  	Tone number of voice prompt pPrompt (see headset_prompts.h). The prompts
+  	are numbered on from the fixed tones so that gEventTones can map an
+  	event to either.
+*/
+#define PROMPT_TONE(pPrompt)    ( NUM_FIXED_TONES + 1 + (pPrompt) )
+
+
 /****************************************************************************
   FUNCTIONS
 */
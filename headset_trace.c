@@ -0,0 +1,137 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    headset_trace.c
+@brief   Implementation of the application message trace recorder.
+*/
+
+/****************************************************************************
+    Header files
+*/
+
+#include "headset_trace.h"
+#include "headset_debug.h"
+
+#ifdef TRACE_MESSAGES
+
+#include <ps.h>
+#include <string.h>
+#include <vm.h>
+
+#ifdef HOST_BUILD
+#include <stdio.h>
+
+#define TRACE_PRINT(x)              {printf x;}
+#else
+#define TRACE_PRINT(x)              DEBUG(x)
+#endif
+
+#define TRACE_ENTRIES_PER_KEY       ( TRACE_ENTRIES / TRACE_PSKEY_COUNT )
+#define TRACE_PSKEY_INDEX           ( TRACE_PSKEY_BASE + TRACE_PSKEY_COUNT )
+
+
+static traceEntry_t gRing [ TRACE_ENTRIES ] ;
+static uint16       gNext = 0 ;
+static uint16       gCount = 0 ;
+
+
+/****************************************************************************
+  LOCAL FUNCTIONS
+*/
+
+static void tracePrint ( void )
+{
+    uint16 lIndex = ( gNext - gCount ) & ( TRACE_ENTRIES - 1 ) ;
+    uint16 i , j ;
+
+    for ( i = 0 ; i < gCount ; i++ )
+    {
+        const traceEntry_t * lEntry = &gRing [ ( lIndex + i ) & ( TRACE_ENTRIES - 1 ) ] ;
+
+        TRACE_PRINT(("TRC %lu %x %u" , (unsigned long) lEntry->time , lEntry->id , lEntry->length)) ;
+        for ( j = 0 ; j < lEntry->length ; j++ )
+            TRACE_PRINT((" %x" , lEntry->payload [ j ])) ;
+        TRACE_PRINT(("\n")) ;
+    }
+}
+
+
+/****************************************************************************
+  FUNCTIONS
+*/
+
+/**************************************************************************/
+void traceRecord ( MessageId pId , Message pMessage , uint16 pWords )
+{
+    traceEntry_t * lEntry = &gRing [ gNext ] ;
+
+    lEntry->time   = VmGetClock () ;
+    lEntry->id     = pId ;
+    lEntry->length = 0 ;
+
+    if ( pMessage )
+    {
+        lEntry->length = ( pWords > TRACE_PAYLOAD_WORDS ) ? TRACE_PAYLOAD_WORDS : pWords ;
+        memcpy ( lEntry->payload , pMessage , lEntry->length * sizeof ( uint16 ) ) ;
+    }
+
+    gNext = ( gNext + 1 ) & ( TRACE_ENTRIES - 1 ) ;
+    if ( gCount < TRACE_ENTRIES )
+        gCount++ ;
+}
+
+
+/**************************************************************************/
+void traceFlush ( traceSink_t pSink )
+{
+    uint16 i ;
+    uint16 lIndex [ 2 ] ;
+
+    if ( pSink == traceToDebug )
+    {
+        tracePrint () ;
+        return ;
+    }
+
+        /*store the ring as it is, with the write position and count alongside*/
+    for ( i = 0 ; i < TRACE_PSKEY_COUNT ; i++ )
+        (void) PsStore ( TRACE_PSKEY_BASE + i , &gRing [ i * TRACE_ENTRIES_PER_KEY ] , TRACE_ENTRIES_PER_KEY * sizeof ( traceEntry_t ) ) ;
+
+    lIndex [ 0 ] = gNext ;
+    lIndex [ 1 ] = gCount ;
+    (void) PsStore ( TRACE_PSKEY_INDEX , lIndex , sizeof ( lIndex ) ) ;
+}
+
+
+/**************************************************************************/
+void traceReportStored ( void )
+{
+    uint16 lIndex [ 2 ] ;
+    uint16 i ;
+
+    if ( !PsRetrieve ( TRACE_PSKEY_INDEX , lIndex , sizeof ( lIndex ) ) )
+        return ;
+
+        /*the ring is reused to read the stored trace - it is cleared after*/
+    memset ( gRing , 0 , sizeof ( gRing ) ) ;
+    for ( i = 0 ; i < TRACE_PSKEY_COUNT ; i++ )
+    {
+        (void) PsRetrieve ( TRACE_PSKEY_BASE + i , &gRing [ i * TRACE_ENTRIES_PER_KEY ] , TRACE_ENTRIES_PER_KEY * sizeof ( traceEntry_t ) ) ;
+        (void) PsStore ( TRACE_PSKEY_BASE + i , 0 , 0 ) ;
+    }
+    (void) PsStore ( TRACE_PSKEY_INDEX , 0 , 0 ) ;
+
+    gNext  = lIndex [ 0 ] & ( TRACE_ENTRIES - 1 ) ;
+    gCount = ( lIndex [ 1 ] > TRACE_ENTRIES ) ? TRACE_ENTRIES : lIndex [ 1 ] ;
+
+    TRACE_PRINT(("TRC stored\n")) ;
+    tracePrint () ;
+
+    memset ( gRing , 0 , sizeof ( gRing ) ) ;
+    gNext  = 0 ;
+    gCount = 0 ;
+}
+
+#endif /* TRACE_MESSAGES */
@@ -0,0 +1,113 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    headset_trace.h
+@brief   Ring buffer recorder of the messages handled by the application task.
+
+    When TRACE_MESSAGES is defined the application handler records the time,
+    id and the first words of the payload of every message it receives. The
+    most recent TRACE_ENTRIES messages can be flushed to the persistent store
+    or printed over the debug channel, in a text form the host replayer
+    (host/host_scenario.c, scenario "replay") reads back:
+
+        TRC <time ms> <id hex> <payload words> <word hex> ...
+
+    Payloads longer than TRACE_PAYLOAD_WORDS are truncated. Only the
+    caller knows how long a payload is, so a message it gives no size for
+    is recorded by its id alone.
+*/
+
+#ifndef _HEADSET_TRACE_H_
+#define _HEADSET_TRACE_H_
+
+
+#include <message.h>
+
+
+/* Number of messages held, must be a power of two */
+#define TRACE_ENTRIES           (32)
+
+/* Number of payload words recorded per message */
+#define TRACE_PAYLOAD_WORDS     (4)
+
+/* Persistent store keys holding a flushed trace, TRACE_ENTRIES / TRACE_PSKEY_COUNT entries each */
+#define TRACE_PSKEY_BASE        (41)
+#define TRACE_PSKEY_COUNT       (4)
+
+
+/*! @brief A recorded message */
+typedef struct
+{
+    uint32      time ;
+    MessageId   id ;
+    uint16      length ;    /*!< Number of valid payload words */
+    uint16      payload [ TRACE_PAYLOAD_WORDS ] ;
+} traceEntry_t ;
+
+
+/*! @brief Where to flush the trace */
+typedef enum
+{
+    traceToDebug ,
+    traceToPs
+} traceSink_t ;
+
+
+#ifdef TRACE_MESSAGES
+
+/****************************************************************************
+  FUNCTIONS
+*/
+
+/*************************************************************************
+NAME
+    traceRecord
+
+DESCRIPTION
+    Record a message in the ring buffer, overwriting the oldest entry,
+    with the first pWords words of its payload, up to TRACE_PAYLOAD_WORDS.
+    pWords is 0 when the caller does not know the payload's size.
+
+*/
+void traceRecord ( MessageId pId , Message pMessage , uint16 pWords ) ;
+
+
+/*************************************************************************
+NAME
+    traceFlush
+
+DESCRIPTION
+    Write the recorded messages, oldest first, to the debug channel or the
+    persistent store.
+
+*/
+void traceFlush ( traceSink_t pSink ) ;
+
+
+/*************************************************************************
+NAME
+    traceReportStored
+
+DESCRIPTION
+    Print a trace previously flushed to the persistent store over the debug
+    channel, then erase it.
+
+*/
+void traceReportStored ( void ) ;
+
+#define TRACE_RECORD(id , message , words)  traceRecord ( id , message , words )
+#define TRACE_FLUSH(sink)           traceFlush ( sink )
+#define TRACE_REPORT_STORED()       traceReportStored ()
+
+#else
+
+#define TRACE_RECORD(id , message , words)
+#define TRACE_FLUSH(sink)
+#define TRACE_REPORT_STORED()
+
+#endif /* TRACE_MESSAGES */
+
+
+#endif /* _HEADSET_TRACE_H_ */
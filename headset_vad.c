@@ -0,0 +1,295 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    headset_vad.c
+@brief   Implementation of the voice activity detector.
+*/
+
+/****************************************************************************
+    Header files
+*/
+
+#include "headset_vad.h"
+#include "headset_debug.h"
+
+#include <string.h>
+
+
+#ifdef DEBUG_VAD
+    #define VAD_DEBUG(x) DEBUG(x)
+#else
+    #define VAD_DEBUG(x)
+#endif
+
+
+/* Lowest noise floor, mean square of samples scaled down by 16: about -60dB */
+#define VAD_NOISE_MIN           (4)
+
+/* Quietest speech, mean square of samples scaled down by 16: about -40dB */
+#define VAD_SPEECH_MIN          (256)
+
+/* Speech stands 9dB above the floor, or 12dB with the raised threshold */
+#define VAD_RATIO_SHIFT         (3)
+#define VAD_RATIO_SHIFT_HIGH    (4)
+
+/* Voiced sound crosses zero on fewer than 3 samples in 8, below about 1.5kHz */
+#define VAD_ZCR_NUM             (3)
+#define VAD_ZCR_DEN             (8)
+
+/* The floor falls to a quieter frame in about 4 frames, and rises over about
+   1.3s to a louder one, or 10s while that is speech */
+#define VAD_FALL_SHIFT          (2)
+#define VAD_RISE_SHIFT          (7)
+#define VAD_RISE_SHIFT_SPEECH   (10)
+
+
+/****************************************************************************
+  FUNCTIONS
+*/
+
+/**************************************************************************/
+void vadInit ( vadState_t * pState )
+{
+    memset ( pState , 0 , sizeof ( vadState_t ) ) ;
+
+    pState->noise = VAD_NOISE_MIN ;
+}
+
+
+/**************************************************************************/
+bool vadFrame ( vadState_t * pState , const int16 * pFrame , uint16 pSamples )
+{
+    uint32 lEnergy = 0 ;
+    uint16 lCrossings = 0 ;
+    int16 lPrevious = pState->last ;
+    bool lVoiced ;
+    uint16 i ;
+
+    if ( !pSamples )
+        return FALSE ;
+
+        /*sum of squares and sign changes; no branches so the loop can be unrolled or vectorised*/
+    for ( i = 0 ; i < pSamples ; i++ )
+    {
+        int32 lSample = pFrame [ i ] >> 4 ;
+
+        lEnergy    += (uint32) ( lSample * lSample ) ;
+        lCrossings += (uint16) ( ( (uint16) ( pFrame [ i ] ^ lPrevious ) ) >> 15 ) ;
+        lPrevious   = pFrame [ i ] ;
+    }
+
+    pState->last = lPrevious ;
+    lEnergy /= pSamples ;
+
+    lVoiced = ( lEnergy > VAD_SPEECH_MIN ) &&
+              ( ( lEnergy >> ( pState->high ? VAD_RATIO_SHIFT_HIGH : VAD_RATIO_SHIFT ) ) > pState->noise ) &&
+              ( (uint32) lCrossings * VAD_ZCR_DEN < (uint32) pSamples * VAD_ZCR_NUM ) ;
+
+        /*track the floor: down quickly, up slowly, more slowly still under speech*/
+    if ( lEnergy < pState->noise )
+    {
+        pState->noise -= ( pState->noise - lEnergy ) >> VAD_FALL_SHIFT ;
+        if ( pState->noise < VAD_NOISE_MIN )
+            pState->noise = VAD_NOISE_MIN ;
+    }
+    else
+    {
+        pState->noise += ( ( lEnergy - pState->noise ) >> ( lVoiced ? VAD_RISE_SHIFT_SPEECH : VAD_RISE_SHIFT ) ) + 1 ;
+    }
+
+    if ( lVoiced )
+    {
+        if ( pState->run < 0xffff )
+            pState->run++ ;
+        pState->hangover = VAD_HANGOVER_FRAMES ;
+    }
+    else
+    {
+        pState->run = 0 ;
+        if ( pState->hangover )
+            pState->hangover-- ;
+    }
+
+    if ( !pState->speech && ( pState->run >= VAD_ONSET_FRAMES ) )
+    {
+        VAD_DEBUG(("VAD: speech, energy %ld floor %ld crossings %d\n" , lEnergy , pState->noise , lCrossings)) ;
+        pState->speech = TRUE ;
+        return TRUE ;
+    }
+
+    if ( pState->speech && !pState->hangover )
+    {
+        VAD_DEBUG(("VAD: silence\n")) ;
+        pState->speech = FALSE ;
+    }
+
+    return FALSE ;
+}
+
+
+#ifdef VOICE_VAD
+
+#include "headset_private.h"
+#include "headset_intercom_msg_handler.h"
+#include "headset_LEDmanager.h"
+#include "headset_mixer.h"
+
+#include <app/message/system_message.h>
+#include <message.h>
+#include <pcm.h>
+#include <source.h>
+#include <stream.h>
+
+
+#define VAD_FRAME_OCTETS        ( VAD_FRAME_SAMPLES * MIXER_SAMPLE_OCTETS )
+
+/* Time the codec must stay free before listening starts, so that a plugin
+   replaced by another does not route the microphone in between */
+#define VAD_LISTEN_DELAY        (500)
+
+/* Sent to the detector's own task */
+#define VAD_LISTEN              (0)
+
+
+static void vadHandler ( Task pTask , MessageId pId , Message pMessage ) ;
+
+static TaskData     gTask = { vadHandler } ;
+static vadState_t   gState ;
+static int16        gFrame [ VAD_FRAME_SAMPLES ] ;
+static Source       gSource = 0 ;
+static bool         gEnabled = FALSE ;
+static bool         gClaimed = FALSE ;
+static bool         gHigh = FALSE ;
+
+
+/****************************************************************************
+  LOCAL FUNCTIONS
+*/
+
+static void vadListen ( void )
+{
+    VAD_DEBUG(("VAD: listen\n")) ;
+
+    (void) PcmRateAndRoute ( 0 , PCM_NO_SYNC , 8000 , 8000 , VM_PCM_INTERNAL_A ) ;
+    gSource = StreamPcmSource ( 0 ) ;
+    (void) MessageSinkTask ( StreamSinkFromSource ( gSource ) , &gTask ) ;
+
+    vadInit ( &gState ) ;
+    gState.high = gHigh ;
+
+    LEDManagerSetMicBias ( (hsTaskData *) getAppTask () , TRUE ) ;
+}
+
+
+static void vadDeafen ( void )
+{
+    VAD_DEBUG(("VAD: deafen\n")) ;
+
+    (void) MessageSinkTask ( StreamSinkFromSource ( gSource ) , NULL ) ;
+    PcmClearAllRouting () ;
+    gSource = 0 ;
+
+    LEDManagerSetMicBias ( (hsTaskData *) getAppTask () , FALSE ) ;
+}
+
+
+/* Listen while enabled and the codec is free, starting after a short delay */
+static void vadUpdate ( void )
+{
+    MessageCancelAll ( &gTask , VAD_LISTEN ) ;
+
+    if ( gEnabled && !gClaimed )
+    {
+        if ( !gSource )
+            MessageSendLater ( &gTask , VAD_LISTEN , 0 , VAD_LISTEN_DELAY ) ;
+    }
+    else if ( gSource )
+    {
+        vadDeafen () ;
+    }
+}
+
+
+/* A rider who starts to speak opens the intercom, if there is a rider to talk
+   to. Listening stops until EventSkipBackward reports the intercom closed. */
+static void vadOnset ( void )
+{
+    hsTaskData * lApp = (hsTaskData *) getAppTask () ;
+
+    if ( intercomIsConnected ( lApp ) && !intercomIsAudioActive ( lApp ) )
+    {
+        VAD_DEBUG(("VAD: open intercom\n")) ;
+        MessageSend ( &lApp->task , APP_INTERCOM_MODE , 0 ) ;
+        vadEnable ( FALSE ) ;
+    }
+}
+
+
+static void vadRead ( void )
+{
+    while ( gSource && ( SourceSize ( gSource ) >= VAD_FRAME_OCTETS ) )
+    {
+        mixerUnpack ( SourceMap ( gSource ) , gFrame , VAD_FRAME_SAMPLES ) ;
+        SourceDrop ( gSource , VAD_FRAME_OCTETS ) ;
+
+        if ( vadFrame ( &gState , gFrame , VAD_FRAME_SAMPLES ) )
+            vadOnset () ;
+    }
+}
+
+
+static void vadHandler ( Task pTask , MessageId pId , Message pMessage )
+{
+    switch ( pId )
+    {
+    case VAD_LISTEN:
+        if ( !gSource && gEnabled && !gClaimed )
+            vadListen () ;
+        break ;
+    case MESSAGE_MORE_DATA:
+        vadRead () ;
+        break ;
+    default:
+        break ;
+    }
+}
+
+
+/****************************************************************************
+  FUNCTIONS
+*/
+
+/**************************************************************************/
+void vadEnable ( bool pEnable )
+{
+    gEnabled = pEnable ;
+    vadUpdate () ;
+}
+
+
+/**************************************************************************/
+void vadSetHighThreshold ( bool pHigh )
+{
+    gHigh       = pHigh ;
+    gState.high = pHigh ;
+}
+
+
+/**************************************************************************/
+void vadCodecClaimed ( void )
+{
+    gClaimed = TRUE ;
+    vadUpdate () ;
+}
+
+
+/**************************************************************************/
+void vadCodecReleased ( void )
+{
+    gClaimed = FALSE ;
+    vadUpdate () ;
+}
+
+#endif /* VOICE_VAD */
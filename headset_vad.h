@@ -0,0 +1,124 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    headset_vad.h
+@brief   Voice activity detection on the helmet microphone.
+
+    The R100 opens the intercom when the rider starts to speak. This was
+    done by an external MSP430 watching the microphone; with VOICE_VAD the
+    detector runs on chip instead, on 10ms frames of 8kHz PCM.
+
+    A frame is speech when its energy stands above a tracked noise floor
+    and its zero crossing rate is that of voiced sound rather than hiss.
+    The floor follows quiet frames quickly and louder ones slowly, so wind
+    and engine noise which persist raise it while a sentence does not.
+    Speech must last VAD_ONSET_FRAMES frames to be reported, so a knock
+    on the helmet is ignored, and is held for VAD_HANGOVER_FRAMES frames
+    after it stops so pauses between words do not end it.
+
+    The kernel, vadFrame, is fixed point with no branches in its per
+    sample loop. With VOICE_VAD the microphone is read while the codec is
+    not in use by a plugin, and APP_INTERCOM_MODE is sent to the
+    application on speech onset.
+*/
+
+#ifndef _HEADSET_VAD_H_
+#define _HEADSET_VAD_H_
+
+
+#include <csrtypes.h>
+
+
+/* Samples per decision, 10ms at 8kHz */
+#define VAD_FRAME_SAMPLES       (80)
+
+/* Speech frames in a row before an onset is reported, 30ms */
+#define VAD_ONSET_FRAMES        (3)
+
+/* Frames speech is held after the last speech frame, 300ms */
+#define VAD_HANGOVER_FRAMES     (30)
+
+
+/*! @brief Detector state of one microphone */
+typedef struct
+{
+    uint32      noise ;         /*!< Tracked floor of the frame energy */
+    uint16      run ;           /*!< Speech frames in a row */
+    uint16      hangover ;      /*!< Frames left before speech ends */
+    int16       last ;          /*!< Last sample of the previous frame */
+    unsigned    speech:1 ;      /*!< Speech is in progress */
+    unsigned    high:1 ;        /*!< The raised threshold is in use */
+} vadState_t ;
+
+
+/****************************************************************************
+  FUNCTIONS
+*/
+
+/*************************************************************************
+NAME
+    vadInit
+
+DESCRIPTION
+    Start a detector with no speech and the floor at its minimum.
+
+*/
+void vadInit ( vadState_t * pState ) ;
+
+
+/*************************************************************************
+NAME
+    vadFrame
+
+DESCRIPTION
+    Classify a frame of pSamples samples, at most VAD_FRAME_SAMPLES * 4.
+
+RETURNS
+    TRUE if speech started with this frame.
+*/
+bool vadFrame ( vadState_t * pState , const int16 * pFrame , uint16 pSamples ) ;
+
+
+#ifdef VOICE_VAD
+
+/*************************************************************************
+NAME
+    vadEnable
+
+DESCRIPTION
+    Allow or stop listening, where the MSP430 was told whether to.
+
+*/
+void vadEnable ( bool pEnable ) ;
+
+
+/*************************************************************************
+NAME
+    vadSetHighThreshold
+
+DESCRIPTION
+    Select the raised speech threshold, as the voice mode selected the
+    MSP430's threshold for open and full face helmets.
+
+*/
+void vadSetHighThreshold ( bool pHigh ) ;
+
+
+/*************************************************************************
+NAME
+    vadCodecClaimed / vadCodecReleased
+
+DESCRIPTION
+    A plugin or the conference is about to take the codec, or has given
+    it back. Listening stops at once and resumes shortly after release.
+
+*/
+void vadCodecClaimed ( void ) ;
+void vadCodecReleased ( void ) ;
+
+#endif /* VOICE_VAD */
+
+
+#endif /* _HEADSET_VAD_H_ */
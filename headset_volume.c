@@ -8,11 +8,17 @@ Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
 */
 
 #include "headset_debug.h"
+#include "headset_intercom_msg_handler.h"
 #include "headset_LEDmanager.h"
 #include "headset_volume.h"
 #include "headset_statemanager.h"
 #include "headset_tones.h"
 #include "headset_configmanager.h"
+#include "headset_conference.h"
+
+#ifdef INTERCOM_AGC
+#include "headset_agc.h"
+#endif
 
 #include <stdlib.h>
 #include <audio.h>
@@ -33,6 +39,13 @@ Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
 #define VOL_DEBUG(x) 
 #endif
 
+/* Messages to the volume task */
+enum
+{
+	VOL_RAMP_STEP,
+	VOL_AMP_SWITCH
+};
+
 typedef struct
 {
 	unsigned int hfpVol:8;
@@ -41,6 +54,106 @@ typedef struct
 
 vol_table_t *gVolLevels = NULL;
 
+static void volumeHandler(Task task, MessageId id, Message message);
+
+static TaskData gVolTask = { volumeHandler };
+static Task gCodec = NULL; /* Codec task of the plugin the walk is for */
+static uint16 gCodecGain = 0; /* Gain the plugin was last given */
+static uint16 gTargetGain = 0; /* Gain the walk is heading for */
+static uint16 gStepMs = VOL_RAMP_STEP_MS;
+static bool gRise = FALSE; /* The next A2DP audio rises to its volume */
+#ifdef R100
+static bool gAmpHigh = FALSE; /* What the amp's gain PIO is to be set to */
+#endif
+
+
+#ifdef R100
+/* Set the amp's gain PIO */
+static void volumeSetAmpGain(bool high)
+{
+	PioSetDir(AMP_GAIN_MASK, AMP_GAIN_MASK);
+	PioSet(AMP_GAIN_MASK, high ? AMP_GAIN_MASK : 0);
+}
+#endif
+
+
+/* Give the plugin the next codec gain of the walk */
+static void volumeRampStep(void)
+{
+	MessageCancelAll(&gVolTask, VOL_RAMP_STEP);
+
+	if (gCodecGain < gTargetGain)
+		gCodecGain++;
+	else if (gCodecGain > gTargetGain)
+		gCodecGain--;
+
+	AudioSetVolume(gCodecGain, gCodec);
+
+	if (gCodecGain != gTargetGain)
+		MessageSendLater(&gVolTask, VOL_RAMP_STEP, 0, gStepMs);
+}
+
+
+/* Walk the codec gain to gain, from where a walk under way has got to or
+   else from start, with the amp's gain PIO set for high */
+static void volumeRampTo(Task codec, uint16 start, uint16 gain, bool high)
+{
+	if (!MessageCancelAll(&gVolTask, VOL_RAMP_STEP))
+		gCodecGain = start;
+
+	gCodec = codec;
+	gTargetGain = gain;
+	gStepMs = VOL_RAMP_STEP_MS;
+
+#ifdef R100 /* v091221 */
+	gAmpHigh = high;
+
+	if (high != ((PioGet() & AMP_GAIN_MASK) != 0))
+	{
+#ifdef CONFERENCE_FRAME_PATH
+		if (conferenceIsActive())
+		{
+			/* No plugin is connected: the conference dips the audio for the switch */
+			conferenceSwitchAmp(&gVolTask, VOL_AMP_SWITCH);
+			gCodecGain = gain;
+			return;
+		}
+#endif
+		/* Trade the amp's gain for codec gain, so the level holds across
+		   the switch and the walk makes the change */
+		if (high)
+			gCodecGain = (gCodecGain > VOL_AMP_GAIN_STEPS) ? gCodecGain - VOL_AMP_GAIN_STEPS : 0;
+		else
+			gCodecGain = (gCodecGain + VOL_AMP_GAIN_STEPS < VOL_CODEC_GAIN_MAX) ? gCodecGain + VOL_AMP_GAIN_STEPS : VOL_CODEC_GAIN_MAX;
+
+		volumeSetAmpGain(high);
+		AudioSetVolume(gCodecGain, codec);
+	}
+#endif
+
+	VOL_DEBUG(("VOL: Walk codec gain %d to %d\n", gCodecGain, gain));
+	volumeRampStep();
+}
+
+
+static void volumeHandler(Task task, MessageId id, Message message)
+{
+	switch (id)
+	{
+	case VOL_RAMP_STEP:
+		volumeRampStep();
+		break;
+#ifdef R100
+	case VOL_AMP_SWITCH:
+		VOL_DEBUG(("VOL: Amp gain %d\n", gAmpHigh));
+		volumeSetAmpGain(gAmpHigh);
+		break;
+#endif
+	default:
+		break;
+	}
+}
+
 /*****************************************************************************/
 void VolumeInit ( hsTaskData * pApp ) 
 {
@@ -181,7 +294,7 @@ bool VolumeGetHeadsetVolume(hsTaskData * pApp, uint16 * actVol, bool * avAudio)
 	    *actVol = pApp->gHfpVolumeLevel;
     }
     /* Insert code for Intercom by Jace */
-    else if(pApp->aghfp_connect || pApp->audio_connect)
+    else if(intercomIsConnected(pApp))
     {
         *actVol = pApp->gHfpVolumeLevel;
     }
@@ -198,28 +311,22 @@ bool VolumeGetHeadsetVolume(hsTaskData * pApp, uint16 * actVol, bool * avAudio)
 /*****************************************************************************/
 void VolumeSetHeadsetVolume(hsTaskData * pApp, uint16 actVol, bool avAudio)
 {
-#ifdef R100 /* v091221 */
-    if(actVol > 4)
-    {
-        PioSetDir(AMP_GAIN_MASK, AMP_GAIN_MASK);
-        PioSet(AMP_GAIN_MASK, AMP_GAIN_MASK);
-    }
-    else
-    {
-        PioSetDir(AMP_GAIN_MASK, AMP_GAIN_MASK);
-        PioSet(AMP_GAIN_MASK, 0);
-    }
-#endif
-
 	if (avAudio)
 	{
+        volumeRampTo(pApp->theCodecTask, gVolLevels[pApp->gAvVolumeLevel].avVol, gVolLevels[actVol].avVol, actVol > VOL_AMP_LEVEL); /* v091111 Release */
 	    pApp->gAvVolumeLevel = actVol;
-        AudioSetVolume( gVolLevels[actVol].avVol , pApp->theCodecTask ) ; /* v091111 Release */
 	}
 	else
 	{
+        volumeRampTo(pApp->theCodecTask, gVolLevels[pApp->gHfpVolumeLevel].hfpVol, gVolLevels[actVol].hfpVol, actVol > VOL_AMP_LEVEL); /* v091111 Release */
 	    pApp->gHfpVolumeLevel = actVol;
-        AudioSetVolume( gVolLevels[actVol].hfpVol, pApp->theCodecTask ) ; /* v091111 Release */
+
+#ifdef INTERCOM_AGC
+        /* No plugin hears AudioSetVolume while the conference carries the
+           intercom; there the step sets the level the AGC aims for */
+        if (conferenceIsActive())
+            conferenceSetTarget(VolumeRetrieveAgcTarget(actVol));
+#endif
 	}
 }
 
@@ -235,3 +342,57 @@ uint16 VolumeRetrieveGain( uint16 index , bool avAudio )
 }
 
 
+/*****************************************************************************/
+uint16 VolumeConnectGain( hsTaskData * pApp , bool avAudio )
+{
+	uint16 gain = VolumeRetrieveGain(avAudio ? pApp->gAvVolumeLevel : pApp->gHfpVolumeLevel, avAudio);
+
+	/* A walk under way was for the plugin now replaced */
+	MessageCancelAll(&gVolTask, VOL_RAMP_STEP);
+	gCodecGain = gain;
+
+	if (gRise && avAudio)
+	{
+		VOL_DEBUG(("VOL: Rise to gain %d\n", gain));
+
+		gCodecGain = (gain > VOL_RISE_STEPS) ? gain - VOL_RISE_STEPS : 0;
+		gTargetGain = gain;
+		gCodec = pApp->theCodecTask;
+		gStepMs = VOL_RISE_STEP_MS;
+
+		if (gCodecGain != gain)
+			MessageSendLater(&gVolTask, VOL_RAMP_STEP, 0, VOL_RISE_STEP_MS);
+	}
+	gRise = FALSE;
+
+	return gCodecGain;
+}
+
+
+/*****************************************************************************/
+void VolumeRiseNextA2dp( void )
+{
+	gRise = TRUE;
+}
+
+
+/*****************************************************************************/
+void VolumeRiseCancel( void )
+{
+	gRise = FALSE;
+}
+
+
+#ifdef INTERCOM_AGC
+/*****************************************************************************/
+uint16 VolumeRetrieveAgcTarget( uint16 index )
+{
+	uint16 top = gVolLevels[VOL_MAX_VOLUME_LEVEL].hfpVol;
+	uint16 gain = gVolLevels[index].hfpVol;
+
+	/* Each codec gain step below the top of the table is 3dB */
+	return agcTargetForStep((top > gain) ? (top - gain) : 0);
+}
+#endif
+
+
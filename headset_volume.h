@@ -5,6 +5,18 @@ Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
 /*!
 @file    headset_volume.h
 @brief  Interface to volume controls.
+
+    A volume step is not made all at once: the codec gain is walked to
+    the new step a 3dB codec step at a time, VOL_RAMP_STEP_MS apart, so
+    that a change of several steps does not click. Where the amp's gain
+    PIO switches, as much codec gain is given up or taken on with it, so
+    the level holds across the switch and the walk makes the change.
+    While the conference carries the intercom, and the samples pass
+    through the VM, the switch is instead made at a zero crossing of
+    audio dipped for it (see conferenceSwitchAmp).
+
+    Music resumed after an interruption rises to its volume from
+    VOL_RISE_STEPS codec steps below it, VOL_RISE_STEP_MS a step.
 */
 
 #ifndef HEADSET_VOLUME_H
@@ -16,6 +28,14 @@ Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
 
 #define VOL_DEFAULT_VOLUME_LEVEL (0x03) /* v091111 Release */
 #define VOL_MAX_VOLUME_LEVEL (0x06) /* v091111 Release */
+
+#define VOL_AMP_LEVEL (4) /* Above this step the amp's gain PIO is high */
+#define VOL_AMP_GAIN_STEPS (2) /* Codec gain steps the amp's high gain is worth */
+#define VOL_CODEC_GAIN_MAX (22) /* Top of the codec's output gain */
+
+#define VOL_RAMP_STEP_MS (10) /* Between codec gain steps of a volume change */
+#define VOL_RISE_STEPS (8) /* Codec gain steps music resumes below its volume */
+#define VOL_RISE_STEP_MS (125) /* Between codec gain steps of the rise */
  
 
 /****************************************************************************
@@ -115,5 +135,64 @@ RETURNS
 uint16 VolumeRetrieveGain( uint16 index , bool avAudio );
 
 
+/****************************************************************************
+NAME 
+    VolumeConnectGain
+
+DESCRIPTION
+    Retrieve the gain to connect a plugin at for the current volume, and
+    walk the codec gain on from there. Every AudioConnect takes its gain
+    from here, so that the walk starts from what the plugin was given.
+    After VolumeRiseNextA2dp, A2DP audio is connected below its volume
+    and rises to it. 
+
+RETURNS
+	Returns the gain to pass to AudioConnect.
+
+*/
+uint16 VolumeConnectGain( hsTaskData * pApp , bool avAudio );
+
+
+/****************************************************************************
+NAME 
+    VolumeRiseNextA2dp
+
+DESCRIPTION
+    Have the next audio connected, if it is A2DP, rise to its volume
+    rather than start at it (Natural Volume Increase).
+
+*/
+void VolumeRiseNextA2dp( void );
+
+
+/****************************************************************************
+NAME 
+    VolumeRiseCancel
+
+DESCRIPTION
+    Forget a rise asked for by VolumeRiseNextA2dp, when the A2DP audio it
+    was for is not coming or something else has taken the codec first.
+
+*/
+void VolumeRiseCancel( void );
+
+
+#ifdef INTERCOM_AGC
+/****************************************************************************
+NAME 
+    VolumeRetrieveAgcTarget
+
+DESCRIPTION
+    Retrieve the level the intercom AGC should bring riders to at a volume
+    step, from the HFP gains in the same table. 
+
+RETURNS
+	Returns the target for conferenceSetTarget.
+
+*/
+uint16 VolumeRetrieveAgcTarget( uint16 index );
+#endif
+
+
 #endif
 
@@ -0,0 +1,408 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    headset_wind.c
+@brief   Implementation of the wind noise suppression.
+*/
+
+/****************************************************************************
+    Header files
+*/
+
+#include "headset_wind.h"
+#include "headset_debug.h"
+
+#include <string.h>
+
+
+#ifdef DEBUG_WIND
+    #define WIND_DEBUG(x) DEBUG(x)
+#else
+    #define WIND_DEBUG(x)
+#endif
+
+
+/* log2 of WIND_FFT */
+#define WIND_FFT_BITS       (7)
+
+/* Before each FFT stage every value is brought below this, so that no
+   butterfly can leave the 16 bit range: 0x3400 * ( 1 + sqrt(2) ) < 0x7fff */
+#define WIND_HEADROOM       (0x3400)
+
+/* Fractional bits kept in the bin magnitudes */
+#define WIND_MAG_FRAC       (4)
+
+/* Bins below 500Hz are the wind band */
+#define WIND_BAND_BINS      (8)
+
+/* Noise is subtracted twice over in the wind band, once above it, and no
+   bin is cut by more than 20dB in the wind band or 12dB above it */
+#define WIND_OVER_BAND      (4)         /* Halves */
+#define WIND_OVER_SPEECH    (2)
+#define WIND_FLOOR_BAND     (3277)      /* Q15 */
+#define WIND_FLOOR_SPEECH   (8231)
+
+/* The noise estimate falls to a quieter bin over about 60ms. It climbs to a
+   louder one by a fixed 1/32 of itself a hop, about 18dB a second: fast
+   enough to follow a gust, too slow to climb onto a syllable */
+#define WIND_FALL_SHIFT     (3)
+#define WIND_RISE_SHIFT     (5)
+
+/* Only suppress while the noise in a wind band bin averages 2^WIND_TILT_SHIFT
+   times that in a bin above it. Between words with no wind the estimate
+   settles on the speech itself, whose energy is mostly above the wind band,
+   and subtracting it would eat the quieter sounds */
+#define WIND_TILT_SHIFT     (2)
+
+/* The estimate never falls below the magnitude of a bin of -90dB noise, so
+   that it can rise again from silence */
+#define WIND_NOISE_MIN      (16)
+
+
+/* Square root of a periodic Hann window, Q15: applied before the FFT and
+   again after the inverse, so that windows half overlapped sum to one */
+static const int16 gWindow [ WIND_WINDOW ] =
+{
+        0 ,   858 ,  1715 ,  2571 ,  3425 ,  4277 ,  5126 ,  5971 ,  6813 ,  7649 ,
+     8481 ,  9306 , 10126 , 10938 , 11743 , 12539 , 13328 , 14107 , 14876 , 15635 ,
+    16383 , 17121 , 17846 , 18559 , 19260 , 19947 , 20621 , 21280 , 21925 , 22555 ,
+    23170 , 23768 , 24351 , 24916 , 25465 , 25996 , 26509 , 27004 , 27481 , 27938 ,
+    28377 , 28796 , 29196 , 29575 , 29934 , 30273 , 30591 , 30888 , 31163 , 31418 ,
+    31650 , 31862 , 32051 , 32218 , 32364 , 32487 , 32587 , 32666 , 32722 , 32756 ,
+    32767 , 32756 , 32722 , 32666 , 32587 , 32487 , 32364 , 32218 , 32051 , 31862 ,
+    31650 , 31418 , 31163 , 30888 , 30591 , 30273 , 29934 , 29575 , 29196 , 28796 ,
+    28377 , 27938 , 27481 , 27004 , 26509 , 25996 , 25465 , 24916 , 24351 , 23768 ,
+    23170 , 22555 , 21925 , 21280 , 20621 , 19947 , 19260 , 18559 , 17846 , 17121 ,
+    16383 , 15635 , 14876 , 14107 , 13328 , 12539 , 11743 , 10938 , 10126 ,  9306 ,
+     8481 ,  7649 ,  6813 ,  5971 ,  5126 ,  4277 ,  3425 ,  2571 ,  1715 ,   858
+} ;
+
+/* cos ( 2 pi k / WIND_FFT ), Q15; the sines are read from it a quarter turn on */
+static const int16 gCos [ WIND_FFT / 2 ] =
+{
+    32767 , 32728 , 32609 , 32412 , 32137 , 31785 , 31356 , 30852 ,
+    30273 , 29621 , 28898 , 28105 , 27245 , 26319 , 25329 , 24279 ,
+    23170 , 22005 , 20787 , 19519 , 18204 , 16846 , 15446 , 14010 ,
+    12539 , 11039 ,  9512 ,  7962 ,  6393 ,  4808 ,  3212 ,  1608 ,
+        0 , -1608 , -3212 , -4808 , -6393 , -7962 , -9512 , -11039 ,
+    -12539 , -14010 , -15446 , -16846 , -18204 , -19519 , -20787 , -22005 ,
+    -23170 , -24279 , -25329 , -26319 , -27245 , -28105 , -28898 , -29621 ,
+    -30273 , -30852 , -31356 , -31785 , -32137 , -32412 , -32609 , -32728
+} ;
+
+
+/* FFT working space, shared by every stream */
+static int16 gRe [ WIND_FFT ] ;
+static int16 gIm [ WIND_FFT ] ;
+
+
+/****************************************************************************
+  LOCAL FUNCTIONS
+*/
+
+static int16 windSin ( uint16 pIndex )
+{
+    return gCos [ ( pIndex < WIND_FFT / 4 ) ? ( WIND_FFT / 4 - pIndex ) : ( pIndex - WIND_FFT / 4 ) ] ;
+}
+
+
+/* Shift the working space right until it is within WIND_HEADROOM, or when
+   pGrow also left until it uses more than half of it. The largest value is
+   bounded from above by or-ing the magnitudes together.
+   Returns the power of two the values were divided by. */
+static int16 windScale ( bool pGrow )
+{
+    int16 lMax = 0 ;
+    int16 lShift = 0 ;
+    uint16 i ;
+
+    for ( i = 0 ; i < WIND_FFT ; i++ )
+    {
+        int16 lRe = ( gRe [ i ] < 0 ) ? -gRe [ i ] : gRe [ i ] ;
+        int16 lIm = ( gIm [ i ] < 0 ) ? -gIm [ i ] : gIm [ i ] ;
+
+        lMax |= lRe | lIm ;
+    }
+
+    if ( !lMax )
+        return 0 ;
+
+    while ( lMax > WIND_HEADROOM )
+    {
+        lMax >>= 1 ;
+        lShift++ ;
+    }
+    while ( pGrow && ( lMax <= ( WIND_HEADROOM >> 1 ) ) )
+    {
+        lMax <<= 1 ;
+        lShift-- ;
+    }
+
+    if ( lShift > 0 )
+    {
+        for ( i = 0 ; i < WIND_FFT ; i++ )
+        {
+            gRe [ i ] >>= lShift ;
+            gIm [ i ] >>= lShift ;
+        }
+    }
+    else if ( lShift < 0 )
+    {
+        for ( i = 0 ; i < WIND_FFT ; i++ )
+        {
+            gRe [ i ] <<= -lShift ;
+            gIm [ i ] <<= -lShift ;
+        }
+    }
+    return lShift ;
+}
+
+
+/* Forward DFT of the working space in place, with block floating point.
+   Returns e such that the transform is the working space times 2^e. */
+static int16 windFft ( void )
+{
+    int16 lExponent ;
+    uint16 lSize ;
+    uint16 lStep ;
+    uint16 i , j ;
+
+        /*bit reversed order*/
+    for ( i = 1 , j = 0 ; i < WIND_FFT ; i++ )
+    {
+        uint16 lBit = WIND_FFT >> 1 ;
+
+        while ( j & lBit )
+        {
+            j ^= lBit ;
+            lBit >>= 1 ;
+        }
+        j |= lBit ;
+
+        if ( i < j )
+        {
+            int16 lRe = gRe [ i ] ;
+            int16 lIm = gIm [ i ] ;
+
+            gRe [ i ] = gRe [ j ] ;
+            gIm [ i ] = gIm [ j ] ;
+            gRe [ j ] = lRe ;
+            gIm [ j ] = lIm ;
+        }
+    }
+
+    lExponent = windScale ( TRUE ) ;
+
+    for ( lSize = 2 , lStep = WIND_FFT / 2 ; lSize <= WIND_FFT ; lSize <<= 1 , lStep >>= 1 )
+    {
+        uint16 lHalf = lSize >> 1 ;
+
+        if ( lSize > 2 )
+            lExponent += windScale ( FALSE ) ;
+
+        for ( j = 0 ; j < lHalf ; j++ )
+        {
+            int32 lCos = gCos [ j * lStep ] ;
+            int32 lSin = windSin ( j * lStep ) ;
+
+            for ( i = j ; i < WIND_FFT ; i += lSize )
+            {
+                uint16 b = i + lHalf ;
+                int16 lRe = (int16) ( ( gRe [ b ] * lCos + gIm [ b ] * lSin + 0x4000 ) >> 15 ) ;
+                int16 lIm = (int16) ( ( gIm [ b ] * lCos - gRe [ b ] * lSin + 0x4000 ) >> 15 ) ;
+
+                gRe [ b ] = gRe [ i ] - lRe ;
+                gIm [ b ] = gIm [ i ] - lIm ;
+                gRe [ i ] += lRe ;
+                gIm [ i ] += lIm ;
+            }
+        }
+    }
+    return lExponent ;
+}
+
+
+/* |re| + |im| approximated as max + min / 2 */
+static uint32 windMagnitude ( int16 pRe , int16 pIm )
+{
+    uint16 lRe = (uint16) ( ( pRe < 0 ) ? -pRe : pRe ) ;
+    uint16 lIm = (uint16) ( ( pIm < 0 ) ? -pIm : pIm ) ;
+
+    return ( lRe > lIm ) ? ( (uint32) lRe + ( lIm >> 1 ) ) : ( (uint32) lIm + ( lRe >> 1 ) ) ;
+}
+
+
+/* Q15 gain leaving what stands above pOver halves of the noise in a bin */
+static uint16 windGain ( uint32 pMagnitude , uint32 pNoise , uint16 pOver , uint16 pFloor )
+{
+    uint32 lNoise = ( pNoise * pOver ) >> 1 ;
+    uint32 lGain ;
+
+    if ( lNoise >= pMagnitude )
+        return pFloor ;
+
+        /*keep the quotient in 32 bits*/
+    while ( pMagnitude >= 0x10000UL )
+    {
+        pMagnitude >>= 1 ;
+        lNoise     >>= 1 ;
+    }
+
+    lGain = ( ( pMagnitude - lNoise ) << 15 ) / pMagnitude ;
+
+    return ( lGain < pFloor ) ? pFloor : (uint16) ( ( lGain > 0x7fff ) ? 0x7fff : lGain ) ;
+}
+
+
+/* Shift a value by pShift, left if positive, and saturate it to 16 bits */
+static int16 windShift ( int32 pValue , int16 pShift )
+{
+    if ( pShift >= 0 )
+    {
+        if ( pShift > 16 )
+            pShift = 16 ;
+        pValue <<= pShift ;
+    }
+    else
+    {
+        pValue = ( pShift < -31 ) ? 0 : ( ( pValue + ( 1L << ( -pShift - 1 ) ) ) >> -pShift ) ;
+    }
+
+    return (int16) ( ( pValue > 0x7fff ) ? 0x7fff : ( ( pValue < -0x8000 ) ? -0x8000 : pValue ) ) ;
+}
+
+
+/* Analyse the window, suppress, and add the result to the output */
+static void windHop ( windState_t * pState )
+{
+    int16 lForward ;
+    int16 lInverse ;
+    int16 lShift ;
+    uint32 lLow = 0 ;
+    uint32 lHigh = 0 ;
+    bool lWindy ;
+    uint16 k , n ;
+
+        /*decide on the noise as it stood before this window*/
+    for ( k = 0 ; k < WIND_BAND_BINS ; k++ )
+        lLow += pState->noise [ k ] >> 4 ;
+    for ( ; k < WIND_BINS ; k++ )
+        lHigh += pState->noise [ k ] >> 4 ;
+
+    lWindy = pState->primed && ( lLow * ( WIND_BINS - WIND_BAND_BINS ) > ( ( lHigh * WIND_BAND_BINS ) << WIND_TILT_SHIFT ) ) ;
+
+    for ( n = 0 ; n < WIND_WINDOW ; n++ )
+        gRe [ n ] = (int16) ( ( (int32) pState->input [ n ] * gWindow [ n ] + 0x4000 ) >> 15 ) ;
+    for ( ; n < WIND_FFT ; n++ )
+        gRe [ n ] = 0 ;
+    memset ( gIm , 0 , sizeof ( gIm ) ) ;
+
+    lForward = windFft () ;
+
+        /*bin magnitudes on a scale independent of the block exponent*/
+    lShift = lForward + WIND_MAG_FRAC - WIND_FFT_BITS ;
+
+    for ( k = 0 ; k < WIND_BINS ; k++ )
+    {
+        uint32 lMagnitude = windMagnitude ( gRe [ k ] , gIm [ k ] ) ;
+        uint32 * lNoise = &pState->noise [ k ] ;
+        uint16 lGain ;
+
+        if ( lShift >= 0 )
+            lMagnitude <<= ( lShift > 12 ) ? 12 : lShift ;
+        else
+            lMagnitude >>= ( -lShift > 31 ) ? 31 : -lShift ;
+
+        if ( !pState->primed )
+            *lNoise = lMagnitude ;
+        else if ( lMagnitude < *lNoise )
+            *lNoise -= ( *lNoise - lMagnitude ) >> WIND_FALL_SHIFT ;
+        else if ( lMagnitude - *lNoise > ( *lNoise >> WIND_RISE_SHIFT ) )
+            *lNoise += ( *lNoise >> WIND_RISE_SHIFT ) + 1 ;
+        else
+            *lNoise = lMagnitude ;
+
+        if ( !lWindy )
+            lGain = 0x7fff ;
+        else if ( k < WIND_BAND_BINS )
+            lGain = windGain ( lMagnitude , *lNoise , WIND_OVER_BAND , WIND_FLOOR_BAND ) ;
+        else
+            lGain = windGain ( lMagnitude , *lNoise , WIND_OVER_SPEECH , WIND_FLOOR_SPEECH ) ;
+
+            /*rise at once so speech onsets are not clipped, fall over a hop to limit musical noise*/
+        if ( lGain < pState->gain [ k ] )
+            lGain = (uint16) ( ( (uint32) lGain + pState->gain [ k ] ) >> 1 ) ;
+        pState->gain [ k ] = lGain ;
+
+        if ( *lNoise < WIND_NOISE_MIN )
+            *lNoise = WIND_NOISE_MIN ;
+
+        gRe [ k ] = (int16) ( ( (int32) gRe [ k ] * lGain ) >> 15 ) ;
+        gIm [ k ] = (int16) ( ( (int32) gIm [ k ] * lGain ) >> 15 ) ;
+
+        if ( k && ( k < WIND_FFT / 2 ) )
+        {
+            gRe [ WIND_FFT - k ] = (int16) ( ( (int32) gRe [ WIND_FFT - k ] * lGain ) >> 15 ) ;
+            gIm [ WIND_FFT - k ] = (int16) ( ( (int32) gIm [ WIND_FFT - k ] * lGain ) >> 15 ) ;
+        }
+    }
+
+        /*the inverse is the forward transform of the conjugate; only the real part is wanted*/
+    for ( k = 0 ; k < WIND_FFT ; k++ )
+        gIm [ k ] = -gIm [ k ] ;
+
+    pState->primed = TRUE ;
+
+    lInverse = windFft () ;
+    lShift   = lForward + lInverse - WIND_FFT_BITS ;
+
+    for ( n = 0 ; n < WIND_HOP ; n++ )
+    {
+        int32 lHead = windShift ( gRe [ n ] , lShift ) ;
+        int32 lTail = windShift ( gRe [ n + WIND_HOP ] , lShift ) ;
+
+        lHead = ( ( lHead * gWindow [ n ] + 0x4000 ) >> 15 ) + pState->overlap [ n ] ;
+
+        pState->output [ n ]  = (int16) ( ( lHead > 0x7fff ) ? 0x7fff : ( ( lHead < -0x8000 ) ? -0x8000 : lHead ) ) ;
+        pState->overlap [ n ] = (int16) ( ( lTail * gWindow [ n + WIND_HOP ] + 0x4000 ) >> 15 ) ;
+    }
+
+    memmove ( pState->input , &pState->input [ WIND_HOP ] , ( WIND_WINDOW - WIND_HOP ) * sizeof ( int16 ) ) ;
+}
+
+
+/****************************************************************************
+  FUNCTIONS
+*/
+
+/**************************************************************************/
+void windInit ( windState_t * pState )
+{
+    uint16 k ;
+
+    memset ( pState , 0 , sizeof ( windState_t ) ) ;
+
+    for ( k = 0 ; k < WIND_BINS ; k++ )
+        pState->gain [ k ] = 0x7fff ;
+}
+
+
+/**************************************************************************/
+void windProcess ( windState_t * pState , int16 * pFrame , uint16 pSamples )
+{
+    uint16 i ;
+
+    for ( i = 0 ; i < pSamples ; i++ )
+    {
+        pState->input [ WIND_WINDOW - WIND_HOP + pState->fill ] = pFrame [ i ] ;
+        pFrame [ i ] = pState->output [ pState->fill ] ;
+
+        if ( ++pState->fill == WIND_HOP )
+        {
+            windHop ( pState ) ;
+            pState->fill = 0 ;
+        }
+    }
+}
@@ -0,0 +1,78 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    headset_wind.h
+@brief   Wind noise suppression for the 8kHz helmet microphone uplink.
+
+    At speed the helmet microphone is dominated by wind buffeting below
+    about 500Hz. Without cVc nothing removes it before it reaches the far
+    rider. This stage takes 15ms windows every 7.5ms, transforms them with
+    a 128 point fixed point FFT, tracks the noise in each frequency bin
+    and scales each bin down by how much of it is noise, then resynthesises
+    by overlap-add. The wind band is suppressed harder than the speech band
+    above it. While the tracked noise is not concentrated in the wind band
+    there is no wind to remove and the samples pass unchanged.
+
+    The stream is delayed by 15ms. Each microphone needs its own
+    windState_t; frames of any length may be passed, in place.
+*/
+
+#ifndef _HEADSET_WIND_H_
+#define _HEADSET_WIND_H_
+
+
+#include <csrtypes.h>
+
+
+/* Samples between analyses, 7.5ms, and the window analysed, 15ms */
+#define WIND_HOP            (60)
+#define WIND_WINDOW         ( 2 * WIND_HOP )
+
+/* Transform size, and the bins 0 to 4kHz it gives */
+#define WIND_FFT            (128)
+#define WIND_BINS           ( WIND_FFT / 2 + 1 )
+
+
+/*! @brief Suppression state of one microphone */
+typedef struct
+{
+    int16       input [ WIND_WINDOW ] ;             /*!< Last window of microphone samples, oldest first */
+    int16       output [ WIND_HOP ] ;               /*!< Suppressed samples being handed back */
+    int16       overlap [ WIND_WINDOW - WIND_HOP ] ; /*!< Tail of the last window, to add to the next */
+    uint32      noise [ WIND_BINS ] ;               /*!< Noise magnitude in each bin */
+    uint16      gain [ WIND_BINS ] ;                /*!< Gain last applied to each bin, Q15 */
+    uint16      fill ;                              /*!< Samples of the current hop taken */
+    bool        primed ;                            /*!< The noise has been estimated from a first window */
+} windState_t ;
+
+
+/****************************************************************************
+  FUNCTIONS
+*/
+
+/*************************************************************************
+NAME
+    windInit
+
+DESCRIPTION
+    Start a stream with silence in its window and no noise estimated.
+
+*/
+void windInit ( windState_t * pState ) ;
+
+
+/*************************************************************************
+NAME
+    windProcess
+
+DESCRIPTION
+    Suppress the wind in pSamples samples of pFrame, in place. The samples
+    returned are those passed WIND_WINDOW samples earlier.
+
+*/
+void windProcess ( windState_t * pState , int16 * pFrame , uint16 pSamples ) ;
+
+
+#endif /* _HEADSET_WIND_H_ */
@@ -0,0 +1,72 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    host_adpcm_encode.c
+@brief   Implementation of the host IMA ADPCM encoder.
+*/
+
+#include "host_adpcm_encode.h"
+
+
+/* Step sizes of the IMA ADPCM standard, as the decoder's */
+static const int gStep [ ADPCM_INDEX_MAX + 1 ] =
+{
+        7 ,     8 ,     9 ,    10 ,    11 ,    12 ,    13 ,    14 ,    16 ,    17 ,
+       19 ,    21 ,    23 ,    25 ,    28 ,    31 ,    34 ,    37 ,    41 ,    45 ,
+       50 ,    55 ,    60 ,    66 ,    73 ,    80 ,    88 ,    97 ,   107 ,   118 ,
+      130 ,   143 ,   157 ,   173 ,   190 ,   209 ,   230 ,   253 ,   279 ,   307 ,
+      337 ,   371 ,   408 ,   449 ,   494 ,   544 ,   598 ,   658 ,   724 ,   796 ,
+      876 ,   963 ,  1060 ,  1166 ,  1282 ,  1411 ,  1552 ,  1707 ,  1878 ,  2066 ,
+     2272 ,  2499 ,  2749 ,  3024 ,  3327 ,  3660 ,  4026 ,  4428 ,  4871 ,  5358 ,
+     5894 ,  6484 ,  7132 ,  7845 ,  8630 ,  9493 , 10442 , 11487 , 12635 , 13899 ,
+    15289 , 16818 , 18500 , 20350 , 22385 , 24623 , 27086 , 29794 , 32767
+} ;
+
+
+/**************************************************************************/
+unsigned long adpcmEncode ( const int16 * pIn , unsigned long pSamples , uint16 * pCodes )
+{
+    adpcmState_t lState ;
+    unsigned long lWords = ADPCM_WORDS ( pSamples ) ;
+    unsigned long n ;
+
+    adpcmInit ( &lState ) ;
+
+    for ( n = 0 ; n < lWords ; n++ )
+        pCodes [ n ] = 0 ;
+
+    for ( n = 0 ; n < pSamples ; n++ )
+    {
+        int lStep = gStep [ lState.index ] ;
+        int lDifference = pIn [ n ] - lState.predicted ;
+        uint16 lCode = 0 ;
+
+        if ( lDifference < 0 )
+        {
+            lCode       = 8 ;
+            lDifference = -lDifference ;
+        }
+
+            /*the magnitude, a bit at a time, as the decoder adds it up*/
+        if ( lDifference >= lStep )
+        {
+            lCode       |= 4 ;
+            lDifference -= lStep ;
+        }
+        if ( lDifference >= ( lStep >> 1 ) )
+        {
+            lCode       |= 2 ;
+            lDifference -= lStep >> 1 ;
+        }
+        if ( lDifference >= ( lStep >> 2 ) )
+            lCode |= 1 ;
+
+        (void) adpcmStep ( &lState , lCode ) ;
+
+        pCodes [ n / ADPCM_CODES_PER_WORD ] |= lCode << ( 12 - 4 * ( n % ADPCM_CODES_PER_WORD ) ) ;
+    }
+
+    return lWords ;
+}
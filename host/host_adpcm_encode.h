@@ -0,0 +1,36 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    host_adpcm_encode.h
+@brief   IMA ADPCM encoding of the voice prompts on the host.
+
+    Shared by the prompt compiler, which writes the prompt image, and the
+    prompt benchmark. The encoder follows the decoder of headset_adpcm.c
+    sample by sample, so what the headset decodes is exactly what was
+    chosen here.
+*/
+
+#ifndef _HOST_ADPCM_ENCODE_H_
+#define _HOST_ADPCM_ENCODE_H_
+
+
+#include "headset_adpcm.h"
+
+
+/*************************************************************************
+NAME
+    adpcmEncode
+
+DESCRIPTION
+    Encode pSamples samples from pIn, starting from adpcmInit's state, and
+    pack the codes into pCodes, the last word padded with zero codes.
+
+RETURNS
+    The words written, ADPCM_WORDS(pSamples).
+*/
+unsigned long adpcmEncode ( const int16 * pIn , unsigned long pSamples , uint16 * pCodes ) ;
+
+
+#endif /* _HOST_ADPCM_ENCODE_H_ */
@@ -0,0 +1,201 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    host_agc_bench.c
+@brief   Benchmark of the intercom automatic gain control (headset_agc.c).
+
+    Builds HOST_BENCH_SECONDS (default 120) of received intercom audio:
+    spoken phrases of 0.5 to 3s, made of synthetic voiced syllables, from
+    riders whose speech arrives between -45 and -6dBFS, each over their own
+    background noise 30dB below their speech. Phrases are separated by 0.5
+    to 3s of that noise alone. The signal is passed through agcProcess in
+    conference frames at three volume steps and one line is printed per
+    step:
+        agc step=<n> target_dbfs=<n> spread_in_db=<n> spread_out_db=<n> error_db=<n> peak_dbfs=<n> gate_db=<n> ns_per_sample=<n> cycles_per_sample=<n>
+    The spreads are the standard deviation of the phrases' levels (mean
+    magnitude over the phrase, in dB) before and after the AGC; error_db is
+    how far their mean after the AGC is from the target, which is followed
+    near syllable peaks. peak_dbfs is the loudest output sample, which the
+    limiter holds below -1dBFS. gate_db is how much further the noise is
+    turned down than the speech before it, once a pause has lasted 0.5s.
+*/
+
+#include "headset_agc.h"
+#include "host_bench.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+#define BENCH_MAX_PHRASES   (1024)
+#define BENCH_SETTLE        ( BENCH_RATE / 2 )
+
+/* Brings benchVoice to a mean magnitude of about one */
+#define BENCH_VOICE_SCALE   (1.6)
+
+
+/* Phrases of 0.5 to 3s after pauses of 0.5 to 3s, at unit level */
+static const benchTalker_t gTalker = { 0.5 , 2.5 , 0.5 , 2.5 , 100.0 , 120.0 , BENCH_VOICE_SCALE , 0.1 , 0.0 } ;
+
+static unsigned long gSamples ;
+static double * gSpeech ;
+static int16 * gIn ;
+static int16 * gOut ;
+static benchPhrase_t gPhrases [ BENCH_MAX_PHRASES ] ;
+static unsigned gPhraseCount ;
+
+
+/* Phrases from riders at random levels, each over their own noise */
+static void benchSignal ( void )
+{
+    unsigned long lSeed = 5 ;
+    unsigned long n = 0 ;
+    double lLevel = 0.0 ;
+    unsigned lCount ;
+    unsigned p ;
+
+    lCount = benchSpeech ( &gTalker , 5 , gSpeech , gSamples , gPhrases , BENCH_MAX_PHRASES , NULL ) ;
+    gPhraseCount = 0 ;
+
+        /*each phrase with the pause before it, then the pause after the last*/
+    for ( p = 0 ; p <= lCount ; p++ )
+    {
+        unsigned long lEnd = ( p < lCount ) ? gPhrases [ p ].end : gSamples ;
+
+            /*a new rider after every few phrases*/
+        if ( ( p % 3 ) == 0 )
+            lLevel = 32768.0 * pow ( 10.0 , ( -45.0 + 39.0 * benchRandom ( &lSeed ) ) / 20.0 ) ;
+
+        for ( ; n < lEnd ; n++ )
+        {
+            double lNoise = 0.03 * lLevel * 3.46 * ( benchRandom ( &lSeed ) - 0.5 ) ;
+
+            gIn [ n ] = benchSaturate ( lLevel * gSpeech [ n ] + lNoise ) ;
+        }
+
+        if ( ( p < lCount ) && ( gPhrases [ p ].start >= BENCH_SETTLE ) )
+            gPhrases [ gPhraseCount++ ] = gPhrases [ p ] ;
+    }
+}
+
+
+/* Mean magnitude of a stretch of samples in dBFS */
+static double benchLevel ( const int16 * pSamples , unsigned long pStart , unsigned long pEnd )
+{
+    double lSum = 0.0 ;
+    unsigned long n ;
+
+    for ( n = pStart ; n < pEnd ; n++ )
+        lSum += fabs ( (double) pSamples [ n ] ) ;
+
+    return 20.0 * log10 ( ( lSum / ( pEnd - pStart ) + 1e-9 ) / 32768.0 ) ;
+}
+
+
+static void benchSpread ( const int16 * pSamples , double * pMean , double * pSpread )
+{
+    double lSum = 0.0 , lSquares = 0.0 ;
+    unsigned p ;
+
+    for ( p = 0 ; p < gPhraseCount ; p++ )
+    {
+        double lLevel = benchLevel ( pSamples , gPhrases [ p ].start , gPhrases [ p ].end ) ;
+
+        lSum     += lLevel ;
+        lSquares += lLevel * lLevel ;
+    }
+
+    *pMean   = lSum / gPhraseCount ;
+    *pSpread = sqrt ( lSquares / gPhraseCount - *pMean * *pMean ) ;
+}
+
+
+static void benchCase ( uint16 pStep )
+{
+    uint16 lTarget = agcTargetForStep ( pStep ) ;
+    unsigned long lFrames = gSamples / AGC_FRAME_SAMPLES ;
+    double lInMean , lInSpread , lOutMean , lOutSpread ;
+    double lGate = 0.0 ;
+    unsigned long lGated = 0 ;
+    unsigned long long lCycles ;
+    double lSeconds ;
+    int lPeak = 0 ;
+    agcState_t lState ;
+    unsigned long n , f ;
+    unsigned p ;
+
+    memcpy ( gOut , gIn , gSamples * sizeof ( int16 ) ) ;
+
+    agcInit ( &lState , lTarget ) ;
+    lSeconds = benchNow () ;
+    lCycles  = BENCH_CYCLES () ;
+
+    for ( f = 0 ; f < lFrames ; f++ )
+        agcProcess ( &lState , &gOut [ f * AGC_FRAME_SAMPLES ] , AGC_FRAME_SAMPLES ) ;
+
+    lCycles  = BENCH_CYCLES () - lCycles ;
+    lSeconds = benchNow () - lSeconds ;
+
+    for ( n = 0 ; n < lFrames * AGC_FRAME_SAMPLES ; n++ )
+        lPeak = ( abs ( gOut [ n ] ) > lPeak ) ? abs ( gOut [ n ] ) : lPeak ;
+
+        /*noise in each pause from 0.5s after the phrase before it*/
+    for ( p = 0 ; p + 1 < gPhraseCount ; p++ )
+    {
+        unsigned long lStart = gPhrases [ p ].end + BENCH_SETTLE ;
+        unsigned long lEnd = gPhrases [ p + 1 ].start ;
+
+        if ( lEnd > lStart + AGC_FRAME_SAMPLES )
+        {
+            lGate += benchLevel ( gOut , gPhrases [ p ].start , gPhrases [ p ].end ) - benchLevel ( gIn , gPhrases [ p ].start , gPhrases [ p ].end ) ;
+            lGate -= benchLevel ( gOut , lStart , lEnd ) - benchLevel ( gIn , lStart , lEnd ) ;
+            lGated++ ;
+        }
+    }
+
+    benchSpread ( gIn , &lInMean , &lInSpread ) ;
+    benchSpread ( gOut , &lOutMean , &lOutSpread ) ;
+
+    printf ( "agc step=%u target_dbfs=%.1f spread_in_db=%.2f spread_out_db=%.2f error_db=%.2f peak_dbfs=%.2f gate_db=%.2f ns_per_sample=%.2f cycles_per_sample=%.2f\n" ,
+             pStep ,
+             20.0 * log10 ( lTarget / 32768.0 ) ,
+             lInSpread , lOutSpread ,
+             lOutMean - 20.0 * log10 ( lTarget / 32768.0 ) ,
+             20.0 * log10 ( ( lPeak + 1e-9 ) / 32768.0 ) ,
+             lGated ? lGate / lGated : 0.0 ,
+             lSeconds * 1e9 / ( (double) lFrames * AGC_FRAME_SAMPLES ) ,
+             (double) lCycles / ( (double) lFrames * AGC_FRAME_SAMPLES ) ) ;
+}
+
+
+int main ( void )
+{
+    static const uint16 lSteps [] = { 0 , 3 , 6 } ;
+    const char * lEnv = getenv ( "HOST_BENCH_SECONDS" ) ;
+    unsigned long lSeconds = lEnv ? strtoul ( lEnv , NULL , 10 ) : 120 ;
+    unsigned s ;
+
+    gSamples = lSeconds * BENCH_RATE ;
+    gSpeech  = malloc ( gSamples * sizeof ( double ) ) ;
+    gIn      = malloc ( gSamples * sizeof ( int16 ) ) ;
+    gOut     = malloc ( gSamples * sizeof ( int16 ) ) ;
+
+    if ( !gSpeech || !gIn || !gOut )
+        return 1 ;
+
+    benchSignal () ;
+    if ( !gPhraseCount )
+        return 1 ;
+
+    for ( s = 0 ; s < sizeof ( lSteps ) / sizeof ( lSteps [ 0 ] ) ; s++ )
+        benchCase ( lSteps [ s ] ) ;
+
+    free ( gSpeech ) ;
+    free ( gIn ) ;
+    free ( gOut ) ;
+    return 0 ;
+}
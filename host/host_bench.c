@@ -0,0 +1,133 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    host_bench.c
+@brief   Implementation of the host benchmarks' timing and test signals.
+*/
+
+#include "host_bench.h"
+
+#include <math.h>
+#include <string.h>
+#include <time.h>
+
+
+/**************************************************************************/
+double benchNow ( void )
+{
+    struct timespec lNow ;
+
+    clock_gettime ( CLOCK_MONOTONIC , &lNow ) ;
+    return lNow.tv_sec + lNow.tv_nsec * 1e-9 ;
+}
+
+
+/**************************************************************************/
+double benchRandom ( unsigned long * pSeed )
+{
+    *pSeed = *pSeed * 1103515245UL + 12345UL ;
+    return ( ( *pSeed >> 8 ) & 0xffffff ) / 16777216.0 ;
+}
+
+
+/**************************************************************************/
+int16 benchSaturate ( double pSample )
+{
+    return (int16) ( pSample > 32767 ? 32767 : ( pSample < -32768 ? -32768 : pSample ) ) ;
+}
+
+
+/**************************************************************************/
+double benchSyllable ( double t , double pFloor )
+{
+    double lSyllable = fmod ( t , 0.25 ) ;
+
+    return ( lSyllable < 0.2 ) ? sin ( M_PI * lSyllable / 0.2 ) : pFloor ;
+}
+
+
+/**************************************************************************/
+double benchHarmonics ( double pPitch , double pSpread , double * pPhase )
+{
+    static const double lFormant [ 3 ] = { 700.0 , 1200.0 , 2500.0 } ;
+    double lSample = 0.0 ;
+    int h ;
+
+    *pPhase += 2 * M_PI * pPitch / BENCH_RATE ;
+    if ( *pPhase > 2 * M_PI )
+        *pPhase -= 2 * M_PI ;
+
+    for ( h = 1 ; h * pPitch < BENCH_RATE / 2 ; h++ )
+    {
+        double lFreq = h * pPitch ;
+        double lGain = 0.0 ;
+        int f ;
+
+        for ( f = 0 ; f < 3 ; f++ )
+            lGain += 1.0 / ( 1.0 + pow ( ( lFreq - lFormant [ f ] ) / 150.0 , 2 ) ) / ( f + 1 ) ;
+
+        lSample += lGain * sin ( h * *pPhase + h * h * pSpread ) ;
+    }
+
+    return lSample ;
+}
+
+
+/**************************************************************************/
+double benchVoice ( double t , double pBase , double pFloor , double pSpread , double * pPhase )
+{
+    double lPitch = pBase * ( 1.0 + 0.15 * sin ( 2 * M_PI * 1.3 * t ) ) ;
+
+    return benchSyllable ( t , pFloor ) * benchHarmonics ( lPitch , pSpread , pPhase ) ;
+}
+
+
+/**************************************************************************/
+unsigned benchSpeech ( const benchTalker_t * pTalker , unsigned long pSeed , double * pOut , unsigned long pSamples ,
+                       benchPhrase_t * pPhrases , unsigned pMax , double * pPower )
+{
+    unsigned long lActive = 0 ;
+    unsigned long n = 0 ;
+    unsigned lCount = 0 ;
+    double lPhase = 0.0 ;
+    double lPower = 0.0 ;
+
+    memset ( pOut , 0 , pSamples * sizeof ( double ) ) ;
+
+    while ( !pPhrases || ( lCount < pMax ) )
+    {
+        unsigned long lPause = 0 ;
+        unsigned long lLength ;
+        double lBase ;
+        unsigned long i ;
+
+        if ( ( pTalker->pause_min > 0.0 ) || ( pTalker->pause_range > 0.0 ) )
+            lPause = (unsigned long) ( ( pTalker->pause_min + pTalker->pause_range * benchRandom ( &pSeed ) ) * BENCH_RATE ) ;
+        lLength = (unsigned long) ( ( pTalker->length_min + pTalker->length_range * benchRandom ( &pSeed ) ) * BENCH_RATE ) ;
+        lBase   = pTalker->pitch_min + pTalker->pitch_range * benchRandom ( &pSeed ) ;
+
+        n += lPause ;
+        if ( n + lLength > pSamples )
+            break ;
+
+        if ( pPhrases )
+        {
+            pPhrases [ lCount ].start = n ;
+            pPhrases [ lCount ].end   = n + lLength ;
+        }
+        lCount++ ;
+
+        for ( i = 0 ; i < lLength ; i++ , n++ )
+        {
+            pOut [ n ] = pTalker->amplitude * benchVoice ( (double) i / BENCH_RATE , lBase , pTalker->floor , pTalker->spread , &lPhase ) ;
+            lPower += pOut [ n ] * pOut [ n ] ;
+            lActive++ ;
+        }
+    }
+
+    if ( pPower )
+        *pPower = lActive ? lPower / lActive : 1.0 ;
+    return lCount ;
+}
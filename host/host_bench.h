@@ -0,0 +1,152 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    host_bench.h
+@brief   Timing and test signals shared by the host benchmarks.
+
+    Each benchmark times its stage with benchNow, and BENCH_CYCLES where it
+    reports cycles: these are read from the time stamp counter on x86 and
+    reported as 0 elsewhere. Signals are made from benchRandom's fixed
+    sequence, so that every run sees the same ones, and speech from
+    benchSpeech: phrases of benchVoice's voiced syllables, harmonics
+    gliding in pitch through three formants. A benchmark describes its
+    talker in a benchTalker_t and otherwise differs only in the module it
+    drives.
+*/
+
+#ifndef _HOST_BENCH_H_
+#define _HOST_BENCH_H_
+
+
+#include <csrtypes.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_CYCLES()      ( (unsigned long long) __rdtsc () )
+#else
+#define BENCH_CYCLES()      ( 0ULL )
+#endif
+
+
+/* Sample rate of the benchmarks' audio, as the SCO links' */
+#define BENCH_RATE          (8000)
+
+
+/*! @brief How benchSpeech's talker speaks. Each phrase follows a pause,
+    and each value with a range is drawn from [min, min + range) */
+typedef struct
+{
+    double  pause_min ;         /*!< Seconds before each phrase, none drawn if this and pause_range are 0 */
+    double  pause_range ;
+    double  length_min ;        /*!< Seconds of each phrase */
+    double  length_range ;
+    double  pitch_min ;         /*!< Base pitch of each phrase, Hz */
+    double  pitch_range ;
+    double  amplitude ;         /*!< Scale of benchVoice */
+    double  floor ;             /*!< Envelope between syllables */
+    double  spread ;            /*!< benchHarmonics' phase spread, 0 for a pulse */
+} benchTalker_t ;
+
+/*! @brief Where benchSpeech put a phrase */
+typedef struct
+{
+    unsigned long   start ;     /*!< First sample of the phrase */
+    unsigned long   end ;       /*!< First sample after it */
+} benchPhrase_t ;
+
+
+/*************************************************************************
+NAME
+    benchNow
+
+DESCRIPTION
+    Returns a monotonic time in seconds.
+
+*/
+double benchNow ( void ) ;
+
+
+/*************************************************************************
+NAME
+    benchRandom
+
+DESCRIPTION
+    Returns the next of a fixed sequence from *pSeed, uniform in [0,1).
+
+*/
+double benchRandom ( unsigned long * pSeed ) ;
+
+
+/*************************************************************************
+NAME
+    benchSaturate
+
+DESCRIPTION
+    Returns pSample rounded towards zero and held to 16 bits.
+
+*/
+int16 benchSaturate ( double pSample ) ;
+
+
+/*************************************************************************
+NAME
+    benchSyllable
+
+DESCRIPTION
+    Returns the envelope of syllables at t seconds: 200ms of half sine,
+    then 50ms at pFloor.
+
+*/
+double benchSyllable ( double t , double pFloor ) ;
+
+
+/*************************************************************************
+NAME
+    benchHarmonics
+
+DESCRIPTION
+    Returns one sample of the harmonics of pPitch Hz, shaped by three
+    formants, advancing *pPhase by one sample. With pSpread 0 the
+    harmonics line up into a pulse; otherwise harmonic h is offset by
+    h * h * pSpread, as a voice's are.
+
+*/
+double benchHarmonics ( double pPitch , double pSpread , double * pPhase ) ;
+
+
+/*************************************************************************
+NAME
+    benchVoice
+
+DESCRIPTION
+    Returns one sample of a voiced phrase t seconds in: benchHarmonics
+    around pBase Hz with pSpread, gliding 15% up and down at 1.3Hz, in
+    benchSyllable's envelope with pFloor between the syllables. *pPhase
+    carries on from one sample to the next.
+
+*/
+double benchVoice ( double t , double pBase , double pFloor , double pSpread , double * pPhase ) ;
+
+
+/*************************************************************************
+NAME
+    benchSpeech
+
+DESCRIPTION
+    Fills pSamples samples of pOut with pTalker's phrases drawn from
+    pSeed, silent between them, stopping at the first phrase which does
+    not fit. When pPhrases is not NULL, stops after pMax phrases and
+    records where each was put.
+
+RETURNS
+    The number of phrases; *pPower, unless NULL, is the mean power of
+    their samples.
+
+*/
+unsigned benchSpeech ( const benchTalker_t * pTalker , unsigned long pSeed , double * pOut , unsigned long pSamples ,
+                       benchPhrase_t * pPhrases , unsigned pMax , double * pPower ) ;
+
+
+#endif /* _HOST_BENCH_H_ */
@@ -0,0 +1,275 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    host_hw.c
+@brief   Host emulation of the persistent store, PIO, charger and battery traps.
+
+    Lengths passed to the persistent store are in the units returned by
+    sizeof on the build platform (words on BlueCore, bytes on the host), so
+    application code using sizeof() behaves identically on both.
+*/
+
+#include "host_runtime.h"
+
+#include <battery.h>
+#include <charger.h>
+#include <message.h>
+#include <panic.h>
+#include <pio.h>
+#include <ps.h>
+#include <sink.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+typedef struct
+{
+    uint16  length ;
+    uint8   data [ HOST_MAX_PS_KEY_SIZE * sizeof ( uint16 ) ] ;
+} hostPsKey ;
+
+static hostPsKey gPsKeys [ HOST_MAX_PS_KEYS ] ;
+
+static uint32   gPioInputs ;
+static uint32   gPioOutputs ;
+static uint32   gPioDirection ;
+static Task     gPioTask ;
+static Task     gChargerTask ;
+
+
+/****************************************************************************
+  PERSISTENT STORE
+*/
+
+uint16 PsStore ( uint16 key , const void * buff , uint16 words )
+{
+    if ( ( key >= HOST_MAX_PS_KEYS ) || ( words > sizeof ( gPsKeys [ 0 ].data ) ) )
+        return 0 ;
+
+    gPsKeys [ key ].length = words ;
+    if ( words )
+        memcpy ( gPsKeys [ key ].data , buff , words ) ;
+
+        /*storing zero words deletes the key - report success*/
+    return words ? words : 1 ;
+}
+
+
+uint16 PsRetrieve ( uint16 key , void * buff , uint16 words )
+{
+    if ( ( key >= HOST_MAX_PS_KEYS ) || !gPsKeys [ key ].length )
+        return 0 ;
+
+    if ( !words )
+        return gPsKeys [ key ].length ;
+
+    if ( words < gPsKeys [ key ].length )
+        return 0 ;
+
+    memcpy ( buff , gPsKeys [ key ].data , gPsKeys [ key ].length ) ;
+    return gPsKeys [ key ].length ;
+}
+
+
+uint16 PsFullRetrieve ( uint16 key , void * buff , uint16 words )
+{
+        /*no firmware keys are modelled*/
+    return 0 ;
+}
+
+
+void HostPsClear ( void )
+{
+    memset ( gPsKeys , 0 , sizeof ( gPsKeys ) ) ;
+}
+
+
+/****************************************************************************
+  PIO
+*/
+
+uint32 PioGet32 ( void )
+{
+    return ( gPioInputs & ~gPioDirection ) | ( gPioOutputs & gPioDirection ) ;
+}
+
+
+uint32 PioSet32 ( uint32 mask , uint32 bits )
+{
+    gPioOutputs = ( gPioOutputs & ~mask ) | ( bits & mask ) ;
+    return 0 ;
+}
+
+
+uint32 PioSetDir32 ( uint32 mask , uint32 dir )
+{
+    gPioDirection = ( gPioDirection & ~mask ) | ( dir & mask ) ;
+    return 0 ;
+}
+
+
+uint16 PioGet ( void )
+{
+    return (uint16) PioGet32 () ;
+}
+
+
+uint16 PioSet ( uint16 mask , uint16 bits )
+{
+    return (uint16) PioSet32 ( mask , bits ) ;
+}
+
+
+uint16 PioSetDir ( uint16 mask , uint16 dir )
+{
+    return (uint16) PioSetDir32 ( mask , dir ) ;
+}
+
+
+uint32 PioDebounce ( uint32 mask , uint16 count , uint16 period )
+{
+    return 0 ;
+}
+
+
+bool PioGetVregEn ( void )
+{
+    return FALSE ;
+}
+
+
+void PioSetPsuRegulator ( bool enable )
+{
+}
+
+
+bool PioSetMicBiasHwEnabled ( bool enable )
+{
+    return TRUE ;
+}
+
+
+bool PioSetMicBiasHwCurrent ( uint8 current )
+{
+    return TRUE ;
+}
+
+
+bool PioSetMicBiasHwVoltage ( uint8 voltage )
+{
+    return TRUE ;
+}
+
+
+bool PioSetLed0 ( bool on )
+{
+    return TRUE ;
+}
+
+
+bool PioSetLed1 ( bool on )
+{
+    return TRUE ;
+}
+
+
+bool PioDimLed0 ( uint16 duty , uint16 period )
+{
+    return FALSE ;
+}
+
+
+bool PioDimLed1 ( uint16 duty , uint16 period )
+{
+    return FALSE ;
+}
+
+
+Task MessagePioTask ( Task task )
+{
+    Task lOld = gPioTask ;
+    gPioTask = task ;
+    return lOld ;
+}
+
+
+void HostPioInject ( uint32 pState )
+{
+    gPioInputs = pState ;
+
+    if ( gPioTask )
+    {
+        MessagePioChanged * lMessage = PanicUnlessNew ( MessagePioChanged ) ;
+
+        memset ( lMessage , 0 , sizeof ( MessagePioChanged ) ) ;
+        lMessage->state       = (uint16) ( pState & 0xffff ) ;
+        lMessage->state16to31 = (uint16) ( pState >> 16 ) ;
+        lMessage->time        = (uint16) HostNow () ;
+
+        MessageSend ( gPioTask , MESSAGE_PIO_CHANGED , lMessage ) ;
+    }
+}
+
+
+uint32 HostPioOutputs ( void )
+{
+    return gPioOutputs & gPioDirection ;
+}
+
+
+/****************************************************************************
+  CHARGER AND BATTERY
+*/
+
+Task MessageChargerTask ( Task task )
+{
+    Task lOld = gChargerTask ;
+    gChargerTask = task ;
+    return lOld ;
+}
+
+
+charger_status ChargerStatus ( void )
+{
+    return NO_POWER ;
+}
+
+
+bool ChargerDebounce ( uint16 events , uint16 count , uint16 period )
+{
+    return TRUE ;
+}
+
+
+bool ChargerSupressLed0 ( bool suppress )
+{
+    return TRUE ;
+}
+
+
+void BatteryInit ( BatteryState * state , Task client , battery_reading_source source , uint32 period )
+{
+        /*report a healthy 4.0V cell after the requested period, the
+          application then re-arms the reading with its own period*/
+    uint32 * lReading = PanicUnlessNew ( uint32 ) ;
+
+    *lReading = 4000 ;
+    MessageCancelAll ( client , BATTERY_READING_MESSAGE ) ;
+    MessageSendLater ( client , BATTERY_READING_MESSAGE , lReading , period ) ;
+}
+
+
+/****************************************************************************
+  SINKS
+*/
+
+bool SinkGetBdAddr ( Sink sink , bdaddr * addr )
+{
+    if ( !sink )
+        return FALSE ;
+
+    *addr = HostPeer ()->peer_addr ;
+    return TRUE ;
+}
@@ -0,0 +1,259 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    host_jitter_bench.c
+@brief   Replay of SCO arrival timing through the jitter buffer (headset_jitter.c).
+
+    Replays HOST_BENCH_SECONDS (default 300) of a rider's 3.75ms frames
+    arriving to a conference that plays one frame every 3.75ms by its own
+    codec clock, and prints one line per trace and buffer:
+        jitter trace=<name> buffer=<adaptive|fixed_<n>ms> concealed_pct=<n> underruns_per_min=<n> late_per_min=<n> mean_depth_ms=<n> max_depth_ms=<n> stretched_pct=<n> ns_per_frame=<n>
+    concealed_pct is the share of frames played that had to be concealed,
+    late_per_min the frames that arrived after their turn. The depths are
+    of what was buffered as each frame was played. The fixed buffers wait
+    for their depth to build up before playing, as the adaptive one waits
+    for its target, and drop their oldest frame when two more than that
+    are queued, but never stretch; they show the choice between latency
+    and dropouts that a fixed depth forces.
+
+    The traces are modelled:
+        pair    one link, the rider's clock 100ppm fast; 3% of frames are
+                retransmitted once, 2.5ms late, and the frames are handed
+                to the application up to 1ms late
+        group   three links sharing the air: 15% of frames retransmitted
+                up to three times, and one frame in 1000 held up with those
+                behind it for 8 to 15ms while the radio is busy elsewhere
+                (about 16 times a minute)
+        mixed   pair and group alternating every 20s
+    and HOST_JITTER_TRACE may name a recorded one: a text file of arrival
+    times in milliseconds, one per frame. Arrival times reach the buffer in
+    whole milliseconds, as VmGetClock gives them.
+*/
+
+#include "headset_jitter.h"
+#include "host_bench.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+#define BENCH_FRAME         (30)
+#define BENCH_PERIOD_MS     ( 1000.0 * BENCH_FRAME / BENCH_RATE )
+
+
+static unsigned long gFrames ;
+static double * gArrival ;
+
+
+static int benchCompare ( const void * pA , const void * pB )
+{
+    double a = * (const double *) pA ;
+    double b = * (const double *) pB ;
+
+    return ( a > b ) - ( a < b ) ;
+}
+
+
+/* Arrival of each frame: sent on the rider's clock, delayed on air and in
+   handing over, never overtaking the frame before */
+static void benchModel ( int pGroup , int pMixed )
+{
+    unsigned long lSeed = 23 ;
+    double lHeld = 0.0 ;
+    unsigned long f ;
+
+    for ( f = 0 ; f < gFrames ; f++ )
+    {
+        double lSent = f * BENCH_PERIOD_MS * ( 1.0 - 100e-6 ) ;
+        int lBusy = pMixed ? (int) ( (unsigned long) ( lSent / 20000.0 ) & 1 ) : pGroup ;
+        double lArrival = lSent + 1.0 + benchRandom ( &lSeed ) ;
+
+        if ( lBusy )
+        {
+            int r ;
+
+            for ( r = 0 ; ( r < 3 ) && ( benchRandom ( &lSeed ) < 0.15 ) ; r++ )
+                lArrival += 1.25 ;
+
+            if ( benchRandom ( &lSeed ) < 0.001 )
+                lHeld = lArrival + 8.0 + 7.0 * benchRandom ( &lSeed ) ;
+        }
+        else if ( benchRandom ( &lSeed ) < 0.03 )
+        {
+            lArrival += 2.5 ;
+        }
+
+        if ( lArrival < lHeld )
+            lArrival = lHeld ;
+        if ( f && ( lArrival < gArrival [ f - 1 ] ) )
+            lArrival = gArrival [ f - 1 ] ;
+
+        gArrival [ f ] = lArrival ;
+    }
+}
+
+
+/* Recorded arrivals from HOST_JITTER_TRACE, FALSE if there are none */
+static bool benchTrace ( void )
+{
+    const char * lName = getenv ( "HOST_JITTER_TRACE" ) ;
+    FILE * lFile ;
+    double lTime ;
+    unsigned long f = 0 ;
+
+    if ( !lName || !( lFile = fopen ( lName , "r" ) ) )
+        return FALSE ;
+
+    while ( ( f < gFrames ) && ( fscanf ( lFile , "%lf" , &lTime ) == 1 ) )
+        gArrival [ f++ ] = lTime ;
+
+    fclose ( lFile ) ;
+
+    if ( !f )
+        return FALSE ;
+
+    gFrames = f ;
+    qsort ( gArrival , gFrames , sizeof ( double ) , benchCompare ) ;
+    return TRUE ;
+}
+
+
+/* Play the trace out through the adaptive buffer, or a fixed one of
+   pFixed frames when pFixed is not 0 */
+static void benchCase ( const char * pTrace , unsigned pFixed )
+{
+    static int16 lFrame [ BENCH_FRAME ] ;
+    jitterState_t lState ;
+    unsigned long lPlayed = 0 , lConcealed = 0 , lStretched = 0 ;
+    unsigned long lUnderruns = 0 , lLate = 0 ;
+    unsigned long lQueued = 0 ;
+    double lDepth = 0.0 , lDepthMax = 0.0 ;
+    double lSeconds = 0.0 ;
+    double lTick ;
+    bool lFilling = TRUE , lStarved = FALSE ;
+    unsigned long f = 0 ;
+    char lBuffer [ 32 ] ;
+
+    jitterInit ( &lState ) ;
+
+        /*the conference's clock starts with the first frame and runs to the last*/
+    for ( lTick = gArrival [ 0 ] ; lTick < gArrival [ gFrames - 1 ] ; lTick += BENCH_PERIOD_MS )
+    {
+        double lStart ;
+        bool lGood ;
+
+        for ( ; ( f < gFrames ) && ( gArrival [ f ] <= lTick ) ; f++ )
+        {
+            if ( pFixed )
+            {
+                if ( ++lQueued > pFixed + 2 )
+                    lQueued-- ;
+                if ( lStarved )
+                    lLate++ ;
+                lStarved = FALSE ;
+            }
+            else
+            {
+                lFrame [ 0 ] = (int16) f ;
+                jitterPut ( &lState , lFrame , BENCH_FRAME , (uint32) gArrival [ f ] ) ;
+            }
+        }
+
+        if ( pFixed )
+        {
+            if ( lFilling && ( lQueued >= pFixed ) )
+                lFilling = FALSE ;
+
+            lGood = !lFilling && lQueued ;
+            if ( !lFilling && !lQueued )
+            {
+                lUnderruns++ ;
+                lStarved = TRUE ;
+                lFilling = TRUE ;
+            }
+            if ( lGood )
+                lQueued-- ;
+
+            lDepth   += lQueued * BENCH_PERIOD_MS ;
+            lDepthMax = ( lQueued * BENCH_PERIOD_MS > lDepthMax ) ? lQueued * BENCH_PERIOD_MS : lDepthMax ;
+        }
+        else
+        {
+            unsigned long lBefore = lState.stats.compressed + lState.stats.expanded ;
+
+            lStart   = benchNow () ;
+            lGood    = jitterGet ( &lState , lFrame , BENCH_FRAME ) ;
+            lSeconds += benchNow () - lStart ;
+
+            lStretched += lState.stats.compressed + lState.stats.expanded - lBefore ;
+            lDepth     += lState.stats.depth * 1000.0 / BENCH_RATE ;
+            lDepthMax   = ( lState.stats.depth * 1000.0 / BENCH_RATE > lDepthMax ) ? lState.stats.depth * 1000.0 / BENCH_RATE : lDepthMax ;
+        }
+
+        lPlayed++ ;
+        if ( !lGood )
+            lConcealed++ ;
+    }
+
+    if ( !pFixed )
+    {
+        lUnderruns = lState.stats.underruns ;
+        lLate      = lState.stats.late ;
+        strcpy ( lBuffer , "adaptive" ) ;
+    }
+    else
+    {
+        sprintf ( lBuffer , "fixed_%.1fms" , pFixed * BENCH_PERIOD_MS ) ;
+    }
+
+    printf ( "jitter trace=%s buffer=%s concealed_pct=%.3f underruns_per_min=%.2f late_per_min=%.2f mean_depth_ms=%.2f max_depth_ms=%.2f stretched_pct=%.2f ns_per_frame=%.1f\n" ,
+             pTrace , lBuffer ,
+             100.0 * lConcealed / lPlayed ,
+             lUnderruns * 60000.0 / ( lPlayed * BENCH_PERIOD_MS ) ,
+             lLate * 60000.0 / ( lPlayed * BENCH_PERIOD_MS ) ,
+             lDepth / lPlayed , lDepthMax ,
+             100.0 * lStretched / lPlayed ,
+             pFixed ? 0.0 : lSeconds * 1e9 / lPlayed ) ;
+}
+
+
+static void benchTraceCases ( const char * pTrace )
+{
+    benchCase ( pTrace , 0 ) ;
+    benchCase ( pTrace , 1 ) ;
+    benchCase ( pTrace , 4 ) ;
+}
+
+
+int main ( void )
+{
+    const char * lEnv = getenv ( "HOST_BENCH_SECONDS" ) ;
+    unsigned long lSeconds = lEnv ? strtoul ( lEnv , NULL , 10 ) : 300 ;
+
+    gFrames  = (unsigned long) ( lSeconds * 1000.0 / BENCH_PERIOD_MS ) ;
+    gArrival = malloc ( gFrames * sizeof ( double ) ) ;
+
+    if ( !gArrival || ( gFrames < 2 ) )
+        return 1 ;
+
+    if ( benchTrace () )
+    {
+        benchTraceCases ( "file" ) ;
+    }
+    else
+    {
+        benchModel ( 0 , 0 ) ;
+        benchTraceCases ( "pair" ) ;
+        benchModel ( 1 , 0 ) ;
+        benchTraceCases ( "group" ) ;
+        benchModel ( 0 , 1 ) ;
+        benchTraceCases ( "mixed" ) ;
+    }
+
+    free ( gArrival ) ;
+    return 0 ;
+}
@@ -0,0 +1,532 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    host_libs.c
+@brief   Host models of the BlueLab profile and audio library entry points.
+
+    Each entry point answers with the confirmation the real library would
+    send, after a latency taken from the remote device model (hostPeerModel).
+    Only the intercom peer is modelled as a real device; the phone and the
+    A2DP source are absent, so connection attempts towards them time out.
+*/
+
+#include "host_runtime.h"
+
+#include <a2dp.h>
+#include <aghfp.h>
+#include <audio.h>
+#include <avrcp.h>
+#include <codec.h>
+#include <connection.h>
+#include <hfp.h>
+#include <panic.h>
+#include <csr_cvc_common_plugin.h>
+#include <csr_common_no_dsp_plugin.h>
+#include <csr_a2dp_decoder_common_plugin.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/* Class of device advertised by the modelled intercom peer */
+#define HOST_PEER_CLASS_OF_DEVICE   (0x200404)
+
+/* Answers to an inquiry arrive within two trains */
+#define HOST_INQUIRY_ANSWER_MS      (2560)
+
+/* Fake stream handles */
+#define HOST_INTERCOM_SLC_SINK      ((Sink)0x1001)
+#define HOST_INTERCOM_SCO_SINK      ((Sink)0x1002)
+
+
+/* Opaque profile instances handed to the application */
+static uint16   gHfpInstance [ 2 ] ;
+static uint16   gAghfpInstance ;
+static uint16   gA2dpInstance ;
+static uint16   gAvrcpInstance ;
+static uint16   gCodecInstance ;
+
+static Task     gHfpTask ;
+static Task     gAghfpTask ;
+static uint16   gHfpInitCount ;
+
+static bool     gAghfpSlcUp ;
+static bool     gAghfpAudioUp ;
+static bool     gReplay ;
+
+static hostPeerModel    gPeer =
+{
+    { 0x000001 , 0x5b , 0x0002 } ,  /* peer_addr */
+    TRUE ,                          /* peer_present */
+    TRUE ,                          /* peer_accepts_sco */
+    0 ,
+    1200 ,                          /* page_ms */
+    5120 ,                          /* page_timeout_ms */
+    150 ,                           /* sco_ms */
+    200 ,                           /* jitter_ms */
+    0 ,                             /* peer_return_ms */
+    0                               /* bystanders */
+} ;
+
+static hostLibTrace     gTrace ;
+
+/* The plugins are only used as identities by the application */
+const CvcPluginTaskdata     csr_cvsd_cvc_1mic_headset_plugin ;
+const NoDspPluginTaskdata   csr_cvsd_no_dsp_plugin ;
+const A2dpPluginTaskdata    csr_sbc_decoder_plugin ;
+
+
+#define HOST_NEW(TYPE) ((TYPE *) memset ( PanicUnlessNew ( TYPE ) , 0 , sizeof ( TYPE ) ))
+
+
+/****************************************************************************
+  LOCAL FUNCTIONS
+*/
+
+/* Post a library message - suppressed while a trace is replayed, as the trace holds them */
+static void hostLibPost ( Task pTask , MessageId pId , void * pMessage , uint32 pDelay )
+{
+    if ( gReplay )
+        free ( pMessage ) ;
+    else
+        MessageSendLater ( pTask , pId , pMessage , pDelay ) ;
+}
+
+
+static uint32 hostJitter ( void )
+{
+    return gPeer.jitter_ms ? ( HostRandom () % gPeer.jitter_ms ) : 0 ;
+}
+
+
+static bool hostPeerInRange ( void )
+{
+    if ( gPeer.peer_present )
+        return TRUE ;
+
+    if ( gPeer.peer_return_ms && ( HostNow () >= gPeer.peer_return_ms ) )
+    {
+        gPeer.peer_present = TRUE ;
+        return TRUE ;
+    }
+    return FALSE ;
+}
+
+
+/****************************************************************************
+  HOST MODEL API
+*/
+
+hostPeerModel * HostPeer ( void )
+{
+    return &gPeer ;
+}
+
+
+hostLibTrace * HostLibTrace ( void )
+{
+    return &gTrace ;
+}
+
+
+void HostLibReset ( void )
+{
+    memset ( &gTrace , 0 , sizeof ( gTrace ) ) ;
+}
+
+
+void HostLibSetReplay ( bool pReplay )
+{
+    gReplay = pReplay ;
+}
+
+
+void HostPeerLinkLoss ( void )
+{
+    if ( !gAghfpSlcUp )
+        return ;
+
+    gPeer.peer_present = FALSE ;
+
+    if ( gAghfpAudioUp )
+    {
+        AGHFP_AUDIO_DISCONNECT_IND_T * lInd = HOST_NEW ( AGHFP_AUDIO_DISCONNECT_IND_T ) ;
+        lInd->aghfp  = (AGHFP *) &gAghfpInstance ;
+        lInd->status = aghfp_audio_disconnect_link_loss ;
+        hostLibPost ( gAghfpTask , AGHFP_AUDIO_DISCONNECT_IND , lInd , 0 ) ;
+        gAghfpAudioUp = FALSE ;
+    }
+
+    {
+        AGHFP_SLC_DISCONNECT_IND_T * lInd = HOST_NEW ( AGHFP_SLC_DISCONNECT_IND_T ) ;
+        lInd->aghfp  = (AGHFP *) &gAghfpInstance ;
+        lInd->status = aghfp_disconnect_link_loss ;
+        hostLibPost ( gAghfpTask , AGHFP_SLC_DISCONNECT_IND , lInd , 0 ) ;
+    }
+    gAghfpSlcUp = FALSE ;
+}
+
+
+void HostPeerCalls ( void )
+{
+    AGHFP_SLC_CONNECT_IND_T * lInd = HOST_NEW ( AGHFP_SLC_CONNECT_IND_T ) ;
+
+    lInd->aghfp   = (AGHFP *) &gAghfpInstance ;
+    lInd->bd_addr = gPeer.peer_addr ;
+    hostLibPost ( gAghfpTask , AGHFP_SLC_CONNECT_IND , lInd , 0 ) ;
+}
+
+
+void HostPhoneLinkLoss ( HFP * pHfp )
+{
+    HFP_SLC_DISCONNECT_IND_T * lInd = HOST_NEW ( HFP_SLC_DISCONNECT_IND_T ) ;
+
+    lInd->hfp    = pHfp ;
+    lInd->status = hfp_disconnect_link_loss ;
+    hostLibPost ( gHfpTask , HFP_SLC_DISCONNECT_IND , lInd , 0 ) ;
+}
+
+
+/****************************************************************************
+  CODEC
+*/
+
+void CodecInitCsrInternal ( Task appTask )
+{
+    CODEC_INIT_CFM_T * lCfm = HOST_NEW ( CODEC_INIT_CFM_T ) ;
+    lCfm->status    = success ;
+    lCfm->codecTask = (Task) &gCodecInstance ;
+    hostLibPost ( appTask , CODEC_INIT_CFM , lCfm , 0 ) ;
+}
+
+
+/****************************************************************************
+  CONNECTION LIBRARY
+*/
+
+void ConnectionInit ( Task theAppTask )
+{
+    CL_INIT_CFM_T * lCfm = HOST_NEW ( CL_INIT_CFM_T ) ;
+    lCfm->status  = success ;
+    lCfm->version = bluetooth2_0 ;
+    hostLibPost ( theAppTask , CL_INIT_CFM , lCfm , 0 ) ;
+}
+
+
+/* The peer is held next to us, bystanders are further off and may be heard as strongly */
+static void hostInquiryAnswer ( Task pTask , const bdaddr * pAddr , int16 pRssi )
+{
+    CL_DM_INQUIRE_RESULT_T * lRes = HOST_NEW ( CL_DM_INQUIRE_RESULT_T ) ;
+
+    lRes->status    = inquiry_status_result ;
+    lRes->bd_addr   = *pAddr ;
+    lRes->dev_class = HOST_PEER_CLASS_OF_DEVICE ;
+    lRes->rssi      = pRssi ;
+    hostLibPost ( pTask , CL_DM_INQUIRE_RESULT , lRes , HostRandom () % HOST_INQUIRY_ANSWER_MS ) ;
+}
+
+
+void ConnectionInquire ( Task theAppTask , uint32 inquiry_lap , uint8 max_responses , uint16 timeout , uint32 class_of_device )
+{
+    uint32 lDuration = (uint32) timeout * 1280 ;
+    CL_DM_INQUIRE_RESULT_T * lReady = HOST_NEW ( CL_DM_INQUIRE_RESULT_T ) ;
+    uint16 i ;
+
+    gTrace.inquiry_calls++ ;
+
+    if ( hostPeerInRange () )
+        hostInquiryAnswer ( theAppTask , &gPeer.peer_addr , (int16) ( -40 - (int16) ( HostRandom () % 30 ) ) ) ;
+
+    for ( i = 0 ; i < gPeer.bystanders ; i++ )
+    {
+        bdaddr lAddr = gPeer.peer_addr ;
+
+        lAddr.lap += 0x100 + i ;
+        hostInquiryAnswer ( theAppTask , &lAddr , (int16) ( -55 - (int16) ( HostRandom () % 35 ) ) ) ;
+    }
+
+    lReady->status = inquiry_status_ready ;
+    hostLibPost ( theAppTask , CL_DM_INQUIRE_RESULT , lReady , lDuration ) ;
+}
+
+
+void ConnectionInquireCancel ( Task theAppTask )
+{
+    CL_DM_INQUIRE_RESULT_T * lReady = HOST_NEW ( CL_DM_INQUIRE_RESULT_T ) ;
+
+    (void) MessageCancelAll ( theAppTask , CL_DM_INQUIRE_RESULT ) ;
+
+    lReady->status = inquiry_status_ready ;
+    hostLibPost ( theAppTask , CL_DM_INQUIRE_RESULT , lReady , 0 ) ;
+}
+
+
+void ConnectionReadLocalName ( Task theAppTask ) { }
+void ConnectionWriteInquiryMode ( Task theAppTask , inquiry_mode mode ) { }
+void ConnectionEnterDutMode ( void ) { }
+void ConnectionWriteClassOfDevice ( uint32 cod ) { }
+void ConnectionWriteScanEnable ( hci_scan_enable mode ) { }
+void ConnectionWritePagescanActivity ( uint16 ps_interval , uint16 ps_window ) { }
+void ConnectionWriteInquiryscanActivity ( uint16 is_interval , uint16 is_window ) { }
+void ConnectionWriteEirData ( uint8 fec_required , uint8 size_eir_data , const uint8 * eir_data ) { }
+void ConnectionSetLinkPolicy ( Sink sink , uint16 size_power_table , lp_power_table const * power_table ) { }
+void ConnectionSetLinkSupervisionTimeout ( Sink sink , uint16 timeout ) { }
+void ConnectionSetRole ( Task theAppTask , Sink sink , hci_role role ) { }
+void ConnectionSetSniffSubRatePolicy ( Sink sink , uint16 max_remote_latency , uint16 min_remote_timeout , uint16 min_local_timeout ) { }
+void ConnectionSmAuthenticate ( Task theAppTask , const bdaddr * bd_addr , uint16 timeout ) { }
+void ConnectionSmAuthoriseResponse ( const bdaddr * bd_addr , dm_protocol_id protocol_id , uint32 channel , bool incoming , bool authorised ) { }
+void ConnectionSmDeleteAllAuthDevices ( uint16 ps_base ) { }
+bool ConnectionSmDeleteAuthDevice ( const bdaddr * peer_bd_addr ) { return TRUE ; }
+void ConnectionSmEncrypt ( Task theAppTask , Sink sink , bool encrypt ) { }
+void ConnectionSmEncryptionKeyRefreshSink ( Sink sink ) { }
+void ConnectionSmIoCapabilityResponse ( const bdaddr * bd_addr , cl_sm_io_capability io_capability , bool force_mitm , bool bonding , bool oob_data_present , uint8 * oob_hash_c , uint8 * oob_rand_r ) { }
+void ConnectionSmPinCodeResponse ( const bdaddr * bd_addr , uint16 length , const uint8 * pin_code ) { }
+void ConnectionSmRegisterIncomingService ( dm_protocol_id protocol_id , uint32 channel , dm_security_level security_level ) { }
+void ConnectionSmSecModeConfig ( Task theAppTask , cl_sm_wae write_auth_enable , bool debug_keys , bool legacy_auto_pair_key_missing ) { }
+void ConnectionSmSetSecurityLevel ( dm_protocol_id protocol_id , uint32 channel , dm_ssp_security_level ssp_sec_level , bool outgoing_ok , bool authorised , bool denied ) { }
+void ConnectionSmUserConfirmationResponse ( const bdaddr * bd_addr , bool confirm ) { }
+void ConnectionSmUserPasskeyResponse ( const bdaddr * bd_addr , bool cancelled , uint32 numeric_value ) { }
+void VmSendDmPrim ( void * prim ) { free ( prim ) ; }
+
+
+/****************************************************************************
+  HFP LIBRARY - the phone is not modelled, connections towards it time out
+*/
+
+void HfpInit ( Task theAppTask , const hfp_init_params * config )
+{
+    HFP_INIT_CFM_T * lCfm = HOST_NEW ( HFP_INIT_CFM_T ) ;
+
+    gHfpTask     = theAppTask ;
+    lCfm->status = hfp_init_success ;
+    lCfm->hfp    = (HFP *) &gHfpInstance [ gHfpInitCount++ & 1 ] ;
+    hostLibPost ( theAppTask , HFP_INIT_CFM , lCfm , 0 ) ;
+}
+
+
+void HfpSlcConnect ( HFP * hfp , const bdaddr * bd_addr , const hfp_connect_params * params )
+{
+    HFP_SLC_CONNECT_CFM_T * lCfm = HOST_NEW ( HFP_SLC_CONNECT_CFM_T ) ;
+    uint32 lLatency = gPeer.page_timeout_ms + hostJitter () ;
+
+    lCfm->hfp    = hfp ;
+    lCfm->status = hfp_connect_timeout ;
+
+    gTrace.hfp_connect_calls++ ;
+    gTrace.page_time_ms += lLatency ;
+
+    hostLibPost ( gHfpTask , HFP_SLC_CONNECT_CFM , lCfm , lLatency ) ;
+}
+
+
+Sink HfpGetSlcSink ( HFP * hfp ) { return 0 ; }
+Sink HfpGetAudioSink ( HFP * hfp ) { return 0 ; }
+void HfpSlcConnectResponse ( HFP * hfp , bool response , const bdaddr * bd_addr , const hfp_connect_params * params ) { }
+void HfpSlcDisconnect ( HFP * hfp ) { }
+void HfpAudioConnect ( HFP * hfp , sync_pkt_type packet_type , const hfp_audio_params * audio_params ) { }
+void HfpAudioConnectResponse ( HFP * hfp , bool response , sync_pkt_type packet_type , const hfp_audio_params * audio_params , bdaddr bd_addr ) { }
+void HfpAudioDisconnect ( HFP * hfp ) { }
+void HfpAnswerCall ( HFP * hfp ) { }
+void HfpTerminateCall ( HFP * hfp ) { }
+void HfpLastNumberRedial ( HFP * hfp ) { }
+void HfpDialNumber ( HFP * hfp , uint16 length , const uint8 * number ) { }
+void HfpGetCurrentCalls ( HFP * hfp ) { }
+void HfpDisableNrEc ( HFP * hfp ) { }
+void HfpSendHsButtonPress ( HFP * hfp ) { }
+void HfpCsrSupportedFeaturesReq ( HFP * hfp , bool callerName , bool rawText , bool smsInd , bool battLevel , bool pwrSource , uint16 codecs ) { }
+
+
+/****************************************************************************
+  AGHFP LIBRARY - the intercom peer
+*/
+
+void AghfpInit ( Task theAppTask , aghfp_profile aghfp_supported_profile , uint16 supported_features )
+{
+    AGHFP_INIT_CFM_T * lCfm = HOST_NEW ( AGHFP_INIT_CFM_T ) ;
+
+    gAghfpTask   = theAppTask ;
+    lCfm->status = aghfp_init_success ;
+    lCfm->aghfp  = (AGHFP *) &gAghfpInstance ;
+    hostLibPost ( theAppTask , AGHFP_INIT_CFM , lCfm , 0 ) ;
+}
+
+
+void AghfpSlcConnect ( AGHFP * aghfp , const bdaddr * bd_addr )
+{
+    AGHFP_SLC_CONNECT_CFM_T * lCfm = HOST_NEW ( AGHFP_SLC_CONNECT_CFM_T ) ;
+    uint32 lLatency ;
+
+    lCfm->aghfp   = aghfp ;
+    lCfm->bd_addr = *bd_addr ;
+
+    if ( hostPeerInRange () && BdaddrIsSame ( bd_addr , &gPeer.peer_addr ) )
+    {
+        lLatency     = gPeer.page_ms + hostJitter () ;
+        lCfm->status = aghfp_connect_success ;
+        lCfm->rfcomm_sink = HOST_INTERCOM_SLC_SINK ;
+        gAghfpSlcUp  = TRUE ;
+        gTrace.last_slc_connect_ms = HostNow () + lLatency ;
+    }
+    else
+    {
+        lLatency     = gPeer.page_timeout_ms + hostJitter () ;
+        lCfm->status = aghfp_connect_timeout ;
+    }
+
+    gTrace.slc_connect_calls++ ;
+    gTrace.page_time_ms += lLatency ;
+
+    hostLibPost ( gAghfpTask , AGHFP_SLC_CONNECT_CFM , lCfm , lLatency ) ;
+}
+
+
+void AghfpSlcConnectResponse ( AGHFP * aghfp , bool response , const bdaddr * bd_addr )
+{
+    AGHFP_SLC_CONNECT_CFM_T * lCfm = HOST_NEW ( AGHFP_SLC_CONNECT_CFM_T ) ;
+
+    lCfm->aghfp   = aghfp ;
+    lCfm->bd_addr = *bd_addr ;
+    lCfm->status  = response ? aghfp_connect_success : aghfp_connect_rejected ;
+    gAghfpSlcUp   = response ;
+    hostLibPost ( gAghfpTask , AGHFP_SLC_CONNECT_CFM , lCfm , 0 ) ;
+}
+
+
+void AghfpSlcDisconnect ( AGHFP * aghfp )
+{
+    AGHFP_SLC_DISCONNECT_IND_T * lInd = HOST_NEW ( AGHFP_SLC_DISCONNECT_IND_T ) ;
+
+    if ( gAghfpAudioUp )
+        AghfpAudioDisconnect ( aghfp ) ;
+
+    lInd->aghfp  = aghfp ;
+    lInd->status = aghfp_disconnect_success ;
+    gAghfpSlcUp  = FALSE ;
+    hostLibPost ( gAghfpTask , AGHFP_SLC_DISCONNECT_IND , lInd , 0 ) ;
+}
+
+
+void AghfpAudioConnect ( AGHFP * aghfp , sync_pkt_type packet_type , const aghfp_audio_params * audio_params )
+{
+    AGHFP_AUDIO_CONNECT_CFM_T * lCfm = HOST_NEW ( AGHFP_AUDIO_CONNECT_CFM_T ) ;
+
+    lCfm->aghfp = aghfp ;
+
+    if ( gAghfpSlcUp && gPeer.peer_accepts_sco )
+    {
+        lCfm->status     = aghfp_audio_connect_success ;
+        lCfm->audio_sink = HOST_INTERCOM_SCO_SINK ;
+        lCfm->link_type  = sync_link_sco ;
+        gAghfpAudioUp    = TRUE ;
+    }
+    else
+    {
+        lCfm->status = aghfp_audio_connect_failure ;
+    }
+
+    hostLibPost ( gAghfpTask , AGHFP_AUDIO_CONNECT_CFM , lCfm , gPeer.sco_ms + hostJitter () ) ;
+}
+
+
+void AghfpAudioConnectResponse ( AGHFP * aghfp , bool response , sync_pkt_type packet_type , const aghfp_audio_params * audio_params )
+{
+    if ( response )
+        AghfpAudioConnect ( aghfp , packet_type , audio_params ) ;
+}
+
+
+void AghfpAudioDisconnect ( AGHFP * aghfp )
+{
+    AGHFP_AUDIO_DISCONNECT_IND_T * lInd = HOST_NEW ( AGHFP_AUDIO_DISCONNECT_IND_T ) ;
+
+    lInd->aghfp   = aghfp ;
+    lInd->status  = aghfp_audio_disconnect_success ;
+    gAghfpAudioUp = FALSE ;
+    hostLibPost ( gAghfpTask , AGHFP_AUDIO_DISCONNECT_IND , lInd , 0 ) ;
+}
+
+
+void aghfpCsrSupportedFeaturesResponse ( AGHFP * aghfp , bool callerName , bool rawText , bool smsInd , bool battLevel , bool pwrSource , uint16 codecs ) { }
+void aghfpFeatureNegotiate ( AGHFP * aghfp , uint16 indicator , uint16 value ) { }
+
+
+/****************************************************************************
+  A2DP AND AVRCP LIBRARIES - the source is not modelled
+*/
+
+void A2dpInit ( Task clientTask , uint16 role , service_record_type * service_records , uint16 size_seps , sep_data_type * seps )
+{
+    A2DP_INIT_CFM_T * lCfm = HOST_NEW ( A2DP_INIT_CFM_T ) ;
+    lCfm->status = a2dp_success ;
+    hostLibPost ( clientTask , A2DP_INIT_CFM , lCfm , 0 ) ;
+}
+
+
+void A2dpConnectSignallingChannel ( Task clientTask , const bdaddr * addr , device_sep_list * sep_list )
+{
+    A2DP_SIGNALLING_CHANNEL_CONNECT_CFM_T * lCfm = HOST_NEW ( A2DP_SIGNALLING_CHANNEL_CONNECT_CFM_T ) ;
+    lCfm->status = a2dp_operation_fail ;
+    hostLibPost ( clientTask , A2DP_SIGNALLING_CHANNEL_CONNECT_CFM , lCfm , gPeer.page_timeout_ms + hostJitter () ) ;
+}
+
+
+void A2dpConnectOpen ( Task clientTask , const bdaddr * addr , uint16 size_seids , uint8 * seids , device_sep_list * sep_list )
+{
+    A2DP_CONNECT_OPEN_CFM_T * lCfm = HOST_NEW ( A2DP_CONNECT_OPEN_CFM_T ) ;
+    lCfm->status = a2dp_operation_fail ;
+    hostLibPost ( clientTask , A2DP_CONNECT_OPEN_CFM , lCfm , gPeer.page_timeout_ms + hostJitter () ) ;
+}
+
+
+void A2dpConnectSignallingChannelResponse ( A2DP * a2dp , bool accept , uint16 connection_id , device_sep_list * sep_list ) { }
+void A2dpOpen ( A2DP * a2dp , uint16 size_seids , uint8 * seids ) { }
+void A2dpStart ( A2DP * a2dp ) { }
+void A2dpSuspend ( A2DP * a2dp ) { }
+void A2dpDisconnectAll ( A2DP * a2dp ) { }
+Sink A2dpGetMediaSink ( A2DP * a2dp ) { return 0 ; }
+Sink A2dpGetSignallingSink ( A2DP * a2dp ) { return 0 ; }
+
+
+void AvrcpInit ( Task theAppTask , const avrcp_init_params * config )
+{
+    AVRCP_INIT_CFM_T * lCfm = HOST_NEW ( AVRCP_INIT_CFM_T ) ;
+    lCfm->status = avrcp_success ;
+    lCfm->avrcp  = (AVRCP *) &gAvrcpInstance ;
+    hostLibPost ( theAppTask , AVRCP_INIT_CFM , lCfm , 0 ) ;
+}
+
+
+void AvrcpConnect ( AVRCP * avrcp , const bdaddr * bd_addr ) { }
+void AvrcpConnectResponse ( AVRCP * avrcp , uint16 connection_id , bool accept ) { }
+void AvrcpDisconnect ( AVRCP * avrcp ) { }
+Sink AvrcpGetSink ( AVRCP * avrcp ) { return 0 ; }
+void AvrcpPassthrough ( AVRCP * avrcp , avc_subunit_type subunit_type , avc_subunit_id subunit_id , bool state , avc_operation_id opid , uint16 size_op_data , Source op_data ) { }
+void AvrcpPassthroughResponse ( AVRCP * avrcp , avrcp_response_type response ) { }
+void AvrcpUnitInfoResponse ( AVRCP * avrcp , bool accept , avc_subunit_type unit_type , uint8 unit , uint32 company_id ) { }
+void AvrcpSubUnitInfoResponse ( AVRCP * avrcp , bool accept , const uint8 * page_data ) { }
+void AvrcpVendorDependentResponse ( AVRCP * avrcp , avrcp_response_type response ) { }
+
+
+/****************************************************************************
+  AUDIO LIBRARY
+*/
+
+bool AudioConnect ( Task audio_plugin , Sink audio_sink , AUDIO_SINK_T sink_type , Task codec_task , uint16 volume , uint32 rate , bool stereo , AUDIO_MODE_T mode , const void * params , Task app_task )
+{
+    gTrace.audio_connect_calls++ ;
+    gTrace.last_audio_connect_ms = HostNow () ;
+    return TRUE ;
+}
+
+
+void AudioDisconnect ( void ) { }
+void AudioSetVolume ( uint16 volume , Task codec_task ) { }
+bool AudioSetMode ( AUDIO_MODE_T mode , const void * params ) { return TRUE ; }
+void AudioStopTone ( void ) { }
+
+
+void AudioPlayTone ( const audio_note * tone , bool can_queue , Task codec_task , uint16 tone_volume , bool stereo )
+{
+    gTrace.tones_played++ ;
+}
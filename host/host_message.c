@@ -0,0 +1,697 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    host_message.c
+@brief   Virtual-time implementation of the BlueCore message scheduler.
+
+    Pending messages are held in a fixed pool and ordered by a binary heap on
+    (due time, post order), so messages falling due at the same instant are
+    delivered in the order they were posted, exactly as on the chip.
+
+    There is one heap per priority lane. Of the messages that are due, those
+    in the highest lane are delivered first; with a single lane in use the
+    behaviour is that of the chip.
+    Conditional messages are kept out of the heap and re-examined after each
+    delivery, since their condition can only change while a handler runs.
+    Messages sent with a delay of D_INFINITE are held apart too: pending,
+    never due, until they are cancelled.
+*/
+
+#include "host_runtime.h"
+
+#include <message.h>
+#include <panic.h>
+#include <vm.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+
+#ifdef DEBUG_HOST
+#define HOST_DEBUG(x) {printf x;}
+#else
+#define HOST_DEBUG(x)
+#endif
+
+
+/* A message waiting to be delivered */
+typedef struct
+{
+    Task            task;
+    MessageId       id;
+    void *          payload;
+    const uint16 *  condition;
+    uint32          due;
+    uint32          seq;
+    uint16          lane;
+} hostMessage;
+
+
+/* A priority lane - a heap of pool indices ordered by due time then post order */
+typedef struct
+{
+    uint16          heap [ HOST_MAX_PENDING_MESSAGES ] ;
+    uint16          size ;
+} hostLane;
+
+
+static hostMessage  gPool [ HOST_MAX_PENDING_MESSAGES ] ;
+static uint16       gFree [ HOST_MAX_PENDING_MESSAGES ] ;
+static uint16       gNumFree ;
+
+static hostLane     gLanes [ HOST_NUM_LANES ] ;
+static uint16       (*gClassify) ( Task pTask , MessageId pId ) = NULL ;
+static void         (*gPanicHook) ( void ) = NULL ;
+
+    /*conditional messages in post order*/
+static uint16       gCond [ HOST_MAX_PENDING_MESSAGES ] ;
+static uint16       gCondSize ;
+
+    /*messages sent with D_INFINITE, never delivered*/
+static uint16       gHeld [ HOST_MAX_PENDING_MESSAGES ] ;
+static uint16       gHeldSize ;
+
+static uint32       gNow ;
+static uint32       gDue ;
+static uint16       gCostUs ;
+static uint16       gCostAccumUs ;
+static uint32       gSeq ;
+static uint32       gRandom = 1 ;
+static hostStats    gStats ;
+static bool         gInitialised = FALSE ;
+
+
+/****************************************************************************
+  LOCAL FUNCTIONS
+*/
+
+static void hostInit ( void )
+{
+    uint16 i ;
+
+    for ( i = 0 ; i < HOST_MAX_PENDING_MESSAGES ; i++ )
+    {
+        gFree [ i ] = HOST_MAX_PENDING_MESSAGES - 1 - i ;
+    }
+    gNumFree   = HOST_MAX_PENDING_MESSAGES ;
+    for ( i = 0 ; i < HOST_NUM_LANES ; i++ )
+    {
+        gLanes [ i ].size = 0 ;
+    }
+    gCondSize  = 0 ;
+    gHeldSize  = 0 ;
+    gInitialised = TRUE ;
+}
+
+
+static hostMessageStats * hostStatsFor ( MessageId pId , bool pCreate )
+{
+    uint16 lSlot = (uint16)( ( pId * 0x9E37u ) >> 4 ) & ( HOST_MAX_MESSAGE_IDS - 1 ) ;
+    uint16 lProbe ;
+
+    for ( lProbe = 0 ; lProbe < HOST_MAX_MESSAGE_IDS ; lProbe++ )
+    {
+        hostMessageStats * lEntry = &gStats.ids [ ( lSlot + lProbe ) & ( HOST_MAX_MESSAGE_IDS - 1 ) ] ;
+
+        if ( lEntry->sent || lEntry->delivered )
+        {
+            if ( lEntry->id == pId )
+                return lEntry ;
+        }
+        else
+        {
+            if ( !pCreate )
+                return NULL ;
+            lEntry->id = pId ;
+            return lEntry ;
+        }
+    }
+    return NULL ;
+}
+
+
+static bool hostBefore ( uint16 pA , uint16 pB )
+{
+    if ( gPool [ pA ].due != gPool [ pB ].due )
+        return gPool [ pA ].due < gPool [ pB ].due ;
+    return gPool [ pA ].seq < gPool [ pB ].seq ;
+}
+
+
+static void hostSiftUp ( hostLane * pLane , uint16 pPos )
+{
+    uint16 * lHeap = pLane->heap ;
+
+    while ( pPos > 0 )
+    {
+        uint16 lParent = ( pPos - 1 ) / 2 ;
+        uint16 lTmp ;
+
+        if ( !hostBefore ( lHeap [ pPos ] , lHeap [ lParent ] ) )
+            break ;
+
+        lTmp = lHeap [ pPos ] ;
+        lHeap [ pPos ] = lHeap [ lParent ] ;
+        lHeap [ lParent ] = lTmp ;
+        pPos = lParent ;
+    }
+}
+
+
+static void hostSiftDown ( hostLane * pLane , uint16 pPos )
+{
+    uint16 * lHeap = pLane->heap ;
+
+    for ( ;; )
+    {
+        uint16 lLeft  = 2 * pPos + 1 ;
+        uint16 lRight = lLeft + 1 ;
+        uint16 lBest  = pPos ;
+        uint16 lTmp ;
+
+        if ( lLeft < pLane->size && hostBefore ( lHeap [ lLeft ] , lHeap [ lBest ] ) )
+            lBest = lLeft ;
+        if ( lRight < pLane->size && hostBefore ( lHeap [ lRight ] , lHeap [ lBest ] ) )
+            lBest = lRight ;
+        if ( lBest == pPos )
+            break ;
+
+        lTmp = lHeap [ pPos ] ;
+        lHeap [ pPos ] = lHeap [ lBest ] ;
+        lHeap [ lBest ] = lTmp ;
+        pPos = lBest ;
+    }
+}
+
+
+/* Returns the pool index of the earliest message in any lane, or HOST_MAX_PENDING_MESSAGES if none */
+static uint16 hostNextTimer ( void )
+{
+    uint16 lNext = HOST_MAX_PENDING_MESSAGES ;
+    uint16 i ;
+
+    for ( i = 0 ; i < HOST_NUM_LANES ; i++ )
+    {
+        if ( gLanes [ i ].size &&
+             ( ( lNext == HOST_MAX_PENDING_MESSAGES ) || ( gPool [ gLanes [ i ].heap [ 0 ] ].due < gPool [ lNext ].due ) ) )
+            lNext = gLanes [ i ].heap [ 0 ] ;
+    }
+    return lNext ;
+}
+
+
+static void hostPost ( Task pTask , MessageId pId , void * pPayload , uint32 pDelay , const uint16 * pCondition )
+{
+    hostMessageStats * lStats ;
+    uint16 lIndex ;
+    hostMessage * lMsg ;
+
+    if ( !gInitialised )
+        hostInit () ;
+
+    if ( !pTask )
+    {
+        /*messages sent to a NULL task are discarded*/
+        free ( pPayload ) ;
+        return ;
+    }
+
+    if ( !gNumFree )
+    {
+        printf ( "HOST: message pool exhausted posting 0x%x\n" , (unsigned) pId ) ;
+        Panic () ;
+    }
+
+    lIndex = gFree [ --gNumFree ] ;
+    lMsg = &gPool [ lIndex ] ;
+
+    lMsg->task      = pTask ;
+    lMsg->id        = pId ;
+    lMsg->payload   = pPayload ;
+    lMsg->condition = pCondition ;
+    lMsg->due       = gNow + pDelay ;
+    lMsg->seq       = gSeq++ ;
+    lMsg->lane      = gClassify ? gClassify ( pTask , pId ) : HOST_LANE_NORMAL ;
+    if ( lMsg->lane >= HOST_NUM_LANES )
+        lMsg->lane = HOST_NUM_LANES - 1 ;
+
+    if ( pCondition )
+    {
+        gCond [ gCondSize++ ] = lIndex ;
+    }
+    else if ( pDelay == D_INFINITE )
+    {
+        gHeld [ gHeldSize++ ] = lIndex ;
+    }
+    else
+    {
+        hostLane * lLane = &gLanes [ lMsg->lane ] ;
+
+        lLane->heap [ lLane->size ] = lIndex ;
+        hostSiftUp ( lLane , lLane->size ) ;
+        lLane->size++ ;
+    }
+
+    gStats.sent++ ;
+    gStats.depth++ ;
+    if ( gStats.depth > gStats.max_depth )
+        gStats.max_depth = gStats.depth ;
+
+    lStats = hostStatsFor ( pId , TRUE ) ;
+    if ( lStats )
+        lStats->sent++ ;
+    else
+        gStats.untracked++ ;
+}
+
+
+static void hostRelease ( uint16 pIndex )
+{
+    gFree [ gNumFree++ ] = pIndex ;
+    gStats.depth-- ;
+}
+
+
+static void hostDeliver ( uint16 pIndex )
+{
+    hostMessage lMsg = gPool [ pIndex ] ;
+    hostMessageStats * lStats ;
+
+        /*release the slot first - the handler is free to post again*/
+    hostRelease ( pIndex ) ;
+
+    gStats.delivered++ ;
+    lStats = hostStatsFor ( lMsg.id , TRUE ) ;
+    if ( lStats )
+        lStats->delivered++ ;
+    else
+        gStats.untracked++ ;
+
+    HOST_DEBUG(("HOST: %6lu deliver 0x%x\n" , (unsigned long) gNow , (unsigned) lMsg.id )) ;
+
+    gDue = lMsg.due ;
+    lMsg.task->handler ( lMsg.task , lMsg.id , lMsg.payload ) ;
+
+    free ( lMsg.payload ) ;
+
+        /*charge the handler's execution time*/
+    gCostAccumUs += gCostUs ;
+    gNow += gCostAccumUs / 1000 ;
+    gCostAccumUs %= 1000 ;
+}
+
+
+/* Deliver a single message that is due now. Returns FALSE if nothing is due. */
+static bool hostStep ( void )
+{
+    uint16 i ;
+
+        /*conditional messages whose condition has cleared go first*/
+    for ( i = 0 ; i < gCondSize ; i++ )
+    {
+        uint16 lIndex = gCond [ i ] ;
+
+        if ( ( gPool [ lIndex ].due <= gNow ) && ( *gPool [ lIndex ].condition == 0 ) )
+        {
+            memmove ( &gCond [ i ] , &gCond [ i + 1 ] , ( gCondSize - i - 1 ) * sizeof ( uint16 ) ) ;
+            gCondSize-- ;
+            hostDeliver ( lIndex ) ;
+            return TRUE ;
+        }
+    }
+
+        /*then the highest lane with a message due*/
+    for ( i = 0 ; i < HOST_NUM_LANES ; i++ )
+    {
+        hostLane * lLane = &gLanes [ i ] ;
+
+        if ( lLane->size && ( gPool [ lLane->heap [ 0 ] ].due <= gNow ) )
+        {
+            uint16 lIndex = lLane->heap [ 0 ] ;
+
+            lLane->heap [ 0 ] = lLane->heap [ --lLane->size ] ;
+            hostSiftDown ( lLane , 0 ) ;
+            hostDeliver ( lIndex ) ;
+            return TRUE ;
+        }
+    }
+
+    return FALSE ;
+}
+
+
+/* Cancel matching messages from a list kept in post order, pCount already cancelled */
+static uint16 hostCancelList ( uint16 * pList , uint16 * pSize , Task pTask , MessageId pId , bool pFirstOnly , uint16 pCount )
+{
+    uint16 i ;
+
+    for ( i = 0 ; ( i < *pSize ) && !( pFirstOnly && pCount ) ; )
+    {
+        uint16 lIndex = pList [ i ] ;
+
+        if ( ( gPool [ lIndex ].task == pTask ) && ( gPool [ lIndex ].id == pId ) )
+        {
+            free ( gPool [ lIndex ].payload ) ;
+            hostRelease ( lIndex ) ;
+            memmove ( &pList [ i ] , &pList [ i + 1 ] , ( *pSize - i - 1 ) * sizeof ( uint16 ) ) ;
+            ( *pSize )-- ;
+            pCount++ ;
+        }
+        else
+        {
+            i++ ;
+        }
+    }
+    return pCount ;
+}
+
+
+static uint16 hostCancel ( Task pTask , MessageId pId , bool pFirstOnly )
+{
+    hostMessageStats * lStats ;
+    uint16 lCount = 0 ;
+    uint16 lLane ;
+    uint16 i ;
+
+    if ( !gInitialised )
+        return 0 ;
+
+    for ( lLane = 0 ; lLane < HOST_NUM_LANES ; lLane++ )
+    {
+        hostLane * lHeap = &gLanes [ lLane ] ;
+        uint16 lRemoved = 0 ;
+
+        for ( i = 0 ; ( i < lHeap->size ) && !( pFirstOnly && lCount ) ; )
+        {
+            uint16 lIndex = lHeap->heap [ i ] ;
+
+            if ( ( gPool [ lIndex ].task == pTask ) && ( gPool [ lIndex ].id == pId ) )
+            {
+                free ( gPool [ lIndex ].payload ) ;
+                hostRelease ( lIndex ) ;
+                lHeap->heap [ i ] = lHeap->heap [ --lHeap->size ] ;
+                lCount++ ;
+                lRemoved++ ;
+            }
+            else
+            {
+                i++ ;
+            }
+        }
+
+        if ( lRemoved )
+        {
+                /*removal breaks the heap order - rebuild it*/
+            for ( i = lHeap->size / 2 ; i-- > 0 ; )
+                hostSiftDown ( lHeap , i ) ;
+        }
+    }
+
+    lCount = hostCancelList ( gCond , &gCondSize , pTask , pId , pFirstOnly , lCount ) ;
+    lCount = hostCancelList ( gHeld , &gHeldSize , pTask , pId , pFirstOnly , lCount ) ;
+
+    if ( lCount )
+    {
+        gStats.cancelled += lCount ;
+        lStats = hostStatsFor ( pId , TRUE ) ;
+        if ( lStats )
+            lStats->cancelled += lCount ;
+        else
+            gStats.untracked++ ;
+    }
+
+    return lCount ;
+}
+
+
+/****************************************************************************
+  MESSAGE API
+*/
+
+void MessageSend ( Task task , MessageId id , void * message )
+{
+    hostPost ( task , id , message , 0 , NULL ) ;
+}
+
+
+void MessageSendLater ( Task task , MessageId id , void * message , uint32 delay )
+{
+    hostPost ( task , id , message , delay , NULL ) ;
+}
+
+
+void MessageSendConditionally ( Task task , MessageId id , void * message , const uint16 * condition )
+{
+    hostPost ( task , id , message , 0 , condition ) ;
+}
+
+
+uint16 MessageCancelAll ( Task task , MessageId id )
+{
+    return hostCancel ( task , id , FALSE ) ;
+}
+
+
+bool MessageCancelFirst ( Task task , MessageId id )
+{
+    return hostCancel ( task , id , TRUE ) != 0 ;
+}
+
+
+void MessageLoop ( void )
+{
+        /*the application has completed its synchronous initialisation -
+          hand over to the scenario runner which drives virtual time*/
+    HostScenarioRun () ;
+    exit ( 0 ) ;
+}
+
+
+/****************************************************************************
+  PANIC AND VM
+*/
+
+void Panic ( void )
+{
+    void (*lHook) ( void ) = gPanicHook ;
+
+    printf ( "HOST: Panic at %lu ms\n" , (unsigned long) gNow ) ;
+
+        /*the hook may itself panic - call it once only*/
+    gPanicHook = NULL ;
+    if ( lHook )
+        lHook () ;
+
+    fflush ( stdout ) ;
+    abort () ;
+}
+
+
+void * PanicNull ( void * p )
+{
+    if ( !p )
+        Panic () ;
+    return p ;
+}
+
+
+uint16 PanicZero ( uint16 x )
+{
+    if ( !x )
+        Panic () ;
+    return x ;
+}
+
+
+bool PanicFalse ( bool x )
+{
+    if ( !x )
+        Panic () ;
+    return x ;
+}
+
+
+void * PanicUnlessMalloc ( size_t sz )
+{
+    return PanicNull ( malloc ( sz ) ) ;
+}
+
+
+uint32 VmGetClock ( void )
+{
+    return gNow ;
+}
+
+
+bool VmDeepSleepEnable ( bool en )
+{
+    return en ;
+}
+
+
+uint16 VmGetAvailableAllocations ( void )
+{
+    return gNumFree ;
+}
+
+
+/****************************************************************************
+  HOST RUNTIME API
+*/
+
+uint32 HostNow ( void )
+{
+    return gNow ;
+}
+
+
+void HostRunFor ( uint32 pTime )
+{
+    uint32 lEnd = gNow + pTime ;
+    uint16 lNext ;
+
+    for ( ;; )
+    {
+        while ( hostStep () )
+            ;
+
+        lNext = hostNextTimer () ;
+        if ( ( lNext == HOST_MAX_PENDING_MESSAGES ) || ( gPool [ lNext ].due > lEnd ) )
+            break ;
+
+            /*idle until the next timer fires*/
+        gNow = gPool [ lNext ].due ;
+        gStats.timer_wakeups++ ;
+    }
+    if ( gNow < lEnd )
+        gNow = lEnd ;
+}
+
+
+bool HostRunUntil ( bool (*pDone)(void) , uint32 pLimit )
+{
+    uint32 lEnd = gNow + pLimit ;
+    uint16 lNext ;
+
+    for ( ;; )
+    {
+        while ( !pDone () && hostStep () )
+            ;
+
+        if ( pDone () )
+            return TRUE ;
+
+        lNext = hostNextTimer () ;
+        if ( ( lNext == HOST_MAX_PENDING_MESSAGES ) || ( gPool [ lNext ].due > lEnd ) )
+            break ;
+
+        gNow = gPool [ lNext ].due ;
+        gStats.timer_wakeups++ ;
+    }
+    if ( gNow < lEnd )
+        gNow = lEnd ;
+    return FALSE ;
+}
+
+
+void HostReset ( void )
+{
+    uint16 i , j ;
+
+    if ( gInitialised )
+    {
+        for ( j = 0 ; j < HOST_NUM_LANES ; j++ )
+            for ( i = 0 ; i < gLanes [ j ].size ; i++ )
+                free ( gPool [ gLanes [ j ].heap [ i ] ].payload ) ;
+        for ( i = 0 ; i < gCondSize ; i++ )
+            free ( gPool [ gCond [ i ] ].payload ) ;
+        for ( i = 0 ; i < gHeldSize ; i++ )
+            free ( gPool [ gHeld [ i ] ].payload ) ;
+    }
+
+    hostInit () ;
+    gNow = 0 ;
+    gSeq = 0 ;
+    gCostAccumUs = 0 ;
+    HostResetStats () ;
+}
+
+
+void HostSetPanicHook ( void (*pHook) ( void ) )
+{
+    gPanicHook = pHook ;
+}
+
+
+void HostSetLaneClassifier ( uint16 (*pClassify) ( Task pTask , MessageId pId ) )
+{
+    gClassify = pClassify ;
+}
+
+
+void HostSetDeliveryCost ( uint16 pMicroseconds )
+{
+    gCostUs = pMicroseconds ;
+}
+
+
+uint32 HostDeliveryDue ( void )
+{
+    return gDue ;
+}
+
+
+uint16 HostQueueDepth ( void )
+{
+    return gStats.depth ;
+}
+
+
+uint32 HostWallClockUs ( void )
+{
+    struct timespec lNow ;
+
+    clock_gettime ( CLOCK_MONOTONIC , &lNow ) ;
+    return (uint32) ( (unsigned long long) lNow.tv_sec * 1000000u + lNow.tv_nsec / 1000 ) ;
+}
+
+
+const hostStats * HostGetStats ( void )
+{
+    return &gStats ;
+}
+
+
+void HostResetStats ( void )
+{
+    uint16 lDepth = gStats.depth ;
+
+    memset ( &gStats , 0 , sizeof ( gStats ) ) ;
+    gStats.depth     = lDepth ;
+    gStats.max_depth = lDepth ;
+}
+
+
+const hostMessageStats * HostFindStats ( MessageId pId )
+{
+    return hostStatsFor ( pId , FALSE ) ;
+}
+
+
+void HostSeed ( uint32 pSeed )
+{
+    gRandom = pSeed ? pSeed : 1 ;
+}
+
+
+uint32 HostRandom ( void )
+{
+        /*xorshift32 - deterministic for a given seed*/
+    gRandom ^= gRandom << 13 ;
+    gRandom ^= gRandom >> 17 ;
+    gRandom ^= gRandom << 5 ;
+    return gRandom ;
+}
@@ -0,0 +1,84 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    host_mixer_bench.c
+@brief   Microbenchmark of the PCM mixer (headset_mixer.c).
+
+    Mixes 1 to MIXER_MAX_SOURCES sources of noise at 8kHz and 16kHz, with
+    and without ducking, for HOST_BENCH_FRAMES frames (default 200000) each
+    and prints one line per case:
+        mixer rate=<hz> sources=<n> duck=<0|1> frames_per_sec=<n> ns_per_sample=<n> cycles_per_sample=<n>
+*/
+
+#include "headset_mixer.h"
+#include "host_bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+
+static int16 gIn [ MIXER_MAX_SOURCES ] [ MIXER_MAX_FRAME ] ;
+static int16 gOut [ MIXER_MAX_FRAME ] ;
+
+
+static void benchCase ( uint16 pRate , uint16 pSources , bool pDuck , unsigned long pFrames )
+{
+    mixerSource_t lSources [ MIXER_MAX_SOURCES ] ;
+    uint16 lSamples = mixerFrameSamples ( pRate ) ;
+    unsigned long long lCycles ;
+    unsigned long f ;
+    long lCheck = 0 ;
+    double lStart , lSeconds ;
+    uint16 i ;
+
+    for ( i = 0 ; i < pSources ; i++ )
+    {
+        lSources [ i ].samples  = gIn [ i ] ;
+        lSources [ i ].gain     = MIXER_GAIN_UNITY - i * 512 ;
+        lSources [ i ].duckable = ( i != 0 ) ;
+        lSources [ i ].ducking  = pDuck && ( i == 0 ) ;
+    }
+
+    lStart  = benchNow () ;
+    lCycles = BENCH_CYCLES () ;
+
+    for ( f = 0 ; f < pFrames ; f++ )
+    {
+        mixerMix ( lSources , pSources , gOut , lSamples , MIXER_GAIN_UNITY / 4 ) ;
+        lCheck += gOut [ f % lSamples ] ;
+    }
+
+    lCycles  = BENCH_CYCLES () - lCycles ;
+    lSeconds = benchNow () - lStart ;
+
+    printf ( "mixer rate=%u sources=%u duck=%d frames_per_sec=%.0f ns_per_sample=%.3f cycles_per_sample=%.3f check=%ld\n" ,
+             pRate , pSources , pDuck ? 1 : 0 ,
+             pFrames / lSeconds ,
+             lSeconds * 1e9 / ( (double) pFrames * lSamples ) ,
+             (double) lCycles / ( (double) pFrames * lSamples ) ,
+             lCheck ) ;
+}
+
+
+int main ( void )
+{
+    const char * lEnv = getenv ( "HOST_BENCH_FRAMES" ) ;
+    unsigned long lFrames = lEnv ? strtoul ( lEnv , NULL , 10 ) : 200000 ;
+    uint16 lRate , lSources , i , j ;
+
+    srand ( 1 ) ;
+    for ( i = 0 ; i < MIXER_MAX_SOURCES ; i++ )
+        for ( j = 0 ; j < MIXER_MAX_FRAME ; j++ )
+            gIn [ i ] [ j ] = (int16) ( ( rand () & 0xffff ) - 0x8000 ) ;
+
+    for ( lRate = 8000 ; lRate <= 16000 ; lRate += 8000 )
+        for ( lSources = 1 ; lSources <= MIXER_MAX_SOURCES ; lSources++ )
+        {
+            benchCase ( lRate , lSources , FALSE , lFrames ) ;
+            benchCase ( lRate , lSources , TRUE , lFrames ) ;
+        }
+
+    return 0 ;
+}
@@ -0,0 +1,328 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    host_plc_bench.c
+@brief   Benchmark of the packet loss concealment (headset_plc.c).
+
+    Plays HOST_BENCH_SECONDS (default 60) of synthetic voiced speech through
+    a link that drops 3.75ms frames, and repairs each loss three ways:
+        zero    silence, as the DSP plugin and the plain conference did
+        repeat  the last good frame again, faded like the concealment
+        plc     headset_plc.c
+    The loss patterns are independent losses of 5, 10 and 20% of frames,
+    and two Gilbert-Elliott channels: short bursts as from eSCO
+    retransmissions running out, and 100ms fades as when a rider turns
+    behind a truck. One line is printed per case:
+        plc loss=<pattern> method=<m> lost_pct=<n> ns_per_frame=<n> cycles_per_frame=<n> lsd_db=<n> ssnr_db=<n>
+    lsd_db is the log spectral distance from the clean speech over the 32ms
+    windows which contain a loss; it ignores phase, so it scores how the
+    gap sounds rather than whether the waveform was guessed, and lower is
+    better. ssnr_db is the segmental SNR over the 4ms segments which
+    overlap a loss, clamped to [-10,35]dB per segment. The time taken by
+    the repair, not the metrics, is reported per frame.
+*/
+
+#include "headset_plc.h"
+#include "host_bench.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+#define BENCH_FRAME         (30)        /* One HV3 packet, as in the conference */
+#define BENCH_WINDOW        (256)       /* Spectral distance window, 32ms */
+#define BENCH_SEGMENT       (32)        /* Segmental SNR segment, 4ms */
+
+
+/* A loss pattern: a two state Markov chain, independent losses when both states agree */
+typedef struct
+{
+    const char *    name ;
+    double          good_loss ;         /* Loss probability in the good state */
+    double          bad_loss ;          /* Loss probability in the bad state */
+    double          to_bad ;            /* Per frame probability of good -> bad */
+    double          to_good ;           /* Per frame probability of bad -> good */
+} benchPattern_t ;
+
+static const benchPattern_t gPatterns [] =
+{
+    { "iid5"    , 0.05 , 0.05 , 0.0   , 1.0 } ,
+    { "iid10"   , 0.10 , 0.10 , 0.0   , 1.0 } ,
+    { "iid20"   , 0.20 , 0.20 , 0.0   , 1.0 } ,
+    { "bursty"  , 0.01 , 0.80 , 0.02  , 0.30 } ,
+    { "fade"    , 0.0  , 1.0  , 0.002 , 0.0375 }
+} ;
+
+typedef enum
+{
+    benchZero ,
+    benchRepeat ,
+    benchPlc ,
+    bench_methods
+} benchMethod_t ;
+
+static const char * const gMethods [ bench_methods ] = { "zero" , "repeat" , "plc" } ;
+
+
+static unsigned long gSamples ;
+static int16 * gClean ;
+static int16 * gRepaired ;
+static unsigned char * gLost ;          /* Per frame */
+
+
+/* Voiced speech: a gliding 90-230Hz pulse train shaped by three formants,
+   gated into 200ms syllables with short unvoiced pauses between them */
+static void benchSignal ( void )
+{
+    unsigned long lSeed = 7 ;
+    double lPhase = 0.0 ;
+    unsigned long n ;
+
+    for ( n = 0 ; n < gSamples ; n++ )
+    {
+        double t = (double) n / BENCH_RATE ;
+        double lPitch = 160.0 + 70.0 * sin ( 2 * M_PI * 0.7 * t ) ;
+        double lSample = benchSyllable ( t , 0.0 ) * benchHarmonics ( lPitch , 0.0 , &lPhase ) ;
+
+        gClean [ n ] = benchSaturate ( 6000.0 * lSample + 100.0 * ( benchRandom ( &lSeed ) - 0.5 ) ) ;
+    }
+}
+
+
+static double benchLosses ( const benchPattern_t * pPattern )
+{
+    unsigned long lFrames = gSamples / BENCH_FRAME ;
+    unsigned long lSeed = 1 ;
+    unsigned long lCount = 0 ;
+    int lBad = 0 ;
+    unsigned long f ;
+
+    for ( f = 0 ; f < lFrames ; f++ )
+    {
+        if ( lBad )
+            lBad = benchRandom ( &lSeed ) >= pPattern->to_good ;
+        else
+            lBad = benchRandom ( &lSeed ) < pPattern->to_bad ;
+
+            /*the first frames are always heard so every method starts with history*/
+        gLost [ f ] = ( f > 10 ) && ( benchRandom ( &lSeed ) < ( lBad ? pPattern->bad_loss : pPattern->good_loss ) ) ;
+        lCount += gLost [ f ] ;
+    }
+    return 100.0 * lCount / lFrames ;
+}
+
+
+/* The last good frame again, at the fade the concealment uses */
+static void benchRepeatFrame ( const int16 * pLast , int16 * pOut , unsigned pLostSamples )
+{
+    unsigned i ;
+
+    for ( i = 0 ; i < BENCH_FRAME ; i++ , pLostSamples++ )
+    {
+        double lGain = 1.0 ;
+
+        if ( pLostSamples >= 480 )
+            lGain = 0.0 ;
+        else if ( pLostSamples >= 80 )
+            lGain = ( 480.0 - pLostSamples ) / 400.0 ;
+
+        pOut [ i ] = (int16) ( pLast [ i ] * lGain ) ;
+    }
+}
+
+
+static double benchRepair ( benchMethod_t pMethod , unsigned long long * pCycles )
+{
+    static plcState_t lPlc ;
+    unsigned long lFrames = gSamples / BENCH_FRAME ;
+    int16 lLast [ BENCH_FRAME ] ;
+    unsigned lLostSamples = 0 ;
+    unsigned long long lCycles ;
+    double lStart ;
+    unsigned long f ;
+
+    memcpy ( gRepaired , gClean , gSamples * sizeof ( int16 ) ) ;
+    memset ( lLast , 0 , sizeof ( lLast ) ) ;
+    plcInit ( &lPlc ) ;
+
+    lStart  = benchNow () ;
+    lCycles = BENCH_CYCLES () ;
+
+    for ( f = 0 ; f < lFrames ; f++ )
+    {
+        int16 * lFrame = &gRepaired [ f * BENCH_FRAME ] ;
+
+        switch ( pMethod )
+        {
+        case benchZero:
+            if ( gLost [ f ] )
+                memset ( lFrame , 0 , BENCH_FRAME * sizeof ( int16 ) ) ;
+            break ;
+        case benchRepeat:
+            if ( gLost [ f ] )
+            {
+                benchRepeatFrame ( lLast , lFrame , lLostSamples ) ;
+                lLostSamples += BENCH_FRAME ;
+            }
+            else
+            {
+                memcpy ( lLast , lFrame , sizeof ( lLast ) ) ;
+                lLostSamples = 0 ;
+            }
+            break ;
+        case benchPlc:
+        default:
+            if ( gLost [ f ] )
+                plcLostFrame ( &lPlc , lFrame , BENCH_FRAME ) ;
+            else
+                plcGoodFrame ( &lPlc , lFrame , BENCH_FRAME ) ;
+            break ;
+        }
+    }
+
+    *pCycles = BENCH_CYCLES () - lCycles ;
+    return benchNow () - lStart ;
+}
+
+
+/* Power spectrum of a Hann windowed block, by direct DFT */
+static void benchSpectrum ( const int16 * pBlock , double * pPower )
+{
+    static double lCos [ BENCH_WINDOW ] , lSin [ BENCH_WINDOW ] , lHann [ BENCH_WINDOW ] ;
+    static int lReady = 0 ;
+    double lIn [ BENCH_WINDOW ] ;
+    int k , n ;
+
+    if ( !lReady )
+    {
+        for ( n = 0 ; n < BENCH_WINDOW ; n++ )
+        {
+            lCos [ n ]  = cos ( 2 * M_PI * n / BENCH_WINDOW ) ;
+            lSin [ n ]  = sin ( 2 * M_PI * n / BENCH_WINDOW ) ;
+            lHann [ n ] = 0.5 - 0.5 * lCos [ n ] ;
+        }
+        lReady = 1 ;
+    }
+
+    for ( n = 0 ; n < BENCH_WINDOW ; n++ )
+        lIn [ n ] = pBlock [ n ] * lHann [ n ] ;
+
+    for ( k = 0 ; k <= BENCH_WINDOW / 2 ; k++ )
+    {
+        double lRe = 0.0 , lIm = 0.0 ;
+
+        for ( n = 0 ; n < BENCH_WINDOW ; n++ )
+        {
+            lRe += lIn [ n ] * lCos [ ( k * n ) % BENCH_WINDOW ] ;
+            lIm -= lIn [ n ] * lSin [ ( k * n ) % BENCH_WINDOW ] ;
+        }
+        pPower [ k ] = lRe * lRe + lIm * lIm ;
+    }
+}
+
+
+/* Mean log spectral distance and segmental SNR over the windows holding a loss */
+static void benchDistance ( double * pLsd , double * pSsnr )
+{
+    double lClean [ BENCH_WINDOW / 2 + 1 ] , lRepaired [ BENCH_WINDOW / 2 + 1 ] ;
+    double lLsd = 0.0 , lSsnr = 0.0 ;
+    unsigned long lWindows = 0 , lSegments = 0 ;
+    unsigned long w ;
+
+    for ( w = 0 ; w + BENCH_WINDOW <= gSamples ; w += BENCH_WINDOW )
+    {
+        unsigned long f ;
+        double lSum = 0.0 ;
+        int lHit = 0 , k , s ;
+
+        for ( f = w / BENCH_FRAME ; f <= ( w + BENCH_WINDOW - 1 ) / BENCH_FRAME ; f++ )
+            lHit |= gLost [ f ] ;
+        if ( !lHit )
+            continue ;
+
+        benchSpectrum ( &gClean [ w ] , lClean ) ;
+        benchSpectrum ( &gRepaired [ w ] , lRepaired ) ;
+
+            /*floor at about -60dB from full scale so silence is not infinitely far*/
+        for ( k = 0 ; k <= BENCH_WINDOW / 2 ; k++ )
+        {
+            double lDiff = 10.0 * log10 ( ( lClean [ k ] + 1e6 ) / ( lRepaired [ k ] + 1e6 ) ) ;
+            lSum += lDiff * lDiff ;
+        }
+        lLsd += sqrt ( lSum / ( BENCH_WINDOW / 2 + 1 ) ) ;
+        lWindows++ ;
+
+        for ( s = 0 ; s < BENCH_WINDOW ; s += BENCH_SEGMENT )
+        {
+            double lSignal = 1.0 , lNoise = 1.0 , lSnr ;
+            int n ;
+
+            if ( !gLost [ ( w + s ) / BENCH_FRAME ] && !gLost [ ( w + s + BENCH_SEGMENT - 1 ) / BENCH_FRAME ] )
+                continue ;
+
+            for ( n = s ; n < s + BENCH_SEGMENT ; n++ )
+            {
+                double lError = (double) gClean [ w + n ] - gRepaired [ w + n ] ;
+
+                lSignal += (double) gClean [ w + n ] * gClean [ w + n ] ;
+                lNoise  += lError * lError ;
+            }
+            lSnr = 10.0 * log10 ( lSignal / lNoise ) ;
+            lSsnr += lSnr < -10.0 ? -10.0 : ( lSnr > 35.0 ? 35.0 : lSnr ) ;
+            lSegments++ ;
+        }
+    }
+
+    *pLsd  = lWindows ? lLsd / lWindows : 0.0 ;
+    *pSsnr = lSegments ? lSsnr / lSegments : 0.0 ;
+}
+
+
+int main ( void )
+{
+    const char * lEnv = getenv ( "HOST_BENCH_SECONDS" ) ;
+    unsigned long lSeconds = lEnv ? strtoul ( lEnv , NULL , 10 ) : 60 ;
+    unsigned p ;
+
+    gSamples  = lSeconds * BENCH_RATE ;
+    gSamples -= gSamples % BENCH_WINDOW ;
+    gClean    = malloc ( gSamples * sizeof ( int16 ) ) ;
+    gRepaired = malloc ( gSamples * sizeof ( int16 ) ) ;
+    gLost     = malloc ( gSamples / BENCH_FRAME + 1 ) ;
+
+    if ( !gClean || !gRepaired || !gLost || !gSamples )
+        return 1 ;
+
+    benchSignal () ;
+
+    for ( p = 0 ; p < sizeof ( gPatterns ) / sizeof ( gPatterns [ 0 ] ) ; p++ )
+    {
+        double lLostPct = benchLosses ( &gPatterns [ p ] ) ;
+        unsigned long lFrames = gSamples / BENCH_FRAME ;
+        int m ;
+
+        for ( m = 0 ; m < bench_methods ; m++ )
+        {
+            unsigned long long lCycles ;
+            double lTime = benchRepair ( (benchMethod_t) m , &lCycles ) ;
+            double lLsd , lSsnr ;
+
+            benchDistance ( &lLsd , &lSsnr ) ;
+
+            printf ( "plc loss=%s method=%s lost_pct=%.1f ns_per_frame=%.1f cycles_per_frame=%.1f lsd_db=%.2f ssnr_db=%.2f\n" ,
+                     gPatterns [ p ].name , gMethods [ m ] , lLostPct ,
+                     lTime * 1e9 / lFrames ,
+                     (double) lCycles / lFrames ,
+                     lLsd , lSsnr ) ;
+        }
+    }
+
+    free ( gClean ) ;
+    free ( gRepaired ) ;
+    free ( gLost ) ;
+    return 0 ;
+}
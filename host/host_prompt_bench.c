@@ -0,0 +1,237 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    host_prompt_bench.c
+@brief   Benchmark of the voice prompt decoder (headset_prompts.c).
+
+    Encodes a prompt image as host_prompt_compiler.c does and decodes it as
+    the tone cache plays it, a block at a time. One line is printed per
+    prompt:
+        prompt id=<n> samples=<n> words=<n> snr_db=<n> ok|FAIL
+    snr_db is of the decoded prompt against the recording. A prompt fails
+    if decoding it a block at a time differs from decoding it whole. Then
+    the speed of the decoder over the whole image, the best of
+    HOST_BENCH_RUNS (default 20), for a few sizes of block:
+        decode block=<n> samples_per_s=<n> ns_per_sample=<n> cycles_per_sample=<n> realtime_x=<n>
+    and the memory the decoder needs while a prompt plays against what
+    decoding the longest prompt whole would:
+        ram state_bytes=<n> block_bytes=<n> peak_bytes=<n> whole_prompt_bytes=<n>
+    Exits 1 if any prompt fails.
+
+    The prompts are a recording when HOST_PROMPT_FILE names a file of raw
+    16 bit little endian 8kHz mono samples, which is used for each of
+    them. Otherwise they are modelled as voiced phrases of 1 to 2s.
+*/
+
+#include "host_adpcm_encode.h"
+#include "headset_prompts.h"
+#include "host_bench.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/* Samples decoded at a time by the tone cache */
+#define BENCH_BLOCK         (32)
+
+/* Longest prompt, a whole number of words */
+#define BENCH_MAX           (65532UL)
+
+
+static int16 * gRecording [ NUM_PROMPTS ] ;
+static uint16 * gImage ;
+static promptEntry_t gIndex [ NUM_PROMPTS ] ;
+static unsigned long gSamples ;
+static double gVoice [ BENCH_MAX ] ;       /* A modelled prompt before it is saturated */
+
+
+/* A voiced phrase of 1 to 2s, its harmonics at spread phases as a voice's
+   are rather than lined up into a pulse */
+static unsigned long benchVoicePrompt ( unsigned pPrompt , int16 * pOut )
+{
+    static const benchTalker_t lTalker = { 0.0 , 0.0 , 1.0 , 1.0 , 110.0 , 100.0 , 2000.0 , 0.0 , 0.7 } ;
+    benchPhrase_t lPhrase ;
+    unsigned long i ;
+
+    if ( !benchSpeech ( &lTalker , pPrompt + 1 , gVoice , BENCH_MAX , &lPhrase , 1 , NULL ) )
+        return 0 ;
+
+    for ( i = 0 ; i < lPhrase.end ; i++ )
+        pOut [ i ] = benchSaturate ( gVoice [ i ] ) ;
+
+    return lPhrase.end ;
+}
+
+
+/* The recording in HOST_PROMPT_FILE, 0 if there is none */
+static unsigned long benchFile ( int16 * pOut )
+{
+    const char * lName = getenv ( "HOST_PROMPT_FILE" ) ;
+    unsigned char lSample [ 2 ] ;
+    unsigned long lCount = 0 ;
+    FILE * lFile ;
+
+    if ( !lName || !( lFile = fopen ( lName , "rb" ) ) )
+        return 0 ;
+
+    while ( ( lCount < BENCH_MAX ) && ( fread ( lSample , 1 , 2 , lFile ) == 2 ) )
+        pOut [ lCount++ ] = (int16) ( lSample [ 0 ] | ( lSample [ 1 ] << 8 ) ) ;
+
+    fclose ( lFile ) ;
+    return lCount ;
+}
+
+
+/* Record and encode every prompt into the image */
+static void benchImage ( void )
+{
+    unsigned long lWords = 0 ;
+    unsigned p ;
+
+    gImage = malloc ( NUM_PROMPTS * ADPCM_WORDS ( BENCH_MAX ) * sizeof ( uint16 ) ) ;
+    if ( !gImage )
+        abort () ;
+
+    for ( p = 0 ; p < NUM_PROMPTS ; p++ )
+    {
+        unsigned long lCount ;
+
+        gRecording [ p ] = malloc ( BENCH_MAX * sizeof ( int16 ) ) ;
+        if ( !gRecording [ p ] )
+            abort () ;
+
+        lCount = benchFile ( gRecording [ p ] ) ;
+        if ( !lCount )
+            lCount = benchVoicePrompt ( p , gRecording [ p ] ) ;
+
+        gIndex [ p ].offset  = (uint16) lWords ;
+        gIndex [ p ].samples = (uint16) lCount ;
+        lWords   += adpcmEncode ( gRecording [ p ] , lCount , gImage + lWords ) ;
+        gSamples += lCount ;
+    }
+}
+
+
+/* Decode a prompt pBlock samples at a time */
+static unsigned long benchDecode ( unsigned pPrompt , int16 * pOut , uint16 pBlock )
+{
+    promptState_t lState ;
+    unsigned long lCount = 0 ;
+    uint16 lDone ;
+
+    promptStart ( &lState , gImage , &gIndex [ pPrompt ] ) ;
+
+    do
+    {
+        lDone   = promptDecode ( &lState , pOut + lCount , pBlock ) ;
+        lCount += lDone ;
+    }
+    while ( lDone == pBlock ) ;
+
+    return lCount ;
+}
+
+
+static int benchPrompt ( unsigned pPrompt )
+{
+    unsigned long lSamples = gIndex [ pPrompt ].samples ;
+    int16 * lStream = calloc ( lSamples + BENCH_BLOCK , sizeof ( int16 ) ) ;
+    int16 * lWhole = calloc ( lSamples + BENCH_BLOCK , sizeof ( int16 ) ) ;
+    double lSignal = 0.0 , lNoise = 0.0 , lSnr ;
+    unsigned long n ;
+    int lOk ;
+
+    if ( !lStream || !lWhole )
+        abort () ;
+
+    lOk  = ( benchDecode ( pPrompt , lStream , BENCH_BLOCK ) == lSamples ) ;
+    lOk &= ( benchDecode ( pPrompt , lWhole , (uint16) ( ( lSamples + ADPCM_CODES_PER_WORD - 1 ) & ~( ADPCM_CODES_PER_WORD - 1 ) ) ) == lSamples ) ;
+    lOk &= !memcmp ( lStream , lWhole , lSamples * sizeof ( int16 ) ) ;
+
+    for ( n = 0 ; n < lSamples ; n++ )
+    {
+        double lError = (double) lStream [ n ] - gRecording [ pPrompt ] [ n ] ;
+
+        lSignal += (double) gRecording [ pPrompt ] [ n ] * gRecording [ pPrompt ] [ n ] ;
+        lNoise  += lError * lError ;
+    }
+    lSnr = 10.0 * log10 ( ( lSignal + 1.0 ) / ( lNoise + 1.0 ) ) ;
+
+    printf ( "prompt id=%u samples=%lu words=%lu snr_db=%.1f %s\n" ,
+             pPrompt , lSamples , (unsigned long) ADPCM_WORDS ( lSamples ) , lSnr , lOk ? "ok" : "FAIL" ) ;
+
+    free ( lStream ) ;
+    free ( lWhole ) ;
+    return lOk ;
+}
+
+
+int main ( void )
+{
+    static const uint16 lBlocks [] = { 4 , BENCH_BLOCK , 256 } ;
+    const char * lEnv = getenv ( "HOST_BENCH_RUNS" ) ;
+    unsigned lRuns = lEnv ? (unsigned) strtoul ( lEnv , NULL , 10 ) : 20 ;
+    unsigned long lLongest = 0 ;
+    int16 * lOut ;
+    int lOk = 1 ;
+    unsigned b , p , r ;
+
+    if ( !lRuns )
+        return 1 ;
+
+    benchImage () ;
+
+    for ( p = 0 ; p < NUM_PROMPTS ; p++ )
+    {
+        lOk &= benchPrompt ( p ) ;
+        if ( gIndex [ p ].samples > lLongest )
+            lLongest = gIndex [ p ].samples ;
+    }
+
+    lOut = malloc ( ( lLongest + 256 ) * sizeof ( int16 ) ) ;
+    if ( !lOut )
+        abort () ;
+
+    for ( b = 0 ; b < sizeof ( lBlocks ) / sizeof ( lBlocks [ 0 ] ) ; b++ )
+    {
+        double lBest = 1e9 ;
+        unsigned long long lBestCycles = 0 ;
+
+        for ( r = 0 ; r < lRuns ; r++ )
+        {
+            unsigned long long lCycles = BENCH_CYCLES () ;
+            double lStart = benchNow () ;
+
+            for ( p = 0 ; p < NUM_PROMPTS ; p++ )
+                (void) benchDecode ( p , lOut , lBlocks [ b ] ) ;
+
+            lStart  = benchNow () - lStart ;
+            lCycles = BENCH_CYCLES () - lCycles ;
+            if ( lStart < lBest )
+            {
+                lBest       = lStart ;
+                lBestCycles = lCycles ;
+            }
+        }
+
+        printf ( "decode block=%u samples_per_s=%.0f ns_per_sample=%.2f cycles_per_sample=%.1f realtime_x=%.0f\n" ,
+                 lBlocks [ b ] , gSamples / lBest , lBest * 1e9 / gSamples ,
+                 (double) lBestCycles / gSamples , gSamples / lBest / PROMPT_RATE ) ;
+    }
+
+        /*the decoder allocates nothing: a prompt needs its state and the block written to the sink*/
+    printf ( "ram state_bytes=%lu block_bytes=%lu peak_bytes=%lu whole_prompt_bytes=%lu\n" ,
+             (unsigned long) sizeof ( promptState_t ) , (unsigned long) ( BENCH_BLOCK * sizeof ( int16 ) ) ,
+             (unsigned long) ( sizeof ( promptState_t ) + BENCH_BLOCK * sizeof ( int16 ) ) ,
+             lLongest * (unsigned long) sizeof ( int16 ) ) ;
+
+    for ( p = 0 ; p < NUM_PROMPTS ; p++ )
+        free ( gRecording [ p ] ) ;
+    free ( gImage ) ;
+    free ( lOut ) ;
+    return lOk ? 0 : 1 ;
+}
@@ -0,0 +1,130 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    host_prompt_compiler.c
+@brief   Writes the voice prompt image (headset_prompt_image.c) from recordings.
+
+    Reads each prompt of prompt_t from <directory>/<name>.raw, raw 16 bit
+    little endian 8kHz mono, encodes it as IMA ADPCM and packs them all
+    into gPromptImage, each starting on a word, with their offsets and
+    lengths in gPromptIndex:
+        host_prompt_compiler ../prompts ../headset_prompt_image.c
+    A prompt with no recording is given an empty entry, and the tone
+    configured for its event is played instead. A prompt may be up to
+    65535 samples, about 8s, and the image up to 65535 words.
+*/
+
+#include "host_adpcm_encode.h"
+#include "headset_prompts.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+
+/* Codes per line of the image written */
+#define COMPILER_PER_LINE   (8)
+
+/* Longest prompt and image, so that both fit a uint16 */
+#define COMPILER_MAX        (65535UL)
+
+
+/* Recording of each prompt, in the order of prompt_t */
+static const char * const gNames [ NUM_PROMPTS ] =
+{
+    "intercom_connected" ,
+    "intercom_disconnected" ,
+    "intercom_failed" ,
+    "phone_paired" ,
+    "phone_connected" ,
+    "battery_low"
+} ;
+
+
+/* Read a recording, returning its length, 0 if there is none */
+static unsigned long compilerRead ( const char * pDirectory , const char * pName , int16 * pSamples )
+{
+    char lPath [ 512 ] ;
+    unsigned char lSample [ 2 ] ;
+    unsigned long lCount = 0 ;
+    FILE * lFile ;
+
+    (void) snprintf ( lPath , sizeof ( lPath ) , "%s/%s.raw" , pDirectory , pName ) ;
+    if ( !( lFile = fopen ( lPath , "rb" ) ) )
+        return 0 ;
+
+    while ( ( lCount <= COMPILER_MAX ) && ( fread ( lSample , 1 , 2 , lFile ) == 2 ) )
+        pSamples [ lCount++ ] = (int16) ( lSample [ 0 ] | ( lSample [ 1 ] << 8 ) ) ;
+
+    fclose ( lFile ) ;
+    return lCount ;
+}
+
+
+int main ( int argc , char * argv [] )
+{
+    static int16 lSamples [ COMPILER_MAX + 1 ] ;
+    static uint16 lImage [ COMPILER_MAX ] ;
+    promptEntry_t lIndex [ NUM_PROMPTS ] ;
+    unsigned long lWords = 0 , i ;
+    FILE * lFile ;
+    unsigned p ;
+
+    if ( ( argc != 3 ) || !( lFile = fopen ( argv [ 2 ] , "w" ) ) )
+    {
+        fprintf ( stderr , "usage: %s <prompt directory> <headset_prompt_image.c>\n" , argv [ 0 ] ) ;
+        return 1 ;
+    }
+
+    for ( p = 0 ; p < NUM_PROMPTS ; p++ )
+    {
+        unsigned long lCount = compilerRead ( argv [ 1 ] , gNames [ p ] , lSamples ) ;
+
+        lIndex [ p ].offset  = (uint16) lWords ;
+        lIndex [ p ].samples = 0 ;
+
+        if ( !lCount )
+        {
+            fprintf ( stderr , "%s: not recorded, its tone is played instead\n" , gNames [ p ] ) ;
+            continue ;
+        }
+        if ( ( lCount > COMPILER_MAX ) || ( lWords + ADPCM_WORDS ( lCount ) > COMPILER_MAX ) )
+        {
+            fprintf ( stderr , "%s: too long for the image\n" , gNames [ p ] ) ;
+            fclose ( lFile ) ;
+            return 1 ;
+        }
+
+        lIndex [ p ].samples = (uint16) lCount ;
+        lWords += adpcmEncode ( lSamples , lCount , lImage + lWords ) ;
+    }
+
+    fprintf ( lFile , "/****************************************************************************\n"
+                      "Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008\n"
+                      "*/\n\n"
+                      "/*!\n"
+                      "@file    headset_prompt_image.c\n"
+                      "@brief   Voice prompt image, written by host/host_prompt_compiler.c.\n\n"
+                      "    Do not edit: run \"make -C host prompt_image\" after changing a\n"
+                      "    recording.\n"
+                      "*/\n\n"
+                      "#include \"headset_prompts.h\"\n\n"
+                      "#ifdef VOICE_PROMPTS\n\n"
+                      "const uint16 gPromptImage [ %lu ] =\n{" , lWords ? lWords : 1 ) ;
+
+    for ( i = 0 ; i < lWords ; i++ )
+        fprintf ( lFile , "%s0x%04x%s" , ( i % COMPILER_PER_LINE ) ? " " : "\n    " , lImage [ i ] , ( i + 1 < lWords ) ? " ," : "" ) ;
+    if ( !lWords )
+        fprintf ( lFile , "\n    0" ) ;
+
+    fprintf ( lFile , "\n} ;\n\n\nconst promptEntry_t gPromptIndex [ NUM_PROMPTS ] =\n{\n" ) ;
+    for ( p = 0 ; p < NUM_PROMPTS ; p++ )
+        fprintf ( lFile , "    { %5u , %5u }%s    /* %s, %lums */\n" , lIndex [ p ].offset , lIndex [ p ].samples ,
+                  ( p + 1 < NUM_PROMPTS ) ? " ," : "  " , gNames [ p ] , lIndex [ p ].samples * 1000UL / PROMPT_RATE ) ;
+    fprintf ( lFile , "} ;\n\n#endif /* VOICE_PROMPTS */\n" ) ;
+
+    fclose ( lFile ) ;
+    fprintf ( stderr , "%lu words of prompts\n" , lWords ) ;
+    return 0 ;
+}
@@ -0,0 +1,261 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    host_ramp_bench.c
+@brief   Click measurement and microbenchmark of the gain ramps (headset_ramp.c).
+
+    A change of gain is measured by the largest step it puts in the
+    output: at each sample, the input times the change in the gain since
+    the sample before, the part of the difference between the two output
+    samples that the signal itself did not make. The peak over the change,
+    in dB below full scale, is printed for each way of making it, the
+    worst of BENCH_OFFSETS starting points across the signal's period:
+        click case=<name> late_ms=<n> peak_dbfs=<n> samples=<n>
+    gain_step is the gain raised 3dB, a codec step, between two samples,
+    gain_ramp the same change slid by rampSetGain. amp_step is the amp's
+    gain switch, doubling the level, made with no dip; amp_dip is the same
+    switch made late_ms after the zero crossing rampProcess returned,
+    within RAMP_HOLD or not.
+    samples is the most from the change being asked for to its end. The
+    ramped cases must be BENCH_MARGIN_DB below their steps.
+
+    Then the speed of rampProcess on BENCH_BLOCK samples at a time is
+    printed, the best of HOST_BENCH_RUNS (default 20) runs of 10s of audio,
+    steady at unity, steady at another gain and sliding throughout:
+        ramp mode=<name> ns_per_sample=<n> cycles_per_sample=<n>
+    Exits 1 if a ramped case does not meet BENCH_MARGIN_DB.
+*/
+
+#include "headset_ramp.h"
+#include "host_bench.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/* Samples processed at a time, a conference frame */
+#define BENCH_BLOCK         (30)
+
+/* Samples of each click case, enough for the slowest switch to finish */
+#define BENCH_CASE          (1024)
+
+/* Sample the change is asked for at, and the starting points tried */
+#define BENCH_CHANGE        (200)
+#define BENCH_OFFSETS       (40)
+
+/* Least a ramped case must be below its step */
+#define BENCH_MARGIN_DB     (20.0)
+
+/* Samples timed a run, 10s */
+#define BENCH_TIMED         ( 10UL * BENCH_RATE )
+
+/* A codec step up, 3dB, in Q12 */
+#define BENCH_STEP          (5793)
+
+/* Magnitude of the probe that reads the gain of each sample */
+#define BENCH_PROBE         (8192)
+
+
+/* Two tones, of a voice's fundamental and formant, at -6dBFS together */
+static void benchSignal ( int16 * pOut , unsigned long pCount , unsigned long pOffset )
+{
+    unsigned long i ;
+
+    for ( i = 0 ; i < pCount ; i++ )
+    {
+        double t = (double) ( i + pOffset ) / BENCH_RATE ;
+
+        pOut [ i ] = (int16) ( 10000.0 * sin ( 2 * M_PI * 300.0 * t ) + 6000.0 * sin ( 2 * M_PI * 1100.0 * t + 1.0 ) ) ;
+    }
+}
+
+
+typedef enum
+{
+    benchGainStep ,
+    benchGainRamp ,
+    benchAmpStep ,
+    benchAmpDip
+} benchCase_t ;
+
+
+/* The peak step of one case from pOffset, and how long the change took */
+static double benchClick ( benchCase_t pCase , unsigned long pOffset , unsigned pLate , unsigned * pSamples )
+{
+    int16 lIn [ BENCH_CASE ] ;
+    double lGain [ BENCH_CASE ] ;
+    rampState_t lState ;
+    unsigned lSwitch = BENCH_CASE ;
+    unsigned lEnd = BENCH_CHANGE ;
+    double lPeak = 0.0 ;
+    unsigned n ;
+
+    benchSignal ( lIn , BENCH_CASE , pOffset ) ;
+    rampInit ( &lState , RAMP_GAIN_UNITY , RAMP_SAMPLES ) ;
+
+    for ( n = 0 ; n < BENCH_CASE ; n++ )
+    {
+        rampState_t lProbe ;
+        int16 lSample = ( lIn [ n ] >= 0 ) ? BENCH_PROBE : -BENCH_PROBE ;
+        int16 lOut = lIn [ n ] ;
+        double lAmp ;
+
+        if ( n == BENCH_CHANGE )
+        {
+            if ( pCase == benchGainRamp )
+                rampSetGain ( &lState , BENCH_STEP ) ;
+            else if ( pCase == benchAmpDip )
+                rampSwitch ( &lState , RAMP_GAIN_UNITY ) ;
+        }
+
+            /*a copy fed a probe of the same sign finds the same crossing, and shows the gain*/
+        lProbe = lState ;
+        (void) rampProcess ( &lProbe , &lSample , 1 ) ;
+        if ( rampProcess ( &lState , &lOut , 1 ) != RAMP_NO_SWITCH )
+            lSwitch = n + pLate * BENCH_RATE / 1000 ;
+
+        switch ( pCase )
+        {
+        case benchGainStep:
+            lAmp = ( n >= BENCH_CHANGE ) ? (double) BENCH_STEP / RAMP_GAIN_UNITY : 1.0 ;
+            break ;
+        case benchAmpStep:
+            lAmp = ( n >= BENCH_CHANGE ) ? 2.0 : 1.0 ;
+            break ;
+        case benchAmpDip:
+            lAmp = ( n >= lSwitch ) ? 2.0 : 1.0 ;
+            break ;
+        default:
+            lAmp = 1.0 ;
+            break ;
+        }
+
+        lGain [ n ] = lAmp * fabs ( (double) lSample ) / BENCH_PROBE ;
+
+        if ( ( n > 0 ) && ( lGain [ n ] != lGain [ n - 1 ] ) )
+        {
+            double lStep = fabs ( lIn [ n ] * ( lGain [ n ] - lGain [ n - 1 ] ) ) / 32768.0 ;
+
+            if ( lStep > lPeak )
+                lPeak = lStep ;
+            lEnd = n ;
+        }
+    }
+
+    *pSamples = lEnd - BENCH_CHANGE + 1 ;
+    return lPeak ;
+}
+
+
+/* The worst of every starting point */
+static double benchCase ( const char * pName , benchCase_t pCase , unsigned pLate )
+{
+    double lWorst = 0.0 ;
+    unsigned lLongest = 0 ;
+    unsigned o ;
+
+    for ( o = 0 ; o < BENCH_OFFSETS ; o++ )
+    {
+        unsigned lSamples ;
+        double lPeak = benchClick ( pCase , o * BENCH_RATE / 300 / BENCH_OFFSETS + o * 7 , pLate , &lSamples ) ;
+
+        if ( lPeak > lWorst )
+            lWorst = lPeak ;
+        if ( lSamples > lLongest )
+            lLongest = lSamples ;
+    }
+
+    lWorst = 20.0 * log10 ( lWorst + 1e-9 ) ;
+    printf ( "click case=%s late_ms=%u peak_dbfs=%.1f samples=%u\n" , pName , pLate , lWorst , lLongest ) ;
+    return lWorst ;
+}
+
+
+/* Time rampProcess in one mode */
+static void benchSpeed ( const char * pName , uint16 pGain , int pSliding , unsigned pRuns , const int16 * pSignal )
+{
+    static int16 lFrame [ BENCH_BLOCK ] ;
+    double lBest = 1e9 ;
+    unsigned long long lBestCycles = 0 ;
+    unsigned long s ;
+    unsigned r ;
+
+    for ( r = 0 ; r < pRuns ; r++ )
+    {
+        rampState_t lState ;
+        unsigned long long lCycles ;
+        double lStart ;
+        uint16 lTarget = pGain ;
+
+        rampInit ( &lState , pGain , RAMP_SAMPLES ) ;
+
+        lCycles = BENCH_CYCLES () ;
+        lStart  = benchNow () ;
+
+        for ( s = 0 ; s + BENCH_BLOCK <= BENCH_TIMED ; s += BENCH_BLOCK )
+        {
+            if ( pSliding && ( lState.phase == rampSteady ) )
+            {
+                lTarget = ( lTarget == pGain ) ? 2 * pGain : pGain ;
+                rampSetGain ( &lState , lTarget ) ;
+            }
+            memcpy ( lFrame , pSignal + s , sizeof ( lFrame ) ) ;
+            (void) rampProcess ( &lState , lFrame , BENCH_BLOCK ) ;
+        }
+
+        lStart  = benchNow () - lStart ;
+        lCycles = BENCH_CYCLES () - lCycles ;
+        if ( lStart < lBest )
+        {
+            lBest       = lStart ;
+            lBestCycles = lCycles ;
+        }
+    }
+
+    printf ( "ramp mode=%s ns_per_sample=%.2f cycles_per_sample=%.1f\n" ,
+             pName , lBest * 1e9 / BENCH_TIMED , (double) lBestCycles / BENCH_TIMED ) ;
+}
+
+
+int main ( void )
+{
+    static const unsigned lLate [] = { 0 , 2 , 6 , 10 } ;
+    const char * lEnv = getenv ( "HOST_BENCH_RUNS" ) ;
+    unsigned lRuns = lEnv ? (unsigned) strtoul ( lEnv , NULL , 10 ) : 20 ;
+    double lGainStep , lAmpStep ;
+    int16 * lSignal ;
+    int lOk = 1 ;
+    unsigned l ;
+
+    if ( !lRuns )
+        return 1 ;
+
+    lGainStep = benchCase ( "gain_step" , benchGainStep , 0 ) ;
+    lOk &= ( benchCase ( "gain_ramp" , benchGainRamp , 0 ) <= lGainStep - BENCH_MARGIN_DB ) ;
+    lAmpStep  = benchCase ( "amp_step" , benchAmpStep , 0 ) ;
+
+        /*a switch landing after RAMP_HOLD is out of the dip, and need not meet the margin*/
+    for ( l = 0 ; l < sizeof ( lLate ) / sizeof ( lLate [ 0 ] ) ; l++ )
+    {
+        double lPeak = benchCase ( "amp_dip" , benchAmpDip , lLate [ l ] ) ;
+
+        if ( lLate [ l ] * BENCH_RATE / 1000 < RAMP_HOLD )
+            lOk &= ( lPeak <= lAmpStep - BENCH_MARGIN_DB ) ;
+    }
+
+    lSignal = malloc ( BENCH_TIMED * sizeof ( int16 ) ) ;
+    if ( !lSignal )
+        abort () ;
+    benchSignal ( lSignal , BENCH_TIMED , 0 ) ;
+
+    benchSpeed ( "unity" , RAMP_GAIN_UNITY , 0 , lRuns , lSignal ) ;
+    benchSpeed ( "steady" , RAMP_GAIN_UNITY / 2 , 0 , lRuns , lSignal ) ;
+    benchSpeed ( "sliding" , RAMP_GAIN_UNITY / 2 , 1 , lRuns , lSignal ) ;
+
+    free ( lSignal ) ;
+    return lOk ? 0 : 1 ;
+}
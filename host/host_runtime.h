@@ -0,0 +1,363 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    host_runtime.h
+@brief   Interface to the host (Linux) discrete-event runtime.
+
+    The host runtime replaces the BlueCore firmware services (message
+    scheduler, persistent store, PIO, VM clock and the BlueLab profile
+    libraries) with a deterministic, virtual-time implementation so that the
+    unmodified application sources can be linked and driven by scripted
+    scenarios on a PC.
+
+    Time only advances when the scheduler has nothing left to deliver at the
+    current instant, so a scenario covering several minutes of headset
+    activity completes in a few milliseconds of wall-clock time.
+*/
+
+#ifndef HOST_RUNTIME_H
+#define HOST_RUNTIME_H
+
+
+#include <csrtypes.h>
+#include <message.h>
+#include <bdaddr.h>
+#include <hfp.h>
+
+
+/* Size of the pending message pool */
+#define HOST_MAX_PENDING_MESSAGES   (256)
+
+/* Size of the per message id statistics table - must be a power of two */
+#define HOST_MAX_MESSAGE_IDS        (256)
+
+/* Priority lanes - of the messages due, the lowest numbered lane is delivered first */
+#define HOST_NUM_LANES              (3)
+#define HOST_LANE_HIGH              (0)
+#define HOST_LANE_NORMAL            (1)
+#define HOST_LANE_LOW               (2)
+
+/* Number of persistent store keys emulated */
+#define HOST_MAX_PS_KEYS            (64)
+#define HOST_MAX_PS_KEY_SIZE        (64)
+
+
+/*! @brief Delivery statistics for a single message id */
+typedef struct
+{
+    MessageId   id;
+    uint32      delivered;      /*!< Number of times the message was delivered */
+    uint32      sent;           /*!< Number of times the message was posted */
+    uint32      cancelled;      /*!< Number of times the message was cancelled while pending */
+} hostMessageStats;
+
+
+/*! @brief Scheduler wide statistics */
+typedef struct
+{
+    uint32      delivered;      /*!< Total number of messages delivered */
+    uint32      sent;           /*!< Total number of messages posted */
+    uint32      cancelled;      /*!< Total number of messages cancelled */
+    uint32      timer_wakeups;  /*!< Number of times the clock was advanced to fire a delayed message */
+    uint16      max_depth;      /*!< Highest number of messages pending at once */
+    uint16      depth;          /*!< Current number of messages pending */
+    uint32      untracked;      /*!< Posts, deliveries and cancels of ids with no room left in ids[] */
+    hostMessageStats ids[HOST_MAX_MESSAGE_IDS];
+} hostStats;
+
+
+/*! @brief Behaviour of the remote devices modelled by the library stubs */
+typedef struct
+{
+    bdaddr      peer_addr;          /*!< Address of the intercom peer */
+    unsigned    peer_present:1;     /*!< Peer is in range and page scanning */
+    unsigned    peer_accepts_sco:1; /*!< Peer accepts (e)SCO set up */
+    unsigned    unused:14;
+    uint16      page_ms;            /*!< Time taken to page and set up an SLC when the peer is present */
+    uint16      page_timeout_ms;    /*!< Time taken for a page to fail when the peer is absent */
+    uint16      sco_ms;             /*!< Time taken to negotiate (e)SCO */
+    uint16      jitter_ms;          /*!< Random jitter added to each of the above */
+    uint32      peer_return_ms;     /*!< Virtual time at which an absent peer comes back in range (0 = never) */
+    uint16      bystanders;         /*!< Other riders answering an inquiry, which never accept our connection */
+} hostPeerModel;
+
+
+/*! @brief Timestamps of interesting library calls, recorded by the stubs */
+typedef struct
+{
+    uint32      slc_connect_calls;      /*!< Number of AghfpSlcConnect calls */
+    uint32      hfp_connect_calls;      /*!< Number of HfpSlcConnect calls */
+    uint32      inquiry_calls;          /*!< Number of ConnectionInquire calls */
+    uint32      page_time_ms;           /*!< Total time spent paging the intercom peer and the phone */
+    uint32      last_slc_connect_ms;    /*!< Time of the last AGHFP SLC connect confirmation with success */
+    uint32      last_audio_connect_ms;  /*!< Time of the last AudioConnect call */
+    uint32      audio_connect_calls;    /*!< Number of AudioConnect calls */
+    uint32      tones_played;           /*!< Number of AudioPlayTone calls */
+} hostLibTrace;
+
+
+/****************************************************************************
+  FUNCTIONS
+*/
+
+/****************************************************************************
+NAME
+    HostNow
+
+DESCRIPTION
+    Returns the current virtual time in milliseconds.
+
+*/
+uint32 HostNow ( void ) ;
+
+
+/****************************************************************************
+NAME
+    HostRunFor
+
+DESCRIPTION
+    Deliver every message that falls due within the next pTime milliseconds,
+    advancing virtual time as required. Virtual time is equal to the start
+    time plus pTime on return.
+
+*/
+void HostRunFor ( uint32 pTime ) ;
+
+
+/****************************************************************************
+NAME
+    HostRunUntil
+
+DESCRIPTION
+    Deliver messages until pDone returns TRUE or pLimit milliseconds have
+    elapsed.
+
+RETURNS
+    TRUE if pDone was satisfied, FALSE on timeout.
+*/
+bool HostRunUntil ( bool (*pDone)(void) , uint32 pLimit ) ;
+
+
+/****************************************************************************
+NAME
+    HostSetLaneClassifier
+
+DESCRIPTION
+    Install the function used to place each posted message in a priority
+    lane (HOST_LANE_HIGH to HOST_LANE_LOW). Without a classifier every
+    message goes in HOST_LANE_NORMAL and delivery order matches the chip.
+
+*/
+void HostSetLaneClassifier ( uint16 (*pClassify) ( Task pTask , MessageId pId ) ) ;
+
+
+/****************************************************************************
+NAME
+    HostSetDeliveryCost
+
+DESCRIPTION
+    Set the virtual time, in microseconds, charged for handling each message.
+    This models the time the application spends in its handlers, so that
+    messages queued behind busy traffic are delivered late as they are on
+    the chip. Defaults to 0.
+
+*/
+void HostSetDeliveryCost ( uint16 pMicroseconds ) ;
+
+
+/****************************************************************************
+NAME
+    HostDeliveryDue / HostQueueDepth
+
+DESCRIPTION
+    While a message is being delivered, returns the virtual time at which it
+    fell due and the number of other messages pending.
+
+*/
+uint32 HostDeliveryDue ( void ) ;
+uint16 HostQueueDepth ( void ) ;
+
+
+/****************************************************************************
+NAME
+    HostWallClockUs
+
+DESCRIPTION
+    Returns a free running wall clock in microseconds, for timing host code.
+
+*/
+uint32 HostWallClockUs ( void ) ;
+
+
+/****************************************************************************
+NAME
+    HostReset
+
+DESCRIPTION
+    Discard all pending messages and statistics and rewind the clock.
+
+*/
+void HostReset ( void ) ;
+
+
+/****************************************************************************
+NAME
+    HostGetStats / HostResetStats
+
+DESCRIPTION
+    Access the scheduler statistics.
+
+*/
+const hostStats * HostGetStats ( void ) ;
+void HostResetStats ( void ) ;
+
+
+/****************************************************************************
+NAME
+    HostFindStats
+
+DESCRIPTION
+    Look up the statistics for a message id.
+
+RETURNS
+    The statistics entry, or NULL if the id has never been posted.
+*/
+const hostMessageStats * HostFindStats ( MessageId pId ) ;
+
+
+/****************************************************************************
+NAME
+    HostRandom
+
+DESCRIPTION
+    Deterministic pseudo random number generator used for jitter. Seeded per
+    scenario run so that each run is reproducible.
+
+*/
+void HostSeed ( uint32 pSeed ) ;
+uint32 HostRandom ( void ) ;
+
+
+/****************************************************************************
+NAME
+    HostPioInject
+
+DESCRIPTION
+    Change the state of the input PIOs and notify the task registered with
+    MessagePioTask, as the firmware would after debouncing.
+
+*/
+void HostPioInject ( uint32 pState ) ;
+
+
+/****************************************************************************
+NAME
+    HostPioOutputs
+
+DESCRIPTION
+    Returns the current state of the PIOs driven by the application.
+
+*/
+uint32 HostPioOutputs ( void ) ;
+
+
+/****************************************************************************
+NAME
+    HostPsClear
+
+DESCRIPTION
+    Erase the emulated persistent store.
+
+*/
+void HostPsClear ( void ) ;
+
+
+/****************************************************************************
+NAME
+    HostPeer / HostLibTrace / HostLibReset
+
+DESCRIPTION
+    Access the remote device model and the trace of library calls made by
+    the application.
+
+*/
+hostPeerModel * HostPeer ( void ) ;
+hostLibTrace * HostLibTrace ( void ) ;
+void HostLibReset ( void ) ;
+
+
+/****************************************************************************
+NAME
+    HostLibSetReplay
+
+DESCRIPTION
+    While set, the library models still act on calls from the application
+    but post no messages back to it, as a replayed trace supplies them.
+
+*/
+void HostLibSetReplay ( bool pReplay ) ;
+
+
+/****************************************************************************
+NAME
+    HostSetPanicHook
+
+DESCRIPTION
+    Install a function called when the application panics, before the
+    process aborts.
+
+*/
+void HostSetPanicHook ( void (*pHook) ( void ) ) ;
+
+
+/****************************************************************************
+NAME
+    HostPeerLinkLoss
+
+DESCRIPTION
+    Simulate a link loss on the intercom SLC. The peer is taken out of range
+    until peer_return_ms.
+
+*/
+void HostPeerLinkLoss ( void ) ;
+
+
+/****************************************************************************
+NAME
+    HostPeerCalls
+
+DESCRIPTION
+    Simulate the peer opening the intercom SLC to the headset: an
+    AGHFP_SLC_CONNECT_IND from peer_addr.
+
+*/
+void HostPeerCalls ( void ) ;
+
+
+/****************************************************************************
+NAME
+    HostPhoneLinkLoss
+
+DESCRIPTION
+    Simulate a link loss on the SLC to the phone served by pHfp. The phone
+    is not modelled, so it never comes back in range.
+
+*/
+void HostPhoneLinkLoss ( HFP * pHfp ) ;
+
+
+/****************************************************************************
+NAME
+    HostScenarioRun
+
+DESCRIPTION
+    Entry point of the scenario runner, called from MessageLoop once the
+    application has completed its synchronous initialisation.
+
+*/
+void HostScenarioRun ( void ) ;
+
+
+#endif /* HOST_RUNTIME_H */
@@ -0,0 +1,708 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    host_scenario.c
+@brief   Scripted scenarios run against the application on the host.
+
+    The scenario is selected with the HOST_SCENARIO environment variable and
+    repeated HOST_RUNS times (default 100). Every run is forked from the state
+    the application reached at MessageLoop, so each run starts from a clean
+    boot and differs only in the random seed used for radio jitter.
+
+    HOST_DELIVERY_COST_US sets the virtual time charged per handled message
+    (default 250us). Messages are placed in the priority lanes assigned with
+    dispatchSetLane. With HOST_DUMP set, the first run of each scenario
+    prints the handler instrumentation when built with INSTRUMENT_HANDLERS.
+
+    The replay scenario boots the headset, then feeds the messages of a
+    trace captured by headset_trace.c (the file named by HOST_TRACE) to the
+    application at their recorded times, with the library models silenced.
+    Payloads beyond the recorded words read as zero.
+
+    Results are printed one line per metric as
+        <scenario> <metric> min=<n> mean=<n> max=<n> runs=<n>
+    which is stable enough to be diffed or parsed by CI.
+*/
+
+#include "host_runtime.h"
+
+#include "headset_private.h"
+#include "headset_coalesce.h"
+#include "headset_audio_switch.h"
+#include "headset_configmanager.h"
+#include "headset_dispatch.h"
+#include "headset_events.h"
+#include "headset_instrument.h"
+#include "headset_intercom_inquire.h"
+#include "headset_intercom_msg_handler.h"
+#include "headset_peer_table.h"
+#include "headset_pio.h"
+#include "headset_pool.h"
+#include "headset_trace.h"
+
+#include <ps.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+
+#define HOST_MAX_METRICS        (8)
+#define HOST_DEFAULT_RUNS       (100)
+#define HOST_DEFAULT_COST_US    (250)
+
+/* Synthetic LED load - a burst of dimming steps every period */
+#define HOST_LED_LOAD_PERIOD_MS (10)
+#define HOST_LED_LOAD_BURST     (24)
+
+/* Smallest payload allocated for a replayed message, so handlers never read
+   past it. Every message is given one, since a message traced by its id
+   alone may still have had a payload */
+#define HOST_REPLAY_PAYLOAD_MIN (64)
+
+/* Other riders answering the inquiry when pairing */
+#define HOST_PAIRING_BYSTANDERS (3)
+
+/* A metric value reported by a run which could not complete */
+#define HOST_METRIC_FAILED      (0xffffffffUL)
+
+
+/* The outcome of a single run */
+typedef struct
+{
+    uint32  metric [ HOST_MAX_METRICS ] ;
+} hostResult ;
+
+
+/* A scripted scenario */
+typedef struct
+{
+    const char *    name ;
+    const char *    description ;
+    void            (*run) ( hostResult * pResult ) ;
+    const char *    metric [ HOST_MAX_METRICS ] ;
+} hostScenario ;
+
+
+/****************************************************************************
+  HELPERS
+*/
+
+static hsTaskData * hostApp ( void )
+{
+    return (hsTaskData *) getAppTask () ;
+}
+
+
+static void hostPowerOn ( void )
+{
+    MessageSend ( getAppTask () , EventPowerOn , 0 ) ;
+        /*let the power on sequence and its tones settle*/
+    HostRunFor ( 2000 ) ;
+}
+
+
+/* Blocks in use at the high water mark of every pool, and allocations which went to the heap */
+static void hostPoolUsage ( uint32 * pHighWater , uint32 * pHeap )
+{
+    uint16 lOversize ;
+    uint16 i ;
+
+    *pHighWater = 0 ;
+    *pHeap = 0 ;
+
+    for ( i = 0 ; i < POOL_NUM_CLASSES ; i++ )
+    {
+        const poolStats_t * lStats = poolGetStats ( i , &lOversize ) ;
+
+        *pHighWater += lStats->high_water ;
+        *pHeap      += lStats->fallbacks ;
+    }
+    *pHeap += lOversize ;
+}
+
+
+/* Number of EventSkipForward/EventSkipBackward sends absorbed by coalescing */
+static uint32 hostCoalesced ( void )
+{
+    return coalesceGetAbsorbed ( getAppTask () , EventSkipForward ) +
+           coalesceGetAbsorbed ( getAppTask () , EventSkipBackward ) ;
+}
+
+
+static uint32 gAudioConnectCalls ;
+
+static bool hostIntercomAudioUp ( void )
+{
+    return HostLibTrace ()->audio_connect_calls != gAudioConnectCalls ;
+}
+
+
+static bool hostIntercomSlcUp ( void )
+{
+    return intercomIsConnected ( hostApp () ) ;
+}
+
+
+static bool hostIntercomGaveUp ( void )
+{
+    return !hostApp ()->intercom [ 0 ].reconnect.active ;
+}
+
+
+static bool hostHfpGaveUp ( void )
+{
+    return !hostApp ()->hfp_reconnect.active ;
+}
+
+
+static uint16 hostClassify ( Task pTask , MessageId pId )
+{
+    return (uint16) dispatchGetLane ( pTask , pId ) ;
+}
+
+
+#ifdef TRACE_MESSAGES
+static void hostTraceOnPanic ( void )
+{
+    traceFlush ( traceToDebug ) ;
+}
+#endif
+
+
+/* Keep the LED task busy with dimming steps, as during a fast flashing pattern */
+static void hostLedLoadHandler ( Task pTask , MessageId pId , Message pMessage )
+{
+    hsTaskData * lApp = hostApp () ;
+    uint16 i ;
+
+    for ( i = 0 ; i < HOST_LED_LOAD_BURST ; i++ )
+        MessageSend ( &lApp->theLEDTask.task , DIM_MSG_BASE + ( i % HEADSET_NUM_LEDS ) , 0 ) ;
+
+    MessageSendLater ( pTask , 0 , 0 , HOST_LED_LOAD_PERIOD_MS ) ;
+}
+
+static TaskData gLedLoadTask = { hostLedLoadHandler } ;
+
+
+/****************************************************************************
+  SCENARIOS
+*/
+
+/* Power on and stay idle for 30 seconds */
+static void scenarioBoot ( hostResult * pResult )
+{
+    const hostStats * lStats = HostGetStats () ;
+
+    MessageSend ( getAppTask () , EventPowerOn , 0 ) ;
+    HostRunFor ( 30000 ) ;
+
+    pResult->metric [ 0 ] = lStats->delivered ;
+    pResult->metric [ 1 ] = lStats->sent ;
+    pResult->metric [ 2 ] = lStats->cancelled ;
+    pResult->metric [ 3 ] = lStats->timer_wakeups ;
+    pResult->metric [ 4 ] = lStats->max_depth ;
+    hostPoolUsage ( &pResult->metric [ 5 ] , &pResult->metric [ 6 ] ) ;
+}
+
+
+/* Open an intercom call to a previously paired peer from the button */
+static void scenarioIntercomOpen ( hostResult * pResult )
+{
+    uint32 lStart ;
+
+    peerTableConnected ( &HostPeer ()->peer_addr ) ;
+    hostPowerOn () ;
+
+    HostResetStats () ;
+    HostLibReset () ;
+    gAudioConnectCalls = 0 ;
+
+    lStart = HostNow () ;
+    MessageSend ( getAppTask () , EventRWDPress , 0 ) ;
+
+    if ( HostRunUntil ( hostIntercomAudioUp , 30000 ) )
+        pResult->metric [ 0 ] = HostLibTrace ()->last_audio_connect_ms - lStart ;
+    else
+        pResult->metric [ 0 ] = HOST_METRIC_FAILED ;
+
+    pResult->metric [ 1 ] = HostGetStats ()->delivered ;
+    pResult->metric [ 2 ] = HostGetStats ()->timer_wakeups ;
+    pResult->metric [ 3 ] = HostLibTrace ()->slc_connect_calls ;
+    pResult->metric [ 4 ] = audioSwitchGetTimings ()->amp_ms ;
+    pResult->metric [ 5 ] = audioSwitchGetTimings ()->sco_ms ;
+    pResult->metric [ 6 ] = audioSwitchGetTimings ()->plugin_ms ;
+    pResult->metric [ 7 ] = hostApp ()->intercom [ 0 ].link.dwell_ms [ intercomLinkConnecting ] ;
+}
+
+
+/* Open an intercom call while the LED task is flooded */
+static void scenarioIntercomOpenBusy ( hostResult * pResult )
+{
+    MessageSend ( &gLedLoadTask , 0 , 0 ) ;
+    scenarioIntercomOpen ( pResult ) ;
+}
+
+
+/* As above with every message in one lane, as delivered by the chip */
+static void scenarioIntercomOpenBusyFifo ( hostResult * pResult )
+{
+    HostSetLaneClassifier ( NULL ) ;
+    scenarioIntercomOpenBusy ( pResult ) ;
+}
+
+
+/* Pair with the peer by inquiry while other riders answer too */
+static void scenarioIntercomPairing ( hostResult * pResult )
+{
+    hsTaskData * lApp = hostApp () ;
+    uint32 lStart ;
+
+    HostPeer ()->bystanders = HOST_PAIRING_BYSTANDERS ;
+    hostPowerOn () ;
+
+    HostResetStats () ;
+    HostLibReset () ;
+
+    lStart = HostNow () ;
+    MessageSend ( &lApp->intercom [ 0 ].task , AGHFP_INQUIRE_START , 0 ) ;
+
+        /*a rider other than the peer never accepts, so only the peer can bring the link up*/
+    if ( HostRunUntil ( hostIntercomSlcUp , 60000 ) && BdaddrIsSame ( &lApp->intercom [ 0 ].bd_addr , &HostPeer ()->peer_addr ) )
+    {
+        pResult->metric [ 0 ] = 100 ;
+        pResult->metric [ 1 ] = HostLibTrace ()->last_slc_connect_ms - lStart ;
+    }
+    else
+    {
+        pResult->metric [ 0 ] = 0 ;
+        pResult->metric [ 1 ] = HOST_METRIC_FAILED ;
+    }
+
+    pResult->metric [ 2 ] = HostLibTrace ()->slc_connect_calls ;
+    pResult->metric [ 3 ] = HostLibTrace ()->inquiry_calls ;
+    pResult->metric [ 4 ] = intercomInquiryFailedStats ()->hits ;
+    pResult->metric [ 5 ] = intercomInquiryFailedStats ()->misses ;
+}
+
+
+/* The peer opens the link: the rider recorded must be the one that called */
+static void scenarioIntercomIncoming ( hostResult * pResult )
+{
+    hsTaskData * lApp = hostApp () ;
+    const bdaddr * lPeer = &HostPeer ()->peer_addr ;
+    bdaddr lZero ;
+    bool lKnown = FALSE ;
+    uint16 i ;
+
+    hostPowerOn () ;
+
+    HostResetStats () ;
+    HostLibReset () ;
+
+    HostPeerCalls () ;
+
+    if ( HostRunUntil ( hostIntercomSlcUp , 30000 ) )
+    {
+        for ( i = 0 ; i < INTERCOM_MAX_PEERS ; i++ )
+        {
+            if ( BdaddrIsSame ( &lApp->intercom [ i ].bd_addr , lPeer ) )
+                lKnown = TRUE ;
+        }
+    }
+
+    BdaddrSetZero ( &lZero ) ;
+    pResult->metric [ 0 ] = ( lKnown && ( peerTableFind ( lPeer , NULL ) != PEER_TABLE_NONE ) ) ? 100 : 0 ;
+    pResult->metric [ 1 ] = ( peerTableFind ( &lZero , NULL ) != PEER_TABLE_NONE ) ? 1 : 0 ;
+    pResult->metric [ 2 ] = HostGetStats ()->delivered ;
+}
+
+
+/* Replay a captured message trace */
+static void scenarioReplay ( hostResult * pResult )
+{
+    const char * lPath = getenv ( "HOST_TRACE" ) ;
+    FILE * lFile = lPath ? fopen ( lPath , "r" ) : NULL ;
+    char lLine [ 256 ] ;
+    bool lFirst = TRUE ;
+    uint32 lBase = 0 ;
+    uint32 lLast = 0 ;
+    uint32 lCount = 0 ;
+
+    if ( !lFile )
+    {
+        printf ( "replay: set HOST_TRACE to a captured trace\n" ) ;
+        pResult->metric [ 0 ] = HOST_METRIC_FAILED ;
+        return ;
+    }
+
+    hostPowerOn () ;
+    HostResetStats () ;
+    HostLibReset () ;
+    HostLibSetReplay ( TRUE ) ;
+
+    while ( fgets ( lLine , sizeof ( lLine ) , lFile ) )
+    {
+        unsigned long lTime ;
+        unsigned lId , lLength ;
+        int lUsed ;
+        uint16 * lPayload ;
+        const char * lWords ;
+        uint16 i ;
+
+        if ( sscanf ( lLine , "TRC %lu %x %u%n" , &lTime , &lId , &lLength , &lUsed ) != 3 )
+            continue ;
+
+        lWords   = lLine + lUsed ;
+        lPayload = calloc ( 1 , HOST_REPLAY_PAYLOAD_MIN + lLength * sizeof ( uint16 ) ) ;
+        for ( i = 0 ; i < lLength ; i++ )
+        {
+            unsigned lWord ;
+            int lWordUsed ;
+
+            if ( sscanf ( lWords , " %x%n" , &lWord , &lWordUsed ) != 1 )
+                break ;
+            lPayload [ i ] = (uint16) lWord ;
+            lWords += lWordUsed ;
+        }
+
+        if ( lFirst )
+        {
+            lBase  = (uint32) lTime ;
+            lFirst = FALSE ;
+        }
+        lLast = (uint32) lTime - lBase ;
+
+        MessageSendLater ( getAppTask () , (MessageId) lId , lPayload , lLast ) ;
+        lCount++ ;
+    }
+    fclose ( lFile ) ;
+
+    HostRunFor ( lLast + 5000 ) ;
+
+    pResult->metric [ 0 ] = lCount ;
+    pResult->metric [ 1 ] = HostGetStats ()->delivered ;
+    pResult->metric [ 2 ] = HostLibTrace ()->audio_connect_calls ;
+    pResult->metric [ 3 ] = HostLibTrace ()->tones_played ;
+    pResult->metric [ 4 ] = HostLibTrace ()->slc_connect_calls ;
+}
+
+
+/* Bring up the intercom link to the peer, returning FALSE if it would not connect */
+static bool hostIntercomUp ( void )
+{
+    peerTableConnected ( &HostPeer ()->peer_addr ) ;
+    hostPowerOn () ;
+
+    gAudioConnectCalls = HostLibTrace ()->audio_connect_calls ;
+    MessageSend ( getAppTask () , EventRWDPress , 0 ) ;
+    if ( !HostRunUntil ( hostIntercomSlcUp , 30000 ) )
+        return FALSE ;
+    HostRunFor ( 5000 ) ;
+
+    HostResetStats () ;
+    HostLibReset () ;
+    return TRUE ;
+}
+
+
+/* Lose the intercom link and measure how long the headset takes to recover */
+static void scenarioLinkLossReconnect ( hostResult * pResult )
+{
+    hostPeerModel * lPeer = HostPeer () ;
+    uint32 lLoss ;
+    uint32 lCoalesced ;
+
+    if ( !hostIntercomUp () )
+    {
+        pResult->metric [ 0 ] = HOST_METRIC_FAILED ;
+        return ;
+    }
+    lCoalesced = hostCoalesced () ;
+
+        /*the peer rides out of range for 5 to 65 seconds*/
+    lLoss = HostNow () ;
+    lPeer->peer_return_ms = lLoss + 5000 + ( HostRandom () % 60000 ) ;
+    HostPeerLinkLoss () ;
+
+    if ( HostRunUntil ( hostIntercomSlcUp , 15UL * 60 * 1000 ) )
+        pResult->metric [ 0 ] = HostLibTrace ()->last_slc_connect_ms - lLoss ;
+    else
+        pResult->metric [ 0 ] = HOST_METRIC_FAILED ;
+
+    pResult->metric [ 1 ] = pResult->metric [ 0 ] == HOST_METRIC_FAILED ? HOST_METRIC_FAILED :
+                            HostLibTrace ()->last_slc_connect_ms - lPeer->peer_return_ms ;
+    pResult->metric [ 2 ] = HostLibTrace ()->slc_connect_calls ;
+    pResult->metric [ 3 ] = HostLibTrace ()->page_time_ms ;
+    pResult->metric [ 4 ] = HostGetStats ()->timer_wakeups ;
+    pResult->metric [ 5 ] = HostGetStats ()->delivered ;
+    pResult->metric [ 6 ] = hostCoalesced () - lCoalesced ;
+}
+
+
+/* Lose the intercom link for good and measure the paging spent before giving up */
+static void scenarioLinkLossAbsent ( hostResult * pResult )
+{
+    uint32 lLoss ;
+
+    if ( !hostIntercomUp () )
+    {
+        pResult->metric [ 0 ] = HOST_METRIC_FAILED ;
+        return ;
+    }
+
+    lLoss = HostNow () ;
+    HostPeer ()->peer_return_ms = 0 ;
+    HostPeerLinkLoss () ;
+    HostRunFor ( 1000 ) ;
+
+    if ( HostRunUntil ( hostIntercomGaveUp , 30UL * 60 * 1000 ) )
+        pResult->metric [ 0 ] = HostNow () - lLoss ;
+    else
+        pResult->metric [ 0 ] = HOST_METRIC_FAILED ;
+
+    pResult->metric [ 1 ] = HostLibTrace ()->slc_connect_calls ;
+    pResult->metric [ 2 ] = HostLibTrace ()->page_time_ms ;
+    pResult->metric [ 3 ] = HostGetStats ()->timer_wakeups ;
+}
+
+
+/* Lose the phone for good and measure the paging spent before giving up */
+static void scenarioPhoneLinkLoss ( hostResult * pResult )
+{
+    static const bdaddr lPhone = { 0x123456 , 0x78 , 0x9abc } ;
+    hsTaskData * lApp = hostApp () ;
+    uint32 lLoss ;
+
+    (void) PsStore ( PSKEY_LAST_USED_AG , &lPhone , sizeof ( bdaddr ) ) ;
+    hostPowerOn () ;
+        /*let the power on reconnect to the absent phone fail*/
+    HostRunFor ( 10000 ) ;
+
+    HostResetStats () ;
+    HostLibReset () ;
+
+        /*pretend the SLC was up, as the phone is not modelled*/
+    lApp->hfp_hsp = lApp->hfp ;
+    lApp->profile_connected = hfp_handsfree_profile ;
+
+    lLoss = HostNow () ;
+    HostPhoneLinkLoss ( lApp->hfp ) ;
+    HostRunFor ( 1000 ) ;
+
+    if ( HostRunUntil ( hostHfpGaveUp , 30UL * 60 * 1000 ) )
+        pResult->metric [ 0 ] = HostNow () - lLoss ;
+    else
+        pResult->metric [ 0 ] = HOST_METRIC_FAILED ;
+
+    pResult->metric [ 1 ] = HostLibTrace ()->hfp_connect_calls ;
+    pResult->metric [ 2 ] = HostLibTrace ()->page_time_ms ;
+    pResult->metric [ 3 ] = HostGetStats ()->timer_wakeups ;
+}
+
+
+static const hostScenario gScenarios [] =
+{
+    {
+        "boot" , "power on and idle for 30s" , scenarioBoot ,
+        { "delivered" , "sent" , "cancelled" , "timer_wakeups" , "max_depth" , "pool_high_water" , "pool_heap_allocs" }
+    } ,
+    {
+        "intercom_open" , "RWD press to intercom audio with a paired peer in range" , scenarioIntercomOpen ,
+        { "latency_ms" , "delivered" , "timer_wakeups" , "slc_connects" , "switch_amp_ms" , "switch_sco_ms" , "switch_plugin_ms" , "slc_phase_ms" }
+    } ,
+    {
+        "intercom_open_busy" , "intercom_open with heavy LED activity, priority lanes" , scenarioIntercomOpenBusy ,
+        { "latency_ms" , "delivered" , "timer_wakeups" , "slc_connects" , "switch_amp_ms" , "switch_sco_ms" , "switch_plugin_ms" , "slc_phase_ms" }
+    } ,
+    {
+        "intercom_open_busy_fifo" , "intercom_open with heavy LED activity, single lane" , scenarioIntercomOpenBusyFifo ,
+        { "latency_ms" , "delivered" , "timer_wakeups" , "slc_connects" , "switch_amp_ms" , "switch_sco_ms" , "switch_plugin_ms" , "slc_phase_ms" }
+    } ,
+    {
+        "intercom_pairing" , "pair by inquiry with 3 other riders answering" , scenarioIntercomPairing ,
+        { "paired_pct" , "time_to_pair_ms" , "slc_connects" , "inquiries" , "failed_hits" , "failed_misses" }
+    } ,
+    {
+        "intercom_incoming" , "the peer opens the intercom SLC and is recorded" , scenarioIntercomIncoming ,
+        { "recorded_pct" , "zero_recorded" , "delivered" }
+    } ,
+    {
+        "link_loss_reconnect" , "intercom link loss, peer returns after 5-65s" , scenarioLinkLossReconnect ,
+        { "reconnect_ms" , "after_return_ms" , "slc_connects" , "page_time_ms" , "timer_wakeups" , "delivered" , "coalesced" }
+    } ,
+    {
+        "link_loss_absent" , "intercom link loss, peer never returns" , scenarioLinkLossAbsent ,
+        { "give_up_ms" , "slc_connects" , "page_time_ms" , "timer_wakeups" }
+    } ,
+    {
+        "phone_link_loss" , "phone link loss, phone never returns" , scenarioPhoneLinkLoss ,
+        { "give_up_ms" , "hfp_connects" , "page_time_ms" , "timer_wakeups" }
+    } ,
+    {
+        "replay" , "replay the message trace in HOST_TRACE" , scenarioReplay ,
+        { "replayed" , "delivered" , "audio_connects" , "tones" , "slc_connects" }
+    } ,
+} ;
+
+#define HOST_NUM_SCENARIOS ( sizeof ( gScenarios ) / sizeof ( gScenarios [ 0 ] ) )
+
+
+/****************************************************************************
+  RUNNER
+*/
+
+/* Run one scenario in a child process so that every run starts from the post-init state */
+static bool hostRunOnce ( const hostScenario * pScenario , uint32 pSeed , hostResult * pResult )
+{
+    int   lPipe [ 2 ] ;
+    int   lStatus ;
+    pid_t lPid ;
+
+    if ( pipe ( lPipe ) )
+        return FALSE ;
+
+    fflush ( stdout ) ;
+    lPid = fork () ;
+
+    if ( lPid == 0 )
+    {
+        hostResult lResult ;
+
+        memset ( &lResult , 0 , sizeof ( lResult ) ) ;
+        close ( lPipe [ 0 ] ) ;
+
+        HostSeed ( pSeed ) ;
+        pScenario->run ( &lResult ) ;
+
+#ifdef INSTRUMENT_HANDLERS
+        if ( ( pSeed == 1 ) && getenv ( "HOST_DUMP" ) )
+        {
+            printf ( "--- %s run 1\n" , pScenario->name ) ;
+            instrumentDump ( FALSE ) ;
+            fflush ( stdout ) ;
+        }
+#endif
+
+        if ( write ( lPipe [ 1 ] , &lResult , sizeof ( lResult ) ) != sizeof ( lResult ) )
+            _exit ( 1 ) ;
+        _exit ( 0 ) ;
+    }
+
+    close ( lPipe [ 1 ] ) ;
+
+    if ( lPid < 0 )
+    {
+        close ( lPipe [ 0 ] ) ;
+        return FALSE ;
+    }
+
+    lStatus = read ( lPipe [ 0 ] , pResult , sizeof ( *pResult ) ) == sizeof ( *pResult ) ;
+    close ( lPipe [ 0 ] ) ;
+
+    {
+        int lExit ;
+        (void) waitpid ( lPid , &lExit , 0 ) ;
+        return lStatus && WIFEXITED ( lExit ) && ( WEXITSTATUS ( lExit ) == 0 ) ;
+    }
+}
+
+
+static void hostRunScenario ( const hostScenario * pScenario , uint32 pRuns )
+{
+    uint32 lMin [ HOST_MAX_METRICS ] ;
+    uint32 lMax [ HOST_MAX_METRICS ] ;
+    double lSum [ HOST_MAX_METRICS ] ;
+    uint32 lCount [ HOST_MAX_METRICS ] ;
+    uint32 lCrashed = 0 ;
+    uint32 lRun ;
+    uint16 m ;
+
+    for ( m = 0 ; m < HOST_MAX_METRICS ; m++ )
+    {
+        lMin [ m ]   = HOST_METRIC_FAILED ;
+        lMax [ m ]   = 0 ;
+        lSum [ m ]   = 0 ;
+        lCount [ m ] = 0 ;
+    }
+
+    for ( lRun = 0 ; lRun < pRuns ; lRun++ )
+    {
+        hostResult lResult ;
+
+        if ( !hostRunOnce ( pScenario , lRun + 1 , &lResult ) )
+        {
+            lCrashed++ ;
+            continue ;
+        }
+
+        for ( m = 0 ; m < HOST_MAX_METRICS && pScenario->metric [ m ] ; m++ )
+        {
+            uint32 lValue = lResult.metric [ m ] ;
+
+            if ( lValue == HOST_METRIC_FAILED )
+                continue ;
+
+            if ( lValue < lMin [ m ] ) lMin [ m ] = lValue ;
+            if ( lValue > lMax [ m ] ) lMax [ m ] = lValue ;
+            lSum [ m ] += lValue ;
+            lCount [ m ]++ ;
+        }
+    }
+
+    for ( m = 0 ; m < HOST_MAX_METRICS && pScenario->metric [ m ] ; m++ )
+    {
+        if ( lCount [ m ] )
+            printf ( "%s %s min=%lu mean=%.1f max=%lu runs=%lu\n" , pScenario->name , pScenario->metric [ m ] ,
+                     (unsigned long) lMin [ m ] , lSum [ m ] / lCount [ m ] , (unsigned long) lMax [ m ] , (unsigned long) lCount [ m ] ) ;
+        else
+            printf ( "%s %s failed runs=0\n" , pScenario->name , pScenario->metric [ m ] ) ;
+    }
+
+    if ( lCrashed )
+        printf ( "%s crashed=%lu\n" , pScenario->name , (unsigned long) lCrashed ) ;
+}
+
+
+void HostScenarioRun ( void )
+{
+    const char * lName = getenv ( "HOST_SCENARIO" ) ;
+    const char * lRuns = getenv ( "HOST_RUNS" ) ;
+    const char * lCost = getenv ( "HOST_DELIVERY_COST_US" ) ;
+    uint32 lNumRuns = lRuns ? (uint32) strtoul ( lRuns , NULL , 10 ) : HOST_DEFAULT_RUNS ;
+    bool lFound = FALSE ;
+    uint16 i ;
+
+    HostSetDeliveryCost ( lCost ? (uint16) strtoul ( lCost , NULL , 10 ) : HOST_DEFAULT_COST_US ) ;
+    HostSetLaneClassifier ( hostClassify ) ;
+#ifdef TRACE_MESSAGES
+    HostSetPanicHook ( hostTraceOnPanic ) ;
+#endif
+
+    for ( i = 0 ; i < HOST_NUM_SCENARIOS ; i++ )
+    {
+        bool lAll = !lName || !strcmp ( lName , "all" ) ;
+
+            /*a replay needs a trace to be named*/
+        if ( lAll && ( gScenarios [ i ].run == scenarioReplay ) && !getenv ( "HOST_TRACE" ) )
+            continue ;
+
+        if ( lAll || !strcmp ( lName , gScenarios [ i ].name ) )
+        {
+            hostRunScenario ( &gScenarios [ i ] , lNumRuns ? lNumRuns : 1 ) ;
+            lFound = TRUE ;
+        }
+    }
+
+    if ( !lFound )
+    {
+        printf ( "unknown scenario '%s', available:\n" , lName ) ;
+        for ( i = 0 ; i < HOST_NUM_SCENARIOS ; i++ )
+            printf ( "  %-20s %s\n" , gScenarios [ i ].name , gScenarios [ i ].description ) ;
+        exit ( 1 ) ;
+    }
+}
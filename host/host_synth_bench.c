@@ -0,0 +1,230 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    host_synth_bench.c
+@brief   Golden output check and microbenchmark of the tone synth (headset_synth.c).
+
+    Renders every script of gFixedTones with the synth, a conference frame
+    of BENCH_BLOCK samples at a time, and checks it against the reference
+    rendering of host_tone_render.c, which reads the scripts without
+    assuming how audio.h packs them and synthesises in floating point. One
+    line is printed per tone:
+        golden id=<n> samples=<n> ref_samples=<n> snr_db=<n> crc=<n> ok|FAIL
+    A tone passes if it is the same length as the reference and within
+    BENCH_GOLDEN_DB of it. crc is the CRC-32 of the synth's samples; with
+    HOST_SYNTH_GOLDEN=<file> the CRCs are written to the file if there is
+    none, and otherwise must match those in it, so that any change to the
+    synth's output is seen. Then the speed of each tone is printed, the
+    best of HOST_BENCH_RUNS (default 20) renderings, capped at 10s of
+    audio a run:
+        synth id=<n> samples_per_s=<n> ns_per_sample=<n> cycles_per_sample=<n>
+    and the speed over all of them. Exits 1 if any tone fails.
+*/
+
+#include "headset_synth.h"
+#include "headset_tone_scripts.h"
+#include "host_tone_render.h"
+#include "host_bench.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+
+/* Samples rendered at a time, a 7.5ms conference frame */
+#define BENCH_BLOCK         (60)
+
+/* Least signal to difference from the reference a tone must have */
+#define BENCH_GOLDEN_DB     (45.0)
+
+/* Most of a tone timed each run, 10s */
+#define BENCH_MAX_TIMED     ( 10UL * SYNTH_RATE )
+
+
+static unsigned long gCrc [ NUM_FIXED_TONES ] ;
+
+
+static unsigned long benchCrc ( unsigned long pCrc , const int16 * pSamples , unsigned long pCount )
+{
+    unsigned long i ;
+    int b ;
+
+    for ( i = 0 ; i < pCount ; i++ )
+    {
+        pCrc ^= (unsigned long) ( pSamples [ i ] & 0xffff ) ;
+        for ( b = 0 ; b < 16 ; b++ )
+            pCrc = ( pCrc >> 1 ) ^ ( ( pCrc & 1 ) ? 0xedb88320UL : 0 ) ;
+    }
+    return pCrc ;
+}
+
+
+/* Render up to pMax samples of a script a block at a time */
+static unsigned long benchRender ( const audio_note * pScript , int16 * pOut , unsigned long pMax )
+{
+    synthState_t lState ;
+    unsigned long lCount = 0 ;
+    uint16 lDone ;
+
+    synthStart ( &lState , pScript ) ;
+
+    do
+    {
+        uint16 lWant = ( pMax - lCount < BENCH_BLOCK ) ? (uint16) ( pMax - lCount ) : BENCH_BLOCK ;
+
+        lDone   = synthRender ( &lState , pOut + lCount , lWant ) ;
+        lCount += lDone ;
+    }
+    while ( lDone == BENCH_BLOCK ) ;
+
+    return lCount ;
+}
+
+
+static int benchGolden ( unsigned pTone )
+{
+    const audio_note * lScript = gFixedTones [ pTone - 1 ] ;
+    double lSignal = 0.0 , lNoise = 0.0 , lSnr ;
+    unsigned long lLength , lRefLength , n ;
+    synthResult_t lResult ;
+    int16 * lSynth , * lRef ;
+    int lOk ;
+
+    lLength = synthLength ( lScript , &lResult ) ;
+
+    if ( renderTone ( lScript , NULL , 0 , &lRefLength ) != renderOk )
+        lRefLength = 0 ;
+
+    lSynth = calloc ( lLength + BENCH_BLOCK , sizeof ( int16 ) ) ;
+    lRef   = calloc ( lRefLength + 1 , sizeof ( int16 ) ) ;
+    if ( !lSynth || !lRef )
+        abort () ;
+
+    (void) benchRender ( lScript , lSynth , lLength + BENCH_BLOCK ) ;
+    (void) renderTone ( lScript , lRef , lRefLength , &lRefLength ) ;
+
+    for ( n = 0 ; n < lLength && n < lRefLength ; n++ )
+    {
+        double lError = (double) lSynth [ n ] - lRef [ n ] ;
+
+        lSignal += (double) lRef [ n ] * lRef [ n ] ;
+        lNoise  += lError * lError ;
+    }
+
+    lSnr = 10.0 * log10 ( ( lSignal + 1.0 ) / ( lNoise + 1.0 ) ) ;
+    gCrc [ pTone - 1 ] = benchCrc ( 0xffffffffUL , lSynth , lLength ) ^ 0xffffffffUL ;
+    lOk  = ( lResult == synthOk ) && lLength && ( lLength == lRefLength ) && ( lSnr >= BENCH_GOLDEN_DB ) ;
+
+    printf ( "golden id=%u samples=%lu ref_samples=%lu snr_db=%.1f crc=%08lx %s\n" ,
+             pTone , lLength , lRefLength , lSnr , gCrc [ pTone - 1 ] , lOk ? "ok" : "FAIL" ) ;
+
+    free ( lSynth ) ;
+    free ( lRef ) ;
+    return lOk ;
+}
+
+
+/* Compare the CRCs with those in the golden file, or write it */
+static int benchGoldenFile ( const char * pName )
+{
+    FILE * lFile = fopen ( pName , "r" ) ;
+    unsigned t ;
+    int lOk = 1 ;
+
+    if ( !lFile )
+    {
+        if ( !( lFile = fopen ( pName , "w" ) ) )
+            return 0 ;
+        for ( t = 0 ; t < NUM_FIXED_TONES ; t++ )
+            fprintf ( lFile , "%u %08lx\n" , t + 1 , gCrc [ t ] ) ;
+        fclose ( lFile ) ;
+        printf ( "golden file %s written\n" , pName ) ;
+        return 1 ;
+    }
+
+    for ( t = 0 ; t < NUM_FIXED_TONES ; t++ )
+    {
+        unsigned lTone ;
+        unsigned long lCrc ;
+
+        if ( ( fscanf ( lFile , "%u %lx" , &lTone , &lCrc ) != 2 ) || ( lTone != t + 1 ) || ( lCrc != gCrc [ t ] ) )
+        {
+            printf ( "golden file %s: tone %u differs\n" , pName , t + 1 ) ;
+            lOk = 0 ;
+        }
+    }
+    fclose ( lFile ) ;
+
+    if ( lOk )
+        printf ( "golden file %s matches\n" , pName ) ;
+    return lOk ;
+}
+
+
+int main ( void )
+{
+    const char * lEnv = getenv ( "HOST_BENCH_RUNS" ) ;
+    const char * lGolden = getenv ( "HOST_SYNTH_GOLDEN" ) ;
+    unsigned lRuns = lEnv ? (unsigned) strtoul ( lEnv , NULL , 10 ) : 20 ;
+    double lTotalTime = 0.0 ;
+    unsigned long long lTotalCycles = 0 ;
+    unsigned long lTotalSamples = 0 ;
+    int16 * lOut ;
+    int lOk = 1 ;
+    unsigned t , r ;
+
+    if ( !lRuns )
+        return 1 ;
+
+    for ( t = 1 ; t <= NUM_FIXED_TONES ; t++ )
+        lOk &= benchGolden ( t ) ;
+
+    if ( lGolden )
+        lOk &= benchGoldenFile ( lGolden ) ;
+
+    lOut = malloc ( ( BENCH_MAX_TIMED + BENCH_BLOCK ) * sizeof ( int16 ) ) ;
+    if ( !lOut )
+        abort () ;
+
+    for ( t = 1 ; t <= NUM_FIXED_TONES ; t++ )
+    {
+        double lBest = 1e9 ;
+        unsigned long long lBestCycles = 0 ;
+        unsigned long lSamples = 0 ;
+
+        for ( r = 0 ; r < lRuns ; r++ )
+        {
+            unsigned long long lCycles = BENCH_CYCLES () ;
+            double lStart = benchNow () ;
+
+            lSamples = benchRender ( gFixedTones [ t - 1 ] , lOut , BENCH_MAX_TIMED ) ;
+
+            lStart  = benchNow () - lStart ;
+            lCycles = BENCH_CYCLES () - lCycles ;
+            if ( lStart < lBest )
+            {
+                lBest       = lStart ;
+                lBestCycles = lCycles ;
+            }
+        }
+
+        if ( !lSamples )
+            continue ;
+
+        printf ( "synth id=%u samples_per_s=%.0f ns_per_sample=%.2f cycles_per_sample=%.1f\n" ,
+                 t , lSamples / lBest , lBest * 1e9 / lSamples , (double) lBestCycles / lSamples ) ;
+
+        lTotalTime    += lBest ;
+        lTotalCycles  += lBestCycles ;
+        lTotalSamples += lSamples ;
+    }
+
+    printf ( "synth all samples_per_s=%.0f ns_per_sample=%.2f cycles_per_sample=%.1f realtime_x=%.0f\n" ,
+             lTotalSamples / lTotalTime , lTotalTime * 1e9 / lTotalSamples ,
+             (double) lTotalCycles / lTotalSamples , lTotalSamples / lTotalTime / SYNTH_RATE ) ;
+
+    free ( lOut ) ;
+    return lOk ? 0 : 1 ;
+}
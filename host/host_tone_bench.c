@@ -0,0 +1,128 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    host_tone_bench.c
+@brief   Benchmark of the tone cache (headset_tone_cache.c) against scripts.
+
+    For each fixed tone short enough to cache, compares producing it from
+    its audio_note script at play time - reading the script and
+    synthesising the notes, as host_tone_render.c does - with expanding
+    its mu-law table, and prints one line per tone:
+        tone id=<n> ms=<n> words=<n> snr_db=<n> script_start_us=<n> cache_start_us=<n> script_us=<n> cache_us=<n>
+    The start is the time to the first block of TONE_CACHE_BLOCK samples
+    the sink is given, the others the time for the whole tone. snr_db is
+    of the decoded table against the rendered tone. Times are the best of
+    HOST_BENCH_RUNS (default 200) runs. The script path here stands for
+    the interpretation the firmware does in AudioPlayTone, which cannot be
+    run on the host.
+*/
+
+#include "host_tone_render.h"
+#include "headset_tone_cache.h"
+#include "headset_tone_scripts.h"
+#include "host_bench.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+
+/* As headset_tone_cache.c writes to the sink */
+#define BENCH_BLOCK         (32)
+
+#define BENCH_MAX_SAMPLES   ( TONE_CACHE_MAX_MS * ( TONE_CACHE_RATE / 1000 ) + TONE_CACHE_PER_WORD )
+
+
+static int16 gRendered [ BENCH_MAX_SAMPLES ] ;
+static int16 gDecoded [ BENCH_MAX_SAMPLES ] ;
+static uint16 gCodes [ TONE_CACHE_WORDS ( BENCH_MAX_SAMPLES ) ] ;
+
+
+/* Decode a table a block at a time, as the cache plays it */
+static void benchDecode ( unsigned long pSamples , unsigned long pMax )
+{
+    unsigned long n ;
+
+    for ( n = 0 ; ( n < pSamples ) && ( n < pMax ) ; n += BENCH_BLOCK )
+    {
+        unsigned long lCount = ( pSamples - n < BENCH_BLOCK ) ? pSamples - n : BENCH_BLOCK ;
+
+        toneCacheDecode ( gCodes , (uint16) n , &gDecoded [ n ] , (uint16) lCount ) ;
+    }
+}
+
+
+static void benchTone ( unsigned pTone , unsigned pRuns )
+{
+    double lScriptStart = 1e9 , lCacheStart = 1e9 , lScript = 1e9 , lCache = 1e9 ;
+    double lSignal = 0.0 , lNoise = 0.0 ;
+    unsigned long lLength , lPadded , lWords , n ;
+    unsigned r ;
+
+    if ( ( renderTone ( gFixedTones [ pTone - 1 ] , NULL , 0 , &lLength ) != renderOk ) ||
+         ( lLength > TONE_CACHE_MAX_MS * ( TONE_CACHE_RATE / 1000 ) ) )
+        return ;
+
+    lPadded = TONE_CACHE_WORDS ( lLength ) * TONE_CACHE_PER_WORD ;
+    for ( n = 0 ; n < lPadded ; n++ )
+        gRendered [ n ] = 0 ;
+    (void) renderTone ( gFixedTones [ pTone - 1 ] , gRendered , lLength , &lLength ) ;
+    lWords = renderEncode ( gRendered , lPadded , gCodes ) ;
+
+    for ( r = 0 ; r < pRuns ; r++ )
+    {
+        double lStart ;
+        unsigned long lIgnored ;
+
+        lStart = benchNow () ;
+        (void) renderTone ( gFixedTones [ pTone - 1 ] , gRendered , BENCH_BLOCK , &lIgnored ) ;
+        lStart = benchNow () - lStart ;
+        lScriptStart = ( lStart < lScriptStart ) ? lStart : lScriptStart ;
+
+        lStart = benchNow () ;
+        (void) renderTone ( gFixedTones [ pTone - 1 ] , gRendered , lLength , &lIgnored ) ;
+        lStart = benchNow () - lStart ;
+        lScript = ( lStart < lScript ) ? lStart : lScript ;
+
+        lStart = benchNow () ;
+        benchDecode ( lPadded , BENCH_BLOCK ) ;
+        lStart = benchNow () - lStart ;
+        lCacheStart = ( lStart < lCacheStart ) ? lStart : lCacheStart ;
+
+        lStart = benchNow () ;
+        benchDecode ( lPadded , lPadded ) ;
+        lStart = benchNow () - lStart ;
+        lCache = ( lStart < lCache ) ? lStart : lCache ;
+    }
+
+    for ( n = 0 ; n < lLength ; n++ )
+    {
+        double lError = (double) gDecoded [ n ] - gRendered [ n ] ;
+
+        lSignal += (double) gRendered [ n ] * gRendered [ n ] ;
+        lNoise  += lError * lError ;
+    }
+
+    printf ( "tone id=%u ms=%lu words=%lu snr_db=%.1f script_start_us=%.2f cache_start_us=%.2f script_us=%.1f cache_us=%.1f\n" ,
+             pTone , lLength * 1000 / TONE_CACHE_RATE , lWords ,
+             10.0 * log10 ( ( lSignal + 1.0 ) / ( lNoise + 1.0 ) ) ,
+             lScriptStart * 1e6 , lCacheStart * 1e6 , lScript * 1e6 , lCache * 1e6 ) ;
+}
+
+
+int main ( void )
+{
+    const char * lEnv = getenv ( "HOST_BENCH_RUNS" ) ;
+    unsigned lRuns = lEnv ? (unsigned) strtoul ( lEnv , NULL , 10 ) : 200 ;
+    unsigned t ;
+
+    if ( !lRuns )
+        return 1 ;
+
+    for ( t = 1 ; t <= NUM_FIXED_TONES ; t++ )
+        benchTone ( t , lRuns ) ;
+
+    return 0 ;
+}
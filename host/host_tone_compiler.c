@@ -0,0 +1,110 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    host_tone_compiler.c
+@brief   Writes the tone cache tables (headset_tone_tables.c) from the fixed tones.
+
+    Renders each script of gFixedTones (headset_tone_scripts.c) at 8kHz
+    and, if it is no longer than TONE_CACHE_MAX_MS, encodes it as packed
+    mu-law. The tables and their index, gToneCache, are written to the
+    file named on the command line:
+        host_tone_compiler ../headset_tone_tables.c
+    Tones too long to cache, or whose scripts the renderer cannot read,
+    are given an empty entry and are played by AudioPlayTone. Build it
+    with the same product defines as the application, since they change
+    some scripts ("make tone_tables" does).
+*/
+
+#include "host_tone_render.h"
+#include "headset_tone_cache.h"
+#include "headset_tone_scripts.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+
+/* Codes per line of the tables written */
+#define COMPILER_PER_LINE   (8)
+
+
+int main ( int argc , char * argv [] )
+{
+    static int16 lSamples [ TONE_CACHE_MAX_MS * ( TONE_CACHE_RATE / 1000 ) + TONE_CACHE_PER_WORD ] ;
+    static uint16 lCodes [ TONE_CACHE_WORDS ( sizeof ( lSamples ) / sizeof ( lSamples [ 0 ] ) ) ] ;
+    const unsigned long lMax = TONE_CACHE_MAX_MS * ( TONE_CACHE_RATE / 1000 ) ;
+    unsigned long lLength [ NUM_FIXED_TONES ] ;
+    unsigned long lWords = 0 ;
+    FILE * lFile ;
+    unsigned t ;
+
+    if ( ( argc != 2 ) || !( lFile = fopen ( argv [ 1 ] , "w" ) ) )
+    {
+        fprintf ( stderr , "usage: %s <headset_tone_tables.c>\n" , argv [ 0 ] ) ;
+        return 1 ;
+    }
+
+    fprintf ( lFile , "/****************************************************************************\n"
+                      "Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008\n"
+                      "*/\n\n"
+                      "/*!\n"
+                      "@file    headset_tone_tables.c\n"
+                      "@brief   Tone cache tables, written by host/host_tone_compiler.c.\n\n"
+                      "    Do not edit: run \"make -C host tone_tables\" after changing\n"
+                      "    headset_tone_scripts.c.\n"
+                      "*/\n\n"
+                      "#include \"headset_tone_cache.h\"\n"
+                      "#include \"headset_tone_scripts.h\"\n\n"
+                      "#ifdef TONE_CACHE\n" ) ;
+
+    for ( t = 0 ; t < NUM_FIXED_TONES ; t++ )
+    {
+        unsigned long lPadded , lCount , i ;
+
+        lLength [ t ] = 0 ;
+
+        if ( renderTone ( gFixedTones [ t ] , lSamples , lMax , &lLength [ t ] ) != renderOk )
+        {
+            fprintf ( stderr , "tone %u: script not understood, left to AudioPlayTone\n" , t + 1 ) ;
+            fprintf ( lFile , "\n/* Tone %u: script not understood, played by AudioPlayTone */\n" , t + 1 ) ;
+            continue ;
+        }
+        if ( lLength [ t ] > lMax )
+        {
+            fprintf ( lFile , "\n/* Tone %u: %lums, longer than TONE_CACHE_MAX_MS, played by AudioPlayTone */\n" ,
+                      t + 1 , lLength [ t ] * 1000 / TONE_CACHE_RATE ) ;
+            lLength [ t ] = 0 ;
+            continue ;
+        }
+
+            /*a whole number of words, padded with silence*/
+        lPadded = TONE_CACHE_WORDS ( lLength [ t ] ) * TONE_CACHE_PER_WORD ;
+        for ( i = lLength [ t ] ; i < lPadded ; i++ )
+            lSamples [ i ] = 0 ;
+        lLength [ t ] = lPadded ;
+
+        lCount  = renderEncode ( lSamples , lPadded , lCodes ) ;
+        lWords += lCount ;
+
+        fprintf ( lFile , "\n/* Tone %u: %lu samples, %lums */\nstatic const uint16 gTone%u [ %lu ] =\n{" ,
+                  t + 1 , lPadded , lPadded * 1000 / TONE_CACHE_RATE , t + 1 , lCount ) ;
+        for ( i = 0 ; i < lCount ; i++ )
+            fprintf ( lFile , "%s0x%04x%s" , ( i % COMPILER_PER_LINE ) ? " " : "\n    " , lCodes [ i ] , ( i + 1 < lCount ) ? " ," : "" ) ;
+        fprintf ( lFile , "\n} ;\n" ) ;
+    }
+
+    fprintf ( lFile , "\n\nconst toneCacheEntry_t gToneCache [ NUM_FIXED_TONES ] =\n{\n" ) ;
+    for ( t = 0 ; t < NUM_FIXED_TONES ; t++ )
+    {
+        if ( lLength [ t ] )
+            fprintf ( lFile , "    { gTone%u , %lu }%s\n" , t + 1 , lLength [ t ] , ( t + 1 < NUM_FIXED_TONES ) ? " ," : "" ) ;
+        else
+            fprintf ( lFile , "    { 0 , 0 }%s\n" , ( t + 1 < NUM_FIXED_TONES ) ? " ," : "" ) ;
+    }
+    fprintf ( lFile , "} ;\n\n#endif /* TONE_CACHE */\n" ) ;
+
+    fclose ( lFile ) ;
+    fprintf ( stderr , "%lu words of tables\n" , lWords ) ;
+    return 0 ;
+}
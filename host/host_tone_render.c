@@ -0,0 +1,271 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    host_tone_render.c
+@brief   Implementation of the host rendering of audio_note scripts.
+*/
+
+#include "host_tone_render.h"
+#include "headset_tone_cache.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+
+/* Longest script read, in notes */
+#define RENDER_MAX_NOTES    (256)
+
+/* Durations are counted in hemidemisemiquavers, sixteen to the beat */
+#define RENDER_PER_BEAT     (16)
+
+/* What a script word does */
+typedef enum
+{
+    wordEnd ,
+    wordNote ,
+    wordTie ,
+    wordTempo ,
+    wordVolume ,
+    wordSine
+} renderWord_t ;
+
+typedef struct
+{
+    audio_note      word ;
+    renderWord_t    kind ;
+    int             value ;         /* Pitch, MIDI numbering, or -1 for a rest; tempo; volume */
+    int             units ;         /* Duration of a note in hemidemisemiquavers */
+    unsigned        order ;         /* Added before those with a higher order */
+} renderKnown_t ;
+
+typedef struct
+{
+    int             pitch ;
+    unsigned long   start ;         /* First sample */
+    unsigned long   end ;           /* First sample after it */
+    int             tied ;          /* Continues the note before */
+    int             volume ;
+} renderNote_t ;
+
+
+static renderKnown_t * gKnown ;
+static unsigned gKnownCount ;
+static unsigned gKnownSize ;
+
+
+static void renderAdd ( audio_note pWord , renderWord_t pKind , int pValue , int pUnits )
+{
+    if ( gKnownCount == gKnownSize )
+    {
+        gKnownSize = gKnownSize ? 2 * gKnownSize : 1024 ;
+        gKnown     = realloc ( gKnown , gKnownSize * sizeof ( renderKnown_t ) ) ;
+        if ( !gKnown )
+            abort () ;
+    }
+
+    gKnown [ gKnownCount ].word  = pWord ;
+    gKnown [ gKnownCount ].kind  = pKind ;
+    gKnown [ gKnownCount ].value = pValue ;
+    gKnown [ gKnownCount ].units = pUnits ;
+    gKnown [ gKnownCount ].order = gKnownCount ;
+    gKnownCount++ ;
+}
+
+
+/* Every note and tie of every duration, by the SDK's macros. The names are
+   pasted, so each must be written out */
+#define RENDER_DURATION(n,p,d,u)    renderAdd ( AUDIO_NOTE ( n , d ) , wordNote , p , u ) ; \
+                                    renderAdd ( AUDIO_NOTE_TIE ( n , d ) , wordTie , p , u ) ;
+#define RENDER_PITCH(n,p)           RENDER_DURATION(n,p,SEMIBREVE,64) RENDER_DURATION(n,p,MINIM,32) \
+                                    RENDER_DURATION(n,p,CROTCHET,16) RENDER_DURATION(n,p,QUAVER,8) \
+                                    RENDER_DURATION(n,p,SEMIQUAVER,4) RENDER_DURATION(n,p,DEMISEMIQUAVER,2) \
+                                    RENDER_DURATION(n,p,HEMIDEMISEMIQUAVER,1)
+#define RENDER_OCTAVE(o)            RENDER_PITCH(C##o,12*o+12) RENDER_PITCH(CS##o,12*o+13) RENDER_PITCH(DF##o,12*o+13) \
+                                    RENDER_PITCH(D##o,12*o+14) RENDER_PITCH(DS##o,12*o+15) RENDER_PITCH(EF##o,12*o+15) \
+                                    RENDER_PITCH(E##o,12*o+16) RENDER_PITCH(F##o,12*o+17) RENDER_PITCH(FS##o,12*o+18) \
+                                    RENDER_PITCH(G##o,12*o+19) RENDER_PITCH(GS##o,12*o+20) RENDER_PITCH(AF##o,12*o+20) \
+                                    RENDER_PITCH(A##o,12*o+21) RENDER_PITCH(BF##o,12*o+22) RENDER_PITCH(B##o,12*o+23)
+
+
+static int renderCompare ( const void * pA , const void * pB )
+{
+    const renderKnown_t * a = pA ;
+    const renderKnown_t * b = pB ;
+
+    return ( a->word > b->word ) - ( a->word < b->word ) ;
+}
+
+
+/* Sorted by word, and of the same word the first added first */
+static int renderCompareOrder ( const void * pA , const void * pB )
+{
+    const renderKnown_t * a = pA ;
+    const renderKnown_t * b = pB ;
+
+    if ( a->word != b->word )
+        return renderCompare ( pA , pB ) ;
+    return ( a->order > b->order ) - ( a->order < b->order ) ;
+}
+
+
+/* The table of known words, sorted, with only the first meaning of any
+   word that more than one value gives */
+static void renderKnow ( void )
+{
+    unsigned i , j ;
+    int v ;
+
+    if ( gKnownCount )
+        return ;
+
+    renderAdd ( AUDIO_END , wordEnd , 0 , 0 ) ;
+    RENDER_PITCH(REST,-1)
+    RENDER_OCTAVE(5)
+    RENDER_OCTAVE(6)
+    RENDER_OCTAVE(7)
+    renderAdd ( AUDIO_TIMBRE ( sine ) , wordSine , 0 , 0 ) ;
+    for ( v = 1 ; v <= 4095 ; v++ )
+        renderAdd ( AUDIO_TEMPO ( v ) , wordTempo , v , 0 ) ;
+    for ( v = 0 ; v <= 255 ; v++ )
+        renderAdd ( AUDIO_VOLUME ( v ) , wordVolume , v , 0 ) ;
+
+    qsort ( gKnown , gKnownCount , sizeof ( renderKnown_t ) , renderCompareOrder ) ;
+
+    for ( i = 0 , j = 0 ; i < gKnownCount ; i++ )
+    {
+        if ( !j || ( gKnown [ i ].word != gKnown [ j - 1 ].word ) )
+            gKnown [ j++ ] = gKnown [ i ] ;
+    }
+    gKnownCount = j ;
+}
+
+
+static const renderKnown_t * renderLookUp ( audio_note pWord )
+{
+    renderKnown_t lKey ;
+
+    lKey.word = pWord ;
+    return bsearch ( &lKey , gKnown , gKnownCount , sizeof ( renderKnown_t ) , renderCompare ) ;
+}
+
+
+/**************************************************************************/
+renderResult_t renderTone ( const audio_note * pScript , int16 * pOut , unsigned long pMax , unsigned long * pLength )
+{
+    static renderNote_t lNotes [ RENDER_MAX_NOTES ] ;
+    unsigned lCount = 0 ;
+    int lTempo = 120 , lVolume = 64 ;
+    double lTime = 0.0 ;
+    double lPhase = 0.0 ;
+    unsigned long n ;
+    unsigned i ;
+
+    renderKnow () ;
+    *pLength = 0 ;
+
+        /*read the script into notes*/
+    for ( ; ; pScript++ )
+    {
+        const renderKnown_t * lKnown = renderLookUp ( *pScript ) ;
+
+        if ( !lKnown || ( lCount == RENDER_MAX_NOTES ) )
+            return renderUnknown ;
+
+        if ( lKnown->kind == wordEnd )
+            break ;
+
+        switch ( lKnown->kind )
+        {
+        case wordTempo:
+            lTempo = lKnown->value ;
+            break ;
+        case wordVolume:
+            lVolume = lKnown->value ;
+            break ;
+        case wordNote:
+        case wordTie:
+            lNotes [ lCount ].pitch  = lKnown->value ;
+            lNotes [ lCount ].start  = (unsigned long) floor ( lTime * RENDER_RATE + 0.5 ) ;
+            lNotes [ lCount ].tied   = ( lKnown->kind == wordTie ) && lCount && ( lNotes [ lCount - 1 ].pitch == lKnown->value ) ;
+            lNotes [ lCount ].volume = lVolume ;
+            lTime += 60.0 * lKnown->units / ( (double) lTempo * RENDER_PER_BEAT ) ;
+            lNotes [ lCount ].end    = (unsigned long) floor ( lTime * RENDER_RATE + 0.5 ) ;
+            lCount++ ;
+            break ;
+        default:
+            break ;
+        }
+    }
+
+    if ( lCount )
+        *pLength = lNotes [ lCount - 1 ].end ;
+
+        /*then play them, with the phase carried from note to note*/
+    for ( i = 0 , n = 0 ; ( i < lCount ) && ( n < pMax ) ; i++ )
+    {
+        const renderNote_t * lNote = &lNotes [ i ] ;
+        int lTiedOn = ( i + 1 < lCount ) && lNotes [ i + 1 ].tied ;
+        double lStep = ( lNote->pitch < 0 ) ? 0.0 : 2 * M_PI * 440.0 * pow ( 2.0 , ( lNote->pitch - 69 ) / 12.0 ) / RENDER_RATE ;
+        unsigned long lFade = ( lNote->end - lNote->start ) / 2 ;
+
+        if ( lFade > RENDER_FADE )
+            lFade = RENDER_FADE ;
+
+        for ( n = lNote->start ; ( n < lNote->end ) && ( n < pMax ) ; n++ )
+        {
+            double lGain = ( lNote->pitch < 0 ) ? 0.0 : lNote->volume * 128.0 ;
+
+            if ( !lNote->tied && ( n - lNote->start < lFade ) )
+                lGain *= (double) ( n - lNote->start + 1 ) / ( lFade + 1 ) ;
+            if ( !lTiedOn && ( lNote->end - n <= lFade ) )
+                lGain *= (double) ( lNote->end - n ) / ( lFade + 1 ) ;
+
+            pOut [ n ] = (int16) floor ( lGain * sin ( lPhase ) + 0.5 ) ;
+            lPhase = fmod ( lPhase + lStep , 2 * M_PI ) ;
+        }
+    }
+
+    return renderOk ;
+}
+
+
+/* G.711 mu-law code of a sample */
+static uint16 renderMuLaw ( int16 pSample )
+{
+    long lMagnitude = pSample ;
+    uint16 lSign = 0 ;
+    uint16 lExponent = 7 ;
+
+    if ( lMagnitude < 0 )
+    {
+        lMagnitude = -lMagnitude ;
+        lSign      = 0x80 ;
+    }
+    if ( lMagnitude > 32635 )
+        lMagnitude = 32635 ;
+    lMagnitude += 0x84 ;
+
+    while ( lExponent && !( lMagnitude & ( 0x80L << lExponent ) ) )
+        lExponent-- ;
+
+    return ~( lSign | ( lExponent << 4 ) | ( ( lMagnitude >> ( lExponent + 3 ) ) & 0x0f ) ) & 0xff ;
+}
+
+
+/**************************************************************************/
+unsigned long renderEncode ( const int16 * pIn , unsigned long pSamples , uint16 * pCodes )
+{
+    unsigned long n ;
+
+    for ( n = 0 ; n < pSamples ; n++ )
+    {
+        if ( n & 1 )
+            pCodes [ n / TONE_CACHE_PER_WORD ] |= renderMuLaw ( pIn [ n ] ) ;
+        else
+            pCodes [ n / TONE_CACHE_PER_WORD ] = renderMuLaw ( pIn [ n ] ) << 8 ;
+    }
+
+    return TONE_CACHE_WORDS ( pSamples ) ;
+}
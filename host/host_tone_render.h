@@ -0,0 +1,75 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    host_tone_render.h
+@brief   Rendering of audio_note scripts into PCM and mu-law on the host.
+
+    Shared by the tone compiler, which writes the tone cache tables, and
+    the tone benchmark. Scripts are read with the SDK's own macros: each
+    word is looked up among the words AUDIO_NOTE, AUDIO_NOTE_TIE,
+    AUDIO_TEMPO, AUDIO_VOLUME, AUDIO_TIMBRE and AUDIO_END give for every
+    value the renderer knows, so nothing depends on how audio.h packs
+    them. Notes are those of octaves 5 to 7, as the fixed tones use, and
+    the timbre is sine; a script with anything else is reported and left
+    to AudioPlayTone.
+
+    A crotchet lasts one beat of the tempo. The sine's amplitude is the
+    volume times 128, so AUDIO_VOLUME(64) is at -12dBFS, and each note is
+    faded in and out over RENDER_FADE samples, except into a tied note,
+    so notes start and stop without a click.
+*/
+
+#ifndef _HOST_TONE_RENDER_H_
+#define _HOST_TONE_RENDER_H_
+
+
+#include <audio.h>
+
+
+/* Sample rate rendered at */
+#define RENDER_RATE         (8000)
+
+/* Samples a note fades in and out over, 2ms */
+#define RENDER_FADE         (16)
+
+
+/* Result of rendering a script */
+typedef enum
+{
+    renderOk ,              /* All the script was read */
+    renderUnknown           /* The script has a word the renderer does not know */
+} renderResult_t ;
+
+
+/*************************************************************************
+NAME
+    renderTone
+
+DESCRIPTION
+    Read pScript and render at most pMax of its samples into pOut, which
+    may be NULL when pMax is 0. *pLength is set to the length of the whole
+    tone in samples, however many were rendered.
+
+RETURNS
+    renderUnknown, with *pLength 0, if the script cannot be read.
+*/
+renderResult_t renderTone ( const audio_note * pScript , int16 * pOut , unsigned long pMax , unsigned long * pLength ) ;
+
+
+/*************************************************************************
+NAME
+    renderEncode
+
+DESCRIPTION
+    Encode pSamples samples of pIn, an even number, as G.711 mu-law into
+    pCodes, packed as toneCacheDecode reads them.
+
+RETURNS
+    The words written.
+*/
+unsigned long renderEncode ( const int16 * pIn , unsigned long pSamples , uint16 * pCodes ) ;
+
+
+#endif /* _HOST_TONE_RENDER_H_ */
@@ -0,0 +1,191 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    host_vad_bench.c
+@brief   Benchmark of the voice activity detector (headset_vad.c).
+
+    Builds HOST_BENCH_SECONDS (default 120) of microphone signal: spoken
+    phrases of 0.5 to 2s, made of synthetic voiced syllables, separated by
+    2 to 6s of noise only. The noise is either hiss (white) or wind (low
+    pass noise whose level swells and falls by 6dB every few seconds), at
+    a range of SNRs against the speech. Each signal is run through vadFrame
+    with both thresholds and one line is printed per case:
+        vad noise=<hiss|wind> snr_db=<n> threshold=<normal|high> detected_pct=<n> latency_ms=<n> false_per_min=<n> ns_per_sample=<n> cycles_per_sample=<n>
+    A phrase is detected when an onset is reported within its first 300ms;
+    latency_ms is the mean delay of those onsets. Any other onset outside a
+    phrase counts as false.
+*/
+
+#include "headset_vad.h"
+#include "host_bench.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+#define BENCH_DETECT_MS     (300)
+#define BENCH_MAX_PHRASES   (1024)
+
+
+/* Phrases of 0.5 to 2s after pauses of 2 to 6s */
+static const benchTalker_t gTalker = { 2.0 , 4.0 , 0.5 , 1.5 , 110.0 , 100.0 , 4000.0 , 0.1 , 0.0 } ;
+
+
+static unsigned long gSamples ;
+static double * gSpeech ;
+static double * gNoise ;
+static int16 * gMic ;
+static benchPhrase_t gPhrases [ BENCH_MAX_PHRASES ] ;
+static unsigned gPhraseCount ;
+static double gSpeechPower ;
+
+
+/* Noise of unit power */
+static void benchNoise ( int pWind )
+{
+    unsigned long lSeed = 11 ;
+    double lLow = 0.0 , lPower = 0.0 ;
+    unsigned long n ;
+
+    for ( n = 0 ; n < gSamples ; n++ )
+    {
+        double lWhite = benchRandom ( &lSeed ) - 0.5 ;
+
+        if ( pWind )
+        {
+            double t = (double) n / BENCH_RATE ;
+
+                /*one pole low pass at about 100Hz, swelling by 6dB over 5s*/
+            lLow = 0.92 * lLow + lWhite ;
+            gNoise [ n ] = lLow * pow ( 2.0 , sin ( 2 * M_PI * 0.2 * t ) ) ;
+        }
+        else
+        {
+            gNoise [ n ] = lWhite ;
+        }
+        lPower += gNoise [ n ] * gNoise [ n ] ;
+    }
+
+    lPower = sqrt ( lPower / gSamples ) ;
+    for ( n = 0 ; n < gSamples ; n++ )
+        gNoise [ n ] /= lPower ;
+}
+
+
+static void benchCase ( const char * pNoise , int pSnr , bool pHigh )
+{
+    double lScale = sqrt ( gSpeechPower / pow ( 10.0 , pSnr / 10.0 ) ) ;
+    unsigned long lFrames = gSamples / VAD_FRAME_SAMPLES ;
+    unsigned long lDetected = 0 , lFalse = 0 ;
+    double lLatency = 0.0 ;
+    unsigned long long lCycles ;
+    double lSeconds ;
+    unsigned lPhrase = 0 ;
+    int lFound = 0 ;
+    vadState_t lState ;
+    unsigned long n , f ;
+
+    for ( n = 0 ; n < gSamples ; n++ )
+    {
+        double lSample = gSpeech [ n ] + lScale * gNoise [ n ] ;
+
+        gMic [ n ] = (int16) ( lSample > 32767 ? 32767 : ( lSample < -32768 ? -32768 : lSample ) ) ;
+    }
+
+        /*timed on its own, then again to score the decisions*/
+    vadInit ( &lState ) ;
+    lState.high = pHigh ;
+    lSeconds = benchNow () ;
+    lCycles  = BENCH_CYCLES () ;
+
+    for ( f = 0 ; f < lFrames ; f++ )
+        lFalse += vadFrame ( &lState , &gMic [ f * VAD_FRAME_SAMPLES ] , VAD_FRAME_SAMPLES ) ;
+
+    lCycles  = BENCH_CYCLES () - lCycles ;
+    lSeconds = benchNow () - lSeconds ;
+    lFalse   = 0 ;
+
+    vadInit ( &lState ) ;
+    lState.high = pHigh ;
+
+    for ( f = 0 ; f < lFrames ; f++ )
+    {
+        unsigned long lEnd = ( f + 1 ) * VAD_FRAME_SAMPLES ;
+        bool lOnset = vadFrame ( &lState , &gMic [ f * VAD_FRAME_SAMPLES ] , VAD_FRAME_SAMPLES ) ;
+
+        while ( ( lPhrase < gPhraseCount ) && ( lEnd > gPhrases [ lPhrase ].end + VAD_HANGOVER_FRAMES * VAD_FRAME_SAMPLES ) )
+        {
+            lPhrase++ ;
+            lFound = 0 ;
+        }
+
+        if ( !lOnset )
+            continue ;
+
+        if ( ( lPhrase < gPhraseCount ) && ( lEnd > gPhrases [ lPhrase ].start ) )
+        {
+            double lDelay = 1000.0 * ( lEnd - gPhrases [ lPhrase ].start ) / BENCH_RATE ;
+
+            if ( !lFound && ( lDelay <= BENCH_DETECT_MS ) )
+            {
+                lDetected++ ;
+                lLatency += lDelay ;
+            }
+            lFound = 1 ;
+        }
+        else
+        {
+            lFalse++ ;
+        }
+    }
+
+    printf ( "vad noise=%s snr_db=%d threshold=%s detected_pct=%.1f latency_ms=%.1f false_per_min=%.2f ns_per_sample=%.2f cycles_per_sample=%.2f\n" ,
+             pNoise , pSnr , pHigh ? "high" : "normal" ,
+             100.0 * lDetected / gPhraseCount ,
+             lDetected ? lLatency / lDetected : 0.0 ,
+             60.0 * lFalse * BENCH_RATE / gSamples ,
+             lSeconds * 1e9 / ( (double) lFrames * VAD_FRAME_SAMPLES ) ,
+             (double) lCycles / ( (double) lFrames * VAD_FRAME_SAMPLES ) ) ;
+}
+
+
+int main ( void )
+{
+    static const int lSnrs [] = { 30 , 20 , 10 , 5 , 0 } ;
+    const char * lEnv = getenv ( "HOST_BENCH_SECONDS" ) ;
+    unsigned long lSeconds = lEnv ? strtoul ( lEnv , NULL , 10 ) : 120 ;
+    unsigned s ;
+    int lWind ;
+
+    gSamples = lSeconds * BENCH_RATE ;
+    gSpeech  = malloc ( gSamples * sizeof ( double ) ) ;
+    gNoise   = malloc ( gSamples * sizeof ( double ) ) ;
+    gMic     = malloc ( gSamples * sizeof ( int16 ) ) ;
+
+    if ( !gSpeech || !gNoise || !gMic )
+        return 1 ;
+
+    gPhraseCount = benchSpeech ( &gTalker , 3 , gSpeech , gSamples , gPhrases , BENCH_MAX_PHRASES , &gSpeechPower ) ;
+    if ( !gPhraseCount )
+        return 1 ;
+
+    for ( lWind = 0 ; lWind <= 1 ; lWind++ )
+    {
+        benchNoise ( lWind ) ;
+
+        for ( s = 0 ; s < sizeof ( lSnrs ) / sizeof ( lSnrs [ 0 ] ) ; s++ )
+        {
+            benchCase ( lWind ? "wind" : "hiss" , lSnrs [ s ] , FALSE ) ;
+            benchCase ( lWind ? "wind" : "hiss" , lSnrs [ s ] , TRUE ) ;
+        }
+    }
+
+    free ( gSpeech ) ;
+    free ( gNoise ) ;
+    free ( gMic ) ;
+    return 0 ;
+}
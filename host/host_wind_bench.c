@@ -0,0 +1,230 @@
+/****************************************************************************
+Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
+*/
+
+/*!
+@file    host_wind_bench.c
+@brief   Benchmark of the wind noise suppression (headset_wind.c).
+
+    Mixes HOST_BENCH_SECONDS (default 60) of synthetic voiced phrases with
+    wind noise at a range of SNRs, suppresses it and prints one line per
+    case:
+        wind snr_db=<n|clean> ssnr_in_db=<n> ssnr_out_db=<n> improvement_db=<n> noise_atten_db=<n> ns_per_frame=<n> cycles_per_frame=<n>
+    The segmental SNRs are taken against the clean speech, delayed by the
+    stage's latency, over the 10ms segments where speech is present and
+    clamped to [-10,35]dB per segment. noise_atten_db is how far the wind
+    alone is reduced in the pauses between phrases. The clean case shows
+    what the stage does to speech with no wind. A frame is 7.5ms, one
+    analysis hop.
+
+    The wind is a recording when HOST_WIND_FILE names a file of raw 16 bit
+    little endian 8kHz mono samples, looped as needed. Otherwise it is
+    modelled: noise below about 300Hz whose level follows random gusts of
+    0.3 to 3s, with buffeting bursts on top.
+*/
+
+#include "headset_wind.h"
+#include "host_bench.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+#define BENCH_SEGMENT       (80)        /* 10ms */
+#define BENCH_CLEAN         (1000)      /* SNR standing for no wind */
+
+
+/* Phrases of 1 to 3s with pauses of 1 to 3s between them */
+static const benchTalker_t gTalker = { 1.0 , 2.0 , 1.0 , 2.0 , 110.0 , 100.0 , 3000.0 , 0.1 , 0.0 } ;
+
+
+static unsigned long gSamples ;
+static double * gSpeech ;
+static double * gWind ;
+static int16 * gMic ;
+static int16 * gOut ;
+static double gSpeechPower ;
+
+
+/* Recorded wind from HOST_WIND_FILE, FALSE if there is none */
+static bool benchWindFile ( void )
+{
+    const char * lName = getenv ( "HOST_WIND_FILE" ) ;
+    unsigned long lRead = 0 ;
+    unsigned char lSample [ 2 ] ;
+    FILE * lFile ;
+    unsigned long n ;
+
+    if ( !lName || !( lFile = fopen ( lName , "rb" ) ) )
+        return FALSE ;
+
+    while ( ( lRead < gSamples ) && ( fread ( lSample , 1 , 2 , lFile ) == 2 ) )
+        gWind [ lRead++ ] = (int16) ( lSample [ 0 ] | ( lSample [ 1 ] << 8 ) ) ;
+
+    fclose ( lFile ) ;
+
+    if ( !lRead )
+        return FALSE ;
+
+    for ( n = lRead ; n < gSamples ; n++ )
+        gWind [ n ] = gWind [ n % lRead ] ;
+    return TRUE ;
+}
+
+
+/* Modelled wind: second order low pass noise with gusts and buffeting */
+static void benchWindModel ( void )
+{
+    unsigned long lSeed = 17 ;
+    double lLow1 = 0.0 , lLow2 = 0.0 ;
+    double lGust = 1.0 , lTarget = 1.0 ;
+    unsigned long lNextGust = 0 ;
+    unsigned long n ;
+
+    for ( n = 0 ; n < gSamples ; n++ )
+    {
+        double lWhite = benchRandom ( &lSeed ) - 0.5 ;
+
+        if ( n == lNextGust )
+        {
+            lTarget   = 0.3 + 1.7 * benchRandom ( &lSeed ) ;
+            lNextGust = n + (unsigned long) ( ( 0.3 + 2.7 * benchRandom ( &lSeed ) ) * BENCH_RATE ) ;
+        }
+        lGust += ( lTarget - lGust ) * 0.0005 ;
+
+            /*two one pole sections at about 250Hz*/
+        lLow1 += ( lWhite - lLow1 ) * 0.18 ;
+        lLow2 += ( lLow1 - lLow2 ) * 0.18 ;
+
+        gWind [ n ] = lLow2 * lGust ;
+
+            /*buffeting: short low thumps*/
+        if ( benchRandom ( &lSeed ) < 2.0 / BENCH_RATE )
+            lGust += 1.5 ;
+    }
+}
+
+
+static void benchWind ( void )
+{
+    double lPower = 0.0 ;
+    unsigned long n ;
+
+    if ( !benchWindFile () )
+        benchWindModel () ;
+
+    for ( n = 0 ; n < gSamples ; n++ )
+        lPower += gWind [ n ] * gWind [ n ] ;
+
+    lPower = sqrt ( lPower / gSamples ) ;
+    for ( n = 0 ; n < gSamples ; n++ )
+        gWind [ n ] = lPower ? gWind [ n ] / lPower : 0.0 ;
+}
+
+
+static void benchCase ( int pSnr )
+{
+    static windState_t lState ;
+    double lScale = ( pSnr == BENCH_CLEAN ) ? 0.0 : sqrt ( gSpeechPower / pow ( 10.0 , pSnr / 10.0 ) ) ;
+    unsigned long lFrames = gSamples / WIND_HOP ;
+    double lInSnr = 0.0 , lOutSnr = 0.0 , lInNoise = 0.0 , lOutNoise = 0.0 ;
+    unsigned long lSegments = 0 ;
+    unsigned long long lCycles ;
+    double lSeconds ;
+    unsigned long n , s ;
+    char lName [ 16 ] ;
+
+    for ( n = 0 ; n < gSamples ; n++ )
+        gMic [ n ] = benchSaturate ( gSpeech [ n ] + lScale * gWind [ n ] ) ;
+
+    memcpy ( gOut , gMic , gSamples * sizeof ( int16 ) ) ;
+    windInit ( &lState ) ;
+
+    lSeconds = benchNow () ;
+    lCycles  = BENCH_CYCLES () ;
+
+    for ( n = 0 ; n + WIND_HOP <= gSamples ; n += WIND_HOP )
+        windProcess ( &lState , &gOut [ n ] , WIND_HOP ) ;
+
+    lCycles  = BENCH_CYCLES () - lCycles ;
+    lSeconds = benchNow () - lSeconds ;
+
+        /*score after the first second, once the noise estimate has settled*/
+    for ( s = BENCH_RATE ; s + BENCH_SEGMENT + WIND_WINDOW <= gSamples ; s += BENCH_SEGMENT )
+    {
+        double lSpeech = 0.0 , lInError = 0.0 , lOutError = 0.0 , lIn = 0.0 , lOut = 0.0 ;
+
+        for ( n = s ; n < s + BENCH_SEGMENT ; n++ )
+        {
+            double lClean = gSpeech [ n ] ;
+            double lOutput = gOut [ n + WIND_WINDOW ] ;
+
+            lSpeech   += lClean * lClean ;
+            lInError  += ( gMic [ n ] - lClean ) * ( gMic [ n ] - lClean ) ;
+            lOutError += ( lOutput - lClean ) * ( lOutput - lClean ) ;
+            lIn       += (double) gMic [ n ] * gMic [ n ] ;
+            lOut      += lOutput * lOutput ;
+        }
+
+        if ( lSpeech > 1e-3 * gSpeechPower * BENCH_SEGMENT )
+        {
+            double lInDb  = 10.0 * log10 ( ( lSpeech + 1.0 ) / ( lInError + 1.0 ) ) ;
+            double lOutDb = 10.0 * log10 ( ( lSpeech + 1.0 ) / ( lOutError + 1.0 ) ) ;
+
+            lInSnr  += lInDb < -10.0 ? -10.0 : ( lInDb > 35.0 ? 35.0 : lInDb ) ;
+            lOutSnr += lOutDb < -10.0 ? -10.0 : ( lOutDb > 35.0 ? 35.0 : lOutDb ) ;
+            lSegments++ ;
+        }
+        else if ( lSpeech == 0.0 )
+        {
+            lInNoise  += lIn ;
+            lOutNoise += lOut ;
+        }
+    }
+
+    if ( pSnr == BENCH_CLEAN )
+        strcpy ( lName , "clean" ) ;
+    else
+        sprintf ( lName , "%d" , pSnr ) ;
+
+    lInSnr  = lSegments ? lInSnr / lSegments : 0.0 ;
+    lOutSnr = lSegments ? lOutSnr / lSegments : 0.0 ;
+
+    printf ( "wind snr_db=%s ssnr_in_db=%.2f ssnr_out_db=%.2f improvement_db=%.2f noise_atten_db=%.2f ns_per_frame=%.1f cycles_per_frame=%.1f\n" ,
+             lName , lInSnr , lOutSnr , lOutSnr - lInSnr ,
+             ( lInNoise > 0.0 && lOutNoise > 0.0 ) ? 10.0 * log10 ( lInNoise / lOutNoise ) : 0.0 ,
+             lSeconds * 1e9 / lFrames ,
+             (double) lCycles / lFrames ) ;
+}
+
+
+int main ( void )
+{
+    static const int lSnrs [] = { BENCH_CLEAN , 10 , 5 , 0 , -5 } ;
+    const char * lEnv = getenv ( "HOST_BENCH_SECONDS" ) ;
+    unsigned long lSeconds = lEnv ? strtoul ( lEnv , NULL , 10 ) : 60 ;
+    unsigned s ;
+
+    gSamples = lSeconds * BENCH_RATE ;
+    gSpeech  = malloc ( gSamples * sizeof ( double ) ) ;
+    gWind    = malloc ( gSamples * sizeof ( double ) ) ;
+    gMic     = malloc ( gSamples * sizeof ( int16 ) ) ;
+    gOut     = malloc ( gSamples * sizeof ( int16 ) ) ;
+
+    if ( !gSpeech || !gWind || !gMic || !gOut || ( gSamples < 2 * BENCH_RATE ) )
+        return 1 ;
+
+    (void) benchSpeech ( &gTalker , 3 , gSpeech , gSamples , NULL , 0 , &gSpeechPower ) ;
+    benchWind () ;
+
+    for ( s = 0 ; s < sizeof ( lSnrs ) / sizeof ( lSnrs [ 0 ] ) ; s++ )
+        benchCase ( lSnrs [ s ] ) ;
+
+    free ( gSpeech ) ;
+    free ( gWind ) ;
+    free ( gMic ) ;
+    free ( gOut ) ;
+    return 0 ;
+}
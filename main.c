@@ -8,30 +8,39 @@ Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
 */
 
 
+#include "headset_a2dp_connection.h"
 #include "headset_a2dp_msg_handler.h"
 #include "headset_a2dp_stream_control.h"
 #include "headset_amp.h"
+#include "headset_audio_switch.h"
 #include "headset_avrcp_event_handler.h"
 #include "headset_avrcp_msg_handler.h"
 #include "headset_charger.h"
 #include "headset_cl_msg_handler.h"
+#include "headset_coalesce.h"
 #include "headset_codec_msg_handler.h"
 #include "headset_debug.h"
+#include "headset_dispatch.h"
 #include "headset_event_handler.h"
 #include "headset_events.h"
 #include "headset_hfp_msg_handler.h"
+#include "headset_hfp_slc.h"
 #include "headset_init.h"
+#include "headset_instrument.h"
 #include "headset_LEDmanager.h"
+#include "headset_pool.h"
 #include "headset_private.h"
 #include "headset_volume.h" /* Natural Volume Increase */
 
 /* Insert code for Intercom by Jace */
 #include "headset_intercom_msg_handler.h"
 #include "headset_statemanager.h"
+#include "headset_trace.h"
 
 #include <string.h>
 #include <a2dp.h>
 #include <avrcp.h>
+#include <bdaddr.h>
 #include <boot.h>
 #include <codec.h>
 #include <connection.h>
@@ -50,6 +59,49 @@ Copyright (C) Cambridge Silicon Radio Ltd. 2004-2008
 #define MAIN_DEBUG(x) 
 #endif
 
+#ifdef TRACE_MESSAGES
+/* Words in a message payload of type t */
+#define TRACE_WORDS(t) ((sizeof(t) + sizeof(uint16) - 1) / sizeof(uint16))
+
+/* The messages whose payloads are traced: those setting up links and audio,
+   which a replay needs to take the same paths. Nothing else's size is known
+   here, so any other message is traced by its id alone */
+static const struct
+{
+    MessageId id;
+    uint16 words;
+} gTracePayloads[] =
+{
+    { HFP_SLC_CONNECT_CFM, TRACE_WORDS(HFP_SLC_CONNECT_CFM_T) },
+    { HFP_SLC_DISCONNECT_IND, TRACE_WORDS(HFP_SLC_DISCONNECT_IND_T) },
+    { HFP_AUDIO_CONNECT_CFM, TRACE_WORDS(HFP_AUDIO_CONNECT_CFM_T) },
+    { HFP_AUDIO_DISCONNECT_IND, TRACE_WORDS(HFP_AUDIO_DISCONNECT_IND_T) },
+    { HFP_SPEAKER_VOLUME_IND, TRACE_WORDS(HFP_SPEAKER_VOLUME_IND_T) },
+    { HFP_CALL_SETUP_IND, TRACE_WORDS(HFP_CALL_SETUP_IND_T) },
+    { HFP_CALL_IND, TRACE_WORDS(HFP_CALL_IND_T) },
+    { A2DP_CONNECT_OPEN_CFM, TRACE_WORDS(A2DP_CONNECT_OPEN_CFM_T) },
+    { A2DP_OPEN_CFM, TRACE_WORDS(A2DP_OPEN_CFM_T) },
+    { AGHFP_SLC_CONNECT_CFM, TRACE_WORDS(AGHFP_SLC_CONNECT_CFM_T) },
+    { AGHFP_SLC_DISCONNECT_IND, TRACE_WORDS(AGHFP_SLC_DISCONNECT_IND_T) },
+    { AGHFP_AUDIO_CONNECT_CFM, TRACE_WORDS(AGHFP_AUDIO_CONNECT_CFM_T) },
+    { AGHFP_AUDIO_DISCONNECT_IND, TRACE_WORDS(AGHFP_AUDIO_DISCONNECT_IND_T) }
+};
+
+
+/* Words of the payload of id to trace, 0 if its size is not known */
+static uint16 traceWords(MessageId id)
+{
+    uint16 i;
+
+    for (i = 0; i < sizeof(gTracePayloads) / sizeof(gTracePayloads[0]); i++)
+    {
+        if (gTracePayloads[i].id == id)
+            return gTracePayloads[i].words;
+    }
+    return 0;
+}
+#endif
+
 
 /* Single instance of the Headset state */
 hsTaskData *theHeadset;
@@ -63,40 +115,57 @@ hsTaskData *theHeadset;
 /* Insert code for Intercom by Jace */
 static void IntercomMode(hsTaskData *app)
 {
+    intercomPeer *first = &app->intercom[0];
+    uint16 links = 0;
+    uint16 i;
+
     MessageCancelAll(&app->task, APP_INTERCOM_MODE);
 
-    if(app->aghfp_connect && app->audio_connect)
+    if(intercomIsAudioActive(app))
     {
-        AghfpAudioDisconnect(app->aghfp);
+        intercomAudioDisconnectAll(app);
     }
-    else if(app->aghfp_initial == FALSE && app->ag_bd_addr.nap == 0 && app->ag_bd_addr.uap == 0 && app->ag_bd_addr.lap == 0)
+    else if(first->link.state == intercomLinkUninitialised && first->bd_addr.nap == 0 && first->bd_addr.uap == 0 && first->bd_addr.lap == 0)
     {
-        AghfpInit(&app->task, aghfp_headset_profile, 0);
+        /* One AGHFP instance for each rider link */
+        for(i = 0; i < INTERCOM_MAX_PEERS; i++)
+            AghfpInit(&app->intercom[i].task, aghfp_headset_profile, 0);
     }
     else
     {
-        if(app->intercom_button) MessageSend(&app->task, EventSkipForward, 0);
-
-        if(app->ag_bd_addr.nap == 0x24 && app->ag_bd_addr.uap == 0xbc && (app->ag_bd_addr.lap >= 0x100000 && app->ag_bd_addr.lap < 0x200000))
-            MessageSend(&app->task, EventSkipForward, 0); /* F100 ȣȯ */
+        if(app->intercom_button) coalesceSend(&app->task, EventSkipForward, 0, coalesceMerge);
 
-        if(app->aghfp_connect)
+        /* The first link is always tried, as before; the others only once they have a rider */
+        for(i = 0; i < INTERCOM_MAX_PEERS; i++)
         {
-#ifndef DUAL_STREAM
-            if((stateManagerGetA2dpState() == headsetA2dpStreaming) || (stateManagerGetA2dpState() == headsetA2dpPaused)) /* SUSPEND */
+            intercomPeer *peer = &app->intercom[i];
+
+            if(i && (peer->link.state == intercomLinkUninitialised || BdaddrIsZero(&peer->bd_addr)))
+                continue;
+
+            if(peer->bd_addr.nap == 0x24 && peer->bd_addr.uap == 0xbc && (peer->bd_addr.lap >= 0x100000 && peer->bd_addr.lap < 0x200000))
+                coalesceSend(&app->task, EventSkipForward, 0, coalesceMerge); /* F100 ȣȯ */
+
+            /* A link already setting up SLC or audio is left to finish */
+            if(peer->link.state >= intercomLinkConnected)
             {
-                streamControlCeaseA2dpStreaming(app, TRUE);
+                if(intercomPeerEvent(peer, intercomEventAudioRequest))
+                {
+                    AghfpAudioConnect(peer->aghfp, sync_all_sco, 0);
+                    links++;
+                }
             }
-#endif
-            AghfpAudioConnect(app->aghfp, sync_all_sco, 0);
-        }
-        else
-        {
-            if(app->intercom_pairing_mode) app->intercom_init = TRUE; /* v100817 v100617 remodify */
-            AghfpSlcConnect(app->aghfp, &app->ag_bd_addr);
+            else if(intercomPeerEvent(peer, intercomEventSlcRequest))
+            {
+                if(app->intercom_pairing_mode) app->intercom_init = TRUE; /* v100817 v100617 remodify */
+                AghfpSlcConnect(peer->aghfp, &peer->bd_addr);
+            }
+
+            MessageSendLater(&peer->task, AGHFP_CONNECT_FAIL_TIMEOUT, 0, D_SEC(10));
         }
 
-        MessageSendLater(&app->task, AGHFP_CONNECT_FAIL_TIMEOUT, 0, D_SEC(10));
+        /* Release A2DP and power the amp while the links negotiate eSCO */
+        audioSwitchStart(app, links);
     }
 }
 
@@ -110,6 +179,8 @@ static void handleAppMessage( Task task, MessageId id, Message message )
     {        
     case APP_RESUME_A2DP:
         MAIN_DEBUG(("APP_RESUME_A2DP\n"));		
+        /* Music resumed after an interruption rises to its volume */
+        VolumeRiseNextA2dp();
         streamControlBeginA2dpStreaming( lApp );
         break;
 	case APP_AVRCP_CONTROLS:
@@ -138,6 +209,18 @@ static void handleAppMessage( Task task, MessageId id, Message message )
         MAIN_DEBUG(("APP_INTERCOM_MODE\n"));
 		IntercomMode(lApp);
 		break;
+	case APP_HFP_RECONNECT:
+		MAIN_DEBUG(("APP_HFP_RECONNECT\n"));
+		/* A failure schedules the next attempt from EventHfpReconnectFailed */
+		if (!hfpSlcIsConnecting(lApp) && !stateManagerIsHfpConnected() && (stateManagerGetHfpState() >= headsetHfpConnectable))
+			hfpSlcConnectRequest(lApp, hfp_handsfree_profile);
+		break;
+	case APP_A2DP_RECONNECT:
+		MAIN_DEBUG(("APP_A2DP_RECONNECT\n"));
+		/* A failure schedules the next attempt from EventA2dpReconnectFailed */
+		if (!a2dpIsConnecting(lApp) && !stateManagerIsA2dpConnected() && (stateManagerGetHfpState() >= headsetHfpConnectable))
+			a2dpReconnectProcedure(lApp);
+		break;
 	default:
 		MAIN_DEBUG(("APP UNHANDLED MSG: 0x%x\n",id));
 		break;
@@ -145,12 +228,44 @@ static void handleAppMessage( Task task, MessageId id, Message message )
 }
 
 
-/* Pass the message to the test harness if running in test mode. */
-#ifdef TEST_HARNESS
-	#define TEST_HANDLE_LIB_MESSAGE(t,i,m) test_handle_lib_message(t, i,  m);
-#else
-	#define TEST_HANDLE_LIB_MESSAGE(t,i,m)
-#endif
+/*************************************************************************
+NAME    
+    registerHandlers
+    
+DESCRIPTION
+    Register the handler for each range of messages received by the
+    application task, and the priority lane of the audio set up messages.
+
+RETURNS
+
+*/
+static void registerHandlers(void)
+{
+    uint16 i;
+
+    dispatchRegister(EVENTS_EVENT_BASE, EVENTS_LAST_EVENT, handleUEMessage, 0);
+    dispatchRegister(CL_MESSAGE_BASE, CL_MESSAGE_TOP, handleCLMessage, DISPATCH_LIB_MESSAGE);
+    dispatchRegister(CODEC_MESSAGE_BASE, CODEC_MESSAGE_TOP, handleCodecMessage, 0);
+    dispatchRegister(HFP_MESSAGE_BASE, HFP_MESSAGE_TOP, handleHFPMessage, DISPATCH_LIB_MESSAGE);
+    dispatchRegister(A2DP_MESSAGE_BASE, A2DP_MESSAGE_TOP, handleA2DPMessage, DISPATCH_LIB_MESSAGE);
+    dispatchRegister(AVRCP_MESSAGE_BASE, AVRCP_MESSAGE_TOP, handleAVRCPMessage, DISPATCH_LIB_MESSAGE);
+    /* Insert code for Intercom by Jace */
+    dispatchRegister(AGHFP_MESSAGE_BASE, AGHFP_MESSAGE_TOP, handleINTERCOMMessage, 0);
+    dispatchRegister(HEADSET_MSG_BASE, HEADSET_MSG_TOP, handleAppMessage, 0);
+
+    /* Audio path set up is served ahead of everything else */
+    dispatchSetLane(getAppTask(), CODEC_MESSAGE_BASE, CODEC_MESSAGE_TOP, dispatchLaneHigh);
+    dispatchSetLane(getAppTask(), HFP_AUDIO_CONNECT_CFM, HFP_AUDIO_CONNECT_CFM, dispatchLaneHigh);
+    dispatchSetLane(getAppTask(), A2DP_START_IND, A2DP_START_IND, dispatchLaneHigh);
+
+    /* Each intercom link has its own task, served by the application handler */
+    for (i = 0; i < INTERCOM_MAX_PEERS; i++)
+    {
+        theHeadset->intercom[i].task.handler = theHeadset->task.handler;
+        dispatchSetLane(&theHeadset->intercom[i].task, AGHFP_AUDIO_CONNECT_CFM, AGHFP_AUDIO_CONNECT_CFM, dispatchLaneHigh);
+    }
+}
+
 
 /*************************************************************************
 NAME    
@@ -158,58 +273,26 @@ NAME
     
 DESCRIPTION
     This is the main message handler for the Headset Application.  All
-    messages pass through this handler to the subsequent handlers.
+    messages pass through this handler to the handler registered for
+    their message range.
 
 RETURNS
 
 */
 static void app_handler(Task task, MessageId id, Message message)
 {
-    /* Determine the message type based on base and offset */
-    if ( ( id >= EVENTS_EVENT_BASE ) && ( id <= EVENTS_LAST_EVENT ) )
-    {
-        /* Message is a User Generated Event */
-        handleUEMessage(task, id,  message);
-    }
-    else if ( (id >= CL_MESSAGE_BASE) && (id <= CL_MESSAGE_TOP) )
-    {
-        handleCLMessage(task, id,  message);
-        TEST_HANDLE_LIB_MESSAGE(task, id,  message);
-    }
-    else if ( (id >= CODEC_MESSAGE_BASE ) && (id <= CODEC_MESSAGE_TOP) )
-    {     
-        handleCodecMessage(task, id,  message);
-    }
-    else if ( (id >= HFP_MESSAGE_BASE ) && (id <= HFP_MESSAGE_TOP) )
-    {     
-        handleHFPMessage(task, id,  message);
-        TEST_HANDLE_LIB_MESSAGE(task, id,  message);
-    }      
-    else if ( (id >= A2DP_MESSAGE_BASE ) && (id <= A2DP_MESSAGE_TOP) )
-    {     
-        handleA2DPMessage(task, id,  message);
-        TEST_HANDLE_LIB_MESSAGE(task, id,  message);
-    }      
-    else if ( (id >= AVRCP_MESSAGE_BASE ) && (id <= AVRCP_MESSAGE_TOP) )
-    {     
-        handleAVRCPMessage(task, id,  message);
-        TEST_HANDLE_LIB_MESSAGE(task, id,  message);
-    }      
-    /* Insert code for Intercom by Jace */
-    else if ( (id >= AGHFP_MESSAGE_BASE ) && (id <= AGHFP_MESSAGE_TOP) )
-    {
-        handleINTERCOMMessage(task, id,  message);
-    }
-	else if ( (id >= HEADSET_MSG_BASE ) && (id <= HEADSET_MSG_TOP) )
-    {     
-        handleAppMessage(task, id,  message);
-    }  
-    else /* This message is not one of the above */
+    TRACE_RECORD(id, message, traceWords(id));
+
+    /* Allow the next coalesced send of this message to be queued */
+    coalesceDelivered(task, id);
+
+    if (!dispatchMessage(task, id, message))
     {
-        /* Pass this message to default handler */
+        /* This message is not one of the registered ranges */
         MAIN_DEBUG(("MSGTYPE ? [%x]\n", id)) ;
     }
 }
+INSTRUMENTED_HANDLER(instrumentApp, app_handler)
 
 
 Task getAppTask(void)
@@ -231,7 +314,14 @@ int main(void)
     memset(theHeadset, 0, sizeof(hsTaskData));
 
     /* Set up the Application task handler */
-    theHeadset->task.handler = app_handler;
+    theHeadset->task.handler = INSTRUMENT(app_handler);
+    registerHandlers();
+
+    /* Set up the fixed block pools before anything allocates from them */
+    poolInit();
+
+    /* Report the trace stored at the last power off */
+    TRACE_REPORT_STORED();
 
     /* Initialise the data contained in the hsTaskData structure */
     InitHeadsetData(theHeadset);